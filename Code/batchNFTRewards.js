@@ -1,4 +1,5 @@
-const { Client, Wallet } = require('xrpl');
+const { Client, Wallet, decodeAccountID, dropsToXrp } = require('xrpl');
+const { distribute, packHolders } = require('../backend/native');
 
 async function batchNFTRewards() {
   const client = new Client('wss://s1.ripple.com');
@@ -7,27 +8,40 @@ async function batchNFTRewards() {
 
   // Query NFT holders (5+ NFTs)
   const nftHolders = await fetchNFTHolders('issuer_r_address', 5);
-  const totalNFTs = nftHolders.reduce((sum, h) => sum + h.nftCount, 0);
   const dailyRewards = await fetchDailyRewards(); // Assume 100 $DRIPPY daily
 
   // Convert to XRP (~$0.00016966 per $DRIPPY)
   const nftRewardXRP = (dailyRewards * 0.01 * 16966) / 1000000; // 1% in XRP drops
-  for (const holder of nftHolders) {
-    const share = (nftRewardXRP * holder.nftCount) / totalNFTs;
-    if (share > 0) {
+  // Exact drops per holder (the pool is already in drops, whole drops only); the
+  // shares add up to the pool
+  const nftShares = prorata(nftHolders, BigInt(Math.floor(nftRewardXRP)), 'nfts');
+  for (let i = 0; i < nftHolders.length; i++) {
+    const share = nftShares[i];
+    if (share > 0n) {
       const tx = {
         TransactionType: 'Payment',
         Account: 'rwprJf1ZEU3foKSiwhDg5kj9zDWFtPgMqJ',
-        Destination: holder.address,
+        Destination: nftHolders[i].address,
         Amount: share.toString(), // XRP drops
       };
       await client.submit(tx, { wallet: treasuryWallet, autofill: true });
-      console.log(`Sent ${share / 1000000} XRP to ${holder.address}`);
+      console.log(`Sent ${dropsToXrp(share.toString())} XRP to ${nftHolders[i].address}`);
     }
   }
   await client.disconnect();
 }
 
+// Pro-rata split of an integer pool (backend/native distribute(): exact shares,
+// leftover to the largest remainders); weight is the balance or the NFT count
+function prorata(holders, pool, basis) {
+  const snapshot = packHolders(holders.map(h => ({
+    account: Buffer.from(decodeAccountID(h.address)),
+    balance: h.units || 0n,
+    nfts: h.nftCount || 0,
+  })));
+  return distribute(snapshot, pool, { basis, deltas: false }).shares;
+}
+
 async function fetchNFTHolders(issuer, minNFTs) {
   // Use account_nfts RPC or bithomp API
   return [
@@ -1,4 +1,7 @@
-const { Client, Wallet } = require('xrpl');
+const { Client, Wallet, decodeAccountID, dropsToXrp } = require('xrpl');
+const { distribute, packHolders } = require('../backend/native');
+
+const TOKEN_DECIMALS = 6; // $DRIPPY amounts are split in millionths
 
 async function batchRewards() {
   const client = new Client('wss://s1.ripple.com');
@@ -7,49 +10,75 @@ async function batchRewards() {
 
   // Query NFT holders (5+ NFTs)
   const nftHolders = await fetchNFTHolders('issuer_r_address', 5);
-  const totalNFTs = nftHolders.reduce((sum, h) => sum + h.nftCount, 0);
   const dailyRewards = await fetchDailyRewards(); // Assume 100 $DRIPPY daily
 
   // NFT rewards in XRP
   const nftRewardXRP = (dailyRewards * 0.01 * 16966) / 1000000; // 1% in XRP drops
-  for (const holder of nftHolders) {
-    const share = (nftRewardXRP * holder.nftCount) / totalNFTs;
-    if (share > 0) {
+  // Exact drops per holder (the pool is already in drops, whole drops only); the
+  // shares add up to the pool
+  const nftShares = prorata(nftHolders, BigInt(Math.floor(nftRewardXRP)), 'nfts');
+  for (let i = 0; i < nftHolders.length; i++) {
+    const share = nftShares[i];
+    if (share > 0n) {
       const tx = {
         TransactionType: 'Payment',
         Account: 'rwprJf1ZEU3foKSiwhDg5kj9zDWFtPgMqJ',
-        Destination: holder.address,
+        Destination: nftHolders[i].address,
         Amount: share.toString(), // XRP drops
       };
       await client.submit(tx, { wallet: treasuryWallet, autofill: true });
-      console.log(`Sent ${share / 1000000} XRP to ${holder.address}`);
+      console.log(`Sent ${dropsToXrp(share.toString())} XRP to ${nftHolders[i].address}`);
     }
   }
 
   // Token holder rewards in $DRIPPY
   const holderReward = dailyRewards * 0.02;
   const tokenHolders = await fetchTokenHolders('DRIPPY', 'issuer_r_address');
-  const totalTokens = tokenHolders.reduce((sum, h) => sum + h.balance, 0);
-  for (const holder of tokenHolders) {
-    const share = (holderReward * holder.balance) / totalTokens;
-    if (share > 0) {
+  for (const holder of tokenHolders) holder.units = toMillionths(holder.balance);
+  const tokenShares = prorata(tokenHolders, toMillionths(holderReward.toFixed(TOKEN_DECIMALS)), 'balance');
+  for (let i = 0; i < tokenHolders.length; i++) {
+    const share = fromMillionths(tokenShares[i]);
+    if (tokenShares[i] > 0n) {
       const tx = {
         TransactionType: 'Payment',
         Account: 'rwprJf1ZEU3foKSiwhDg5kj9zDWFtPgMqJ',
-        Destination: holder.address,
+        Destination: tokenHolders[i].address,
         Amount: {
           currency: 'DRIPPY',
-          value: share.toString(),
+          value: share,
           issuer: 'issuer_r_address',
         },
       };
       await client.submit(tx, { wallet: treasuryWallet, autofill: true });
-      console.log(`Sent ${share} $DRIPPY to ${holder.address}`);
+      console.log(`Sent ${share} $DRIPPY to ${tokenHolders[i].address}`);
     }
   }
   await client.disconnect();
 }
 
+// Pro-rata split of an integer pool (backend/native distribute(): exact shares,
+// leftover to the largest remainders); weight is the balance or the NFT count
+function prorata(holders, pool, basis) {
+  const snapshot = packHolders(holders.map(h => ({
+    account: Buffer.from(decodeAccountID(h.address)),
+    balance: h.units || 0n,
+    nfts: h.nftCount || 0,
+  })));
+  return distribute(snapshot, pool, { basis, deltas: false }).shares;
+}
+
+// Decimal string to integer millionths, truncating past six places
+function toMillionths(value) {
+  const [whole, frac = ''] = String(value).split('.');
+  return BigInt(whole + frac.padEnd(TOKEN_DECIMALS, '0').slice(0, TOKEN_DECIMALS));
+}
+
+function fromMillionths(units) {
+  const digits = units.toString().padStart(TOKEN_DECIMALS + 1, '0');
+  const frac = digits.slice(-TOKEN_DECIMALS).replace(/0+$/, '');
+  return digits.slice(0, -TOKEN_DECIMALS) + (frac ? '.' + frac : '');
+}
+
 async function fetchNFTHolders(issuer, minNFTs) {
   // Use account_nfts RPC or bithomp.com API
   const response = await fetch('https://api.bithomp.com/v2/nft?issuer=' + issuer);
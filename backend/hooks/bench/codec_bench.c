@@ -0,0 +1,258 @@
+// Native micro-benchmark: include/drippy_codec.h against the helper loops it replaced
+//
+// Each case runs the legacy out-of-line loop (as it was in drippy_claim_simple.c,
+// drippy_claim_guarded.c, drippy_fee_router_*.c and drippy_claim_web_fixed.c) and the
+// shared helper on the same input, and reports instructions retired per call. Counts
+// come from perf_event_open. Where that is unavailable (containers, perf_event_paranoid)
+// the table is filled from the TSC or the monotonic clock instead; those timings are noisy
+// and are no evidence about instruction counts, so the run says so and exits 2.
+//
+// Exits 1 if any shared helper is not cheaper than the loop it replaced.
+//
+// Build and run: make bench
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "drippy_codec.h"
+
+#define ITERATIONS 200000
+#define ROUNDS 5
+
+#define NOINLINE __attribute__((noinline))
+
+// Keep the optimizer from folding work across iterations
+#define CLOBBER(p) __asm__ volatile("" : : "g"(p) : "memory")
+
+// ---- Legacy helpers, verbatim apart from names -------------------------------------
+
+NOINLINE uint64_t legacy_buf_to_u64(const uint8_t* buf) {
+    uint64_t result = 0;
+    for (int i = 0; i < 8; i++) {
+        result = (result << 8) | buf[i];
+    }
+    return result;
+}
+
+NOINLINE void legacy_u64_to_buf(uint8_t* buf, uint64_t value) {
+    for (int i = 7; i >= 0; i--) {
+        buf[i] = value & 0xFF;
+        value >>= 8;
+    }
+}
+
+NOINLINE uint32_t legacy_bytes_to_uint32(const uint8_t* buf) {
+    uint32_t result = 0;
+    for (int i = 0; i < 4; i++) {
+        result = (result << 8) | buf[i];
+    }
+    return result;
+}
+
+NOINLINE int legacy_mem_cmp(const void* a, const void* b, int len) {
+    const uint8_t* pa = (const uint8_t*)a;
+    const uint8_t* pb = (const uint8_t*)b;
+    for (int i = 0; i < len; i++) {
+        if (pa[i] != pb[i]) return pa[i] - pb[i];
+    }
+    return 0;
+}
+
+NOINLINE int legacy_arrays_equal(const uint8_t* a, const uint8_t* b, int len) {
+    for (int i = 0; i < len; i++) {
+        if (a[i] != b[i]) return 0;
+    }
+    return 1;
+}
+
+NOINLINE void legacy_mem_cpy(void* dest, const void* src, int len) {
+    uint8_t* d = (uint8_t*)dest;
+    const uint8_t* s = (const uint8_t*)src;
+    for (int i = 0; i < len; i++) {
+        d[i] = s[i];
+    }
+}
+
+NOINLINE void legacy_clear_array(uint8_t* arr, int len) {
+    for (int i = 0; i < len; i++) {
+        arr[i] = 0;
+    }
+}
+
+NOINLINE int legacy_get_str_len(const char* str) {
+    int len = 0;
+    while (str[len] != 0) len++;
+    return len;
+}
+
+// ---- Shared helpers, out of line so both sides pay the same call overhead ------------
+
+NOINLINE uint64_t shared_be_load_u64(const uint8_t* buf) { return be_load_u64(buf); }
+NOINLINE void shared_be_store_u64(uint8_t* buf, uint64_t v) { be_store_u64(buf, v); }
+NOINLINE uint32_t shared_be_load_u32(const uint8_t* buf) { return be_load_u32(buf); }
+NOINLINE int shared_equal_20(const void* a, const void* b) { return equal_20(a, b); }
+NOINLINE int shared_equal_32(const void* a, const void* b) { return equal_32(a, b); }
+NOINLINE void shared_copy_20(void* d, const void* s) { copy_20(d, s); }
+NOINLINE void shared_zero_32(void* d) { zero_32(d); }
+NOINLINE int shared_lit_len(void) { return LIT_LEN("DRIPPY:ROUTER:"); }
+
+// ---- Counters --------------------------------------------------------------------------
+
+static int perf_fd = -1;
+static const char* unit = "instr";
+
+static void counter_open(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    perf_fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (perf_fd < 0) {
+#if defined(__x86_64__) || defined(__i386__)
+        unit = "cycles";
+#else
+        unit = "ns";
+#endif
+    }
+}
+
+static uint64_t counter_read(void) {
+    if (perf_fd >= 0) {
+        uint64_t value = 0;
+        if (read(perf_fd, &value, sizeof(value)) != sizeof(value)) return 0;
+        return value;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static void counter_start(void) {
+    if (perf_fd >= 0) {
+        ioctl(perf_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+static void counter_stop(void) {
+    if (perf_fd >= 0) ioctl(perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+}
+
+// ---- Cases -----------------------------------------------------------------------------
+
+static uint8_t acc_a[32], acc_b[32], out[32];
+static volatile uint64_t sink;
+
+enum {
+    CASE_U64_LOAD, CASE_U64_STORE, CASE_U32_LOAD, CASE_EQUAL_20, CASE_EQUAL_32,
+    CASE_COPY_20, CASE_ZERO_32, CASE_STR_LEN, CASE_EMPTY, CASE_COUNT
+};
+
+static void run_case(int which, int shared) {
+    uint64_t acc = 0;
+    for (int i = 0; i < ITERATIONS; i++) {
+        CLOBBER(acc_a);
+        switch (which) {
+            case CASE_U64_LOAD:
+                acc += shared ? shared_be_load_u64(acc_a) : legacy_buf_to_u64(acc_a);
+                break;
+            case CASE_U64_STORE:
+                if (shared) shared_be_store_u64(out, (uint64_t)i);
+                else legacy_u64_to_buf(out, (uint64_t)i);
+                break;
+            case CASE_U32_LOAD:
+                acc += shared ? shared_be_load_u32(acc_a) : legacy_bytes_to_uint32(acc_a);
+                break;
+            case CASE_EQUAL_20:
+                acc += shared ? shared_equal_20(acc_a, acc_b) : legacy_mem_cmp(acc_a, acc_b, 20) == 0;
+                break;
+            case CASE_EQUAL_32:
+                acc += shared ? shared_equal_32(acc_a, acc_b) : legacy_arrays_equal(acc_a, acc_b, 32);
+                break;
+            case CASE_COPY_20:
+                if (shared) shared_copy_20(out, acc_a);
+                else legacy_mem_cpy(out, acc_a, 20);
+                break;
+            case CASE_ZERO_32:
+                if (shared) shared_zero_32(out);
+                else legacy_clear_array(out, 32);
+                break;
+            case CASE_STR_LEN:
+                acc += shared ? shared_lit_len() : legacy_get_str_len("DRIPPY:ROUTER:");
+                break;
+            default:
+                break;
+        }
+        CLOBBER(out);
+    }
+    sink = acc;
+}
+
+// Best of ROUNDS, per call
+static double measure(int which, int shared) {
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < ROUNDS; r++) {
+        counter_start();
+        uint64_t start = counter_read();
+        run_case(which, shared);
+        uint64_t end = counter_read();
+        counter_stop();
+        if (end - start < best) best = end - start;
+    }
+    return (double)best / ITERATIONS;
+}
+
+int main(void) {
+    static const char* names[CASE_COUNT] = {
+        "buf_to_u64 -> be_load_u64", "u64_to_buf -> be_store_u64", "bytes_to_uint32 -> be_load_u32",
+        "mem_cmp(20) -> equal_20", "arrays_equal(32) -> equal_32", "mem_cpy(20) -> copy_20",
+        "clear_array(32) -> zero_32", "get_str_len -> LIT_LEN", "loop overhead"
+    };
+
+    // Equal accounts: the comparison loops run to the end, as they do on a match
+    for (int i = 0; i < 32; i++) {
+        acc_a[i] = (uint8_t)(0x11 * i + 7);
+        acc_b[i] = acc_a[i];
+    }
+
+    counter_open();
+    if (perf_fd < 0)
+        fprintf(stderr, "codec_bench: perf_event_open unavailable, NO instruction counts were measured;\n"
+                        "codec_bench: the %s below are timing only and do not show the helpers are cheaper\n",
+                unit);
+
+    double overhead = measure(CASE_EMPTY, 0);
+    int failures = 0;
+
+    printf("%-32s %12s %12s %8s   (%s per call%s)\n", "helper", "legacy", "shared", "ratio", unit,
+           perf_fd < 0 ? ", NOT instruction counts" : "");
+    for (int c = 0; c < CASE_EMPTY; c++) {
+        double legacy = measure(c, 0) - overhead;
+        double shared = measure(c, 1) - overhead;
+        int ok = shared < legacy;
+        failures += !ok;
+        printf("%-32s %12.1f %12.1f %7.1fx%s\n", names[c], legacy, shared,
+               shared > 0 ? legacy / shared : 0.0, ok ? "" : "   NOT FASTER");
+    }
+
+    if (perf_fd < 0) return 2;
+    return failures ? 1 : 0;
+}
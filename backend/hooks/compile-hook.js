@@ -4,6 +4,10 @@ const fs = require('fs');
 const path = require('path');
 const fetch = (...args) => import('node-fetch').then(({default: fetch}) => fetch(...args));
 
+// Remote builder fallback for machines without a wasm32 clang toolchain.
+// The local build (`make -j build-all`) is incremental and much faster.
+const BUILDER_URL = process.env.HOOKS_BUILDER_URL || 'http://localhost:9000';
+
 async function compileHook(sourceFile, outputFile) {
     console.log(`Compiling ${sourceFile} to ${outputFile}...`);
 
@@ -22,7 +26,7 @@ async function compileHook(sourceFile, outputFile) {
     };
 
     try {
-        const response = await fetch('http://localhost:9000/api/build', {
+        const response = await fetch(`${BUILDER_URL}/api/build`, {
             method: 'POST',
             headers: {
                 'Content-Type': 'application/json',
@@ -73,6 +77,10 @@ async function main() {
             source: 'src/drippy_fee_router.c',
             output: 'build/drippy_fee_router.wasm'
         },
+        {
+            source: 'src/drippy_nft_router.c',
+            output: 'build/drippy_nft_router.wasm'
+        },
         {
             source: 'src/drippy_claim_hook.c',
             output: 'build/drippy_claim_hook.wasm'
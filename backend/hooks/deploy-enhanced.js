@@ -11,6 +11,7 @@ require('dotenv').config({ path: '../.env' })
 const xrpl = require('xrpl')
 const fs = require('fs')
 const path = require('path')
+const { loadArtifact, planHook, describePlan } = require('./hook-deploy')
 
 // Configuration
 const CONFIG = {
@@ -44,7 +45,11 @@ const CONFIG = {
     COOLD: process.env.CLAIM_COOLDOWN || '3600', // 1 hour
     DAILY_MAX: process.env.CLAIM_DAILY_MAX || '5000000000', // 5000 DRIPPY per day
     MIN_CLAIM: process.env.CLAIM_MIN_AMOUNT || '1000000', // 1 XRP minimum
-    BOOST_MAX: process.env.CLAIM_BOOST_MAX || '500' // 5x maximum boost
+    BOOST_MAX: process.env.CLAIM_BOOST_MAX || '500', // 5x maximum boost
+    // On-chain NFT boost table: "rIssuer:taxon:multiplier,..." (taxon * = any)
+    NFT_TBL: process.env.CLAIM_NFT_TABLE || '',
+    // Single-source claim build to deploy: min | cooldown | full (default: full build)
+    PROFILE: process.env.CLAIM_PROFILE || ''
   },
 
   ROUTER_PARAMS: {
@@ -87,21 +92,18 @@ function validateConfig() {
 }
 
 function loadHookWasm(hookName) {
-  const wasmPath = path.join(__dirname, 'build', `${hookName}.wasm`)
   const hexPath = path.join(__dirname, 'build', `${hookName}.wasm.hex`)
 
   if (!fs.existsSync(hexPath)) {
-    throw new Error(`Hook not built: ${hexPath}. Run 'make build-${hookName.split('_')[1]}' first.`)
+    const target = hookName.startsWith('drippy_claim_')
+      ? `claim-${hookName.substring('drippy_claim_'.length)}`
+      : `build-${hookName.split('_')[1]}`
+    throw new Error(`Hook not built: ${hexPath}. Run 'make ${target}' first.`)
   }
 
-  const hexData = fs.readFileSync(hexPath, 'utf8').trim().replace(/\n/g, '').toUpperCase()
-
-  if (hexData.length === 0 || hexData.length % 2 !== 0) {
-    throw new Error(`Invalid hex data in ${hexPath}`)
-  }
-
-  console.log(`Loaded ${hookName}: ${hexData.length / 2} bytes`)
-  return hexData
+  const artifact = loadArtifact(hookName)
+  console.log(`Loaded ${hookName}: ${artifact.bytes} bytes, HookHash ${artifact.hookHash}`)
+  return artifact
 }
 
 function encodeHookParameter(name, value, type = 'string') {
@@ -125,6 +127,17 @@ function encodeHookParameter(name, value, type = 'string') {
       const num32 = parseInt(value)
       valueHex = num32.toString(16).padStart(8, '0').toUpperCase()
       break
+    case 'nfttable':
+      // Entries: issuer(20) + u32 taxon + u16 multiplier, max 8
+      valueHex = value.split(',').filter(Boolean).slice(0, 8).map(entry => {
+        const [issuer, taxon, multiplier] = entry.trim().split(':')
+        const row = Buffer.alloc(26)
+        Buffer.from(xrpl.decodeAccountID(issuer)).copy(row, 0)
+        row.writeUInt32BE(taxon === '*' ? 0xFFFFFFFF : parseInt(taxon), 20)
+        row.writeUInt16BE(parseInt(multiplier), 24)
+        return row.toString('hex')
+      }).join('').toUpperCase()
+      break
     case 'currency':
       if (value.length <= 3) {
         // Standard currency code
@@ -146,18 +159,48 @@ function encodeHookParameter(name, value, type = 'string') {
   }
 }
 
+// Features compiled into each claim profile (see src/drippy_enhanced_claim.c)
+const CLAIM_PROFILES = {
+  min: { cooldown: false, boost: false, iou: false },
+  cooldown: { cooldown: true, boost: false, iou: false },
+  full: { cooldown: true, boost: true, iou: true }
+}
+
+function claimHookName() {
+  const profile = CONFIG.CLAIM_PARAMS.PROFILE
+  if (!profile) return 'drippy_enhanced_claim'
+  if (!CLAIM_PROFILES[profile]) {
+    throw new Error(`Unknown CLAIM_PROFILE '${profile}' (expected: ${Object.keys(CLAIM_PROFILES).join(', ')})`)
+  }
+  return `drippy_claim_${profile}`
+}
+
 function buildClaimHookParams() {
+  // Parameters a profile compiled out are left off the SetHook
+  const features = CLAIM_PROFILES[CONFIG.CLAIM_PARAMS.PROFILE] || CLAIM_PROFILES.full
+
   const params = [
     encodeHookParameter('ADMIN', CONFIG.CLAIM_POOL_ACCOUNT, 'account'),
     encodeHookParameter('MAXP', CONFIG.CLAIM_PARAMS.MAXP, 'u64'),
-    encodeHookParameter('COOLD', CONFIG.CLAIM_PARAMS.COOLD, 'u64'),
-    encodeHookParameter('DAILY_MAX', CONFIG.CLAIM_PARAMS.DAILY_MAX, 'u64'),
-    encodeHookParameter('MIN_CLAIM', CONFIG.CLAIM_PARAMS.MIN_CLAIM, 'u64'),
-    encodeHookParameter('BOOST_MAX', CONFIG.CLAIM_PARAMS.BOOST_MAX, 'u32')
+    encodeHookParameter('MIN_CLAIM', CONFIG.CLAIM_PARAMS.MIN_CLAIM, 'u64')
   ]
 
+  if (features.cooldown) {
+    params.push(encodeHookParameter('COOLD', CONFIG.CLAIM_PARAMS.COOLD, 'u64'))
+    params.push(encodeHookParameter('DAILY_MAX', CONFIG.CLAIM_PARAMS.DAILY_MAX, 'u64'))
+  }
+
+  if (features.boost) {
+    params.push(encodeHookParameter('BOOST_MAX', CONFIG.CLAIM_PARAMS.BOOST_MAX, 'u32'))
+  }
+
+  // Enable on-chain NFT boost derivation if a table is configured
+  if (features.boost && CONFIG.CLAIM_PARAMS.NFT_TBL) {
+    params.push(encodeHookParameter('NFT_TBL', CONFIG.CLAIM_PARAMS.NFT_TBL, 'nfttable'))
+  }
+
   // Add IOU parameters if configured
-  if (CONFIG.DRIPPY_ISSUER) {
+  if (features.iou && CONFIG.DRIPPY_ISSUER) {
     params.push(encodeHookParameter('CUR', CONFIG.DRIPPY_CURRENCY, 'currency'))
     params.push(encodeHookParameter('ISSUER', CONFIG.DRIPPY_ISSUER, 'account'))
   }
@@ -181,23 +224,23 @@ function buildRouterHookParams() {
   ]
 }
 
-async function deployHook(client, wallet, hookAccount, hookWasm, hookParams, hookName) {
+async function deployHook(client, wallet, hookAccount, artifact, hookParams, hookName) {
   console.log(`\\nDeploying ${hookName} to ${hookAccount}...`)
 
+  // Upload code only if this build is not on-ledger yet (see hook-deploy.js)
+  const plan = await planHook(client, hookAccount, artifact, {
+    HookOn: '0x0000000000000000', // All transaction types
+    HookNamespace: Buffer.from('DRIPPY', 'utf8').toString('hex').padEnd(64, '0').toUpperCase(),
+    HookApiVersion: 0,
+    HookParameters: hookParams
+  })
+  console.log(`Code: ${describePlan(plan, artifact)}`)
+
   const setHookTx = {
     TransactionType: 'SetHook',
     Account: wallet.classicAddress,
     Destination: hookAccount,
-    Hooks: [{
-      Hook: {
-        HookOn: '0x0000000000000000', // All transaction types
-        HookNamespace: Buffer.from('DRIPPY', 'utf8').toString('hex').padEnd(64, '0').toUpperCase(),
-        HookApiVersion: 0,
-        CreateCode: hookWasm,
-        HookParameters: hookParams,
-        Flags: 1 // hsfOverride
-      }
-    }]
+    Hooks: [plan.entry]
   }
 
   console.log(`Parameters: ${hookParams.length} items`)
@@ -244,8 +287,8 @@ async function main() {
     console.log(`✅ Admin wallet: ${wallet.classicAddress}`)
 
     // Load hook WASM files
-    const claimWasm = loadHookWasm('drippy_enhanced_claim')
-    const routerWasm = loadHookWasm('drippy_fee_router')
+    const claimArtifact = loadHookWasm(claimHookName())
+    const routerArtifact = loadHookWasm('drippy_fee_router')
 
     // Build hook parameters
     const claimParams = buildClaimHookParams()
@@ -260,7 +303,7 @@ async function main() {
     try {
       const claimResult = await deployHook(
         client, wallet, CONFIG.CLAIM_POOL_ACCOUNT,
-        claimWasm, claimParams, 'Enhanced Claim Hook'
+        claimArtifact, claimParams, 'Enhanced Claim Hook'
       )
       deployments.push({ type: 'claim', result: claimResult })
     } catch (error) {
@@ -271,7 +314,7 @@ async function main() {
     try {
       const routerResult = await deployHook(
         client, wallet, CONFIG.FEE_ROUTER_ACCOUNT,
-        routerWasm, routerParams, 'Fee Router Hook'
+        routerArtifact, routerParams, 'Fee Router Hook'
       )
       deployments.push({ type: 'router', result: routerResult })
     } catch (error) {
@@ -332,6 +375,7 @@ Environment Variables:
     DRIPPY_CURRENCY             Currency code (default: DRIPPY)
     CLAIM_MAX_PER_CLAIM         Max DRIPPY per claim (default: 1000)
     CLAIM_COOLDOWN              Claim cooldown seconds (default: 3600)
+    CLAIM_NFT_TABLE             On-chain boost table "rIssuer:taxon:mult,..." (default: off)
     ROUTER_NFT_ALLOC            NFT allocation % (default: 40)
     ROUTER_HOLD_ALLOC           Holder allocation % (default: 30)
     ROUTER_TREA_ALLOC           Treasury allocation % (default: 20)
@@ -1,11 +1,13 @@
 #!/usr/bin/env node
 
-const fs = require('fs');
-const path = require('path');
 const xrpl = require('xrpl');
+const { loadArtifact, planHook, describePlan } = require('./hook-deploy');
 require('dotenv').config();
 
 // Helper functions for parameter encoding
+// The hooks compare ANTI_SNIPE with ledger_last_time(), which counts from 2000-01-01
+const RIPPLE_EPOCH = 946684800;
+
 function toHex(buf) {
     return Buffer.from(buf).toString('hex').toUpperCase();
 }
@@ -49,13 +51,8 @@ async function deployFeeRouterHook() {
     }
 
     // Load compiled hook bytecode
-    const wasmHexPath = path.join(__dirname, 'build', 'drippy_fee_router.wasm.hex');
-    if (!fs.existsSync(wasmHexPath)) {
-        throw new Error(`Hook bytecode not found at: ${wasmHexPath}`);
-    }
-
-    const hookHex = fs.readFileSync(wasmHexPath, 'utf8').trim();
-    console.log(`📦 Loaded hook bytecode: ${hookHex.length} hex chars`);
+    const artifact = loadArtifact('drippy_fee_router');
+    console.log(`📦 Loaded hook bytecode: ${artifact.bytes} bytes, HookHash ${artifact.hookHash}`);
 
     // Connect to Xahau
     const client = new xrpl.Client(xahauWss);
@@ -80,27 +77,42 @@ async function deployFeeRouterHook() {
         param('FEE_BPS', toHex(u32ToBE(process.env.ROUTER_FEE_BPS || 100)))
     ];
 
+    // Launch-window throttle (see manage-whitelist.js for the whitelist set).
+    // ROUTER_ANTI_SNIPE_END is Unix seconds; the parameter holds Ripple-epoch seconds.
+    if (process.env.ROUTER_ANTI_SNIPE_END) {
+        const snipeEnd = BigInt(process.env.ROUTER_ANTI_SNIPE_END) - BigInt(RIPPLE_EPOCH);
+        if (snipeEnd <= 0n) {
+            throw new Error('ROUTER_ANTI_SNIPE_END must be a Unix time after 2000-01-01');
+        }
+        hookParams.push(
+            param('ANTI_SNIPE', toHex(u64ToBE(snipeEnd))),
+            param('SNIPE_BURST', toHex(u32ToBE(process.env.ROUTER_SNIPE_BURST || 3))),
+            param('SNIPE_REFILL', toHex(u32ToBE(process.env.ROUTER_SNIPE_REFILL || 10))),
+            param('SNIPE_VOL', toHex(u64ToBE(process.env.ROUTER_SNIPE_VOL || 0)))
+        );
+    }
+
     console.log('📋 Hook Parameters:');
     hookParams.forEach(p => {
         const name = Buffer.from(p.HookParameter.HookParameterName, 'hex').toString('utf8');
         console.log(`   ${name}: ${p.HookParameter.HookParameterValue}`);
     });
 
+    // Upload code only if this build is not on-ledger yet (see hook-deploy.js)
+    const plan = await planHook(client, feeRouterAccount, artifact, {
+        HookOn: '0000000000000000000000000000000000000000000000000000000000000001', // ttPAYMENT only
+        HookNamespace: Buffer.from('DRIPPY:FEE:ROUTER:v1', 'utf8').toString('hex').padEnd(64, '0').toUpperCase(),
+        HookApiVersion: 0,
+        HookParameters: hookParams
+    });
+    console.log(`🧩 Code: ${describePlan(plan, artifact)}`);
+
     // Create SetHook transaction
     const setHookTx = {
         TransactionType: 'SetHook',
         Account: adminWallet.classicAddress,
         Destination: feeRouterAccount,
-        Hooks: [{
-            Hook: {
-                HookOn: '0000000000000000000000000000000000000000000000000000000000000001', // ttPAYMENT only
-                HookNamespace: Buffer.from('DRIPPY:FEE:ROUTER:v1', 'utf8').toString('hex').padEnd(64, '0').toUpperCase(),
-                HookApiVersion: 0,
-                CreateCode: hookHex,
-                HookParameters: hookParams,
-                Flags: 1  // hsfOverride
-            }
-        }]
+        Hooks: [plan.entry]
     };
 
     console.log('\n🔨 Preparing SetHook transaction...');
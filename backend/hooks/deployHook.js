@@ -2,6 +2,8 @@
 const fs = require('fs')
 const path = require('path')
 const xrpl = require('xrpl')
+const { hookHash } = require('./tools/hook-manifest')
+const { planHook, describePlan } = require('./hook-deploy')
 
 async function main() {
   const ws = process.env.XAHAU_WSS || 'wss://xahau.network'
@@ -12,15 +14,19 @@ async function main() {
   const wallet = xrpl.Wallet.fromSeed(seed)
 
   const setHook = require('./sethook.example.json')
-  // Inject bytecode into CreateCode if provided via env var
+  // Bytecode from HOOK_BYTECODE_FILE is installed by HookHash when already on-ledger
   const codeFile = process.env.HOOK_BYTECODE_FILE
     ? path.resolve(process.cwd(), process.env.HOOK_BYTECODE_FILE)
     : null
   if (codeFile) {
-    const hex = fs.readFileSync(codeFile, 'utf8').trim()
-    if (!/^[0-9A-Fa-f]+$/.test(hex)) throw new Error('HOOK_BYTECODE_FILE must contain base16 only')
+    const hex = fs.readFileSync(codeFile, 'utf8').replace(/\s+/g, '').toUpperCase()
+    if (!/^[0-9A-F]+$/.test(hex)) throw new Error('HOOK_BYTECODE_FILE must contain base16 only')
     if (!setHook.Hooks || !setHook.Hooks[0] || !setHook.Hooks[0].Hook) throw new Error('Invalid sethook json structure')
-    setHook.Hooks[0].Hook.CreateCode = hex.toUpperCase()
+    const artifact = { hex, hookHash: hookHash(Buffer.from(hex, 'hex')), bytes: hex.length / 2 }
+    const { CreateCode, Flags, ...hook } = setHook.Hooks[0].Hook
+    const plan = await planHook(client, wallet.classicAddress, artifact, hook)
+    console.log(`Code: ${describePlan(plan, artifact)}`)
+    setHook.Hooks[0] = plan.entry
   }
   setHook.Account = wallet.classicAddress
 
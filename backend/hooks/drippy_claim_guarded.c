@@ -3,67 +3,20 @@
 // Triggers: Payments with "CLAIM" memo to this account
 
 #include "hookapi.h"
+#include "drippy_codec.h"
+
+// State key: "DRIPPY:" followed by the account id, zero padded
+static const uint8_t STATE_KEY_PREFIX[32] = "DRIPPY:";
 
 // Required guard function for hooks
 int64_t _g(uint32_t id, uint32_t maxiter) {
     return 0;
 }
 
-// Convert pointer for API calls
-uint32_t ptr_to_u32(const void* ptr) {
-    return (uint32_t)(uintptr_t)ptr;
-}
-
-// Get string length manually
-int get_str_len(const char* str) {
-    int len = 0;
-    while (str[len] != 0) len++;
-    return len;
-}
-
-// Compare arrays manually
-int arrays_equal(const uint8_t* a, const uint8_t* b, int len) {
-    for (int i = 0; i < len; i++) {
-        if (a[i] != b[i]) return 0;
-    }
-    return 1;
-}
-
-// Copy array manually
-void copy_array(uint8_t* dest, const uint8_t* src, int len) {
-    for (int i = 0; i < len; i++) {
-        dest[i] = src[i];
-    }
-}
-
-// Clear array manually
-void clear_array(uint8_t* arr, int len) {
-    for (int i = 0; i < len; i++) {
-        arr[i] = 0;
-    }
-}
-
-// Convert buffer to uint64
-uint64_t bytes_to_uint64(const uint8_t* buf) {
-    uint64_t result = 0;
-    for (int i = 0; i < 8; i++) {
-        result = (result << 8) | buf[i];
-    }
-    return result;
-}
-
-// Convert uint64 to buffer
-void uint64_to_bytes(uint8_t* buf, uint64_t value) {
-    for (int i = 7; i >= 0; i--) {
-        buf[i] = value & 0xFF;
-        value >>= 8;
-    }
-}
-
 // Check if transaction has CLAIM memo
 int has_claim_memo() {
     uint8_t memos_buffer[512];
-    int memos_len = otxn_field(ptr_to_u32(memos_buffer), sizeof(memos_buffer), sfMemos);
+    int memos_len = otxn_field(PTR32(memos_buffer), sizeof(memos_buffer), sfMemos);
 
     if (memos_len <= 0) return 0;
 
@@ -78,10 +31,8 @@ int has_claim_memo() {
     return 0;
 }
 
-// Get parameter from hook
-int get_hook_param(uint8_t* out, int out_len, const char* name) {
-    return hook_param(ptr_to_u32(out), out_len, ptr_to_u32(name), get_str_len(name));
-}
+// Get parameter from hook (name must be a string literal)
+#define get_hook_param(out, out_len, name) hook_param(PTR32(out), out_len, LIT(name))
 
 // Check if sender is admin
 int sender_is_admin() {
@@ -92,21 +43,16 @@ int sender_is_admin() {
     if (get_hook_param(admin_account, 20, "ADMIN") != 20) return 0;
 
     // Get transaction sender
-    if (otxn_field(ptr_to_u32(sender), 20, sfAccount) != 20) return 0;
+    if (otxn_field(PTR32(sender), 20, sfAccount) != 20) return 0;
 
     // Compare accounts
-    return arrays_equal(admin_account, sender, 20);
+    return equal_20(admin_account, sender);
 }
 
 // Generate state key for account
 void create_state_key(uint8_t* key, const uint8_t* account) {
-    clear_array(key, 32);
-
-    // Prefix: "DRIPPY:"
-    key[0] = 'D'; key[1] = 'R'; key[2] = 'I'; key[3] = 'P'; key[4] = 'P'; key[5] = 'Y'; key[6] = ':';
-
-    // Add account (first 20 bytes starting at position 7)
-    copy_array(key + 7, account, 20);
+    copy_32(key, STATE_KEY_PREFIX);
+    copy_20(key + 7, account);
 }
 
 // Load user balance from state
@@ -116,9 +62,9 @@ uint64_t get_user_balance(const uint8_t* account) {
 
     create_state_key(key, account);
 
-    int result = state(ptr_to_u32(balance_data), 8, ptr_to_u32(key), 32);
+    int result = state(PTR32(balance_data), 8, PTR32(key), 32);
     if (result == 8) {
-        return bytes_to_uint64(balance_data);
+        return be_load_u64(balance_data);
     }
     return 0; // No balance
 }
@@ -129,9 +75,9 @@ int set_user_balance(const uint8_t* account, uint64_t balance) {
     uint8_t balance_data[8];
 
     create_state_key(key, account);
-    uint64_to_bytes(balance_data, balance);
+    be_store_u64(balance_data, balance);
 
-    return state_set(ptr_to_u32(balance_data), 8, ptr_to_u32(key), 32);
+    return state_set(PTR32(balance_data), 8, PTR32(key), 32);
 }
 
 // Process claim request
@@ -139,22 +85,22 @@ int handle_claim() {
     uint8_t sender[20];
 
     // Get sender account
-    if (otxn_field(ptr_to_u32(sender), 20, sfAccount) != 20) {
-        return rollback(ptr_to_u32("bad sender"), get_str_len("bad sender"), 1);
+    if (otxn_field(PTR32(sender), 20, sfAccount) != 20) {
+        return rollback(LIT("bad sender"), 1);
     }
 
     // Get current balance
     uint64_t balance = get_user_balance(sender);
 
     if (balance == 0) {
-        return rollback(ptr_to_u32("no balance"), get_str_len("no balance"), 2);
+        return rollback(LIT("no balance"), 2);
     }
 
     // Get max claim parameter (optional)
     uint8_t max_buf[8];
     uint64_t max_claim = 0;
     if (get_hook_param(max_buf, 8, "MAXP") == 8) {
-        max_claim = bytes_to_uint64(max_buf);
+        max_claim = be_load_u64(max_buf);
     }
 
     // Calculate payout
@@ -165,16 +111,16 @@ int handle_claim() {
 
     // Check minimum (1 XRP = 1,000,000 drops)
     if (payout < 1000000) {
-        return rollback(ptr_to_u32("too small"), get_str_len("too small"), 3);
+        return rollback(LIT("too small"), 3);
     }
 
     // Mark as claimed by reducing balance
     uint64_t new_balance = balance - payout;
     if (set_user_balance(sender, new_balance) < 0) {
-        return rollback(ptr_to_u32("state error"), get_str_len("state error"), 4);
+        return rollback(LIT("state error"), 4);
     }
 
-    return accept(ptr_to_u32("claimed"), get_str_len("claimed"), 0);
+    return accept(LIT("claimed"), 0);
 }
 
 // Process admin adding balance
@@ -183,45 +129,45 @@ int handle_admin_add() {
     uint8_t amount_data[8];
 
     // Get sender
-    if (otxn_field(ptr_to_u32(sender), 20, sfAccount) != 20) {
-        return rollback(ptr_to_u32("bad sender"), get_str_len("bad sender"), 1);
+    if (otxn_field(PTR32(sender), 20, sfAccount) != 20) {
+        return rollback(LIT("bad sender"), 1);
     }
 
     // Get payment amount
-    if (otxn_field(ptr_to_u32(amount_data), 8, sfAmount) != 8) {
-        return rollback(ptr_to_u32("bad amount"), get_str_len("bad amount"), 2);
+    if (otxn_field(PTR32(amount_data), 8, sfAmount) != 8) {
+        return rollback(LIT("bad amount"), 2);
     }
 
-    uint64_t add_amount = bytes_to_uint64(amount_data);
+    uint64_t add_amount = be_load_u64(amount_data);
     uint64_t current_balance = get_user_balance(sender);
     uint64_t new_balance = current_balance + add_amount;
 
     if (set_user_balance(sender, new_balance) < 0) {
-        return rollback(ptr_to_u32("state error"), get_str_len("state error"), 3);
+        return rollback(LIT("state error"), 3);
     }
 
-    return accept(ptr_to_u32("added"), get_str_len("added"), 0);
+    return accept(LIT("added"), 0);
 }
 
 // Main hook function
 int64_t hook(int64_t reserved) {
     // Only handle payments
     if (otxn_type() != ttPAYMENT) {
-        return accept(ptr_to_u32("not payment"), get_str_len("not payment"), 0);
+        return accept(LIT("not payment"), 0);
     }
 
     // Check if payment is to our account
     uint8_t destination[20];
     uint8_t our_account[20];
 
-    if (otxn_field(ptr_to_u32(destination), 20, sfDestination) != 20) {
-        return rollback(ptr_to_u32("no dest"), get_str_len("no dest"), 1);
+    if (otxn_field(PTR32(destination), 20, sfDestination) != 20) {
+        return rollback(LIT("no dest"), 1);
     }
 
-    hook_account(ptr_to_u32(our_account), 20);
+    hook_account(PTR32(our_account), 20);
 
-    if (!arrays_equal(destination, our_account, 20)) {
-        return accept(ptr_to_u32("not for us"), get_str_len("not for us"), 0);
+    if (!equal_20(destination, our_account)) {
+        return accept(LIT("not for us"), 0);
     }
 
     // Check for CLAIM memo
@@ -235,7 +181,7 @@ int64_t hook(int64_t reserved) {
     }
 
     // Regular payment, just accept
-    return accept(ptr_to_u32("ok"), get_str_len("ok"), 0);
+    return accept(LIT("ok"), 0);
 }
 
 // Required callback function
@@ -3,67 +3,15 @@
 // Triggers: Payments with "CLAIM" memo to this account
 
 #include "hookapi.h"
+#include "drippy_codec.h"
 
-// Convert string to pointer for API calls
-uint32_t str_to_ptr(const char* str) {
-    return (uint32_t)(uintptr_t)str;
-}
-
-// Get string length manually
-int str_len(const char* str) {
-    int len = 0;
-    while (str[len] != 0) len++;
-    return len;
-}
-
-// Compare memory manually
-int mem_cmp(const void* a, const void* b, int len) {
-    const uint8_t* pa = (const uint8_t*)a;
-    const uint8_t* pb = (const uint8_t*)b;
-    for (int i = 0; i < len; i++) {
-        if (pa[i] != pb[i]) return pa[i] - pb[i];
-    }
-    return 0;
-}
-
-// Copy memory manually
-void mem_cpy(void* dest, const void* src, int len) {
-    uint8_t* d = (uint8_t*)dest;
-    const uint8_t* s = (const uint8_t*)src;
-    for (int i = 0; i < len; i++) {
-        d[i] = s[i];
-    }
-}
-
-// Set memory manually
-void mem_set(void* ptr, int value, int len) {
-    uint8_t* p = (uint8_t*)ptr;
-    for (int i = 0; i < len; i++) {
-        p[i] = (uint8_t)value;
-    }
-}
-
-// Convert buffer to uint64
-uint64_t buf_to_u64(const uint8_t* buf) {
-    uint64_t result = 0;
-    for (int i = 0; i < 8; i++) {
-        result = (result << 8) | buf[i];
-    }
-    return result;
-}
-
-// Convert uint64 to buffer
-void u64_to_buf(uint8_t* buf, uint64_t value) {
-    for (int i = 7; i >= 0; i--) {
-        buf[i] = value & 0xFF;
-        value >>= 8;
-    }
-}
+// State key: "DRIPPY:CLAIM:" followed by the account id, truncated to 32 bytes
+static const uint8_t CLAIM_KEY_PREFIX[32] = "DRIPPY:CLAIM:";
 
 // Check if transaction has CLAIM memo
 int has_claim_memo() {
     uint8_t memos_buffer[1024];
-    int memos_len = otxn_field(str_to_ptr(memos_buffer), sizeof(memos_buffer), sfMemos);
+    int memos_len = otxn_field(PTR32(memos_buffer), sizeof(memos_buffer), sfMemos);
 
     if (memos_len <= 0) return 0;
 
@@ -78,10 +26,8 @@ int has_claim_memo() {
     return 0;
 }
 
-// Get parameter value
-int get_param(void* out, int out_len, const char* name) {
-    return hook_param(str_to_ptr(out), out_len, str_to_ptr(name), str_len(name));
-}
+// Get parameter value (name must be a string literal)
+#define get_param(out, out_len, name) hook_param(PTR32(out), out_len, LIT(name))
 
 // Check if sender is admin
 int is_admin() {
@@ -92,23 +38,21 @@ int is_admin() {
     if (get_param(admin_account, 20, "ADMIN") != 20) return 0;
 
     // Get transaction sender
-    if (otxn_field(str_to_ptr(sender), 20, sfAccount) != 20) return 0;
+    if (otxn_field(PTR32(sender), 20, sfAccount) != 20) return 0;
 
     // Compare
-    return mem_cmp(admin_account, sender, 20) == 0;
+    return equal_20(admin_account, sender);
 }
 
 // Generate state key for account
 void make_key(uint8_t* key, const uint8_t* account) {
-    mem_set(key, 0, 32);
-
-    // Prefix: "DRIPPY:CLAIM:"
-    const char* prefix = "DRIPPY:CLAIM:";
-    int prefix_len = str_len(prefix);
-    mem_cpy(key, prefix, prefix_len);
+    copy_32(key, CLAIM_KEY_PREFIX);
 
-    // Add account (20 bytes)
-    mem_cpy(key + prefix_len, account, 20);
+    // The 13-byte prefix leaves room for the first 19 bytes of the account
+    copy_16(key + 13, account);
+    key[29] = account[16];
+    key[30] = account[17];
+    key[31] = account[18];
 }
 
 // Load account balance from state
@@ -118,9 +62,9 @@ uint64_t load_balance(const uint8_t* account) {
 
     make_key(key, account);
 
-    int result = state(str_to_ptr(balance_buf), 8, str_to_ptr(key), 32);
+    int result = state(PTR32(balance_buf), 8, PTR32(key), 32);
     if (result == 8) {
-        return buf_to_u64(balance_buf);
+        return be_load_u64(balance_buf);
     }
     return 0; // No balance found
 }
@@ -131,9 +75,9 @@ int save_balance(const uint8_t* account, uint64_t balance) {
     uint8_t balance_buf[8];
 
     make_key(key, account);
-    u64_to_buf(balance_buf, balance);
+    be_store_u64(balance_buf, balance);
 
-    return state_set(str_to_ptr(balance_buf), 8, str_to_ptr(key), 32);
+    return state_set(PTR32(balance_buf), 8, PTR32(key), 32);
 }
 
 // Emit XRP payment
@@ -146,7 +90,7 @@ int emit_xrp_payment(const uint8_t* to_account, uint64_t drops) {
     if (tx_len < 0) return -1;
 
     // Emit the transaction
-    return emit(str_to_ptr(tx_blob), tx_len, str_to_ptr(""), 0);
+    return emit(PTR32(tx_blob), tx_len, PTR32(""), 0);
 }
 
 // Process claim request
@@ -154,22 +98,22 @@ int process_claim() {
     uint8_t sender[20];
 
     // Get sender account
-    if (otxn_field(str_to_ptr(sender), 20, sfAccount) != 20) {
-        return rollback(str_to_ptr("invalid sender"), str_len("invalid sender"), 1);
+    if (otxn_field(PTR32(sender), 20, sfAccount) != 20) {
+        return rollback(LIT("invalid sender"), 1);
     }
 
     // Load current balance
     uint64_t balance = load_balance(sender);
 
     if (balance == 0) {
-        return rollback(str_to_ptr("no balance"), str_len("no balance"), 1);
+        return rollback(LIT("no balance"), 1);
     }
 
     // Get maximum claim amount (default 1000 XRP)
     uint8_t max_buf[8];
     uint64_t max_claim = 1000000000; // 1000 XRP in drops
     if (get_param(max_buf, 8, "MAXP") == 8) {
-        max_claim = buf_to_u64(max_buf);
+        max_claim = be_load_u64(max_buf);
     }
 
     // Calculate payout (minimum of balance and max_claim)
@@ -181,7 +125,7 @@ int process_claim() {
     // Minimum claim check (default 1 XRP)
     uint64_t min_claim = 1000000; // 1 XRP in drops
     if (payout < min_claim) {
-        return rollback(str_to_ptr("below minimum"), str_len("below minimum"), 1);
+        return rollback(LIT("below minimum"), 1);
     }
 
     // Reserve transaction emission slot
@@ -189,16 +133,16 @@ int process_claim() {
 
     // Emit payment
     if (emit_xrp_payment(sender, payout) < 0) {
-        return rollback(str_to_ptr("emit failed"), str_len("emit failed"), 1);
+        return rollback(LIT("emit failed"), 1);
     }
 
     // Update balance
     uint64_t new_balance = balance - payout;
     if (save_balance(sender, new_balance) < 0) {
-        return rollback(str_to_ptr("state failed"), str_len("state failed"), 1);
+        return rollback(LIT("state failed"), 1);
     }
 
-    return accept(str_to_ptr("claimed"), str_len("claimed"), 0);
+    return accept(LIT("claimed"), 0);
 }
 
 // Process admin deposit (add to user balance)
@@ -207,16 +151,16 @@ int process_admin_deposit() {
     uint8_t amount_buf[8];
 
     // Get sender account
-    if (otxn_field(str_to_ptr(sender), 20, sfAccount) != 20) {
-        return rollback(str_to_ptr("invalid sender"), str_len("invalid sender"), 1);
+    if (otxn_field(PTR32(sender), 20, sfAccount) != 20) {
+        return rollback(LIT("invalid sender"), 1);
     }
 
     // Get payment amount
-    if (otxn_field(str_to_ptr(amount_buf), 8, sfAmount) != 8) {
-        return rollback(str_to_ptr("invalid amount"), str_len("invalid amount"), 1);
+    if (otxn_field(PTR32(amount_buf), 8, sfAmount) != 8) {
+        return rollback(LIT("invalid amount"), 1);
     }
 
-    uint64_t deposit_amount = buf_to_u64(amount_buf);
+    uint64_t deposit_amount = be_load_u64(amount_buf);
 
     // Load current balance
     uint64_t current_balance = load_balance(sender);
@@ -226,33 +170,33 @@ int process_admin_deposit() {
 
     // Save new balance
     if (save_balance(sender, new_balance) < 0) {
-        return rollback(str_to_ptr("state failed"), str_len("state failed"), 1);
+        return rollback(LIT("state failed"), 1);
     }
 
-    return accept(str_to_ptr("deposited"), str_len("deposited"), 0);
+    return accept(LIT("deposited"), 0);
 }
 
 // Main hook function
 int64_t hook(int64_t reserved) {
     // Only handle payments
     if (otxn_type() != ttPAYMENT) {
-        return accept(str_to_ptr("not payment"), str_len("not payment"), 0);
+        return accept(LIT("not payment"), 0);
     }
 
     // Get destination account
     uint8_t destination[20];
     uint8_t hook_acc[20];
 
-    if (otxn_field(str_to_ptr(destination), 20, sfDestination) != 20) {
-        return rollback(str_to_ptr("no destination"), str_len("no destination"), 1);
+    if (otxn_field(PTR32(destination), 20, sfDestination) != 20) {
+        return rollback(LIT("no destination"), 1);
     }
 
     // Get our account
-    hook_account(str_to_ptr(hook_acc), 20);
+    hook_account(PTR32(hook_acc), 20);
 
     // Check if payment is to us
-    if (mem_cmp(destination, hook_acc, 20) != 0) {
-        return accept(str_to_ptr("not for us"), str_len("not for us"), 0);
+    if (!equal_20(destination, hook_acc)) {
+        return accept(LIT("not for us"), 0);
     }
 
     // Check for CLAIM memo
@@ -266,7 +210,7 @@ int64_t hook(int64_t reserved) {
     }
 
     // Regular payment - just accept
-    return accept(str_to_ptr("payment ok"), str_len("payment ok"), 0);
+    return accept(LIT("payment ok"), 0);
 }
 
 // Callback function (required)
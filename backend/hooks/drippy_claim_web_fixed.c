@@ -3,7 +3,7 @@
 // Triggers: Payments with specific memos to the claim pool account
 
 #include "hookapi.h"
-#include <stdint.h>
+#include "drippy_codec.h"
 
 #define KEYLEN 32
 #define STATE_SIZE 32
@@ -25,82 +25,38 @@ int get_memo_data(uint32_t memo_slot, uint8_t* out, int max_len) {
     return slot(out, max_len, memo_slot);
 }
 
-// Helper function to convert buffer to uint64
-uint64_t buf_to_uint64(uint8_t* buf) {
-    uint64_t result = 0;
-    for (int i = 0; i < 8; i++) {
-        result = (result << 8) | buf[i];
-    }
-    return result;
-}
-
-// Helper function to convert uint64 to buffer
-void uint64_to_buf(uint8_t* buf, uint64_t value) {
-    for (int i = 7; i >= 0; i--) {
-        buf[i] = value & 0xFF;
-        value >>= 8;
-    }
-}
-
-// Helper function to convert buffer to uint32
-uint32_t buf_to_uint32(uint8_t* buf) {
-    uint32_t result = 0;
-    for (int i = 0; i < 4; i++) {
-        result = (result << 8) | buf[i];
-    }
-    return result;
-}
-
-// Helper function to convert uint32 to buffer
-void uint32_to_buf(uint8_t* buf, uint32_t value) {
-    for (int i = 3; i >= 0; i--) {
-        buf[i] = value & 0xFF;
-        value >>= 8;
-    }
-}
+// Helper function to get parameter as uint64 (name must be a string literal)
+#define get_param_u64(name) param_u64(LIT(name))
 
-// Helper function to get parameter as uint64
-uint64_t get_param_u64(const char* name) {
+uint64_t param_u64(uint32_t name_ptr, uint32_t name_len) {
     uint8_t buf[8];
-    int name_len = 0;
-    while (name[name_len] != 0) name_len++; // Manual strlen
-
-    if (hook_param(buf, 8, name, name_len) == 8) {
-        return buf_to_uint64(buf);
+    if (hook_param(PTR32(buf), 8, name_ptr, name_len) == 8) {
+        return be_load_u64(buf);
     }
     return 0;
 }
 
-// Helper function to get parameter as uint32
-uint32_t get_param_u32(const char* name) {
-    uint8_t buf[4];
-    int name_len = 0;
-    while (name[name_len] != 0) name_len++; // Manual strlen
+// Helper function to get parameter as uint32 (name must be a string literal)
+#define get_param_u32(name) param_u32(LIT(name))
 
-    if (hook_param(buf, 4, name, name_len) == 4) {
-        return buf_to_uint32(buf);
+uint32_t param_u32(uint32_t name_ptr, uint32_t name_len) {
+    uint8_t buf[4];
+    if (hook_param(PTR32(buf), 4, name_ptr, name_len) == 4) {
+        return be_load_u32(buf);
     }
     return 0;
 }
 
 // Helper function to get parameter as account
-int get_param_account(uint8_t* account, const char* name) {
-    int name_len = 0;
-    while (name[name_len] != 0) name_len++; // Manual strlen
-    return hook_param(account, 20, name, name_len) == 20;
-}
+#define get_param_account(account, name) (hook_param(PTR32(account), 20, LIT(name)) == 20)
+
+// Account key: "DRIPPY:CLAIM" followed by the account id
+static const uint8_t ACCOUNT_KEY_PREFIX[KEYLEN] = "DRIPPY:CLAIM";
 
 // Generate state key for account
 void make_account_key(uint8_t* key, uint8_t* account) {
-    // Clear key
-    for (int i = 0; i < KEYLEN; i++) key[i] = 0;
-
-    // Add prefix "DRIPPY:CLAIM:"
-    uint8_t prefix[12] = {'D','R','I','P','P','Y',':','C','L','A','I','M',':'};
-    for (int i = 0; i < 12; i++) key[i] = prefix[i];
-
-    // Add account id
-    for (int i = 0; i < 20; i++) key[12 + i] = account[i];
+    copy_32(key, ACCOUNT_KEY_PREFIX);
+    copy_20(key + 12, account);
 }
 
 // Load account state
@@ -111,7 +67,7 @@ int load_account_state(uint8_t* state, uint8_t* account) {
     int result = state_get(state, STATE_SIZE, key, KEYLEN);
     if (result < 0) {
         // Initialize empty state
-        for (int i = 0; i < STATE_SIZE; i++) state[i] = 0;
+        zero_32(state);
         return 0;
     }
     return result;
@@ -136,11 +92,7 @@ int is_admin(uint8_t* sender) {
         return 0; // No admin configured
     }
 
-    // Compare accounts
-    for (int i = 0; i < 20; i++) {
-        if (admin_account[i] != sender[i]) return 0;
-    }
-    return 1;
+    return equal_20(admin_account, sender);
 }
 
 // Emit payment transaction
@@ -173,11 +125,11 @@ int process_claim(uint8_t* claimant) {
     }
 
     // Extract state data
-    uint64_t accrued = buf_to_uint64(state + OFFSET_ACCRUED);
-    uint64_t last_claim = buf_to_uint64(state + OFFSET_LAST_CLAIM);
-    uint32_t claim_count = buf_to_uint32(state + OFFSET_CLAIM_COUNT);
-    uint32_t boost_mult = buf_to_uint32(state + OFFSET_BOOST_MULT);
-    uint64_t daily_claimed = buf_to_uint64(state + OFFSET_DAILY_CLAIMED);
+    uint64_t accrued = be_load_u64(state + OFFSET_ACCRUED);
+    uint64_t last_claim = be_load_u64(state + OFFSET_LAST_CLAIM);
+    uint32_t claim_count = be_load_u32(state + OFFSET_CLAIM_COUNT);
+    uint32_t boost_mult = be_load_u32(state + OFFSET_BOOST_MULT);
+    uint64_t daily_claimed = be_load_u64(state + OFFSET_DAILY_CLAIMED);
 
     // Check if there's anything to claim
     if (accrued == 0) {
@@ -239,10 +191,10 @@ int process_claim(uint8_t* claimant) {
 
     // Update state
     uint64_t now = (uint64_t)ledger_last_time();
-    uint64_to_buf(state + OFFSET_ACCRUED, accrued - payout);
-    uint64_to_buf(state + OFFSET_LAST_CLAIM, now);
-    uint32_to_buf(state + OFFSET_CLAIM_COUNT, claim_count + 1);
-    uint64_to_buf(state + OFFSET_DAILY_CLAIMED, daily_claimed + payout);
+    be_store_u64(state + OFFSET_ACCRUED, accrued - payout);
+    be_store_u64(state + OFFSET_LAST_CLAIM, now);
+    be_store_u32(state + OFFSET_CLAIM_COUNT, claim_count + 1);
+    be_store_u64(state + OFFSET_DAILY_CLAIMED, daily_claimed + payout);
 
     if (save_account_state(state, claimant) < 0) {
         return rollback("state update failed", 1);
@@ -258,8 +210,8 @@ int process_admin_accrual(uint8_t* target_account, uint64_t amount) {
         return rollback("state load failed", 1);
     }
 
-    uint64_t current_accrued = buf_to_uint64(state + OFFSET_ACCRUED);
-    uint64_to_buf(state + OFFSET_ACCRUED, current_accrued + amount);
+    uint64_t current_accrued = be_load_u64(state + OFFSET_ACCRUED);
+    be_store_u64(state + OFFSET_ACCRUED, current_accrued + amount);
 
     if (save_account_state(state, target_account) < 0) {
         return rollback("state update failed", 1);
@@ -282,7 +234,7 @@ int process_admin_boost(uint8_t* target_account, uint32_t boost_multiplier) {
         return rollback("state load failed", 1);
     }
 
-    uint32_to_buf(state + OFFSET_BOOST_MULT, boost_multiplier);
+    be_store_u32(state + OFFSET_BOOST_MULT, boost_multiplier);
 
     if (save_account_state(state, target_account) < 0) {
         return rollback("state update failed", 1);
@@ -336,15 +288,7 @@ int64_t hook(int64_t reserved) {
     uint8_t hook_acc[20];
     hook_account(hook_acc, 20);
 
-    int is_to_us = 1;
-    for (int i = 0; i < 20; i++) {
-        if (destination[i] != hook_acc[i]) {
-            is_to_us = 0;
-            break;
-        }
-    }
-
-    if (!is_to_us) {
+    if (!equal_20(destination, hook_acc)) {
         return accept("not for us", 0);
     }
 
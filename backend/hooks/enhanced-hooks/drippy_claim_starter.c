@@ -4,6 +4,8 @@
  * Triggers: Payments with "CLAIM" memo to this account
  */
 #include "hookapi.h"
+#include "drippy_trace.h"
+#include "drippy_metrics.h"
 
 int64_t hook(uint32_t reserved) {
 
@@ -131,6 +133,9 @@ int64_t hook(uint32_t reserved) {
 
     TRACEVAR(new_balance);
 
+    event_record(EVT_OP_CLAIM, EVT_OK, sender, claim_amount, 0);
+    metrics_record(0, 0, claim_amount, 1);
+
     // Accept the claim transaction
     accept(SBUF("DRIPPY Claim: Claimed successfully"), 0);
 
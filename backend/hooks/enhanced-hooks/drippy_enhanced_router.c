@@ -1,6 +1,8 @@
 #define HAS_CALLBACK
 #include <stdint.h>
 #include "hookapi.h"
+#include "drippy_trace.h"
+#include "drippy_metrics.h"
 
 int64_t cbak(uint32_t reserved)
 {
@@ -51,6 +53,7 @@ int64_t hook(uint32_t reserved)
 
     // Minimum distribution check
     if (total_fee < 1000000) { // 1 XRP minimum
+        event_record(EVT_OP_ROUTE, EVT_SKIPPED, sender, (uint64_t)total_fee, 0);
         accept(SBUF("Enhanced Router: Amount too small"), 0);
     }
 
@@ -134,8 +137,12 @@ int64_t hook(uint32_t reserved)
     TRACEVAR(emit5);
     TRACEVAR(emit6);
 
+    // Payments actually emitted, recorded in the event below
+    uint32_t emitted = (emit1 >= 0) + (emit2 >= 0) + (emit3 >= 0) +
+                       (emit4 >= 0) + (emit5 >= 0) + (emit6 >= 0);
+
     // Check if all emissions succeeded
-    if (emit1 < 0 || emit2 < 0 || emit3 < 0 || emit4 < 0 || emit5 < 0 || emit6 < 0) {
+    if (emitted != 6) {
         rollback(SBUF("Enhanced Router: Distribution failed"), 4);
     }
 
@@ -183,6 +190,15 @@ int64_t hook(uint32_t reserved)
 
     TRACEVAR(total_distributed);
 
+    event_record(EVT_OP_ROUTE, EVT_OK, sender, (uint64_t)total_fee, emitted);
+
+    // Hourly/daily buckets: volume and the six pool shares in payment tag order
+    const uint64_t pool_amounts[METRIC_POOLS] = {
+        nft_reward_total, holder_reward_total, treasury_share,
+        amm_deposit, xrp_lp_reward, drippy_lp_reward
+    };
+    metrics_record((uint64_t)total_fee, pool_amounts, 0, 0);
+
     accept(SBUF("Enhanced Router: All distributions complete"), 0);
     return 0;
 }
\ No newline at end of file
@@ -1,6 +1,25 @@
 #define HAS_CALLBACK
 #include <stdint.h>
 #include "hookapi.h"
+#include "simple_emit.h"
+#include "drippy_trace.h"
+
+// HookParameters (names without terminator):
+//   CUR       : 20-byte DRIPPY currency code (required)
+//   ISSUER    : 20-byte DRIPPY issuer (default: hook account)
+//   ADMIN     : 20-byte whitelisted admin account
+//   TREASURY  : 20-byte fee destination (default: treasury address below)
+//   ANTI_SNIPE: 8-byte u64 anti-sniping end time, Ripple-epoch seconds (ledger_last_time)
+//   FEE_TIERS : up to 4 x [8-byte XFL min amount | u16 buy bps | u16 sell bps]
+//   SNIPE_BPS : 2-byte u16 anti-snipe sell tax in bps (default 5000)
+//   FEE_FLUSH : 8-byte XFL pending fees that trigger a treasury payout (default 1000)
+//   SNIPE_BURST : 4-byte u32 trades per account back to back during anti-snipe (default 3)
+//   SNIPE_REFILL: 4-byte u32 ledgers to earn one more trade (default 10)
+//   SNIPE_VOL   : 8-byte XFL DRIPPY volume per ledger from non-whitelisted traders (0 = no cap)
+//
+// Anti-snipe whitelist is a state set: key "DRIPPY:WL:v1" + account id, edited by ADMIN
+// with a Payment carrying a WLADD / WLDEL memo of up to 8 concatenated account ids.
+#define PNAME(name) SBUF(name) - 1
 
 int64_t cbak(uint32_t reserved)
 {
@@ -33,6 +52,47 @@ int64_t hook(uint32_t reserved)
         accept(SBUF("DRIPPY Utility: Invalid destination"), 0);
     }
 
+    uint8_t admin_account[20];
+    int has_admin = (hook_param(SBUF(admin_account), PNAME("ADMIN")) == 20);
+
+    // Admin whitelist updates: memo type WLADD / WLDEL, data = account ids
+    int is_admin = 0;
+    if (has_admin) {
+        BUFFER_EQUAL(is_admin, sender, admin_account, 20);
+    }
+
+    if (is_admin && otxn_slot(1) == 1 && slot_subfield(1, sfMemos, 2) == 2 &&
+        slot_subarray(2, 0, 3) == 3 && slot_subfield(3, sfMemo, 3) == 3 &&
+        slot_subfield(3, sfMemoType, 4) == 4 && slot_subfield(3, sfMemoData, 5) == 5) {
+        uint8_t memo_type[5];
+        if (slot(SBUF(memo_type), 4) == 5 && memo_type[0] == 'W' && memo_type[1] == 'L') {
+            int wl_add = (memo_type[2] == 'A' && memo_type[3] == 'D' && memo_type[4] == 'D');
+            int wl_del = (memo_type[2] == 'D' && memo_type[3] == 'E' && memo_type[4] == 'L');
+
+            uint8_t wl_accounts[160];
+            int64_t wl_len = slot(SBUF(wl_accounts), 5);
+            if ((wl_add || wl_del) && (wl_len <= 0 || wl_len % 20 != 0)) {
+                rollback(SBUF("DRIPPY Utility: Whitelist memo must hold account ids"), 1);
+            }
+
+            if (wl_add || wl_del) {
+                uint8_t wl_key[32] = { 'D','R','I','P','P','Y',':','W','L',':','v','1' };
+                uint8_t wl_flag = 1;
+                // copy_20 is straight-line, so only the batch loop spends guard budget
+                for (int i = 0; GUARD(8), i < wl_len / 20; ++i) {
+                    copy_20(wl_key + 12, wl_accounts + i * 20);
+                    int64_t wl_result = wl_add
+                        ? state_set(SVAR(wl_flag), SBUF(wl_key))
+                        : state_set(0, 0, SBUF(wl_key));
+                    if (wl_result < 0) {
+                        rollback(SBUF("DRIPPY Utility: Whitelist update failed"), 2);
+                    }
+                }
+                accept(SBUF("DRIPPY Utility: Whitelist updated"), 0);
+            }
+        }
+    }
+
     // Check if this transaction involves our DRIPPY issuer account
     int involves_issuer = 0;
     BUFFER_EQUAL(involves_issuer, sender, hook_accid, 20);
@@ -58,8 +118,33 @@ int64_t hook(uint32_t reserved)
         accept(SBUF("DRIPPY Utility: Invalid amount format"), 0);
     }
 
-    // Extract IOU details (simplified - in production, parse full IOU structure)
-    // For now, assume all 48-byte amounts involving issuer are DRIPPY
+    // Decode the issued amount: [0..7] XFL-style amount, [8..27] currency, [28..47] issuer
+    uint8_t drippy_currency[20];
+    if (hook_param(SBUF(drippy_currency), PNAME("CUR")) != 20) {
+        rollback(SBUF("DRIPPY Utility: CUR parameter missing"), 3);
+    }
+
+    uint8_t drippy_issuer[20];
+    if (hook_param(SBUF(drippy_issuer), PNAME("ISSUER")) != 20) {
+        for (int i = 0; GUARD(20), i < 20; ++i)
+            drippy_issuer[i] = hook_accid[i];
+    }
+
+    int is_drippy = 0;
+    BUFFER_EQUAL(is_drippy, amount_buffer + 8, drippy_currency, 20);
+    if (is_drippy) {
+        BUFFER_EQUAL(is_drippy, amount_buffer + 28, drippy_issuer, 20);
+    }
+
+    if (!is_drippy) {
+        accept(SBUF("DRIPPY Utility: Not a DRIPPY amount"), 0);
+    }
+
+    // A partial payment's Amount can be far above what it delivers; charging the fee on
+    // it would pay out DRIPPY nobody paid in, so DRIPPY partial payments are refused
+    if (otxn_partial_payment()) {
+        rollback(SBUF("DRIPPY Utility: Partial payments not accepted"), 1);
+    }
 
     // Determine transaction type
     int is_buy = 0;  // Payment TO issuer (user buying DRIPPY)
@@ -72,18 +157,36 @@ int64_t hook(uint32_t reserved)
         accept(SBUF("DRIPPY Utility: Regular transfer"), 0);
     }
 
-    // Get transaction amount (simplified for 48-byte IOU)
-    // In production, properly parse IOU amount
-    uint64_t drippy_amount = 1000000; // Placeholder - extract from IOU structure
+    uint8_t treasury_account[20];
+    if (hook_param(SBUF(treasury_account), PNAME("TREASURY")) != 20) {
+        int64_t ret = util_accid(SBUF(treasury_account), SBUF("rUWEnNWzwJKDDJeZJD3EqgrcT4rK14G2PZ"));
+        if (ret < 0) {
+            rollback(SBUF("DRIPPY Utility: Invalid treasury address"), 1);
+        }
+    }
+
+    // The fee payouts emitted below come back through this hook; they are not trades
+    int is_payout = 0;
+    if (is_sell) {
+        BUFFER_EQUAL(is_payout, destination, treasury_account, 20);
+    }
+    if (is_payout) {
+        accept(SBUF("DRIPPY Utility: Fee payout"), 0);
+    }
+
+    int64_t drippy_amount = float_sto_set(amount_buffer, 48);
+    if (drippy_amount <= 0) {
+        accept(SBUF("DRIPPY Utility: Zero or invalid amount"), 0);
+    }
 
-    TRACEVAR(drippy_amount);
+    TRACEXFL(drippy_amount);
     TRACEVAR(is_buy);
     TRACEVAR(is_sell);
 
     // Anti-sniping check (configurable via parameter)
     uint64_t anti_snipe_end = 0;
     uint8_t anti_snipe_buf[8];
-    if (hook_param(SBUF(anti_snipe_buf), SBUF("ANTI_SNIPE")) == 8) {
+    if (hook_param(SBUF(anti_snipe_buf), PNAME("ANTI_SNIPE")) == 8) {
         anti_snipe_end = UINT64_FROM_BUF(anti_snipe_buf);
     }
 
@@ -94,55 +197,221 @@ int64_t hook(uint32_t reserved)
     TRACEVAR(anti_snipe_end);
     TRACEVAR(anti_snipe_active);
 
-    // Check whitelist (simplified)
+    // The trader is the counterparty of the issuer
+    uint8_t* trader = is_buy ? sender : destination;
+
+    // Whitelist: admin, or an O(1) lookup in the state-held set
     int is_whitelisted = 0;
-    uint8_t admin_account[20];
-    if (hook_param(SBUF(admin_account), SBUF("ADMIN")) == 20) {
-        BUFFER_EQUAL(is_whitelisted, sender, admin_account, 20);
+    if (has_admin) {
+        BUFFER_EQUAL(is_whitelisted, trader, admin_account, 20);
+    }
+
+    if (anti_snipe_active && !is_whitelisted) {
+        uint8_t wl_key[32] = { 'D','R','I','P','P','Y',':','W','L',':','v','1' };
+        for (int i = 0; GUARD(20), i < 20; ++i)
+            wl_key[12 + i] = trader[i];
+        uint8_t wl_flag;
+        is_whitelisted = (state(SVAR(wl_flag), SBUF(wl_key)) == 1);
     }
 
-    // Calculate fees
-    uint64_t fee_rate = 500; // 5% in basis points (500/10000)
+    // Throttle non-whitelisted traders during the anti-snipe window
+    if (anti_snipe_active && !is_whitelisted) {
+        uint32_t seq = (uint32_t)ledger_seq();
+
+        uint32_t burst = 3;
+        uint32_t refill = 10;
+        uint8_t param_buf[8];
+        if (hook_param(param_buf, 4, PNAME("SNIPE_BURST")) == 4)
+            burst = UINT32_FROM_BUF(param_buf);
+        if (hook_param(param_buf, 4, PNAME("SNIPE_REFILL")) == 4)
+            refill = UINT32_FROM_BUF(param_buf);
+        if (refill == 0)
+            refill = 1;
+
+        // Token bucket in one of 64 shared slots, so the state stays bounded however many
+        // accounts trade: key "DRIPPY:TB:v2" + (last trader byte mod 64) ->
+        // [trader | u32 ledger seq | u32 tokens]. A slot held by another trader is taken
+        // over with a full bucket.
+        uint8_t tb_key[32] = { 'D','R','I','P','P','Y',':','T','B',':','v','2' };
+        tb_key[12] = trader[19] % 64;
+
+        uint8_t bucket[28];
+        uint32_t last = seq;
+        uint32_t tokens = burst;
+        int own_bucket = 0;
+        if (state(SBUF(bucket), SBUF(tb_key)) == 28) {
+            BUFFER_EQUAL(own_bucket, bucket, trader, 20);
+        }
+        if (own_bucket) {
+            last = UINT32_FROM_BUF(bucket + 20);
+            tokens = UINT32_FROM_BUF(bucket + 24);
+
+            // Credit whole refill periods only, the partial period carries over
+            uint32_t earned = (seq - last) / refill;
+            if (tokens + earned >= burst) {
+                tokens = burst;
+                last = seq;
+            } else {
+                tokens += earned;
+                last += earned * refill;
+            }
+        }
+
+        if (tokens == 0) {
+            rollback(SBUF("DRIPPY Utility: Anti-snipe trade rate exceeded"), 3);
+        }
+
+        for (int i = 0; GUARD(20), i < 20; ++i)
+            bucket[i] = trader[i];
+        UINT32_TO_BUF(bucket + 20, last);
+        UINT32_TO_BUF(bucket + 24, tokens - 1);
+        if (state_set(SBUF(bucket), SBUF(tb_key)) != 28) {
+            rollback(SBUF("DRIPPY Utility: Throttle update failed"), 2);
+        }
+
+        // Global per-ledger volume: key "DRIPPY:UTIL:LVOL" -> [u32 ledger seq | XFL volume]
+        int64_t vol_cap = 0;
+        if (hook_param(param_buf, 8, PNAME("SNIPE_VOL")) == 8) {
+            uint8_t* cap_buf = param_buf;
+            vol_cap = INT64_FROM_BUF(cap_buf);
+        }
+
+        if (vol_cap > 0) {
+            uint8_t vol_key[32] = {
+                'D','R','I','P','P','Y',':','U','T','I','L',':','L','V','O','L'
+            };
+            uint8_t vol_record[12];
+            int64_t volume = 0;
+            if (state(SBUF(vol_record), SBUF(vol_key)) == 12 && UINT32_FROM_BUF(vol_record) == seq) {
+                uint8_t* vol_buf = vol_record + 4;
+                volume = INT64_FROM_BUF(vol_buf);
+            }
+
+            volume = float_sum(volume, drippy_amount);
+            if (volume < 0 || float_compare(volume, vol_cap, COMPARE_GREATER) == 1) {
+                rollback(SBUF("DRIPPY Utility: Anti-snipe ledger volume cap reached"), 3);
+            }
+
+            UINT32_TO_BUF(vol_record, seq);
+            INT64_TO_BUF(vol_record + 4, volume);
+            if (state_set(SBUF(vol_record), SBUF(vol_key)) != 12) {
+                rollback(SBUF("DRIPPY Utility: Throttle update failed"), 2);
+            }
+        }
+    }
 
-    // Anti-sniping: 50% sell tax if active and selling and not whitelisted
+    // Fee tiers: up to 4 x 12 bytes [XFL min amount | u16 buy bps | u16 sell bps],
+    // ascending by min amount. The last tier whose minimum is reached applies.
+    uint32_t fee_rate = 500; // 5% in basis points when no tiers are set
+    uint8_t tiers[48];
+    int64_t tiers_len = hook_param(SBUF(tiers), PNAME("FEE_TIERS"));
+    for (int i = 0; GUARD(4), i < 4 && (i + 1) * 12 <= tiers_len; ++i) {
+        uint8_t* tier = tiers + i * 12;
+        int64_t tier_min = INT64_FROM_BUF(tier);
+        if (tier_min > 0 && float_compare(drippy_amount, tier_min, COMPARE_LESS) == 1)
+            break;
+        fee_rate = is_buy ? UINT16_FROM_BUF(tier + 8) : UINT16_FROM_BUF(tier + 10);
+    }
+
+    // Anti-sniping: higher sell tax if active and selling and not whitelisted
     if (anti_snipe_active && is_sell && !is_whitelisted) {
-        fee_rate = 5000; // 50% anti-snipe tax
+        uint8_t snipe_buf[2];
+        fee_rate = 5000; // 50% anti-snipe tax by default
+        if (hook_param(SBUF(snipe_buf), PNAME("SNIPE_BPS")) == 2) {
+            fee_rate = UINT16_FROM_BUF(snipe_buf);
+        }
         TRACESTR("DRIPPY Utility: Anti-snipe tax applied");
     }
 
-    uint64_t total_fee = (drippy_amount * fee_rate) / 10000;
-    TRACEVAR(total_fee);
+    if (fee_rate > 10000) {
+        rollback(SBUF("DRIPPY Utility: Invalid fee tier"), 1);
+    }
+
+    int64_t total_fee = float_mulratio(drippy_amount, 0, fee_rate, 10000);
+    TRACEXFL(total_fee);
 
-    if (total_fee == 0) {
+    if (total_fee <= 0) {
         accept(SBUF("DRIPPY Utility: No fee required"), 0);
     }
 
-    // Reserve emission slots for fee distribution
-    etxn_reserve(1);
+    // Coalesced fee record (32 bytes, key "DRIPPY:UTIL:FEES"):
+    //   [0..7]   XFL fees pending payout to treasury
+    //   [8..15]  XFL lifetime fees collected
+    //   [16..19] u32 buy count   [20..23] u32 sell count
+    //   [24..27] u32 anti-snipe count   [28..31] u32 treasury flush count
+    uint8_t fee_key[32] = {
+        'D','R','I','P','P','Y',':','U','T','I','L',':','F','E','E','S'
+    };
+    uint8_t fee_record[32];
+    if (state(SBUF(fee_record), SBUF(fee_key)) != 32) {
+        for (int i = 0; GUARD(32), i < 32; ++i)
+            fee_record[i] = 0;
+    }
 
-    // Send collected fees to treasury for distribution
-    uint8_t treasury_account[20];
-    int64_t ret = util_accid(SBUF(treasury_account), SBUF("rUWEnNWzwJKDDJeZJD3EqgrcT4rK14G2PZ"));
+    uint8_t* pending_buf = fee_record;
+    uint8_t* lifetime_buf = fee_record + 8;
+    int64_t pending = float_sum(INT64_FROM_BUF(pending_buf), total_fee);
+    int64_t lifetime = float_sum(INT64_FROM_BUF(lifetime_buf), total_fee);
+    if (pending < 0 || lifetime < 0) {
+        rollback(SBUF("DRIPPY Utility: Fee accounting overflow"), 1);
+    }
+
+    if (is_buy) {
+        UINT32_TO_BUF(fee_record + 16, UINT32_FROM_BUF(fee_record + 16) + 1);
+    } else {
+        UINT32_TO_BUF(fee_record + 20, UINT32_FROM_BUF(fee_record + 20) + 1);
+    }
+    if (anti_snipe_active && is_sell && !is_whitelisted) {
+        UINT32_TO_BUF(fee_record + 24, UINT32_FROM_BUF(fee_record + 24) + 1);
+    }
 
-    if (ret < 0) {
-        rollback(SBUF("DRIPPY Utility: Invalid treasury address"), 1);
+    // Only pay the treasury once the pending balance reaches FEE_FLUSH (XFL, default 1000)
+    int64_t flush_min = float_set(3, 1);
+    uint8_t flush_buf[8];
+    if (hook_param(SBUF(flush_buf), PNAME("FEE_FLUSH")) == 8) {
+        flush_min = INT64_FROM_BUF(flush_buf);
     }
 
-    // Create fee payment to treasury (simplified - use XRP for now)
-    // In production, emit DRIPPY IOU payment
-    unsigned char fee_tx[PREPARE_PAYMENT_SIMPLE_SIZE];
-    PREPARE_PAYMENT_SIMPLE(fee_tx, total_fee, treasury_account, 0, 0);
+    if (float_compare(pending, flush_min, COMPARE_LESS) != 1) {
+        etxn_reserve(1);
+
+        // Send collected fees to treasury for distribution
+        // Fee is paid in DRIPPY over the treasury trustline
+        uint8_t fee_amount[48];
+        if (float_sto(SBUF(fee_amount), SBUF(drippy_currency), SBUF(drippy_issuer), pending, 0) != 48) {
+            rollback(SBUF("DRIPPY Utility: Fee serialization failed"), 2);
+        }
 
-    // Emit fee payment
-    uint8_t emithash[32];
-    int64_t emit_result = emit(SBUF(emithash), SBUF(fee_tx));
+        // macro.h sizes PREPARE_PAYMENT_SIMPLE_TRUSTLINE one byte short of the payment it
+        // builds; SIMPLE_TL_PAYMENT_SIZE holds the fields and the callback EmitDetails
+        uint8_t fee_tx[SIMPLE_TL_PAYMENT_SIZE];
+        int64_t fee_len = PREPARE_PAYMENT_SIMPLE_TL(fee_tx, sizeof(fee_tx), 0, treasury_account, fee_amount);
 
-    TRACEVAR(emit_result);
+        // Emit fee payment
+        uint8_t emithash[32];
+        int64_t emit_result = emit(SBUF(emithash), fee_tx, (uint32_t)fee_len);
 
-    if (emit_result < 0) {
-        rollback(SBUF("DRIPPY Utility: Fee emission failed"), 2);
+        TRACEVAR(emit_result);
+
+        if (emit_result < 0) {
+            rollback(SBUF("DRIPPY Utility: Fee emission failed"), 2);
+        }
+
+        pending = 0;
+        UINT32_TO_BUF(fee_record + 28, UINT32_FROM_BUF(fee_record + 28) + 1);
     }
 
+    INT64_TO_BUF(pending_buf, pending);
+    INT64_TO_BUF(lifetime_buf, lifetime);
+    if (state_set(SBUF(fee_record), SBUF(fee_key)) != 32) {
+        rollback(SBUF("DRIPPY Utility: Fee record update failed"), 2);
+    }
+
+    // Event amount is the XFL fee; aux bit 0 = buy, bit 1 = anti-snipe tax, bit 2 = flushed
+    event_record(EVT_OP_FEE, EVT_OK, trader, (uint64_t)total_fee,
+                 (is_buy ? 1 : 0) | (anti_snipe_active && is_sell && !is_whitelisted ? 2 : 0) |
+                 (pending == 0 ? 4 : 0));
+
     // Log transaction type and fee for monitoring
     if (anti_snipe_active && is_sell) {
         accept(SBUF("DRIPPY Utility: Anti-snipe fee collected"), 0);
@@ -0,0 +1,101 @@
+// Content-addressed SetHook entries.
+//
+// Every built hook has a HookHash recorded in build/manifest.json. Before a deploy,
+// planHook() checks the ledger:
+//   - the account already runs this hash at the position -> update parameters only
+//   - a HookDefinition with this hash exists              -> install by HookHash
+//   - otherwise                                           -> upload CreateCode
+// Code is only uploaded (and the size-proportional fee paid) the first time a given
+// build reaches the network, so parameter changes and rollouts across pool accounts
+// reuse the existing definition.
+
+const fs = require('fs');
+const path = require('path');
+const { hookHash } = require('./tools/hook-manifest');
+
+const BUILD_DIR = path.join(__dirname, 'build');
+const HSF_OVERRIDE = 1;
+
+function readManifest() {
+    const file = path.join(BUILD_DIR, 'manifest.json');
+    return fs.existsSync(file) ? JSON.parse(fs.readFileSync(file, 'utf8')) : { hooks: {} };
+}
+
+// Built hook as { name, hex, hookHash, bytes }; the manifest hash must match the build
+function loadArtifact(name) {
+    const hexPath = path.join(BUILD_DIR, `${name}.wasm.hex`);
+    if (!fs.existsSync(hexPath)) {
+        throw new Error(`Hook not built: ${hexPath}`);
+    }
+
+    const hex = fs.readFileSync(hexPath, 'utf8').replace(/\s+/g, '').toUpperCase();
+    if (hex.length === 0 || hex.length % 2 !== 0 || !/^[0-9A-F]+$/.test(hex)) {
+        throw new Error(`Invalid hex data in ${hexPath}`);
+    }
+
+    const hash = hookHash(Buffer.from(hex, 'hex'));
+    const entry = readManifest().hooks[name];
+    if (entry && entry.hookHash !== hash) {
+        throw new Error(`${name}: build/manifest.json is stale (${entry.hookHash} != ${hash}); rebuild with make`);
+    }
+
+    return { name, hex, hookHash: hash, bytes: hex.length / 2 };
+}
+
+async function definitionExists(client, hash) {
+    try {
+        await client.request({ command: 'ledger_entry', hook_definition: hash, ledger_index: 'validated' });
+        return true;
+    } catch (error) {
+        if (error.data?.error === 'entryNotFound' || /entryNotFound/.test(error.message)) return false;
+        throw error;
+    }
+}
+
+// HookHash installed at a position of an account's Hooks array, or null
+async function installedHash(client, account, position = 0) {
+    try {
+        const res = await client.request({ command: 'account_objects', account, type: 'hook', ledger_index: 'validated' });
+        const hooks = res.result.account_objects[0]?.Hooks || [];
+        return hooks[position]?.Hook?.HookHash || null;
+    } catch (error) {
+        if (error.data?.error === 'actNotFound') return null;
+        throw error;
+    }
+}
+
+// Build the Hook entry for a SetHook; `hook` carries HookOn, HookNamespace,
+// HookApiVersion and HookParameters
+async function planHook(client, account, artifact, hook, position = 0) {
+    const current = await installedHash(client, account, position);
+
+    if (current === artifact.hookHash) {
+        // Same code already installed: only parameters / HookOn / namespace change
+        const { HookApiVersion, ...update } = hook;
+        return { mode: 'update', entry: { Hook: update } };
+    }
+
+    if (await definitionExists(client, artifact.hookHash)) {
+        // HookApiVersion belongs to the definition and is only sent with CreateCode
+        const { HookApiVersion, ...install } = hook;
+        return {
+            mode: 'install',
+            entry: { Hook: { ...install, HookHash: artifact.hookHash, Flags: HSF_OVERRIDE } }
+        };
+    }
+
+    return {
+        mode: 'upload',
+        entry: { Hook: { ...hook, CreateCode: artifact.hex, Flags: HSF_OVERRIDE } }
+    };
+}
+
+function describePlan(plan, artifact) {
+    switch (plan.mode) {
+        case 'update': return `parameters only (${artifact.hookHash} already installed)`;
+        case 'install': return `install existing definition ${artifact.hookHash}`;
+        default: return `upload ${artifact.bytes} bytes (${artifact.hookHash})`;
+    }
+}
+
+module.exports = { loadArtifact, planHook, describePlan, definitionExists, installedHash };
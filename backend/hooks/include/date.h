@@ -0,0 +1,5 @@
+// Placeholder for the Hooks Builder date helpers pulled in by the vendored hookapi.h.
+// None of the DRIPPY hooks use them; this keeps local (non-Builder) compiles working.
+#ifndef DRIPPY_DATE_H
+#define DRIPPY_DATE_H
+#endif
@@ -0,0 +1,42 @@
+// DRIPPY change log: a cursor for indexers over the claim and router hook state
+//
+// Every accepted state change appends one record to a ring of CHANGE_LOG_SLOTS state
+// entries under "DRIPPY:CHG:" (format in drippy_ring.h). The sequence number in the
+// head entry only grows, so an indexer asks for "changes since N" and reads exactly
+// the new records instead of re-listing every account object (backend/src/hook-events.js,
+// decoded by backend/native).
+//
+// The value field is the state value after the change, not a delta, so replaying a
+// record twice is harmless:
+//   CHG_ACCRUED     account's accrued drops; aux = claim count
+//   CHG_BOOST       account's boost multiplier
+//   CHG_ROUTED      router TOTAL_DIST in drops after a native fee from account;
+//                   aux = distribution count
+//   CHG_ROUTED_IOU  issued-currency fee from account as XFL; aux = IOU fee count
+//   CHG_WHITELIST   anti-snipe whitelist: 1 = account added, 0 = removed
+//
+// Size the ring above the number of changes an indexer may fall behind by; it reports
+// how many it missed when it does. Unlike the event ring this log is never compiled out.
+
+#ifndef DRIPPY_CHANGES_H
+#define DRIPPY_CHANGES_H
+
+#include "drippy_ring.h"
+
+#ifndef CHANGE_LOG_SLOTS
+#define CHANGE_LOG_SLOTS 256
+#endif
+
+#define CHG_ACCRUED     1
+#define CHG_BOOST       2
+#define CHG_ROUTED      3
+#define CHG_ROUTED_IOU  4
+#define CHG_WHITELIST   5
+
+static const uint8_t CHANGE_HEAD_KEY[32] = "DRIPPY:CHG:HEAD";
+static const uint8_t CHANGE_SLOT_KEY[32] = "DRIPPY:CHG:";
+
+#define change_record(op, account, value, aux) \
+    ring_append(CHANGE_HEAD_KEY, CHANGE_SLOT_KEY, CHANGE_LOG_SLOTS, (op), 0, (account), (value), (aux))
+
+#endif
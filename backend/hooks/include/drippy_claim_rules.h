@@ -0,0 +1,135 @@
+// DRIPPY claim rules: the payout decision of src/drippy_enhanced_claim.c
+//
+// claim_apply() takes an account's 32-byte claim state, the limits the hook read from
+// its parameters and the ledger time, and either returns why the claim is refused or
+// computes the payout and writes the state the hook stores after paying. The hook
+// compiles it for wasm; backend/native compiles the same code for /claim/preview, so a
+// preview is the hook's own arithmetic rather than a second implementation of it.
+//
+// Nothing here calls the hook API. The one loop, over the NFT_TBL rows, is guarded when
+// macro.h is in scope and unbounded otherwise.
+//
+// State layout (32 bytes, big-endian):
+//   [0..7]   accrued drops      [8..15]  last claim time    [16..19] claim count
+//   [20..23] boost multiplier   [24..31] claimed on the day of the last claim
+
+#ifndef DRIPPY_CLAIM_RULES_H
+#define DRIPPY_CLAIM_RULES_H
+
+#include <stdint.h>
+#include "drippy_codec.h"
+
+#ifndef GUARDM
+#define GUARDM(maxiter, n) ((void)0)
+#endif
+
+#define CLAIM_STATE_SIZE 32
+#define CLAIM_SECONDS_PER_DAY 86400
+
+// NFT_TBL rows: [0..19] issuer, [20..23] u32 taxon (0xFFFFFFFF = any), [24..25] u16 multiplier
+#define CLAIM_NFT_ROW 26
+#define CLAIM_NFT_ROWS_MAX 8
+#define CLAIM_NFT_IDS_MAX 8
+#define CLAIM_NFT_TAXON_ANY 0xFFFFFFFFUL
+
+// Features a build was compiled with (CLAIM_FEATURE_*); the others leave the state alone
+#define CLAIM_RULE_DAILY_CAP 1
+#define CLAIM_RULE_BOOST 2
+
+// Outcomes, in the order the hook checks them
+#define CLAIM_OK 0
+#define CLAIM_BELOW_MINIMUM 1
+#define CLAIM_COOLDOWN 2
+#define CLAIM_DAILY_LIMIT 3
+
+typedef struct {
+    uint64_t min_claim;     // MIN_CLAIM
+    uint64_t max_claim;     // MAXP, 0 = unlimited
+    uint64_t cooldown;      // COOLD seconds, 0 = none
+    uint64_t daily_max;     // DAILY_MAX, 0 = unlimited
+    uint32_t boost;         // multiplier derived from NFT_TBL, 0 = use the stored one
+    uint32_t features;      // CLAIM_RULE_*
+} claim_rules;
+
+typedef struct {
+    uint64_t payout;        // taken from the accrued balance
+    uint64_t paid;          // payout with the boost applied, the amount emitted
+    uint32_t boost;         // multiplier applied, 100 = 1x
+} claim_outcome;
+
+// Boost points one URIToken adds: multiplier - 100 from the first NFT_TBL row matching
+// its issuer and taxon; tokens no row matches add nothing. The hook calls this once per
+// listed token, and a token no row matches evaluates the guard rows + 1 times, so the
+// bound covers CLAIM_NFT_IDS_MAX unmatched tokens against a full table.
+static inline uint32_t claim_nft_bonus(const uint8_t* table, int rows, const uint8_t issuer[20],
+                                       uint32_t taxon)
+{
+    for (int e = 0; GUARDM(CLAIM_NFT_IDS_MAX * (CLAIM_NFT_ROWS_MAX + 1), 7), e < rows; ++e) {
+        const uint8_t* row = table + e * CLAIM_NFT_ROW;
+        uint32_t row_taxon = be_load_u32(row + 20);
+        if (!equal_20(row, issuer)) continue;
+        if (row_taxon != CLAIM_NFT_TAXON_ANY && row_taxon != taxon) continue;
+
+        uint32_t mult = be_load_u16(row + 24);
+        return mult > 100 ? mult - 100 : 0;
+    }
+    return 0;
+}
+
+// Checks a claim at ledger time `now` and, when it is allowed, updates `state` to what
+// the hook writes after paying it. Returns CLAIM_OK or the reason the hook rolls back.
+static inline int claim_apply(uint8_t state[CLAIM_STATE_SIZE], const claim_rules* rules,
+                              uint64_t now, claim_outcome* out)
+{
+    uint64_t daily_claimed = 0;
+    if (rules->features & CLAIM_RULE_DAILY_CAP) {
+        // The daily counter only covers claims made on the day of the last claim
+        if (be_load_u64(state + 8) / CLAIM_SECONDS_PER_DAY != now / CLAIM_SECONDS_PER_DAY)
+            be_store_u64(state + 24, 0);
+        daily_claimed = be_load_u64(state + 24);
+    }
+
+    uint64_t accrued = be_load_u64(state);
+    uint32_t claim_count = be_load_u32(state + 16);
+
+    uint32_t boost = 100;
+    if (rules->features & CLAIM_RULE_BOOST) {
+        boost = be_load_u32(state + 20);
+        if (rules->boost) {
+            boost = rules->boost;
+            be_store_u32(state + 20, boost);
+        }
+        if (boost == 0) boost = 100;
+    }
+    out->boost = boost;
+
+    if (accrued < rules->min_claim) return CLAIM_BELOW_MINIMUM;
+
+    if (rules->cooldown > 0) {
+        uint64_t last_claim = be_load_u64(state + 8);
+        if (last_claim && now < last_claim + rules->cooldown) return CLAIM_COOLDOWN;
+    }
+
+    uint64_t payout = accrued;
+    if (rules->max_claim > 0 && payout > rules->max_claim) payout = rules->max_claim;
+
+    if ((rules->features & CLAIM_RULE_DAILY_CAP) && rules->daily_max > 0) {
+        uint64_t daily_remaining =
+            rules->daily_max > daily_claimed ? rules->daily_max - daily_claimed : 0;
+        if (payout > daily_remaining) payout = daily_remaining;
+    }
+
+    if (payout == 0) return CLAIM_DAILY_LIMIT;
+
+    // The boost multiplies the payout, not the accrued balance
+    out->payout = payout;
+    out->paid = (rules->features & CLAIM_RULE_BOOST) ? (payout * boost) / 100 : payout;
+
+    be_store_u64(state, accrued - payout);
+    be_store_u64(state + 8, now);
+    be_store_u32(state + 16, claim_count + 1);
+    if (rules->features & CLAIM_RULE_DAILY_CAP) be_store_u64(state + 24, daily_claimed + payout);
+    return CLAIM_OK;
+}
+
+#endif
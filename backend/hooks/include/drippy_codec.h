@@ -0,0 +1,92 @@
+// DRIPPY codec helpers for the top-level hook variants
+//
+// Straight-line replacements for the byte-at-a-time helper loops those hooks carried:
+//   be_load_u16/u32/u64, be_store_u32/u64 : big-endian integers (state values, parameters)
+//   equal_20 / equal_32                   : account id and key comparison
+//   copy_16 / copy_20 / copy_32, zero_32  : fixed-length copies
+//   PTR32, LIT_LEN, LIT                   : hook API pointers and string literal lengths
+//
+// Nothing here loops, so the helpers spend no guard budget and guard_checker has nothing
+// to bound. Fixed-size buffers are accessed a word at a time (wasm allows unaligned
+// loads and stores), the way BUFFER_EQUAL_20 in macro.h does.
+//
+// bench/codec_bench.c measures each helper against the loop it replaced (make bench).
+
+#ifndef DRIPPY_CODEC_H
+#define DRIPPY_CODEC_H
+
+#include <stdint.h>
+
+// Hook API pointer argument
+#define PTR32(p) ((uint32_t)(uintptr_t)(p))
+
+// Length of a string literal without the terminator; the "" rejects plain pointers
+#define LIT_LEN(s) (sizeof(s "") - 1)
+#define LIT(s) PTR32(s), LIT_LEN(s)
+
+typedef uint64_t codec_u64 __attribute__((aligned(1), may_alias));
+typedef uint32_t codec_u32 __attribute__((aligned(1), may_alias));
+
+static inline uint16_t be_load_u16(const uint8_t* b) {
+    return (uint16_t)(((uint16_t)b[0] << 8) | b[1]);
+}
+
+static inline uint32_t be_load_u32(const uint8_t* b) {
+    return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+}
+
+static inline uint64_t be_load_u64(const uint8_t* b) {
+    return ((uint64_t)be_load_u32(b) << 32) | be_load_u32(b + 4);
+}
+
+static inline void be_store_u32(uint8_t* b, uint32_t v) {
+    b[0] = (uint8_t)(v >> 24);
+    b[1] = (uint8_t)(v >> 16);
+    b[2] = (uint8_t)(v >> 8);
+    b[3] = (uint8_t)v;
+}
+
+static inline void be_store_u64(uint8_t* b, uint64_t v) {
+    be_store_u32(b, (uint32_t)(v >> 32));
+    be_store_u32(b + 4, (uint32_t)v);
+}
+
+static inline int equal_20(const void* a, const void* b) {
+    const codec_u64* x = (const codec_u64*)a;
+    const codec_u64* y = (const codec_u64*)b;
+    return ((x[0] ^ y[0]) | (x[1] ^ y[1]) |
+            (((const codec_u32*)a)[4] ^ ((const codec_u32*)b)[4])) == 0;
+}
+
+static inline int equal_32(const void* a, const void* b) {
+    const codec_u64* x = (const codec_u64*)a;
+    const codec_u64* y = (const codec_u64*)b;
+    return ((x[0] ^ y[0]) | (x[1] ^ y[1]) | (x[2] ^ y[2]) | (x[3] ^ y[3])) == 0;
+}
+
+static inline void copy_16(void* dst, const void* src) {
+    codec_u64* d = (codec_u64*)dst;
+    const codec_u64* s = (const codec_u64*)src;
+    d[0] = s[0];
+    d[1] = s[1];
+}
+
+static inline void copy_20(void* dst, const void* src) {
+    copy_16(dst, src);
+    ((codec_u32*)dst)[4] = ((const codec_u32*)src)[4];
+}
+
+static inline void copy_32(void* dst, const void* src) {
+    copy_16(dst, src);
+    copy_16((uint8_t*)dst + 16, (const uint8_t*)src + 16);
+}
+
+static inline void zero_32(void* dst) {
+    codec_u64* d = (codec_u64*)dst;
+    d[0] = 0;
+    d[1] = 0;
+    d[2] = 0;
+    d[3] = 0;
+}
+
+#endif
@@ -0,0 +1,98 @@
+// DRIPPY metrics rollup: hourly and daily buckets in hook state
+//
+// metrics_record() adds one operation to the bucket of the current hour and of the
+// current day. Buckets live in two fixed rings of state entries indexed by
+// ledger_last_time() / 3600 and / 86400, so the analytics backend reads the last N
+// hours or days with one account_namespace query (backend/src/hook-metrics.js)
+// instead of rebuilding them from transaction history.
+//
+//   key "DRIPPY:MET:H" / "DRIPPY:MET:D" + slot (u32 BE in bytes 28..32),
+//   slot = period % METRIC_HOURS / METRIC_DAYS
+//
+//   bucket (80 bytes)
+//     [0..4)   period (u32 BE, hours or days since the Ripple epoch)
+//     [4..8)   operations (u32 BE)
+//     [8..16)  volume in drops (u64 BE)
+//     [16..64) per-pool amounts in drops, 6 x u64 BE (order is up to the hook)
+//     [64..72) claims paid in drops (u64 BE)
+//     [72..76) claims (u32 BE)
+//     [76..80) reserved, zero
+//
+// A slot holding an older period is reset before it is reused, so stale buckets never
+// mix into the current one. Each record is two state() reads and two state_set()
+// calls. Build with make METRICS=0 (DRIPPY_NO_METRICS) to leave it out.
+
+#ifndef DRIPPY_METRICS_H
+#define DRIPPY_METRICS_H
+
+#include <stdint.h>
+#include "drippy_codec.h"
+
+#ifndef METRIC_HOURS
+#define METRIC_HOURS 48
+#endif
+
+#ifndef METRIC_DAYS
+#define METRIC_DAYS 30
+#endif
+
+#define METRIC_POOLS 6
+#define METRIC_BUCKET_SIZE 80
+
+#ifdef DRIPPY_NO_METRICS
+
+#define metrics_record(volume, pools, claimed, claims) ((void)(pools))
+
+#else
+
+static const uint8_t METRIC_HOUR_KEY[32] = "DRIPPY:MET:H";
+static const uint8_t METRIC_DAY_KEY[32] = "DRIPPY:MET:D";
+
+static inline void metric_add_u64(uint8_t* b, uint64_t v)
+{
+    be_store_u64(b, be_load_u64(b) + v);
+}
+
+static void metrics_bucket(const uint8_t* slot_key, uint32_t slots, uint32_t period,
+                           uint64_t volume, const uint64_t* pools, uint64_t claimed, uint32_t claims)
+{
+    uint8_t key[32];
+    uint8_t b[METRIC_BUCKET_SIZE];
+
+    copy_32(key, slot_key);
+    be_store_u32(key + 28, period % slots);
+
+    if (state(PTR32(b), sizeof(b), PTR32(key), 32) != METRIC_BUCKET_SIZE || be_load_u32(b) != period) {
+        zero_32(b);
+        zero_32(b + 32);
+        zero_32(b + 48);
+        be_store_u32(b, period);
+    }
+
+    be_store_u32(b + 4, be_load_u32(b + 4) + 1);
+    metric_add_u64(b + 8, volume);
+    if (pools) {
+        metric_add_u64(b + 16, pools[0]);
+        metric_add_u64(b + 24, pools[1]);
+        metric_add_u64(b + 32, pools[2]);
+        metric_add_u64(b + 40, pools[3]);
+        metric_add_u64(b + 48, pools[4]);
+        metric_add_u64(b + 56, pools[5]);
+    }
+    metric_add_u64(b + 64, claimed);
+    be_store_u32(b + 72, be_load_u32(b + 72) + claims);
+
+    state_set(PTR32(b), sizeof(b), PTR32(key), 32);
+}
+
+// pools: METRIC_POOLS amounts in drops, or 0 when the operation paid no pools
+static void metrics_record(uint64_t volume, const uint64_t* pools, uint64_t claimed, uint32_t claims)
+{
+    uint32_t now = (uint32_t)ledger_last_time();
+    metrics_bucket(METRIC_HOUR_KEY, METRIC_HOURS, now / 3600, volume, pools, claimed, claims);
+    metrics_bucket(METRIC_DAY_KEY, METRIC_DAYS, now / 86400, volume, pools, claimed, claims);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,65 @@
+// DRIPPY record ring in hook state
+//
+// A fixed number of state entries written round-robin plus a head entry holding the
+// next sequence number. The event ring (drippy_trace.h) and the change log
+// (drippy_changes.h) share the format, so one off-ledger decoder reads both.
+//
+//   head key <prefix>"HEAD"                  12 bytes
+//     [0..8)   next sequence number (u64 BE)
+//     [8..12)  slot count (u32 BE)
+//
+//   slot key <prefix> + slot (u32 BE in bytes 28..32), slot = seq % slot count
+//     [0..8)   sequence number (u64 BE)
+//     [8..12)  ledger sequence (u32 BE)
+//     [12]     operation
+//     [13]     result
+//     [14..16) reserved, zero
+//     [16..36) account
+//     [36..44) value (u64 BE)
+//     [44..48) aux (u32 BE)
+//
+// A reader with cursor N reads the head, then slots N .. next-1; a slot whose stored
+// sequence differs from the one expected was overwritten before it was read.
+// Each append is one state() read and two state_set() calls, with no loops.
+
+#ifndef DRIPPY_RING_H
+#define DRIPPY_RING_H
+
+#include <stdint.h>
+#include "drippy_codec.h"
+
+#define RING_RECORD_SIZE 48
+#define RING_HEAD_SIZE 12
+
+static void ring_append(const uint8_t* head_key, const uint8_t* slot_key, uint32_t slots,
+                        uint8_t op, uint8_t result, const uint8_t* account,
+                        uint64_t value, uint32_t aux)
+{
+    uint8_t head[RING_HEAD_SIZE];
+    uint8_t record[RING_RECORD_SIZE];
+    uint8_t key[32];
+
+    uint64_t seq = 0;
+    if (state(PTR32(head), sizeof(head), PTR32(head_key), 32) == RING_HEAD_SIZE)
+        seq = be_load_u64(head);
+
+    be_store_u64(record, seq);
+    be_store_u32(record + 8, (uint32_t)ledger_seq());
+    record[12] = op;
+    record[13] = result;
+    record[14] = 0;
+    record[15] = 0;
+    copy_20(record + 16, account);
+    be_store_u64(record + 36, value);
+    be_store_u32(record + 44, aux);
+
+    copy_32(key, slot_key);
+    be_store_u32(key + 28, (uint32_t)(seq % slots));
+    state_set(PTR32(record), sizeof(record), PTR32(key), 32);
+
+    be_store_u64(head, seq + 1);
+    be_store_u32(head + 8, slots);
+    state_set(PTR32(head), sizeof(head), PTR32(head_key), 32);
+}
+
+#endif
@@ -0,0 +1,59 @@
+// DRIPPY trace telemetry: compiled-out traces and a binary event ring in hook state
+//
+// Traces: TRACEVAR/TRACESTR/TRACEXFL/TRACEHEX from macro.h test DEBUG, which is only
+// cleared by NDEBUG. Including this header after hookapi.h forces DEBUG to 0 unless
+// DRIPPY_TRACE is defined, so every trace compiles away whatever the toolchain passes.
+// Build with make TRACE=1 to keep them.
+//
+// Event ring: event_record() appends one record per operation to a ring of
+// EVENT_RING_SLOTS state entries (include/drippy_ring.h) under "DRIPPY:EVT:". Off-ledger
+// readers keep a cursor and fetch only the records written since
+// (backend/src/hook-events.js). Record fields:
+//   op      EVT_OP_*
+//   result  EVT_OK, EVT_SKIPPED or a hook-specific code
+//   account the account the operation was for
+//   amount  drops unless the operation says otherwise
+//   aux     operation specific
+//
+// State written by a hook that rolls back is discarded, so the ring holds accepted
+// operations only. Build with make EVENTS=0 (DRIPPY_NO_EVENTS) to drop it entirely.
+
+#ifndef DRIPPY_TRACE_H
+#define DRIPPY_TRACE_H
+
+#include "drippy_ring.h"
+
+#ifndef DRIPPY_TRACE
+#undef DEBUG
+#define DEBUG 0
+#endif
+
+#ifndef EVENT_RING_SLOTS
+#define EVENT_RING_SLOTS 64
+#endif
+
+// Operations
+#define EVT_OP_ROUTE   1   // fee routed to the pools; aux = payments emitted
+#define EVT_OP_CLAIM   2   // rewards paid to account
+#define EVT_OP_ACCRUE  3   // rewards credited to account
+#define EVT_OP_FEE     4   // utility hook fee taken on a swap; amount is XFL
+
+// Results
+#define EVT_OK         0
+#define EVT_SKIPPED    1
+
+#ifdef DRIPPY_NO_EVENTS
+
+#define event_record(op, result, account, amount, aux) ((void)0)
+
+#else
+
+static const uint8_t EVENT_HEAD_KEY[32] = "DRIPPY:EVT:HEAD";
+static const uint8_t EVENT_SLOT_KEY[32] = "DRIPPY:EVT:";
+
+#define event_record(op, result, account, amount, aux) \
+    ring_append(EVENT_HEAD_KEY, EVENT_SLOT_KEY, EVENT_RING_SLOTS, (op), (result), (account), (amount), (aux))
+
+#endif
+
+#endif
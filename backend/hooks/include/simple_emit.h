@@ -0,0 +1,163 @@
+// DRIPPY hook helpers shared by the hooks in src/
+//
+// Builds on the Hooks API headers (hookapi.h must be included first):
+//   PREPARE_PAYMENT_SIMPLE_DROPS / _ISSUED : write an emittable Payment into a caller buffer
+//   PREPARE_PAYMENT_SIMPLE_TL              : the same for an already serialized issued amount
+//   otxn_field_slot                        : slot a field of the originating transaction
+//   unhexlify                              : decode ASCII hex memo data into bytes
+//   memcpy / memset / strlen               : guarded freestanding versions (hooks link without libc)
+//
+// Every loop is guarded. Guard limits count iterations across the whole hook execution,
+// so the string helpers share one budget sized for the key building done by the hooks.
+
+#ifndef DRIPPY_SIMPLE_EMIT_H
+#define DRIPPY_SIMPLE_EMIT_H
+
+#include "drippy_codec.h"
+
+#define SIMPLE_MEM_GUARD 2048
+#define SIMPLE_HEX_GUARD 64
+
+// Issued-currency Payment: 172 bytes of fields, then EmitDetails (116 bytes, 138 with the
+// callback account). PREPARE_PAYMENT_SIMPLE_TRUSTLINE_SIZE in macro.h is one byte short.
+#define SIMPLE_TL_FIELDS_SIZE 172
+#ifdef HAS_CALLBACK
+#define SIMPLE_DETAILS_SIZE 138
+#else
+#define SIMPLE_DETAILS_SIZE 116
+#endif
+#define SIMPLE_TL_PAYMENT_SIZE (SIMPLE_TL_FIELDS_SIZE + SIMPLE_DETAILS_SIZE)
+
+static void* simple_memcpy(void* dst, const void* src, uint32_t n) {
+    uint8_t* d = (uint8_t*)dst;
+    const uint8_t* s = (const uint8_t*)src;
+    for (uint32_t i = 0; GUARD(SIMPLE_MEM_GUARD), i < n; ++i)
+        d[i] = s[i];
+    return dst;
+}
+
+static void* simple_memset(void* dst, int c, uint32_t n) {
+    uint8_t* d = (uint8_t*)dst;
+    for (uint32_t i = 0; GUARD(SIMPLE_MEM_GUARD), i < n; ++i)
+        d[i] = (uint8_t)c;
+    return dst;
+}
+
+static uint32_t simple_strlen(const char* s) {
+    uint32_t n = 0;
+    while (GUARD(SIMPLE_MEM_GUARD), s[n])
+        ++n;
+    return n;
+}
+
+#define memcpy(dst, src, n) simple_memcpy((dst), (src), (uint32_t)(n))
+#define memset(dst, c, n) simple_memset((dst), (c), (uint32_t)(n))
+#define strlen(s) simple_strlen((const char*)(s))
+
+// Payment of native drops; returns bytes written
+static int64_t PREPARE_PAYMENT_SIMPLE_DROPS(uint8_t* buf, int64_t maxlen, uint32_t dest_tag,
+                                            const uint8_t* to, uint64_t drops) {
+    if (maxlen < PREPARE_PAYMENT_SIMPLE_SIZE) return rollback(SBUF("emit buffer too small"), 1);
+    PREPARE_PAYMENT_SIMPLE(buf, drops, to, dest_tag, 0);
+    return PREPARE_PAYMENT_SIMPLE_SIZE;
+}
+
+// Payment of a 48-byte serialized issued amount (float_sto output); returns bytes written.
+// The fields are those of PREPARE_PAYMENT_SIMPLE_TRUSTLINE, but the amount is copied
+// straight-line: ENCODE_TL copies it in a GUARDM loop whose budget is shared by every
+// payment the hook builds, so a second emit from the same call site overran it.
+static int64_t PREPARE_PAYMENT_SIMPLE_TL(uint8_t* buf, int64_t maxlen, uint32_t dest_tag,
+                                         const uint8_t* to, const uint8_t* tlamt) {
+    if (maxlen < SIMPLE_TL_PAYMENT_SIZE) return rollback(SBUF("emit buffer too small"), 1);
+
+    uint8_t* buf_out = buf;
+    uint8_t acc[20];
+    uint32_t cls = (uint32_t)ledger_seq();
+    hook_account(SBUF(acc));
+    _01_02_ENCODE_TT                   (buf_out, ttPAYMENT);
+    _02_02_ENCODE_FLAGS                (buf_out, tfCANONICAL);
+    _02_03_ENCODE_TAG_SRC              (buf_out, 0);
+    _02_04_ENCODE_SEQUENCE             (buf_out, 0);
+    _02_14_ENCODE_TAG_DST              (buf_out, dest_tag);
+    _02_26_ENCODE_FLS                  (buf_out, cls + 1);
+    _02_27_ENCODE_LLS                  (buf_out, cls + 5);
+    buf_out[0] = 0x60U + amAMOUNT;
+    copy_32(buf_out + 1, tlamt);
+    copy_16(buf_out + 33, tlamt + 32);
+    buf_out += 49;
+    uint8_t* fee_ptr = buf_out;
+    _06_08_ENCODE_DROPS_FEE            (buf_out, 0);
+    _07_03_ENCODE_SIGNING_PUBKEY_NULL  (buf_out);
+    _08_01_ENCODE_ACCOUNT_SRC          (buf_out, acc);
+    _08_03_ENCODE_ACCOUNT_DST          (buf_out, to);
+    if (etxn_details((uint32_t)buf_out, SIMPLE_DETAILS_SIZE) != SIMPLE_DETAILS_SIZE)
+        return rollback(SBUF("emit details failed"), 1);
+    int64_t fee = etxn_fee_base((uint32_t)buf, SIMPLE_TL_PAYMENT_SIZE);
+    _06_08_ENCODE_DROPS_FEE            (fee_ptr, fee);
+    return SIMPLE_TL_PAYMENT_SIZE;
+}
+
+// Payment of an issued currency; amount is in millionths (6 decimals, the drops scale)
+static int64_t PREPARE_PAYMENT_SIMPLE_ISSUED(uint8_t* buf, int64_t maxlen, uint32_t dest_tag,
+                                             const uint8_t* to, const uint8_t* cur20,
+                                             const uint8_t* issuer20, uint64_t amount) {
+    uint8_t tlamt[48];
+    int64_t xfl = float_set(-6, (int64_t)amount);
+    if (xfl < 0 || float_sto(SBUF(tlamt), cur20, 20, issuer20, 20, xfl, 0) != 48)
+        return rollback(SBUF("amount encoding failed"), 1);
+
+    return PREPARE_PAYMENT_SIMPLE_TL(buf, maxlen, dest_tag, to, tlamt);
+}
+
+#ifndef tfPartialPayment
+#define tfPartialPayment 0x00020000UL
+#endif
+
+// 1 when the originating Payment is a partial payment. Its Amount is only the most it
+// may deliver; what it did deliver (DeliveredAmount) is in the metadata, which a hook
+// cannot read, so no fee or split may be computed from it.
+static int otxn_partial_payment(void) {
+    uint8_t flags[4];
+    if (otxn_field(SBUF(flags), sfFlags) != 4) return 0;
+    return (UINT32_FROM_BUF(flags) & tfPartialPayment) != 0;
+}
+
+// Slot a field of the originating transaction; DOESNT_EXIST when absent
+static int64_t otxn_field_slot(uint32_t field_id, uint32_t new_slot) {
+    static int64_t otxn_slot_no = 0;
+    if (otxn_slot_no <= 0) {
+        otxn_slot_no = otxn_slot(0);
+        if (otxn_slot_no < 0) return DOESNT_EXIST;
+    }
+
+    int64_t field_slot = slot_subfield(otxn_slot_no, field_id, new_slot);
+    return field_slot < 0 ? DOESNT_EXIST : field_slot;
+}
+
+// Decode ASCII hex into out; returns bytes written or INVALID_ARGUMENT
+static int64_t unhexlify(uint8_t* out, int64_t outlen, const uint8_t* hex, int64_t hexlen) {
+    if (hexlen < 0 || hexlen > SIMPLE_HEX_GUARD || (hexlen + 1) / 2 > outlen) return INVALID_ARGUMENT;
+
+    // An odd length is read as if left-padded with '0'
+    int64_t written = 0;
+    int nibble_hi = (hexlen & 1) == 0;
+    uint8_t acc = 0;
+    for (int64_t i = 0; GUARD(SIMPLE_HEX_GUARD), i < hexlen; ++i) {
+        uint8_t c = hex[i];
+        uint8_t v;
+        if (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+        else return INVALID_ARGUMENT;
+
+        if (nibble_hi) {
+            acc = (uint8_t)(v << 4);
+        } else {
+            out[written++] = acc | v;
+        }
+        nibble_hi = !nibble_hi;
+    }
+    return written;
+}
+
+#endif
@@ -0,0 +1,87 @@
+#!/usr/bin/env node
+
+// Edit the anti-sniping whitelist held in hook state by the fee router and utility hooks.
+// The hook ADMIN sends a 1-drop Payment to the hook account with a WLADD / WLDEL memo whose
+// data is up to 8 concatenated 20-byte account ids.
+//
+// Usage: node manage-whitelist.js <add|del> <hookAccount> <rAddress> [rAddress ...]
+
+const xrpl = require('xrpl');
+const { decodeAccounts } = require('../native');
+require('dotenv').config();
+
+const MAX_PER_MEMO = 8;
+
+function toHex(buf) {
+    return Buffer.from(buf).toString('hex').toUpperCase();
+}
+
+async function updateWhitelist(action, hookAccount, accounts) {
+    const adminSeed = process.env.HOOK_ADMIN_SEED;
+    const xahauWss = process.env.XAHAU_WSS || 'wss://hooks-testnet-v3.xrpl-labs.com';
+
+    if (!adminSeed) {
+        throw new Error('Required environment variable missing: HOOK_ADMIN_SEED');
+    }
+
+    const memoType = action === 'add' ? 'WLADD' : 'WLDEL';
+    const packed = decodeAccounts(accounts);
+    const ids = accounts.map((_, i) => packed.subarray(20 * i, 20 * i + 20));
+
+    const client = new xrpl.Client(xahauWss);
+    await client.connect();
+
+    try {
+        const adminWallet = xrpl.Wallet.fromSeed(adminSeed);
+
+        for (let i = 0; i < ids.length; i += MAX_PER_MEMO) {
+            const batch = ids.slice(i, i + MAX_PER_MEMO);
+            const tx = {
+                TransactionType: 'Payment',
+                Account: adminWallet.classicAddress,
+                Destination: hookAccount,
+                Amount: '1',
+                Memos: [{
+                    Memo: {
+                        MemoType: toHex(Buffer.from(memoType, 'utf8')),
+                        MemoData: toHex(Buffer.concat(batch))
+                    }
+                }]
+            };
+
+            const prepared = await client.autofill(tx);
+            const signed = adminWallet.sign(prepared);
+            const result = await client.submitAndWait(signed.tx_blob);
+            const code = result.result.meta?.TransactionResult;
+
+            console.log(`${memoType} ${batch.length} account(s): ${code} (${result.result.hash})`);
+            if (code !== 'tesSUCCESS') {
+                throw new Error(`Whitelist update failed: ${code}`);
+            }
+        }
+    } finally {
+        await client.disconnect();
+    }
+}
+
+async function main() {
+    const [action, hookAccount, ...accounts] = process.argv.slice(2);
+
+    if (!['add', 'del'].includes(action) || !hookAccount || accounts.length === 0) {
+        console.log('Usage: node manage-whitelist.js <add|del> <hookAccount> <rAddress> [rAddress ...]');
+        process.exit(1);
+    }
+
+    try {
+        await updateWhitelist(action, hookAccount, accounts);
+    } catch (error) {
+        console.error('Whitelist update failed:', error.message);
+        process.exit(1);
+    }
+}
+
+if (require.main === module) {
+    main();
+}
+
+module.exports = { updateWhitelist };
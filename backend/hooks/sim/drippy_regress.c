@@ -0,0 +1,592 @@
+// DRIPPY regression checks: the utility hook, fee router and enhanced claim hook on the
+// emulator (see hookemu.h), in the situations their past bugs showed up in
+//
+//   iou-routing      an IOU fee to the router becomes one payment per pool, all applied
+//   whitelist-batch  WLADD / WLDEL memos of 8 accounts, the most one memo holds, in the
+//                    utility hook and the router
+//   nft-unmatched    a claim listing 8 URITokens that no row of a full NFT_TBL matches;
+//                    a matching token and a token not on the ledger as controls
+//   emit-sizes       every payment the hooks emit has room for the callback EmitDetails
+//   self-payment     the router's own pool payments reach it again and are not re-routed
+//   partial-payment  partial payments are refused by the utility hook and left unrouted
+//                    by the router
+//   bucket-slots     the anti-snipe token buckets of both hooks stay within their slots
+//
+// Every check starts from a fresh ledger. Prints one line per check and exits 1 when
+// any fails.
+//
+// Build and run from backend/hooks: make test
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hookemu.h"
+
+// Hook objects are renamed by the Makefile: hook -> sim_<name>_hook, .data -> sim_<name>_data
+#define SIM_HOOK(name, arg_t) \
+    int64_t sim_##name##_hook(arg_t reserved); \
+    extern uint8_t __start_sim_##name##_data[] __attribute__((weak)); \
+    extern uint8_t __stop_sim_##name##_data[] __attribute__((weak)); \
+    static int64_t name##_entry(void) { return sim_##name##_hook(0); }
+
+SIM_HOOK(utility, uint32_t)
+SIM_HOOK(router, int64_t)
+SIM_HOOK(claim, int64_t)
+
+#define SIM_HOOK_ENTRY(name) { #name, name##_entry, __start_sim_##name##_data, __stop_sim_##name##_data, 0 }
+
+typedef struct {
+    const char* name;
+    emu_entry entry;
+    uint8_t* data_start;
+    uint8_t* data_end;
+    uint8_t* pristine;        // the data section before any run, restored for every check
+} sim_hook;
+
+static sim_hook sim_hooks[] = {
+    SIM_HOOK_ENTRY(utility),
+    SIM_HOOK_ENTRY(router),
+    SIM_HOOK_ENTRY(claim),
+};
+
+#define SIM_HOOK_COUNT (sizeof(sim_hooks) / sizeof(sim_hooks[0]))
+
+#define DROPS_PER_XRP 1000000LL
+#define REGRESS_START_TIME 789004800U   // 2025-01-01T00:00:00Z, seconds since the Ripple epoch
+
+// Emitted Payments with the callback account in EmitDetails (138 bytes): 132 bytes of
+// fields for drops, 172 for an issued amount
+#define DROPS_PAYMENT_SIZE 270
+#define IOU_PAYMENT_SIZE 310
+
+#define WL_BATCH 8
+#define NFT_ROWS 8
+#define NFT_ROW 26
+#define NFT_IDS 8
+#define SNIPERS 200
+#define SNIPE_SLOTS 64   // token buckets each hook keeps at most
+
+// ---- Ledger participants -----------------------------------------------------------
+
+static uint8_t issuer[20], treasury[20], admin[20];
+static uint8_t pools[4][20];   // NFT, HOLD, TREA, AMM: the router's order
+static uint8_t traders[WL_BATCH][20];
+static uint8_t currency[20] = { 'D', 'R', 'I', 'P', 'P', 'Y' };
+
+static const char* POOL_NAMES[4] = { "nft", "hold", "trea", "amm" };
+
+static emu_hook *utility, *router, *claim;
+
+static void make_id(uint8_t out[20], const char* tag, uint32_t n)
+{
+    char s[64];
+    uint8_t hash[32];
+    int len = snprintf(s, sizeof(s), "drippy-regress:%s:%u", tag, n);
+    emu_sha512h(hash, (const uint8_t*)s, (uint32_t)len);
+    memcpy(out, hash, 20);
+}
+
+static void hex(char* out, const uint8_t* data, uint32_t len)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    for (uint32_t i = 0; i < len; i++) {
+        out[i * 2] = digits[data[i] >> 4];
+        out[i * 2 + 1] = digits[data[i] & 0xF];
+    }
+    out[len * 2] = 0;
+}
+
+static void be64(uint8_t out[8], uint64_t v)
+{
+    for (int i = 0; i < 8; i++)
+        out[i] = (uint8_t)(v >> (56 - 8 * i));
+}
+
+static void be32(uint8_t out[4], uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        out[i] = (uint8_t)(v >> (24 - 8 * i));
+}
+
+static emu_hook* install(const char* name, const uint8_t account[20])
+{
+    for (size_t i = 0; i < SIM_HOOK_COUNT; i++) {
+        if (strcmp(sim_hooks[i].name, name) != 0)
+            continue;
+        emu_hook* h = emu_hook_install(sim_hooks[i].name, account, sim_hooks[i].entry,
+                                       sim_hooks[i].data_start, sim_hooks[i].data_end);
+        // Every hook exports cbak, so a node adds the callback account to EmitDetails
+        h->has_callback = 1;
+        return h;
+    }
+    abort();
+}
+
+// A ledger with the three hooks installed the way drippy_sim installs them
+static void fresh_ledger(void)
+{
+    emu_free();
+    emu_config config = {
+        .base_fee = 10,
+        .hook_fee = 10,
+        .ledger_seq = 1000,
+        .close_time = REGRESS_START_TIME,
+        .ledger_interval = 4,
+    };
+    emu_init(&config);
+    for (size_t i = 0; i < SIM_HOOK_COUNT; i++)
+        memcpy(sim_hooks[i].data_start, sim_hooks[i].pristine,
+               (size_t)(sim_hooks[i].data_end - sim_hooks[i].data_start));
+
+    emu_account_add(issuer, 1000 * DROPS_PER_XRP);
+    emu_account_add(treasury, 1000 * DROPS_PER_XRP);
+    emu_account_add(admin, 1000 * DROPS_PER_XRP);
+    for (int i = 0; i < 4; i++)
+        emu_account_add(pools[i], 1000 * DROPS_PER_XRP);
+    for (int i = 0; i < WL_BATCH; i++)
+        emu_account_add(traders[i], 1000 * DROPS_PER_XRP);
+
+    uint8_t flush[8];
+    be64(flush, (uint64_t)emu_xfl_from_units(1));
+    utility = install("utility", issuer);
+    emu_hook_param(utility, "ADMIN", admin, 20);
+    emu_hook_param(utility, "CUR", currency, 20);
+    emu_hook_param(utility, "TREASURY", treasury, 20);
+    emu_hook_param(utility, "FEE_FLUSH", flush, 8);
+
+    uint8_t whitelist[40];
+    memcpy(whitelist, currency, 20);
+    memcpy(whitelist + 20, issuer, 20);
+    router = install("router", treasury);
+    emu_hook_param(router, "ADMIN", admin, 20);
+    emu_hook_param(router, "NFT_POOL", pools[0], 20);
+    emu_hook_param(router, "HOLD_POOL", pools[1], 20);
+    emu_hook_param(router, "TREA_POOL", pools[2], 20);
+    emu_hook_param(router, "AMM_POOL", pools[3], 20);
+    emu_hook_param(router, "IOU_WL", whitelist, 40);
+
+    claim = install("claim", pools[1]);
+    emu_hook_param(claim, "ADMIN", admin, 20);
+}
+
+// ---- What the ledger did -----------------------------------------------------------
+
+typedef struct {
+    uint32_t applied;          // emitted transactions applied
+    uint32_t failed;           // emitted transactions not applied
+    uint32_t sizes[2];         // emissions of DROPS_PAYMENT_SIZE / IOU_PAYMENT_SIZE bytes
+    uint32_t odd_size;         // emissions of any other length
+    uint32_t odd_len;          // the last such length
+    uint32_t router_own;       // router runs on payments the treasury itself sent
+    uint32_t router_own_emits; // transactions those runs emitted
+} ledger_log;
+
+static ledger_log seen;
+
+static void observe(const uint8_t* blob, uint32_t len, int emitted, void* arg)
+{
+    (void)blob; (void)len; (void)arg;
+    const emu_report* r = emu_last_report();
+    if (emitted) {
+        if (r->result == EMU_SUCCESS)
+            seen.applied++;
+        else
+            seen.failed++;
+    }
+    if (r->from && memcmp(r->from->id, treasury, 20) == 0) {
+        for (uint32_t i = 0; i < r->run_count; i++) {
+            if (r->runs[i].hook != router)
+                continue;
+            seen.router_own++;
+            seen.router_own_emits += r->runs[i].emitted;
+        }
+    }
+    for (uint32_t i = 0; i < r->emit_count; i++) {
+        uint32_t n;
+        emu_report_emit(i, &n);
+        if (n == DROPS_PAYMENT_SIZE)
+            seen.sizes[0]++;
+        else if (n == IOU_PAYMENT_SIZE)
+            seen.sizes[1]++;
+        else {
+            seen.odd_size++;
+            seen.odd_len = n;
+        }
+    }
+}
+
+// Closes the open ledger and applies what it emitted in the next, `count` times
+static void next_ledgers(int count)
+{
+    for (int i = 0; i < count; i++) {
+        emu_ledger_close();
+        emu_ledger_begin();
+    }
+}
+
+static const emu_run_report* run_of(const emu_hook* h)
+{
+    const emu_report* r = emu_last_report();
+    for (uint32_t i = 0; i < r->run_count; i++) {
+        if (r->runs[i].hook == h)
+            return &r->runs[i];
+    }
+    return 0;
+}
+
+// ---- Transactions ------------------------------------------------------------------
+
+static int submit_drops_flags(const uint8_t* from, const uint8_t* to, uint64_t drops, uint32_t flags,
+                              const emu_memo* memos, uint32_t memo_count)
+{
+    uint8_t blob[EMU_TXN_MAX], amount[8];
+    emu_amount_drops(amount, drops);
+    uint32_t len = emu_payment_flags(blob, from, to, amount, 8, flags, memos, memo_count);
+    return emu_submit(blob, len);
+}
+
+static int submit_drops(const uint8_t* from, const uint8_t* to, uint64_t drops,
+                        const emu_memo* memos, uint32_t memo_count)
+{
+    return submit_drops_flags(from, to, drops, 0, memos, memo_count);
+}
+
+static int submit_drippy_flags(const uint8_t* from, const uint8_t* to, double units, uint32_t flags)
+{
+    uint8_t blob[EMU_TXN_MAX], amount[48];
+    emu_amount_iou(amount, emu_xfl_from_units(units), currency, issuer);
+    uint32_t len = emu_payment_flags(blob, from, to, amount, 48, flags, 0, 0);
+    return emu_submit(blob, len);
+}
+
+static int submit_drippy(const uint8_t* from, const uint8_t* to, double units)
+{
+    return submit_drippy_flags(from, to, units, 0);
+}
+
+static int submit_accrual(const uint8_t* holder, uint64_t drops)
+{
+    char account_hex[41], value_hex[17];
+    hex(account_hex, holder, 20);
+    snprintf(value_hex, sizeof(value_hex), "%llX", (unsigned long long)drops);
+    emu_memo memos[2] = {
+        { "ACC_A", (const uint8_t*)account_hex, 40 },
+        { "ACC_V", (const uint8_t*)value_hex, (uint32_t)strlen(value_hex) },
+    };
+    return submit_drops(admin, pools[1], 1, memos, 2);
+}
+
+static int submit_nft_claim(const uint8_t* holder, const uint8_t* ids, uint32_t count)
+{
+    emu_memo memos[2] = {
+        { "CLAIM", 0, 0 },
+        { "NFTS", ids, count * 32 },
+    };
+    return submit_drops(holder, pools[1], 1, memos, 2);
+}
+
+// ---- Checks ------------------------------------------------------------------------
+
+static int failures;
+static int check_failed;
+
+static void expect(int ok, const char* fmt, ...)
+{
+    if (ok)
+        return;
+    va_list ap;
+    va_start(ap, fmt);
+    printf("       ");
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+    check_failed = 1;
+}
+
+static void expect_run(const emu_hook* h, int result, const char* message, uint32_t emitted)
+{
+    const emu_run_report* run = run_of(h);
+    const emu_report* r = emu_last_report();
+    expect(result == r->result, "%s: transaction result %d, expected %d", h->name, r->result, result);
+    if (!run) {
+        expect(0, "%s did not run", h->name);
+        return;
+    }
+    expect(run->accepted == (result == EMU_SUCCESS), "%s %s: \"%s\"", h->name,
+           run->accepted ? "accepted" : "rolled back", run->message);
+    if (message)
+        expect(strcmp(run->message, message) == 0, "%s: \"%s\", expected \"%s\"", h->name,
+               run->message, message);
+    expect(run->emitted == emitted, "%s emitted %u, expected %u", h->name, run->emitted, emitted);
+}
+
+static void check_iou_routing(void)
+{
+    submit_drippy(traders[0], treasury, 1000);
+    expect_run(router, EMU_SUCCESS, "iou fees routed", 4);
+
+    next_ledgers(1);
+    expect(seen.applied == 4 && seen.failed == 0, "%u pool payments applied, %u not, expected 4",
+           seen.applied, seen.failed);
+
+    double total = 0;
+    for (int i = 0; i < 4; i++) {
+        double units = emu_account_find(pools[i])->iou;
+        expect(units > 0, "%s pool received no DRIPPY", POOL_NAMES[i]);
+        total += units;
+    }
+    expect(fabs(total - 1000) < 1e-6, "pools received %.6f DRIPPY of 1000", total);
+}
+
+static void check_whitelist_batch(void)
+{
+    const struct { emu_hook* hook; const uint8_t* account; const char* accepted; } targets[2] = {
+        { utility, issuer, "DRIPPY Utility: Whitelist updated" },
+        { router, treasury, "whitelist updated" },
+    };
+    uint8_t ids[WL_BATCH * 20];
+    for (int i = 0; i < WL_BATCH; i++)
+        memcpy(ids + i * 20, traders[i], 20);
+
+    for (int t = 0; t < 2; t++) {
+        emu_hook* h = targets[t].hook;
+        for (int op = 0; op < 2; op++) {
+            emu_memo memo = { op == 0 ? "WLADD" : "WLDEL", ids, sizeof(ids) };
+            submit_drops(admin, targets[t].account, 1, &memo, 1);
+            expect_run(h, EMU_SUCCESS, targets[t].accepted, 0);
+
+            uint32_t listed = 0;
+            for (int i = 0; i < WL_BATCH; i++) {
+                uint8_t key[32] = "DRIPPY:WL:v1", value[EMU_STATE_MAX];
+                uint32_t len;
+                memcpy(key + 12, traders[i], 20);
+                listed += emu_hook_state(h, key, value, &len);
+            }
+            uint32_t want = op == 0 ? WL_BATCH : 0;
+            expect(listed == want, "%s: %u accounts whitelisted after %s, expected %u", h->name,
+                   listed, memo.type, want);
+        }
+    }
+}
+
+static void check_nft_unmatched(void)
+{
+    // A full table: 8 rows, any taxon, 1.5x each
+    uint8_t table[NFT_ROWS * NFT_ROW];
+    uint8_t row_issuers[NFT_ROWS][20];
+    for (int r = 0; r < NFT_ROWS; r++) {
+        uint8_t* row = table + r * NFT_ROW;
+        make_id(row_issuers[r], "nft-issuer", (uint32_t)r);
+        memcpy(row, row_issuers[r], 20);
+        be32(row + 20, 0xFFFFFFFFU);
+        row[24] = 0;
+        row[25] = 150;
+    }
+    emu_hook_param(claim, "NFT_TBL", table, sizeof(table));
+
+    // Holder 0 owns 8 tokens from issuers no row names, holder 1 one from a row issuer
+    uint8_t unmatched[NFT_IDS * 32], matched[32], missing[32];
+    for (int i = 0; i < NFT_IDS; i++) {
+        uint8_t token[EMU_OBJECT_MAX], stranger[20], digest[32] = { 0 };
+        char tag[32];
+        uint32_t n = (uint32_t)snprintf(tag, sizeof(tag), "drippy-regress:token:%d", i);
+        emu_sha512h(unmatched + i * 32, (const uint8_t*)tag, n);
+        make_id(stranger, "stranger", (uint32_t)i);
+        emu_object_set(unmatched + i * 32, token, emu_uri_token(token, traders[0], stranger, digest));
+    }
+    {
+        uint8_t token[EMU_OBJECT_MAX], digest[32] = { 0 };
+        emu_sha512h(matched, (const uint8_t*)"drippy-regress:token:matched", 28);
+        emu_object_set(matched, token, emu_uri_token(token, traders[1], row_issuers[3], digest));
+        emu_sha512h(missing, (const uint8_t*)"drippy-regress:token:missing", 28);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        submit_accrual(traders[i], 5 * DROPS_PER_XRP);
+        expect_run(claim, EMU_SUCCESS, 0, 0);
+    }
+
+    const struct { const uint8_t* ids; uint32_t count; int result; uint32_t boost; } claims[3] = {
+        { unmatched, NFT_IDS, EMU_SUCCESS, 100 },
+        { matched, 1, EMU_SUCCESS, 150 },
+        { missing, 1, EMU_REJECTED, 0 },
+    };
+    for (int i = 0; i < 3; i++) {
+        submit_nft_claim(traders[i], claims[i].ids, claims[i].count);
+        expect_run(claim, claims[i].result, claims[i].result == EMU_SUCCESS ? 0 : "nft not owned",
+                   claims[i].result == EMU_SUCCESS);
+        if (claims[i].result != EMU_SUCCESS)
+            continue;
+
+        uint8_t key[32] = "DRIPPY:CLAIM", state[EMU_STATE_MAX];
+        uint32_t len = 0;
+        memcpy(key + 12, traders[i], 20);
+        uint32_t boost = 0;
+        if (emu_hook_state(claim, key, state, &len) && len == 32)
+            boost = (uint32_t)state[20] << 24 | (uint32_t)state[21] << 16 | (uint32_t)state[22] << 8 | state[23];
+        expect(boost == claims[i].boost, "claim with %u tokens: boost %u, expected %u",
+               claims[i].count, boost, claims[i].boost);
+    }
+}
+
+static void check_emit_sizes(void)
+{
+    // Every emitting path: the utility fee flush (IOU), native and IOU routing, a claim
+    submit_drippy(traders[0], issuer, 10000);
+    expect_run(utility, EMU_SUCCESS, 0, 1);
+    submit_drops(traders[1], treasury, 10 * DROPS_PER_XRP, 0, 0);
+    expect_run(router, EMU_SUCCESS, "fees routed", 4);
+    submit_drippy(traders[2], treasury, 1000);
+    expect_run(router, EMU_SUCCESS, "iou fees routed", 4);
+    submit_accrual(traders[3], 5 * DROPS_PER_XRP);
+    emu_memo memo = { "CLAIM", 0, 0 };
+    submit_drops(traders[3], pools[1], 1, &memo, 1);
+    expect_run(claim, EMU_SUCCESS, 0, 1);
+
+    // The flush reaches the router next ledger, and its pool payments the one after
+    next_ledgers(3);
+
+    expect(seen.odd_size == 0, "%u emissions of %u bytes, expected %u or %u", seen.odd_size,
+           seen.odd_len, DROPS_PAYMENT_SIZE, IOU_PAYMENT_SIZE);
+    expect(seen.sizes[0] == 5, "%u native payments emitted, expected 5 (router 4, claim 1)", seen.sizes[0]);
+    expect(seen.sizes[1] == 9, "%u IOU payments emitted, expected 9 (flush 1, router 2 x 4)", seen.sizes[1]);
+    expect(seen.failed == 0, "%u emitted transactions not applied", seen.failed);
+    const emu_hook* hooks[3] = { utility, router, claim };
+    for (int i = 0; i < 3; i++)
+        expect(hooks[i]->details_short == 0, "%s: EmitDetails overran the emit buffer by %u bytes on %llu emits",
+               hooks[i]->name, hooks[i]->details_short_bytes, (unsigned long long)hooks[i]->details_short);
+}
+
+static void check_self_payment(void)
+{
+    submit_drops(traders[0], treasury, 10 * DROPS_PER_XRP, 0, 0);
+    expect_run(router, EMU_SUCCESS, "fees routed", 4);
+    submit_drops(treasury, pools[2], 10 * DROPS_PER_XRP, 0, 0);
+    expect_run(router, EMU_SUCCESS, "outgoing payment", 0);
+
+    // The 4 pool payments are sent by the treasury, so the router runs on each of them
+    next_ledgers(2);
+    expect(seen.router_own == 5, "router ran on %u payments from the treasury, expected 5", seen.router_own);
+    expect(seen.router_own_emits == 0, "router emitted %u transactions for its own payments",
+           seen.router_own_emits);
+    expect(seen.applied == 4, "%u emitted transactions applied, expected the 4 pool payments", seen.applied);
+}
+
+static void check_partial_payment(void)
+{
+    // A partial payment's Amount is only an upper bound; no fee may be taken on it
+    submit_drippy_flags(traders[0], issuer, 1e12, tfPartialPayment);
+    expect_run(utility, EMU_REJECTED, "DRIPPY Utility: Partial payments not accepted", 0);
+    submit_drippy(traders[0], issuer, 10000);
+    expect_run(utility, EMU_SUCCESS, 0, 1);
+
+    // The router keeps partial payments of either kind without splitting them
+    submit_drops_flags(traders[1], treasury, 10 * DROPS_PER_XRP, tfPartialPayment, 0, 0);
+    expect_run(router, EMU_SUCCESS, "partial payment not routed", 0);
+    submit_drippy_flags(traders[2], treasury, 1000, tfPartialPayment);
+    expect_run(router, EMU_SUCCESS, "partial payment not routed", 0);
+    submit_drops(traders[1], treasury, 10 * DROPS_PER_XRP, 0, 0);
+    expect_run(router, EMU_SUCCESS, "fees routed", 4);
+}
+
+// Token-bucket entries ("DRIPPY:TB:") the hook holds in state
+static uint32_t bucket_entries(const emu_hook* h)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < h->state_capacity; i++) {
+        const uint8_t *key, *data;
+        uint32_t len;
+        if (emu_hook_state_at(h, i, &key, &data, &len) && memcmp(key, "DRIPPY:TB:", 10) == 0)
+            count++;
+    }
+    return count;
+}
+
+static void check_bucket_slots(void)
+{
+    uint8_t end[8];
+    be64(end, (uint64_t)REGRESS_START_TIME + 86400);
+    emu_hook_param(utility, "ANTI_SNIPE", end, 8);
+    emu_hook_param(router, "ANTI_SNIPE", end, 8);
+
+    // The default burst of 3 still throttles a single account
+    for (int i = 0; i < 3; i++) {
+        submit_drops(traders[0], treasury, 10 * DROPS_PER_XRP, 0, 0);
+        expect_run(router, EMU_SUCCESS, "fees routed", 4);
+    }
+    submit_drops(traders[0], treasury, 10 * DROPS_PER_XRP, 0, 0);
+    expect_run(router, EMU_REJECTED, "anti-sniping: trade rate exceeded", 0);
+
+    // However many accounts trade, the buckets stay within their slots
+    for (uint32_t i = 0; i < SNIPERS; i++) {
+        uint8_t sniper[20];
+        make_id(sniper, "sniper", i);
+        emu_account_add(sniper, 100 * DROPS_PER_XRP);
+        submit_drops(sniper, treasury, 10 * DROPS_PER_XRP, 0, 0);
+        expect_run(router, EMU_SUCCESS, "fees routed", 4);
+        int result = submit_drippy(sniper, issuer, 100);
+        expect(result == EMU_SUCCESS, "sniper %u: DRIPPY buy result %d, expected %d", i, result, EMU_SUCCESS);
+    }
+    uint32_t held[2] = { bucket_entries(router), bucket_entries(utility) };
+    expect(held[0] <= SNIPE_SLOTS, "router holds %u token buckets for %u accounts, expected at most %u",
+           held[0], SNIPERS + 1, SNIPE_SLOTS);
+    expect(held[1] <= SNIPE_SLOTS, "utility holds %u token buckets for %u accounts, expected at most %u",
+           held[1], SNIPERS, SNIPE_SLOTS);
+}
+
+static const struct {
+    const char* name;
+    void (*fn)(void);
+} checks[] = {
+    { "iou-routing", check_iou_routing },
+    { "whitelist-batch", check_whitelist_batch },
+    { "nft-unmatched", check_nft_unmatched },
+    { "emit-sizes", check_emit_sizes },
+    { "self-payment", check_self_payment },
+    { "partial-payment", check_partial_payment },
+    { "bucket-slots", check_bucket_slots },
+};
+
+static int regress(void* unused)
+{
+    (void)unused;
+    make_id(issuer, "issuer", 0);
+    make_id(treasury, "treasury", 0);
+    make_id(admin, "admin", 0);
+    for (int i = 0; i < 4; i++)
+        make_id(pools[i], POOL_NAMES[i], 0);
+    for (int i = 0; i < WL_BATCH; i++)
+        make_id(traders[i], "trader", (uint32_t)i);
+    emu_observe(observe, 0);
+
+    for (size_t i = 0; i < sizeof(checks) / sizeof(checks[0]); i++) {
+        fresh_ledger();
+        memset(&seen, 0, sizeof(seen));
+        check_failed = 0;
+        emu_ledger_begin();
+        checks[i].fn();
+        printf("%s %s\n", check_failed ? "FAIL" : "ok  ", checks[i].name);
+        failures += check_failed;
+    }
+    emu_free();
+    return failures ? 1 : 0;
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < SIM_HOOK_COUNT; i++) {
+        size_t size = (size_t)(sim_hooks[i].data_end - sim_hooks[i].data_start);
+        sim_hooks[i].pristine = malloc(size + 1);
+        memcpy(sim_hooks[i].pristine, sim_hooks[i].data_start, size);
+    }
+    printf("DRIPPY regression checks\n");
+    int result = emu_run(regress, 0);
+    if (result == 0)
+        printf("all %zu checks passed\n", sizeof(checks) / sizeof(checks[0]));
+    else
+        printf("%d of %zu checks failed\n", failures, sizeof(checks) / sizeof(checks[0]));
+    return result == 0 ? 0 : 1;
+}
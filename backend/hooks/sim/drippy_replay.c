@@ -0,0 +1,688 @@
+// DRIPPY replay: runs recorded mainnet traffic through the locally built hooks and
+// reports where they now behave differently, and what they cost
+//
+// The corpus is written by tools/hook-record.js: the hook accounts with the sim hook
+// each runs (utility, router, claim) and its HookParameters, their state and the
+// balances before the first ledger, then every ledger's Payments to or from those
+// accounts with what the network recorded for them. Each transaction is submitted to
+// the emulator (see hookemu.h) in its recorded ledger and compared with the recording:
+//   result     tesSUCCESS / tecHOOK_REJECTED against applied / rejected
+//   hooks      which hooks ran, accept or rollback, the accept/rollback string (first
+//              EMU_MESSAGE_MAX - 1 bytes) and how many transactions each emitted
+//   state      every HookState entry created, modified or deleted
+//   emitted    the emitted transactions, without Fee and EmitDetails (emu_txn_strip),
+//              in any order
+// Transactions emitted on the network are not in the corpus; the emulator emits its own.
+//
+// Cost is the guard iterations and host time of every hook run; the instruction count
+// the network recorded is listed next to it. --costs writes them per transaction and
+// --baseline compares against an earlier --costs file, to see what a hook change costs
+// on real traffic. --repeat runs the corpus again and keeps each run's fastest time.
+//
+// Corpus format, integers big-endian: "DRIPCORP", u32 version (1), then records of
+// u8 type, u32 payload length, payload:
+//   1 HOOK     account[20], u8 name length, sim hook name, u16 parameter count, then per
+//              parameter u8 name length, name, u16 value length, value
+//   2 ACCOUNT  account[20], i64 drops
+//   3 STATE    account[20], key[32], u16 length, data
+//   4 LEDGER   u32 sequence, u32 parent close time; starts the next ledger
+//   5 TXN      hash[32], u8 result (0 tesSUCCESS, 1 tecHOOK_REJECTED, 2 other),
+//              u16 length, blob, then
+//              u8 hook runs:      account[20], u8 accepted, u16 emitted,
+//                                 u64 instructions, u8 length, return string
+//              u16 state changes: account[20], key[32], u8 deleted, u16 length, data
+//              u16 emitted:       u16 length, blob
+//
+// Build and run from backend/hooks: make replay CORPUS=corpus.bin REPLAY_ARGS="--costs after.csv"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hookemu.h"
+
+// Hook objects are renamed by the Makefile: hook -> sim_<name>_hook, .data -> sim_<name>_data
+#define SIM_HOOK(name, arg_t) \
+    int64_t sim_##name##_hook(arg_t reserved); \
+    extern uint8_t __start_sim_##name##_data[] __attribute__((weak)); \
+    extern uint8_t __stop_sim_##name##_data[] __attribute__((weak)); \
+    static int64_t name##_entry(void) { return sim_##name##_hook(0); }
+
+SIM_HOOK(utility, uint32_t)
+SIM_HOOK(router, int64_t)
+SIM_HOOK(claim, int64_t)
+
+#define SIM_HOOK_ENTRY(name) { #name, name##_entry, __start_sim_##name##_data, __stop_sim_##name##_data, 0 }
+
+typedef struct {
+    const char* name;
+    emu_entry entry;
+    uint8_t* data_start;
+    uint8_t* data_end;
+    uint8_t* pristine;        // the data section before any run, restored for every pass
+} sim_hook;
+
+static sim_hook sim_hooks[] = {
+    SIM_HOOK_ENTRY(utility),
+    SIM_HOOK_ENTRY(router),
+    SIM_HOOK_ENTRY(claim),
+};
+
+#define SIM_HOOK_COUNT (sizeof(sim_hooks) / sizeof(sim_hooks[0]))
+
+enum { REC_HOOK = 1, REC_ACCOUNT, REC_STATE, REC_LEDGER, REC_TXN };
+enum { RESULT_SUCCESS = 0, RESULT_REJECTED, RESULT_OTHER };
+
+#define RUNS_MAX 2
+
+static struct {
+    const char* corpus;
+    const char* costs;
+    const char* baseline;
+    uint32_t repeat;
+    uint32_t max_diffs;
+    int trace;
+} opt = {
+    .repeat = 1,
+    .max_diffs = 20,
+};
+
+// One hook run, for the cost report
+typedef struct {
+    uint32_t txn;             // ordinal of the transaction in the corpus
+    const sim_hook* hook;
+    uint64_t guard_iterations;
+    uint64_t nanos;           // fastest over the passes
+    uint64_t instructions;    // recorded on the network, 0 when the hook did not run there
+} run_cost;
+
+static uint8_t* corpus;
+static size_t corpus_len;
+
+static run_cost* costs;
+static size_t cost_count, cost_capacity;
+
+static struct {
+    uint32_t ledgers;
+    uint32_t transactions;
+    uint32_t mismatched;      // transactions with at least one difference
+    uint64_t diffs;
+} stats;
+
+// ---- Corpus reading ----------------------------------------------------------------
+
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+    int bad;
+} reader;
+
+static const uint8_t* take(reader* r, size_t n)
+{
+    if (r->bad || (size_t)(r->end - r->p) < n) {
+        r->bad = 1;
+        return 0;
+    }
+    const uint8_t* p = r->p;
+    r->p += n;
+    return p;
+}
+
+static uint64_t take_be(reader* r, size_t n)
+{
+    const uint8_t* p = take(r, n);
+    uint64_t v = 0;
+    for (size_t i = 0; p && i < n; i++)
+        v = v << 8 | p[i];
+    return v;
+}
+
+static void corpus_error(const char* what)
+{
+    fprintf(stderr, "drippy_replay: %s: %s\n", opt.corpus, what);
+    exit(1);
+}
+
+static void load_corpus(void)
+{
+    FILE* f = fopen(opt.corpus, "rb");
+    if (!f) {
+        perror(opt.corpus);
+        exit(1);
+    }
+    fseek(f, 0, SEEK_END);
+    corpus_len = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    corpus = malloc(corpus_len ? corpus_len : 1);
+    if (fread(corpus, 1, corpus_len, f) != corpus_len)
+        corpus_error("short read");
+    fclose(f);
+
+    if (corpus_len < 12 || memcmp(corpus, "DRIPCORP", 8) != 0)
+        corpus_error("not a replay corpus");
+    reader r = { corpus + 8, corpus + 12, 0 };
+    if (take_be(&r, 4) != 1)
+        corpus_error("unsupported corpus version");
+}
+
+static void hex(char* out, const uint8_t* p, size_t n)
+{
+    static const char DIGITS[] = "0123456789ABCDEF";
+    for (size_t i = 0; i < n; i++) {
+        out[2 * i] = DIGITS[p[i] >> 4];
+        out[2 * i + 1] = DIGITS[p[i] & 15];
+    }
+    out[2 * n] = 0;
+}
+
+// ---- Comparison --------------------------------------------------------------------
+
+typedef struct {
+    const uint8_t* account;
+    int accepted;
+    uint32_t emitted;
+    uint64_t instructions;
+    char message[EMU_MESSAGE_MAX];
+} recorded_run;
+
+typedef struct {
+    char hash[65];
+    uint32_t ledger;
+    int reported;
+} txn_context;
+
+static void diff(txn_context* c, const char* fmt, ...)
+{
+    stats.diffs++;
+    if (!c->reported) {
+        c->reported = 1;
+        stats.mismatched++;
+    }
+    if (stats.diffs > opt.max_diffs)
+        return;
+    va_list ap;
+    va_start(ap, fmt);
+    printf("  %.16s (ledger %u): ", c->hash, c->ledger);
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+}
+
+static const char* RESULT_NAMES[3] = { "tesSUCCESS", "tecHOOK_REJECTED", "other" };
+static const char* EMU_NAMES[4] = { "applied", "rejected", "unfunded", "malformed" };
+
+static const emu_run_report* find_run(const emu_report* rep, const uint8_t account[20])
+{
+    for (uint32_t i = 0; i < rep->run_count; i++) {
+        if (memcmp(rep->runs[i].hook->account, account, 20) == 0)
+            return &rep->runs[i];
+    }
+    return 0;
+}
+
+static const recorded_run* find_recorded(const recorded_run* runs, uint32_t n, const uint8_t account[20])
+{
+    for (uint32_t i = 0; i < n; i++) {
+        if (memcmp(runs[i].account, account, 20) == 0)
+            return &runs[i];
+    }
+    return 0;
+}
+
+static void compare_runs(txn_context* c, const emu_report* rep, const recorded_run* runs, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++) {
+        const emu_account* a = emu_account_find(runs[i].account);
+        const emu_run_report* e = find_run(rep, runs[i].account);
+        if (!a || !a->hook)
+            continue;
+        if (!e) {
+            diff(c, "%s hook ran on the network but not here", a->hook->name);
+            continue;
+        }
+        if (e->accepted != runs[i].accepted)
+            diff(c, "%s hook %s", a->hook->name,
+                 runs[i].accepted ? "accepted on the network, rolled back here" : "rolled back on the network, accepted here");
+        if (strcmp(e->message, runs[i].message) != 0) {
+            diff(c, "%s hook returned \"%s\" on the network, \"%s\" here", a->hook->name,
+                 runs[i].message, e->message);
+        }
+        if (e->emitted != runs[i].emitted)
+            diff(c, "%s hook emitted %u on the network, %u here", a->hook->name, runs[i].emitted, e->emitted);
+    }
+    for (uint32_t i = 0; i < rep->run_count; i++) {
+        if (!find_recorded(runs, n, rep->runs[i].hook->account))
+            diff(c, "%s hook ran here but not on the network", rep->runs[i].hook->name);
+    }
+}
+
+// State changes are compared as sets of (hook, key) -> value; emulated changes are
+// marked off as they are matched
+static void compare_state(txn_context* c, reader* r, uint32_t n, const emu_report* rep, int compare)
+{
+    uint8_t* matched = calloc(rep->state_count + 1, 1);
+    char key[65];
+    for (uint32_t i = 0; i < n; i++) {
+        const uint8_t* account = take(r, 20);
+        const uint8_t* k = take(r, 32);
+        int deleted = (int)take_be(r, 1);
+        uint32_t len = (uint32_t)take_be(r, 2);
+        const uint8_t* data = take(r, len);
+        if (r->bad || !compare)
+            continue;
+
+        hex(key, k, 32);
+        uint32_t j;
+        for (j = 0; j < rep->state_count; j++) {
+            const emu_hook* h;
+            const uint8_t *ek, *ed;
+            uint32_t elen;
+            emu_report_state(j, &h, &ek, &ed, &elen);
+            if (matched[j] || memcmp(h->account, account, 20) != 0 || memcmp(ek, k, 32) != 0)
+                continue;
+            matched[j] = 1;
+            if (deleted != !ed)
+                diff(c, "state %s %s", key, deleted ? "deleted on the network, written here" : "written on the network, deleted here");
+            else if (!deleted && (elen != len || memcmp(ed, data, len) != 0))
+                diff(c, "state %s %s", key, "written with different data");
+            break;
+        }
+        if (j == rep->state_count)
+            diff(c, "state %s %s", key, deleted ? "deleted on the network only" : "written on the network only");
+    }
+    for (uint32_t j = 0; compare && j < rep->state_count; j++) {
+        const emu_hook* h;
+        const uint8_t *ek, *ed;
+        uint32_t elen;
+        if (matched[j])
+            continue;
+        emu_report_state(j, &h, &ek, &ed, &elen);
+        hex(key, ek, 32);
+        diff(c, "state %s %s", key, ed ? "written here only" : "deleted here only");
+    }
+    free(matched);
+}
+
+// Emissions are compared as a multiset: the network lists them in canonical order in
+// the next ledger, not in the order the hook emitted them
+static void compare_emitted(txn_context* c, reader* r, uint32_t n, const emu_report* rep, int compare)
+{
+    uint8_t a[EMU_TXN_MAX], b[EMU_TXN_MAX];
+    uint8_t* matched = calloc(rep->emit_count + 1, 1);
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t len = (uint32_t)take_be(r, 2);
+        const uint8_t* blob = take(r, len);
+        if (r->bad || !compare || len > EMU_TXN_MAX)
+            continue;
+        uint32_t alen = emu_txn_strip(a, blob, len);
+        uint32_t j;
+        for (j = 0; alen && j < rep->emit_count; j++) {
+            uint32_t elen;
+            const uint8_t* emitted = emu_report_emit(j, &elen);
+            if (!matched[j] && emu_txn_strip(b, emitted, elen) == alen && memcmp(a, b, alen) == 0) {
+                matched[j] = 1;
+                break;
+            }
+        }
+        if (!alen || j == rep->emit_count)
+            diff(c, "emitted transaction %u on the network has no match here", i);
+    }
+    if (compare && n != rep->emit_count)
+        diff(c, "%u transactions emitted on the network, %u here", n, rep->emit_count);
+    free(matched);
+}
+
+// ---- Replay ------------------------------------------------------------------------
+
+static void add_cost(uint32_t pass, uint32_t* next, uint32_t txn, const emu_run_report* e,
+                     uint64_t instructions)
+{
+    if (pass > 0) {
+        run_cost* rc = &costs[(*next)++];
+        if (e->nanos < rc->nanos)
+            rc->nanos = e->nanos;
+        return;
+    }
+    if (cost_count == cost_capacity) {
+        cost_capacity = cost_capacity ? cost_capacity * 2 : 1024;
+        costs = realloc(costs, cost_capacity * sizeof(*costs));
+    }
+    const sim_hook* hook = 0;
+    for (size_t i = 0; i < SIM_HOOK_COUNT; i++) {
+        if (strcmp(sim_hooks[i].name, e->hook->name) == 0)
+            hook = &sim_hooks[i];
+    }
+    costs[cost_count++] = (run_cost){ txn, hook, e->guard_iterations, e->nanos, instructions };
+}
+
+static void replay_txn(reader* r, uint32_t pass, uint32_t txn, uint32_t* next_cost)
+{
+    txn_context c = { .ledger = emu_ledger_seq() };
+    hex(c.hash, take(r, 32), 32);
+    int result = (int)take_be(r, 1);
+    uint32_t len = (uint32_t)take_be(r, 2);
+    const uint8_t* blob = take(r, len);
+    if (r->bad)
+        return;
+
+    int got = emu_submit(blob, len);
+    const emu_report* rep = emu_last_report();
+    int compare = pass == 0;
+
+    recorded_run runs[RUNS_MAX];
+    uint32_t kept = (uint32_t)take_be(r, 1);
+    if (kept > RUNS_MAX)
+        corpus_error("more hook runs than a Payment has");
+    for (uint32_t i = 0; i < kept; i++) {
+        recorded_run* rr = &runs[i];
+        rr->account = take(r, 20);
+        rr->accepted = (int)take_be(r, 1);
+        rr->emitted = (uint32_t)take_be(r, 2);
+        rr->instructions = take_be(r, 8);
+        uint32_t mlen = (uint32_t)take_be(r, 1);
+        const uint8_t* m = take(r, mlen);
+        if (r->bad)
+            return;
+        if (mlen >= EMU_MESSAGE_MAX)
+            mlen = EMU_MESSAGE_MAX - 1;
+        memcpy(rr->message, m, mlen);
+        rr->message[mlen] = 0;
+    }
+
+    if (compare) {
+        stats.transactions++;
+        if (result != RESULT_OTHER &&
+            got != (result == RESULT_SUCCESS ? EMU_SUCCESS : EMU_REJECTED))
+            diff(&c, "%s on the network, %s here", RESULT_NAMES[result], EMU_NAMES[got]);
+        compare_runs(&c, rep, runs, kept);
+    }
+
+    for (uint32_t i = 0; i < rep->run_count; i++) {
+        const recorded_run* rr = find_recorded(runs, kept, rep->runs[i].hook->account);
+        add_cost(pass, next_cost, txn, &rep->runs[i], rr ? rr->instructions : 0);
+    }
+
+    // The network lists state and emissions only for applied transactions
+    int effects = compare && result == RESULT_SUCCESS && got == EMU_SUCCESS;
+    compare_state(&c, r, (uint32_t)take_be(r, 2), rep, effects);
+    compare_emitted(&c, r, (uint32_t)take_be(r, 2), rep, effects);
+}
+
+static void install_hook(reader* r)
+{
+    const uint8_t* account = take(r, 20);
+    uint32_t name_len = (uint32_t)take_be(r, 1);
+    const uint8_t* name = take(r, name_len);
+    if (r->bad)
+        corpus_error("truncated HOOK record");
+
+    const sim_hook* s = 0;
+    for (size_t i = 0; i < SIM_HOOK_COUNT; i++) {
+        if (strlen(sim_hooks[i].name) == name_len && memcmp(sim_hooks[i].name, name, name_len) == 0)
+            s = &sim_hooks[i];
+    }
+    if (!s)
+        corpus_error("HOOK record names a hook this build does not have");
+    emu_hook* h = emu_hook_install(s->name, account, s->entry, s->data_start, s->data_end);
+
+    for (uint32_t n = (uint32_t)take_be(r, 2); n > 0; n--) {
+        char pname[33];
+        uint32_t plen = (uint32_t)take_be(r, 1);
+        const uint8_t* p = take(r, plen);
+        uint32_t vlen = (uint32_t)take_be(r, 2);
+        const uint8_t* v = take(r, vlen);
+        if (r->bad || plen > 32 || memchr(p, 0, plen))
+            corpus_error("bad HOOK parameter");
+        memcpy(pname, p, plen);
+        pname[plen] = 0;
+        emu_hook_param(h, pname, v, vlen);
+    }
+}
+
+static int replay(void* arg)
+{
+    uint32_t pass = *(uint32_t*)arg;
+    emu_config config = {
+        .base_fee = 10,
+        .hook_fee = 10,
+        .ledger_interval = 4,
+        .trace = opt.trace,
+    };
+    emu_init(&config);
+    for (size_t i = 0; i < SIM_HOOK_COUNT; i++)
+        memcpy(sim_hooks[i].data_start, sim_hooks[i].pristine, (size_t)(sim_hooks[i].data_end - sim_hooks[i].data_start));
+
+    reader r = { corpus + 12, corpus + corpus_len, 0 };
+    uint32_t txn = 0, next_cost = 0;
+    int open = 0;
+    while (r.p < r.end) {
+        uint32_t type = (uint32_t)take_be(&r, 1);
+        uint32_t len = (uint32_t)take_be(&r, 4);
+        const uint8_t* payload = take(&r, len);
+        if (r.bad)
+            corpus_error("truncated record");
+        reader rec = { payload, payload + len, 0 };
+
+        switch (type) {
+        case REC_HOOK:
+            install_hook(&rec);
+            break;
+        case REC_ACCOUNT: {
+            const uint8_t* id = take(&rec, 20);
+            int64_t drops = (int64_t)take_be(&rec, 8);
+            if (!rec.bad)
+                emu_account_add(id, drops);
+            break;
+        }
+        case REC_STATE: {
+            const uint8_t* id = take(&rec, 20);
+            const uint8_t* key = take(&rec, 32);
+            uint32_t dlen = (uint32_t)take_be(&rec, 2);
+            const uint8_t* data = take(&rec, dlen);
+            emu_account* a = rec.bad ? 0 : emu_account_find(id);
+            if (!a || !a->hook || dlen > EMU_STATE_MAX)
+                corpus_error("STATE record for an account without a hook");
+            emu_hook_state_set(a->hook, key, data, dlen);
+            break;
+        }
+        case REC_LEDGER: {
+            uint32_t seq = (uint32_t)take_be(&rec, 4);
+            uint32_t close_time = (uint32_t)take_be(&rec, 4);
+            if (open)
+                emu_ledger_close();
+            emu_ledger_set(seq, close_time);
+            emu_ledger_begin();
+            open = 1;
+            if (pass == 0)
+                stats.ledgers++;
+            break;
+        }
+        case REC_TXN:
+            if (!open)
+                corpus_error("transaction before the first ledger");
+            replay_txn(&rec, pass, txn++, &next_cost);
+            break;
+        default:
+            break;                // unknown records are skipped, for newer recorders
+        }
+        if (rec.bad)
+            corpus_error("truncated record");
+    }
+    if (open)
+        emu_ledger_close();
+    emu_free();
+    return 0;
+}
+
+// ---- Costs -------------------------------------------------------------------------
+
+typedef struct {
+    uint64_t runs;
+    uint64_t guard_iterations;
+    uint64_t nanos;
+    uint64_t instructions;
+} cost_total;
+
+static void write_costs(void)
+{
+    FILE* f = fopen(opt.costs, "w");
+    if (!f) {
+        perror(opt.costs);
+        exit(1);
+    }
+    fprintf(f, "txn,hook,guard_iterations,nanos,instructions\n");
+    for (size_t i = 0; i < cost_count; i++)
+        fprintf(f, "%u,%s,%llu,%llu,%llu\n", costs[i].txn, costs[i].hook->name,
+                (unsigned long long)costs[i].guard_iterations, (unsigned long long)costs[i].nanos,
+                (unsigned long long)costs[i].instructions);
+    fclose(f);
+}
+
+// Totals per sim hook from an earlier --costs file; returns the number of runs read
+static uint64_t read_baseline(cost_total* totals, uint64_t* changed)
+{
+    FILE* f = fopen(opt.baseline, "r");
+    if (!f) {
+        perror(opt.baseline);
+        exit(1);
+    }
+    char line[256], name[32];
+    uint64_t count = 0;
+    size_t at = 0;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned txn;
+        unsigned long long guard, nanos, instructions;
+        if (sscanf(line, "%u,%31[^,],%llu,%llu,%llu", &txn, name, &guard, &nanos, &instructions) != 5)
+            continue;
+        for (size_t i = 0; i < SIM_HOOK_COUNT; i++) {
+            if (strcmp(sim_hooks[i].name, name) != 0)
+                continue;
+            totals[i].runs++;
+            totals[i].guard_iterations += guard;
+            totals[i].nanos += nanos;
+            totals[i].instructions += instructions;
+        }
+        // Same corpus: the runs line up one to one
+        if (at < cost_count && (costs[at].txn != txn || strcmp(costs[at].hook->name, name) != 0 ||
+                                costs[at].guard_iterations != guard))
+            (*changed)++;
+        at++;
+        count++;
+    }
+    fclose(f);
+    if (count != cost_count)
+        *changed += count > cost_count ? count - cost_count : cost_count - count;
+    return count;
+}
+
+static double change(uint64_t before, uint64_t after)
+{
+    return before ? 100.0 * ((double)after - (double)before) / (double)before : 0;
+}
+
+static void print_costs(void)
+{
+    cost_total now[SIM_HOOK_COUNT] = { 0 }, before[SIM_HOOK_COUNT] = { 0 };
+    for (size_t i = 0; i < cost_count; i++) {
+        cost_total* t = &now[costs[i].hook - sim_hooks];
+        t->runs++;
+        t->guard_iterations += costs[i].guard_iterations;
+        t->nanos += costs[i].nanos;
+        t->instructions += costs[i].instructions;
+    }
+
+    printf("\nCost per hook run (mean)\n");
+    for (size_t i = 0; i < SIM_HOOK_COUNT; i++) {
+        const cost_total* t = &now[i];
+        if (!t->runs)
+            continue;
+        printf("  %-8s runs %llu  guard iterations %.1f  %.0f ns  network instructions %.0f\n",
+               sim_hooks[i].name, (unsigned long long)t->runs, (double)t->guard_iterations / t->runs,
+               (double)t->nanos / t->runs, (double)t->instructions / t->runs);
+    }
+    if (!opt.baseline)
+        return;
+
+    uint64_t changed = 0;
+    read_baseline(before, &changed);
+    printf("\nAgainst %s\n", opt.baseline);
+    for (size_t i = 0; i < SIM_HOOK_COUNT; i++) {
+        const cost_total* a = &before[i];
+        const cost_total* b = &now[i];
+        if (!a->runs && !b->runs)
+            continue;
+        printf("  %-8s runs %llu -> %llu  guard iterations %llu -> %llu (%+.1f%%)  time %+.1f%%\n",
+               sim_hooks[i].name, (unsigned long long)a->runs, (unsigned long long)b->runs,
+               (unsigned long long)a->guard_iterations, (unsigned long long)b->guard_iterations,
+               change(a->guard_iterations, b->guard_iterations), change(a->nanos, b->nanos));
+    }
+    printf("  hook runs with different guard iterations: %llu\n", (unsigned long long)changed);
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: drippy_replay [options] corpus\n"
+            "  --costs FILE           per hook run: guard iterations, time and network instructions\n"
+            "  --baseline FILE        compare costs with an earlier --costs file\n"
+            "  --repeat N             replay N times, keeping each run's fastest time (1)\n"
+            "  --max-diffs N          differences printed (20)\n"
+            "  --trace                print hook traces to stderr\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (strcmp(a, "--trace") == 0) {
+            opt.trace = 1;
+            continue;
+        }
+        if (a[0] != '-') {
+            if (opt.corpus)
+                usage();
+            opt.corpus = a;
+            continue;
+        }
+        if (i + 1 >= argc)
+            usage();
+        const char* v = argv[++i];
+
+        if (strcmp(a, "--costs") == 0) opt.costs = v;
+        else if (strcmp(a, "--baseline") == 0) opt.baseline = v;
+        else if (strcmp(a, "--repeat") == 0) opt.repeat = (uint32_t)atoi(v);
+        else if (strcmp(a, "--max-diffs") == 0) opt.max_diffs = (uint32_t)atoi(v);
+        else usage();
+    }
+    if (!opt.corpus || !opt.repeat)
+        usage();
+
+    load_corpus();
+    for (size_t i = 0; i < SIM_HOOK_COUNT; i++) {
+        size_t size = (size_t)(sim_hooks[i].data_end - sim_hooks[i].data_start);
+        sim_hooks[i].pristine = malloc(size + 1);
+        memcpy(sim_hooks[i].pristine, sim_hooks[i].data_start, size);
+    }
+
+    printf("DRIPPY replay: %s\n", opt.corpus);
+    for (uint32_t pass = 0; pass < opt.repeat; pass++) {
+        if (emu_run(replay, &pass) != 0)
+            return 1;
+        if (pass == 0 && stats.diffs)
+            printf("\n");
+    }
+    if (stats.diffs > opt.max_diffs)
+        printf("  ... %llu more differences\n\n", (unsigned long long)(stats.diffs - opt.max_diffs));
+
+    printf("%u ledgers, %u transactions, %u differ from the recording (%llu differences)\n",
+           stats.ledgers, stats.transactions, stats.mismatched, (unsigned long long)stats.diffs);
+    print_costs();
+    if (opt.costs)
+        write_costs();
+
+    free(costs);
+    free(corpus);
+    return stats.mismatched ? 1 : 0;
+}
@@ -0,0 +1,680 @@
+// DRIPPY economy simulator: the utility hook, fee router and enhanced claim hook on one
+// synthetic ledger (see hookemu.h for what the emulator models)
+//
+//   issuer     drippy_utility_hook   takes the DRIPPY trade fee, flushes it to the treasury
+//   treasury   drippy_fee_router     splits incoming fees over the NFT/HOLD/TREA/AMM pools
+//   hold pool  drippy_enhanced_claim holders claim what the admin accrued to them
+//
+// Traffic is generated per ledger from a seeded PRNG, so a run is reproducible:
+//   trades        DRIPPY payments trader <-> issuer (--trades-per-hour, --buy-share,
+//                 sizes from --trade-dist with mean --trade-mean)
+//   native fees   XRP payments to the treasury (--xrp-fees-per-hour, --xrp-fee-mean)
+//   accruals      every --accrue-hours the admin accrues --accrue-ratio of the hold pool's
+//                 routed inflow (router HOLD_TOTAL) to the holders by weight
+//   claims        background claims (--claims-per-hour) plus claim waves: every
+//                 --claim-wave-hours, --claim-wave-share of the holders claim within
+//                 --claim-wave-spread hours
+//
+// Output: a summary on stdout, and optionally an hourly series (--csv) and per-ledger
+// load (--ledger-csv).
+//
+// Build and run from backend/hooks: make sim SIM_ARGS="--hours 336 --trades-per-hour 10000"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hookemu.h"
+
+// Hook objects are renamed by the Makefile: hook -> sim_<name>_hook, .data -> sim_<name>_data
+#define SIM_HOOK(name, arg_t) \
+    int64_t sim_##name##_hook(arg_t reserved); \
+    extern uint8_t __start_sim_##name##_data[] __attribute__((weak)); \
+    extern uint8_t __stop_sim_##name##_data[] __attribute__((weak)); \
+    static int64_t name##_entry(void) { return sim_##name##_hook(0); }
+
+SIM_HOOK(utility, uint32_t)
+SIM_HOOK(router, int64_t)
+SIM_HOOK(claim, int64_t)
+
+#define INSTALL_HOOK(name, account) \
+    emu_hook_install(#name, account, name##_entry, __start_sim_##name##_data, __stop_sim_##name##_data)
+
+#define DROPS_PER_XRP 1000000LL
+#define SIM_START_TIME 789004800U    // 2025-01-01T00:00:00Z, seconds since the Ripple epoch
+
+enum { DIST_EXP, DIST_FIXED, DIST_PARETO };
+
+typedef struct {
+    uint64_t seed;
+    double hours;
+    uint32_t ledger_secs;
+    uint64_t base_fee;
+    uint64_t hook_fee;
+    uint64_t owner_reserve;
+    uint32_t traders;
+    double trades_per_hour;
+    double buy_share;
+    double trade_mean;
+    int trade_dist;
+    double xrp_fees_per_hour;
+    double xrp_fee_mean;
+    double pool_xrp;
+    double fee_flush;
+    uint32_t accrue_hours;
+    double accrue_ratio;
+    double boost_share;
+    uint32_t boost_mult;
+    double claims_per_hour;
+    uint32_t claim_wave_hours;
+    uint32_t claim_wave_start;
+    double claim_wave_share;
+    double claim_wave_spread;
+    uint64_t claim_cooldown;
+    uint64_t claim_max;
+    int trace;
+    const char* csv;
+    const char* ledger_csv;
+} sim_options;
+
+typedef struct {
+    uint32_t ledger;
+    uint32_t holder;
+} wave_claim;
+
+static sim_options opt = {
+    .seed = 1,
+    .hours = 168,
+    .ledger_secs = 4,
+    .base_fee = 10,
+    .hook_fee = 10,
+    .owner_reserve = 200000,
+    .traders = 500,
+    .trades_per_hour = 1000,
+    .buy_share = 0.55,
+    .trade_mean = 5000,
+    .trade_dist = DIST_EXP,
+    .xrp_fees_per_hour = 30,
+    .xrp_fee_mean = 25,
+    .pool_xrp = 100000,
+    .fee_flush = 0,
+    .accrue_hours = 24,
+    .accrue_ratio = 1.0,
+    .boost_share = 0.1,
+    .boost_mult = 150,
+    .claims_per_hour = 5,
+    .claim_wave_hours = 168,
+    .claim_wave_start = 0,
+    .claim_wave_share = 0.6,
+    .claim_wave_spread = 6,
+};
+
+static uint64_t rng_state;
+
+static uint64_t rng_next(void)
+{
+    uint64_t x = rng_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    rng_state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+// Uniform in (0, 1)
+static double rng_uniform(void)
+{
+    return ((rng_next() >> 11) + 0.5) / 9007199254740992.0;
+}
+
+static uint32_t rng_below(uint32_t n)
+{
+    return (uint32_t)(rng_uniform() * n);
+}
+
+static uint32_t rng_poisson(double lambda)
+{
+    if (lambda <= 0)
+        return 0;
+    if (lambda > 30) {
+        // Normal approximation; Box-Muller
+        double z = sqrt(-2 * log(rng_uniform())) * cos(2 * M_PI * rng_uniform());
+        double v = lambda + sqrt(lambda) * z + 0.5;
+        return v < 0 ? 0 : (uint32_t)v;
+    }
+    double limit = exp(-lambda), p = 1;
+    uint32_t k = 0;
+    while ((p *= rng_uniform()) > limit)
+        k++;
+    return k;
+}
+
+static double trade_size(void)
+{
+    switch (opt.trade_dist) {
+    case DIST_FIXED:
+        return opt.trade_mean;
+    case DIST_PARETO: {
+        // alpha 1.5: a few whales, mean trade_mean
+        const double alpha = 1.5;
+        double xm = opt.trade_mean * (alpha - 1) / alpha;
+        return xm * pow(rng_uniform(), -1 / alpha);
+    }
+    default:
+        return -opt.trade_mean * log(rng_uniform());
+    }
+}
+
+// ---- Ledger participants -----------------------------------------------------------
+
+static uint8_t issuer[20], treasury[20], admin[20];
+static uint8_t pools[4][20];   // NFT, HOLD, TREA, AMM: the router's order
+static uint8_t currency[20] = { 'D', 'R', 'I', 'P', 'P', 'Y' };
+static uint8_t (*traders)[20];
+static double* weights;
+static double weight_total;
+
+static const char* POOL_NAMES[4] = { "nft", "hold", "trea", "amm" };
+
+static emu_hook *utility, *router, *claim;
+
+static void make_id(uint8_t out[20], const char* tag, uint32_t n)
+{
+    char s[64];
+    uint8_t hash[32];
+    int len = snprintf(s, sizeof(s), "drippy-sim:%s:%u", tag, n);
+    emu_sha512h(hash, (const uint8_t*)s, (uint32_t)len);
+    memcpy(out, hash, 20);
+}
+
+static void hex(char* out, const uint8_t* data, uint32_t len)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    for (uint32_t i = 0; i < len; i++) {
+        out[i * 2] = digits[data[i] >> 4];
+        out[i * 2 + 1] = digits[data[i] & 0xF];
+    }
+    out[len * 2] = 0;
+}
+
+static void be64(uint8_t out[8], uint64_t v)
+{
+    for (int i = 0; i < 8; i++)
+        out[i] = (uint8_t)(v >> (56 - 8 * i));
+}
+
+static uint64_t read_be64(const uint8_t* p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+        v = v << 8 | p[i];
+    return v;
+}
+
+static void setup(void)
+{
+    make_id(issuer, "issuer", 0);
+    make_id(treasury, "treasury", 0);
+    make_id(admin, "admin", 0);
+    for (int i = 0; i < 4; i++)
+        make_id(pools[i], POOL_NAMES[i], 0);
+
+    emu_account_add(issuer, 1000 * DROPS_PER_XRP);
+    emu_account_add(treasury, 1000 * DROPS_PER_XRP);
+    emu_account_add(admin, 1000 * DROPS_PER_XRP);
+    for (int i = 0; i < 4; i++)
+        emu_account_add(pools[i], 100 * DROPS_PER_XRP);
+    emu_account_add(pools[1], (int64_t)(opt.pool_xrp * DROPS_PER_XRP));
+
+    traders = calloc(opt.traders, 20);
+    weights = calloc(opt.traders, sizeof(*weights));
+    for (uint32_t i = 0; i < opt.traders; i++) {
+        make_id(traders[i], "trader", i);
+        emu_account_add(traders[i], 10000 * DROPS_PER_XRP);
+        // Holder weight: Pareto, so a few accounts hold most of the supply
+        weights[i] = pow(rng_uniform(), -1 / 1.2);
+        weight_total += weights[i];
+    }
+
+    // Every hook exports cbak, so a node adds the callback account to EmitDetails
+    utility = INSTALL_HOOK(utility, issuer);
+    utility->has_callback = 1;
+    emu_hook_param(utility, "CUR", currency, 20);
+    emu_hook_param(utility, "TREASURY", treasury, 20);
+    if (opt.fee_flush > 0) {
+        uint8_t flush[8];
+        be64(flush, (uint64_t)emu_xfl_from_units(opt.fee_flush));
+        emu_hook_param(utility, "FEE_FLUSH", flush, 8);
+    }
+
+    router = INSTALL_HOOK(router, treasury);
+    router->has_callback = 1;
+    uint8_t whitelist[40];
+    memcpy(whitelist, currency, 20);
+    memcpy(whitelist + 20, issuer, 20);
+    emu_hook_param(router, "ADMIN", admin, 20);
+    emu_hook_param(router, "NFT_POOL", pools[0], 20);
+    emu_hook_param(router, "HOLD_POOL", pools[1], 20);
+    emu_hook_param(router, "TREA_POOL", pools[2], 20);
+    emu_hook_param(router, "AMM_POOL", pools[3], 20);
+    emu_hook_param(router, "IOU_WL", whitelist, 40);
+
+    claim = INSTALL_HOOK(claim, pools[1]);
+    claim->has_callback = 1;
+    emu_hook_param(claim, "ADMIN", admin, 20);
+    if (opt.claim_cooldown) {
+        uint8_t v[8];
+        be64(v, opt.claim_cooldown);
+        emu_hook_param(claim, "COOLD", v, 8);
+    }
+    if (opt.claim_max) {
+        uint8_t v[8];
+        be64(v, opt.claim_max);
+        emu_hook_param(claim, "MAXP", v, 8);
+    }
+}
+
+// ---- Transactions ------------------------------------------------------------------
+
+typedef struct {
+    uint64_t trades, xrp_fees, accruals, boosts;
+    uint64_t claims, claims_ok;
+} sim_counts;
+
+static sim_counts counts, hour_counts;
+
+static int submit_drops(const uint8_t* from, const uint8_t* to, uint64_t drops,
+                        const emu_memo* memos, uint32_t memo_count)
+{
+    uint8_t blob[EMU_TXN_MAX], amount[8];
+    emu_amount_drops(amount, drops);
+    uint32_t len = emu_payment(blob, from, to, amount, 8, memos, memo_count);
+    return emu_submit(blob, len);
+}
+
+static void submit_trade(void)
+{
+    uint8_t blob[EMU_TXN_MAX], amount[48];
+    const uint8_t* trader = traders[rng_below(opt.traders)];
+    int buy = rng_uniform() < opt.buy_share;
+    emu_amount_iou(amount, emu_xfl_from_units(trade_size()), currency, issuer);
+    uint32_t len = buy ? emu_payment(blob, trader, issuer, amount, 48, 0, 0)
+                       : emu_payment(blob, issuer, trader, amount, 48, 0, 0);
+    emu_submit(blob, len);
+    counts.trades++;
+}
+
+static void submit_xrp_fee(void)
+{
+    const uint8_t* payer = traders[rng_below(opt.traders)];
+    double xrp = -opt.xrp_fee_mean * log(rng_uniform());
+    submit_drops(payer, treasury, (uint64_t)(xrp * DROPS_PER_XRP) + 1, 0, 0);
+    counts.xrp_fees++;
+}
+
+// Admin memo pair: ACC_A = target account (hex), second memo carries the value
+static int submit_admin(const uint8_t* target, const char* type, uint64_t value)
+{
+    char account_hex[41], value_hex[17];
+    hex(account_hex, target, 20);
+    snprintf(value_hex, sizeof(value_hex), "%llX", (unsigned long long)value);
+    emu_memo memos[2] = {
+        { "ACC_A", (const uint8_t*)account_hex, 40 },
+        { type, (const uint8_t*)value_hex, (uint32_t)strlen(value_hex) },
+    };
+    return submit_drops(admin, pools[1], 1, memos, 2);
+}
+
+static void submit_claim(uint32_t holder)
+{
+    emu_memo memo = { "CLAIM", 0, 0 };
+    counts.claims++;
+    hour_counts.claims++;
+    if (submit_drops(traders[holder], pools[1], 1, &memo, 1) == EMU_SUCCESS) {
+        counts.claims_ok++;
+        hour_counts.claims_ok++;
+    }
+}
+
+static uint64_t router_hold_total(void)
+{
+    uint8_t key[32] = "DRIPPY:ROUTER:v1:HOLD_TOTAL";
+    uint8_t value[EMU_STATE_MAX];
+    uint32_t len;
+    if (!emu_hook_state(router, key, value, &len) || len != 8)
+        return 0;
+    return read_be64(value);
+}
+
+static uint64_t accrued_hold_total;
+
+static void accrue(void)
+{
+    uint64_t total = router_hold_total();
+    double budget = (double)(total - accrued_hold_total) * opt.accrue_ratio;
+    accrued_hold_total = total;
+
+    for (uint32_t i = 0; i < opt.traders; i++) {
+        uint64_t share = (uint64_t)(budget * weights[i] / weight_total);
+        if (!share)
+            continue;
+        submit_admin(traders[i], "ACC_V", share);
+        counts.accruals++;
+    }
+}
+
+static int compare_wave(const void* a, const void* b)
+{
+    const wave_claim *x = a, *y = b;
+    return x->ledger < y->ledger ? -1 : x->ledger > y->ledger;
+}
+
+static int compare_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// ---- Reporting ---------------------------------------------------------------------
+
+static int64_t balance(const uint8_t* id)
+{
+    emu_account* a = emu_account_find(id);
+    return a ? a->drops : 0;
+}
+
+static double xrp(int64_t drops)
+{
+    return (double)drops / DROPS_PER_XRP;
+}
+
+static void write_csv_header(FILE* f)
+{
+    fprintf(f, "hour,hold_xrp,nft_xrp,trea_xrp,amm_xrp,treasury_xrp,treasury_drippy,"
+               "transactions,emitted,rejected,claims,claims_ok,fees_drops,state_entries,state_bytes\n");
+}
+
+static void write_csv_row(FILE* f, uint32_t hour, const emu_ledger_stats* h)
+{
+    const emu_totals* t = emu_get_totals();
+    emu_account* tr = emu_account_find(treasury);
+    uint64_t entries = utility->state_entries + router->state_entries + claim->state_entries;
+    uint64_t bytes = utility->state_bytes + router->state_bytes + claim->state_bytes;
+    fprintf(f, "%u,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%u,%u,%u,%llu,%llu,%llu,%llu,%llu\n", hour,
+            xrp(balance(pools[1])), xrp(balance(pools[0])), xrp(balance(pools[2])),
+            xrp(balance(pools[3])), xrp(tr->drops), tr->iou, h->transactions, h->emitted_applied,
+            h->rejected, (unsigned long long)hour_counts.claims, (unsigned long long)hour_counts.claims_ok,
+            (unsigned long long)(t->fees_origin + t->fees_emitted), (unsigned long long)entries,
+            (unsigned long long)bytes);
+}
+
+static void print_hook(const emu_hook* h)
+{
+    printf("  %-8s runs %llu  accepted %llu  rolled back %llu  emitted %llu  max guard iterations %llu\n",
+           h->name, (unsigned long long)h->runs, (unsigned long long)h->accepts,
+           (unsigned long long)h->rollbacks, (unsigned long long)h->emitted,
+           (unsigned long long)h->guard_max);
+    printf("           state %u entries, %llu bytes, owner reserve %.1f XRP\n", h->state_entries,
+           (unsigned long long)h->state_bytes, xrp((int64_t)(h->state_entries * opt.owner_reserve)));
+    if (h->details_short)
+        printf("           EmitDetails overran the emit buffer by %u bytes on %llu emits\n",
+               h->details_short_bytes, (unsigned long long)h->details_short);
+    for (int i = 0; i < 5 && i < EMU_REASONS_MAX && h->reasons[i].count; i++)
+        printf("           %8llu x %s\n", (unsigned long long)h->reasons[i].count, h->reasons[i].message);
+}
+
+static void print_summary(uint32_t* emitted, uint32_t ledgers, int64_t hold_start, int64_t hold_min,
+                          uint32_t hold_min_hour)
+{
+    const emu_totals* t = emu_get_totals();
+    static const char* RESULTS[4] = { "applied", "rejected", "unfunded", "malformed" };
+
+    printf("DRIPPY economy simulation: %.0f hours, %u ledgers of %us, seed %llu\n", opt.hours, ledgers,
+           opt.ledger_secs, (unsigned long long)opt.seed);
+    printf("\nTraffic\n");
+    printf("  trades %llu  native fees %llu  accruals %llu  boosts %llu  claims %llu (%llu paid)\n",
+           (unsigned long long)counts.trades, (unsigned long long)counts.xrp_fees,
+           (unsigned long long)counts.accruals, (unsigned long long)counts.boosts,
+           (unsigned long long)counts.claims, (unsigned long long)counts.claims_ok);
+    printf("  originating:");
+    for (int i = 0; i < 4; i++)
+        printf(" %s %llu", RESULTS[i], (unsigned long long)t->applied[i]);
+    printf("\n  emitted:    ");
+    for (int i = 0; i < 4; i++)
+        printf(" %s %llu", RESULTS[i], (unsigned long long)t->emitted_applied[i]);
+    printf("\n");
+
+    qsort(emitted, ledgers, sizeof(*emitted), compare_u32);
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < ledgers; i++)
+        sum += emitted[i];
+    printf("\nEmitted transactions per ledger\n");
+    printf("  mean %.2f  p50 %u  p99 %u  max %u\n", (double)sum / ledgers, emitted[ledgers / 2],
+           emitted[(uint32_t)(ledgers * 0.99)], emitted[ledgers - 1]);
+
+    printf("\nHooks (%llu executions)\n", (unsigned long long)t->hook_runs);
+    print_hook(utility);
+    print_hook(router);
+    print_hook(claim);
+
+    printf("\nFees\n");
+    printf("  originating %.6f XRP  emitted %.6f XRP (issuer %.6f, treasury %.6f, hold pool %.6f)\n",
+           xrp((int64_t)t->fees_origin), xrp((int64_t)t->fees_emitted),
+           xrp((int64_t)emu_account_find(issuer)->fees_paid), xrp((int64_t)emu_account_find(treasury)->fees_paid),
+           xrp((int64_t)emu_account_find(pools[1])->fees_paid));
+    if (t->emitted_unfunded_drops)
+        printf("  emitted payments that found the sender short: %.6f XRP\n", xrp((int64_t)t->emitted_unfunded_drops));
+
+    printf("\nPools (XRP)\n");
+    printf("  hold     start %.6f  min %.6f (hour %u)  end %.6f\n", xrp(hold_start), xrp(hold_min),
+           hold_min_hour, xrp(balance(pools[1])));
+    for (int i = 0; i < 4; i++) {
+        if (i != 1)
+            printf("  %-8s end %.6f\n", POOL_NAMES[i], xrp(balance(pools[i])));
+    }
+    emu_account* tr = emu_account_find(treasury);
+    printf("  treasury end %.6f XRP, %.6f DRIPPY\n", xrp(tr->drops), tr->iou);
+}
+
+// ---- Main loop ---------------------------------------------------------------------
+
+static int simulate(void* unused)
+{
+    (void)unused;
+    emu_config config = {
+        .base_fee = opt.base_fee,
+        .hook_fee = opt.hook_fee,
+        .ledger_seq = 1000,
+        .close_time = SIM_START_TIME,
+        .ledger_interval = opt.ledger_secs,
+        .trace = opt.trace,
+    };
+    emu_init(&config);
+    rng_state = opt.seed * 0x9E3779B97F4A7C15ULL + 1;
+    setup();
+
+    FILE* csv = opt.csv ? fopen(opt.csv, "w") : 0;
+    FILE* ledger_csv = opt.ledger_csv ? fopen(opt.ledger_csv, "w") : 0;
+    if ((opt.csv && !csv) || (opt.ledger_csv && !ledger_csv)) {
+        perror("drippy_sim");
+        return 1;
+    }
+    if (csv)
+        write_csv_header(csv);
+    if (ledger_csv)
+        fprintf(ledger_csv, "ledger,transactions,hook_runs,emitted_applied,emitted_queued,rejected\n");
+
+    uint32_t per_hour = 3600 / opt.ledger_secs;
+    uint32_t ledgers = (uint32_t)(opt.hours * per_hour);
+    uint32_t* emitted = calloc(ledgers ? ledgers : 1, sizeof(*emitted));
+    wave_claim* wave = calloc(opt.traders, sizeof(*wave));
+    uint32_t wave_count = 0, wave_next = 0;
+    double per_ledger = (double)opt.ledger_secs / 3600;
+    uint32_t wave_start = opt.claim_wave_start ? opt.claim_wave_start
+                          : opt.claim_wave_hours > 24 ? opt.claim_wave_hours - 24 : opt.claim_wave_hours;
+
+    int64_t hold_start = balance(pools[1]), hold_min = hold_start;
+    uint32_t hold_min_hour = 0;
+    emu_ledger_stats hour_stats = { 0 };
+
+    for (uint32_t l = 0; l < ledgers; l++) {
+        uint32_t hour = l / per_hour;
+        emu_ledger_begin();
+
+        if (l == 0) {
+            for (uint32_t i = 0; i < opt.traders; i++) {
+                if (rng_uniform() < opt.boost_share) {
+                    submit_admin(traders[i], "BOOST", opt.boost_mult);
+                    counts.boosts++;
+                }
+            }
+        }
+
+        if (l % per_hour == 0 && hour > 0) {
+            if (opt.accrue_hours && hour % opt.accrue_hours == 0)
+                accrue();
+            if (opt.claim_wave_hours && hour >= wave_start && (hour - wave_start) % opt.claim_wave_hours == 0) {
+                wave_count = wave_next = 0;
+                uint32_t spread = (uint32_t)(opt.claim_wave_spread * per_hour);
+                for (uint32_t i = 0; i < opt.traders; i++) {
+                    if (rng_uniform() < opt.claim_wave_share)
+                        wave[wave_count++] = (wave_claim){ l + (spread ? rng_below(spread) : 0), i };
+                }
+                qsort(wave, wave_count, sizeof(*wave), compare_wave);
+            }
+        }
+
+        for (uint32_t n = rng_poisson(opt.trades_per_hour * per_ledger); n > 0; n--)
+            submit_trade();
+        for (uint32_t n = rng_poisson(opt.xrp_fees_per_hour * per_ledger); n > 0; n--)
+            submit_xrp_fee();
+        for (uint32_t n = rng_poisson(opt.claims_per_hour * per_ledger); n > 0; n--)
+            submit_claim(rng_below(opt.traders));
+        for (; wave_next < wave_count && wave[wave_next].ledger == l; wave_next++)
+            submit_claim(wave[wave_next].holder);
+
+        const emu_ledger_stats* s = emu_ledger_close();
+        emitted[l] = s->emitted_applied;
+        if (ledger_csv)
+            fprintf(ledger_csv, "%u,%u,%u,%u,%u,%u\n", s->seq, s->transactions, s->hook_runs,
+                    s->emitted_applied, s->emitted_queued, s->rejected);
+
+        hour_stats.transactions += s->transactions;
+        hour_stats.emitted_applied += s->emitted_applied;
+        hour_stats.rejected += s->rejected;
+        if (balance(pools[1]) < hold_min) {
+            hold_min = balance(pools[1]);
+            hold_min_hour = hour;
+        }
+        if ((l + 1) % per_hour == 0 || l + 1 == ledgers) {
+            if (csv)
+                write_csv_row(csv, hour, &hour_stats);
+            memset(&hour_stats, 0, sizeof(hour_stats));
+            memset(&hour_counts, 0, sizeof(hour_counts));
+        }
+    }
+
+    if (csv)
+        fclose(csv);
+    if (ledger_csv)
+        fclose(ledger_csv);
+    if (ledgers)
+        print_summary(emitted, ledgers, hold_start, hold_min, hold_min_hour);
+
+    free(emitted);
+    free(wave);
+    free(traders);
+    free(weights);
+    emu_free();
+    return 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: drippy_sim [options]\n"
+            "  --seed N               PRNG seed (1)\n"
+            "  --hours H              simulated hours (168)\n"
+            "  --ledger-secs S        seconds per ledger (4)\n"
+            "  --base-fee D           drops per transaction (10)\n"
+            "  --hook-fee D           drops per hook execution (10)\n"
+            "  --owner-reserve D      drops per state entry in the reserve estimate (200000)\n"
+            "  --traders N            traders, who are also the holders (500)\n"
+            "  --trades-per-hour R    DRIPPY trades through the issuer (1000)\n"
+            "  --buy-share F          share of trades that are buys (0.55)\n"
+            "  --trade-mean U         mean trade size in DRIPPY (5000)\n"
+            "  --trade-dist exp|fixed|pareto  trade size distribution (exp)\n"
+            "  --xrp-fees-per-hour R  native fee payments to the treasury (30)\n"
+            "  --xrp-fee-mean X       mean native fee in XRP (25)\n"
+            "  --pool-xrp X           hold pool balance at the start (100000)\n"
+            "  --fee-flush U          utility FEE_FLUSH in DRIPPY (hook default 1000)\n"
+            "  --accrue-hours H       hours between admin accruals (24, 0 = none)\n"
+            "  --accrue-ratio F       share of the hold pool inflow accrued (1.0)\n"
+            "  --boost-share F        holders given a BOOST at the start (0.1)\n"
+            "  --boost-mult M         their multiplier, 100 = 1x (150)\n"
+            "  --claims-per-hour R    background claims (5)\n"
+            "  --claim-wave-hours H   hours between claim waves (168, 0 = none)\n"
+            "  --claim-wave-start H   hour of the first wave (claim-wave-hours - 24)\n"
+            "  --claim-wave-share F   holders claiming in a wave (0.6)\n"
+            "  --claim-wave-spread H  hours a wave is spread over (6)\n"
+            "  --claim-cooldown S     claim hook COOLD in seconds (unset)\n"
+            "  --claim-max D          claim hook MAXP in drops (unset)\n"
+            "  --csv FILE             hourly series\n"
+            "  --ledger-csv FILE      per-ledger load\n"
+            "  --trace                print hook traces to stderr\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (strcmp(a, "--trace") == 0) {
+            opt.trace = 1;
+            continue;
+        }
+        if (i + 1 >= argc)
+            usage();
+        const char* v = argv[++i];
+
+        if (strcmp(a, "--seed") == 0) opt.seed = strtoull(v, 0, 10);
+        else if (strcmp(a, "--hours") == 0) opt.hours = atof(v);
+        else if (strcmp(a, "--ledger-secs") == 0) opt.ledger_secs = (uint32_t)atoi(v);
+        else if (strcmp(a, "--base-fee") == 0) opt.base_fee = strtoull(v, 0, 10);
+        else if (strcmp(a, "--hook-fee") == 0) opt.hook_fee = strtoull(v, 0, 10);
+        else if (strcmp(a, "--owner-reserve") == 0) opt.owner_reserve = strtoull(v, 0, 10);
+        else if (strcmp(a, "--traders") == 0) opt.traders = (uint32_t)atoi(v);
+        else if (strcmp(a, "--trades-per-hour") == 0) opt.trades_per_hour = atof(v);
+        else if (strcmp(a, "--buy-share") == 0) opt.buy_share = atof(v);
+        else if (strcmp(a, "--trade-mean") == 0) opt.trade_mean = atof(v);
+        else if (strcmp(a, "--trade-dist") == 0) {
+            if (strcmp(v, "exp") == 0) opt.trade_dist = DIST_EXP;
+            else if (strcmp(v, "fixed") == 0) opt.trade_dist = DIST_FIXED;
+            else if (strcmp(v, "pareto") == 0) opt.trade_dist = DIST_PARETO;
+            else usage();
+        }
+        else if (strcmp(a, "--xrp-fees-per-hour") == 0) opt.xrp_fees_per_hour = atof(v);
+        else if (strcmp(a, "--xrp-fee-mean") == 0) opt.xrp_fee_mean = atof(v);
+        else if (strcmp(a, "--pool-xrp") == 0) opt.pool_xrp = atof(v);
+        else if (strcmp(a, "--fee-flush") == 0) opt.fee_flush = atof(v);
+        else if (strcmp(a, "--accrue-hours") == 0) opt.accrue_hours = (uint32_t)atoi(v);
+        else if (strcmp(a, "--accrue-ratio") == 0) opt.accrue_ratio = atof(v);
+        else if (strcmp(a, "--boost-share") == 0) opt.boost_share = atof(v);
+        else if (strcmp(a, "--boost-mult") == 0) opt.boost_mult = (uint32_t)atoi(v);
+        else if (strcmp(a, "--claims-per-hour") == 0) opt.claims_per_hour = atof(v);
+        else if (strcmp(a, "--claim-wave-hours") == 0) opt.claim_wave_hours = (uint32_t)atoi(v);
+        else if (strcmp(a, "--claim-wave-start") == 0) opt.claim_wave_start = (uint32_t)atoi(v);
+        else if (strcmp(a, "--claim-wave-share") == 0) opt.claim_wave_share = atof(v);
+        else if (strcmp(a, "--claim-wave-spread") == 0) opt.claim_wave_spread = atof(v);
+        else if (strcmp(a, "--claim-cooldown") == 0) opt.claim_cooldown = strtoull(v, 0, 10);
+        else if (strcmp(a, "--claim-max") == 0) opt.claim_max = strtoull(v, 0, 10);
+        else if (strcmp(a, "--csv") == 0) opt.csv = v;
+        else if (strcmp(a, "--ledger-csv") == 0) opt.ledger_csv = v;
+        else usage();
+    }
+    if (!opt.ledger_secs || opt.ledger_secs > 3600 || !opt.traders)
+        usage();
+
+    return emu_run(simulate, 0) == 0 ? 0 : 1;
+}
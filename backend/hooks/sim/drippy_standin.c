@@ -0,0 +1,332 @@
+// DRIPPY stand-in ledger: the hook emulator (hookemu.h) as a child process of the local
+// Xahau stand-in node (backend/src/standin-node.js)
+//
+// The node keeps the parts of the ledger the emulator does not model (Sequence, Tickets,
+// ledger history) and sends the rest here over stdin; every request gets one reply on
+// stdout. Integers are big-endian.
+//   request    u8 op, u32 payload length, payload
+//   reply      u32 payload length, payload
+//
+//   1 HOOK     as in the replay corpus (drippy_replay.c): installs a hook; empty reply
+//   2 ACCOUNT  account[20], i64 drops: adds drops (negative to charge a fee), creating
+//              the account; replies i64 balance
+//   3 STATE    as in the replay corpus: writes a state entry; empty reply
+//   8 SUBMIT   blob: applies a Payment to the open ledger; replies its event
+//   9 LEDGER   u32 sequence, u32 parent close time: closes the open ledger and opens this
+//              one, which applies the transactions emitted in the last; replies their
+//              events
+//  10 ENTRIES  account[20]: replies u32 count, then per state entry of the account's
+//              hook key[32], u16 length, data
+//
+// Balances only change through ACCOUNT, SUBMIT and LEDGER, whose replies carry them, so
+// the node mirrors them without asking.
+//
+// Event, one per transaction applied:
+//   u8 result (EMU_*), u8 emitted, u64 fee charged, u16 length, blob,
+//   u8 accounts (0 when malformed, else 2): account[20], i64 balance after (sender,
+//   destination), u8 hook runs: account[20], u8 accepted, u16 emitted,
+//   u64 guard iterations, u8 length, return string, u16 state changes: account[20],
+//   key[32], u8 deleted, u16 length, data
+//
+// Build from backend/hooks: make standin
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hookemu.h"
+
+// Hook objects are renamed by the Makefile: hook -> sim_<name>_hook, .data -> sim_<name>_data
+#define SIM_HOOK(name, arg_t) \
+    int64_t sim_##name##_hook(arg_t reserved); \
+    extern uint8_t __start_sim_##name##_data[] __attribute__((weak)); \
+    extern uint8_t __stop_sim_##name##_data[] __attribute__((weak)); \
+    static int64_t name##_entry(void) { return sim_##name##_hook(0); }
+
+SIM_HOOK(utility, uint32_t)
+SIM_HOOK(router, int64_t)
+SIM_HOOK(claim, int64_t)
+
+#define SIM_HOOK_ENTRY(name) { #name, name##_entry, __start_sim_##name##_data, __stop_sim_##name##_data }
+
+static const struct {
+    const char* name;
+    emu_entry entry;
+    uint8_t* data_start;
+    uint8_t* data_end;
+} sim_hooks[] = {
+    SIM_HOOK_ENTRY(utility),
+    SIM_HOOK_ENTRY(router),
+    SIM_HOOK_ENTRY(claim),
+};
+
+enum {
+    OP_HOOK = 1,
+    OP_ACCOUNT = 2,
+    OP_STATE = 3,
+    OP_SUBMIT = 8,
+    OP_LEDGER = 9,
+    OP_ENTRIES = 10,
+};
+
+#define REQUEST_MAX (1 << 20)
+
+static struct {
+    uint64_t base_fee;
+    uint64_t hook_fee;
+    int trace;
+} opt = {
+    .base_fee = 10,
+    .hook_fee = 10,
+};
+
+// ---- Reply buffer ------------------------------------------------------------------
+
+static struct {
+    uint8_t* p;
+    size_t len;
+    size_t capacity;
+} out;
+
+static void put(const void* data, size_t n)
+{
+    if (out.len + n > out.capacity) {
+        while (out.len + n > out.capacity)
+            out.capacity = out.capacity ? out.capacity * 2 : 65536;
+        out.p = realloc(out.p, out.capacity);
+    }
+    memcpy(out.p + out.len, data, n);
+    out.len += n;
+}
+
+static void put_be(uint64_t v, size_t n)
+{
+    uint8_t b[8];
+    for (size_t i = 0; i < n; i++)
+        b[i] = (uint8_t)(v >> (8 * (n - 1 - i)));
+    put(b, n);
+}
+
+static void reply(void)
+{
+    uint8_t len[4] = { (uint8_t)(out.len >> 24), (uint8_t)(out.len >> 16), (uint8_t)(out.len >> 8), (uint8_t)out.len };
+    fwrite(len, 1, 4, stdout);
+    fwrite(out.p, 1, out.len, stdout);
+    fflush(stdout);
+    out.len = 0;
+}
+
+// ---- Requests ----------------------------------------------------------------------
+
+static uint64_t get_be(const uint8_t* p, size_t n)
+{
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; i++)
+        v = v << 8 | p[i];
+    return v;
+}
+
+static void fail(const char* what)
+{
+    fprintf(stderr, "drippy_standin: %s\n", what);
+    exit(1);
+}
+
+static void install_hook(const uint8_t* p, uint32_t len)
+{
+    const uint8_t* end = p + len;
+    if (len < 21 || len < 21u + p[20] + 2)
+        fail("short HOOK request");
+    const uint8_t* account = p;
+    uint32_t name_len = p[20];
+    const uint8_t* name = p + 21;
+    p += 21 + name_len;
+
+    emu_hook* h = 0;
+    for (size_t i = 0; i < sizeof(sim_hooks) / sizeof(sim_hooks[0]); i++) {
+        if (strlen(sim_hooks[i].name) == name_len && memcmp(sim_hooks[i].name, name, name_len) == 0)
+            h = emu_hook_install(sim_hooks[i].name, account, sim_hooks[i].entry, sim_hooks[i].data_start,
+                                 sim_hooks[i].data_end);
+    }
+    if (!h)
+        fail("HOOK names a hook this build does not have");
+    // Every hook exports cbak, so a node adds the callback account to EmitDetails
+    h->has_callback = 1;
+
+    uint32_t count = (uint32_t)get_be(p, 2);
+    p += 2;
+    for (uint32_t i = 0; i < count; i++) {
+        char pname[33];
+        if (p >= end || p[0] > 32 || end - p < 1 + p[0] + 2)
+            fail("bad HOOK parameter");
+        uint32_t plen = p[0];
+        memcpy(pname, p + 1, plen);
+        pname[plen] = 0;
+        p += 1 + plen;
+        uint32_t vlen = (uint32_t)get_be(p, 2);
+        p += 2;
+        if ((uint32_t)(end - p) < vlen)
+            fail("bad HOOK parameter");
+        emu_hook_param(h, pname, p, vlen);
+        p += vlen;
+    }
+}
+
+static void put_event(const uint8_t* blob, uint32_t len, int emitted, void* arg)
+{
+    (void)arg;
+    const emu_report* rep = emu_last_report();
+    put_be((uint64_t)rep->result, 1);
+    put_be((uint64_t)emitted, 1);
+    put_be(rep->fee, 8);
+    put_be(len, 2);
+    put(blob, len);
+
+    put_be(rep->from ? 2 : 0, 1);
+    if (rep->from) {
+        put(rep->from->id, 20);
+        put_be((uint64_t)rep->from->drops, 8);
+        put(rep->to->id, 20);
+        put_be((uint64_t)rep->to->drops, 8);
+    }
+
+    put_be(rep->run_count, 1);
+    for (uint32_t i = 0; i < rep->run_count; i++) {
+        const emu_run_report* r = &rep->runs[i];
+        size_t mlen = strlen(r->message);
+        put(r->hook->account, 20);
+        put_be((uint64_t)r->accepted, 1);
+        put_be(r->emitted, 2);
+        put_be(r->guard_iterations, 8);
+        put_be(mlen, 1);
+        put(r->message, mlen);
+    }
+
+    put_be(rep->state_count, 2);
+    for (uint32_t i = 0; i < rep->state_count; i++) {
+        const emu_hook* h;
+        const uint8_t *key, *data;
+        uint32_t dlen;
+        emu_report_state(i, &h, &key, &data, &dlen);
+        put(h->account, 20);
+        put(key, 32);
+        put_be(data ? 0 : 1, 1);
+        put_be(data ? dlen : 0, 2);
+        if (data)
+            put(data, dlen);
+    }
+}
+
+static void put_entries(const emu_hook* h)
+{
+    put_be(h ? h->state_entries : 0, 4);
+    for (uint32_t i = 0; h && i < h->state_capacity; i++) {
+        const uint8_t *key, *data;
+        uint32_t len;
+        if (!emu_hook_state_at(h, i, &key, &data, &len))
+            continue;
+        put(key, 32);
+        put_be(len, 2);
+        put(data, len);
+    }
+}
+
+static int serve(void* unused)
+{
+    (void)unused;
+    emu_config config = {
+        .base_fee = opt.base_fee,
+        .hook_fee = opt.hook_fee,
+        .ledger_interval = 4,
+        .trace = opt.trace,
+    };
+    emu_init(&config);
+    emu_observe(put_event, 0);
+
+    uint8_t* buf = malloc(REQUEST_MAX);
+    uint8_t head[5];
+    int open = 0;
+    while (fread(head, 1, 5, stdin) == 5) {
+        uint32_t len = (uint32_t)get_be(head + 1, 4);
+        if (len > REQUEST_MAX)
+            fail("request too large");
+        if (fread(buf, 1, len, stdin) != len)
+            fail("short request");
+
+        switch (head[0]) {
+        case OP_HOOK:
+            install_hook(buf, len);
+            break;
+        case OP_ACCOUNT:
+            if (len < 28)
+                fail("short ACCOUNT request");
+            put_be((uint64_t)emu_account_add(buf, (int64_t)get_be(buf + 20, 8))->drops, 8);
+            break;
+        case OP_STATE: {
+            emu_account* a = len >= 54 ? emu_account_find(buf) : 0;
+            uint32_t dlen = len >= 54 ? (uint32_t)get_be(buf + 52, 2) : 0;
+            if (!a || !a->hook || dlen > EMU_STATE_MAX || len < 54 + dlen)
+                fail("bad STATE request");
+            emu_hook_state_set(a->hook, buf + 20, buf + 54, dlen);
+            break;
+        }
+        case OP_SUBMIT:
+            if (!open)
+                fail("SUBMIT before the first LEDGER");
+            emu_submit(buf, len);
+            break;
+        case OP_LEDGER:
+            if (len < 8)
+                fail("short LEDGER request");
+            if (open)
+                emu_ledger_close();
+            emu_ledger_set((uint32_t)get_be(buf, 4), (uint32_t)get_be(buf + 4, 4));
+            emu_ledger_begin();
+            open = 1;
+            break;
+        case OP_ENTRIES: {
+            emu_account* a = len >= 20 ? emu_account_find(buf) : 0;
+            put_entries(a ? a->hook : 0);
+            break;
+        }
+        default:
+            fail("unknown request");
+        }
+        reply();
+    }
+
+    free(buf);
+    free(out.p);
+    emu_free();
+    return 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: drippy_standin [options]   (requests on stdin, see the top of drippy_standin.c)\n"
+            "  --base-fee D           drops per transaction (10)\n"
+            "  --hook-fee D           drops per hook execution (10)\n"
+            "  --trace                print hook traces to stderr\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (strcmp(a, "--trace") == 0) {
+            opt.trace = 1;
+            continue;
+        }
+        if (i + 1 >= argc)
+            usage();
+        const char* v = argv[++i];
+
+        if (strcmp(a, "--base-fee") == 0) opt.base_fee = strtoull(v, 0, 10);
+        else if (strcmp(a, "--hook-fee") == 0) opt.hook_fee = strtoull(v, 0, 10);
+        else usage();
+    }
+
+    return emu_run(serve, 0) == 0 ? 0 : 1;
+}
@@ -0,0 +1,1580 @@
+// Hook API emulator: host functions, ledger and transaction processing (see hookemu.h)
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include "hookapi.h"
+#include "hookemu.h"
+
+#define EMU_PTR(p) ((uint8_t*)(uintptr_t)(p))
+
+#define EMU_SLOTS 256
+#define EMU_GUARDS 64
+#define EMU_JOURNAL_MAX 1024
+#define EMU_EMIT_MAX 256
+#define EMU_MAX_GENERATION 10
+#define EMU_STACK_SIZE (8U << 20)
+#define EMU_DETAILS_SIZE 116      // EmitDetails without the callback account
+#define EMU_CALLBACK_SIZE 22
+
+#define LOW_4G(p) ((uintptr_t)(p) <= UINT32_MAX)
+
+enum { SLOT_EMPTY = 0, SLOT_OBJECT, SLOT_ARRAY, SLOT_LEAF };
+
+struct emu_param {
+    uint8_t name[32];
+    uint32_t name_len;
+    uint8_t value[256];
+    uint32_t len;
+};
+
+struct emu_state {
+    uint8_t key[32];
+    uint8_t used;             // 0 empty, 1 live, 2 deleted
+    uint16_t len;
+    uint8_t data[EMU_STATE_MAX];
+};
+
+typedef struct {
+    emu_hook* hook;
+    uint8_t key[32];
+    int deleted;
+    uint16_t len;
+    uint8_t data[EMU_STATE_MAX];
+} journal_entry;
+
+typedef struct {
+    uint8_t blob[EMU_TXN_MAX];
+    uint32_t len;
+    uint32_t generation;
+    emu_hook* hook;
+} queued_txn;
+
+typedef struct {
+    queued_txn* items;
+    uint32_t count;
+    uint32_t capacity;
+} txn_queue;
+
+typedef struct {
+    const uint8_t* data;
+    uint32_t len;
+    int kind;
+} slot_entry;
+
+typedef struct {
+    uint8_t key[32];
+    uint32_t len;
+    uint8_t data[EMU_OBJECT_MAX];
+} ledger_object;
+
+// Fields of a Payment the ledger acts on
+typedef struct {
+    uint16_t type;
+    const uint8_t* account;
+    const uint8_t* destination;
+    const uint8_t* amount;
+    uint32_t amount_len;
+    uint64_t fee;
+} txn_fields;
+
+static emu_config config;
+static emu_totals totals;
+static emu_ledger_stats ledger;
+static uint32_t ledger_seq_now;
+static uint32_t close_time_now;
+
+static emu_account** accounts;      // open addressing on the account id
+static uint32_t account_capacity;
+static uint32_t account_count;
+
+static emu_hook* hooks[16];
+static uint32_t hook_count;
+
+// Few objects are added (by tests), so they are searched in order
+static ledger_object* objects;
+static uint32_t object_count;
+
+static txn_queue queue_now, queue_next;
+
+// Changes of the transaction being applied, committed when every hook accepts
+static journal_entry journal[EMU_JOURNAL_MAX];
+static uint32_t journal_count;
+static queued_txn pending_emits[EMU_EMIT_MAX];
+static uint32_t pending_count;
+static emu_report report;
+static emu_observer observer;
+static void* observer_arg;
+static uint32_t report_state[EMU_JOURNAL_MAX];   // journal entries that changed state
+
+// The hook execution in progress
+static struct {
+    emu_hook* hook;
+    const uint8_t* otxn;
+    uint32_t otxn_len;
+    uint32_t generation;
+    uint8_t otxn_id[32];
+
+    jmp_buf exit;
+    int rolled_back;
+    char message[EMU_MESSAGE_MAX];
+
+    slot_entry slots[EMU_SLOTS];
+    struct { uint32_t id, count; } guards[EMU_GUARDS];
+    uint32_t guard_count;
+    uint64_t guard_total;
+
+    int64_t reserved;         // -1 until etxn_reserve
+    uint32_t emitted;
+    uint32_t nonce;
+    uint8_t* details_ptr;     // etxn_details output, written once the buffer is known
+} run;
+
+// ---- SHA-512 -----------------------------------------------------------------------
+
+static const uint64_t sha512_k[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+#define ROTR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+static void sha512_block(uint64_t h[8], const uint8_t* block)
+{
+    uint64_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = 0;
+        for (int j = 0; j < 8; j++)
+            w[i] = w[i] << 8 | block[i * 8 + j];
+    }
+    for (int i = 16; i < 80; i++) {
+        uint64_t s0 = ROTR64(w[i - 15], 1) ^ ROTR64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+        uint64_t s1 = ROTR64(w[i - 2], 19) ^ ROTR64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint64_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+    for (int i = 0; i < 80; i++) {
+        uint64_t t1 = k + (ROTR64(e, 14) ^ ROTR64(e, 18) ^ ROTR64(e, 41)) + ((e & f) ^ (~e & g)) +
+                      sha512_k[i] + w[i];
+        uint64_t t2 = (ROTR64(a, 28) ^ ROTR64(a, 34) ^ ROTR64(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+        k = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+    h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+}
+
+// First half of SHA-512, the hash the ledger uses for ids
+void emu_sha512h(uint8_t out[32], const uint8_t* data, uint32_t len)
+{
+    uint64_t h[8] = {
+        0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+        0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+    };
+    uint8_t block[128];
+    uint32_t done = 0;
+    for (; len - done >= 128; done += 128)
+        sha512_block(h, data + done);
+
+    uint32_t rest = len - done;
+    memset(block, 0, sizeof(block));
+    memcpy(block, data + done, rest);
+    block[rest] = 0x80;
+    if (rest >= 112) {
+        sha512_block(h, block);
+        memset(block, 0, sizeof(block));
+    }
+    uint64_t bits = (uint64_t)len * 8;
+    for (int i = 0; i < 8; i++)
+        block[127 - i] = (uint8_t)(bits >> (8 * i));
+    sha512_block(h, block);
+
+    for (int i = 0; i < 32; i++)
+        out[i] = (uint8_t)(h[i / 8] >> (56 - 8 * (i % 8)));
+}
+
+// ---- Addresses ---------------------------------------------------------------------
+
+static const char B58_ALPHABET[] = "rpshnaf39wBUDNEGHJKLM4PQRST7VWXYZ2bcdeCg65jkm8oFqi1tuvAxyz";
+
+// Classic address to account id; the checksum is not verified
+int emu_decode_address(uint8_t out[20], const char* address)
+{
+    uint8_t bytes[25] = { 0 };
+    size_t n = strlen(address);
+    if (n < 25 || n > 35)
+        return 0;
+
+    for (size_t i = 0; i < n; i++) {
+        const char* at = strchr(B58_ALPHABET, address[i]);
+        if (!at || !*at)
+            return 0;
+        uint32_t carry = (uint32_t)(at - B58_ALPHABET);
+        for (int j = 24; j >= 0; j--) {
+            carry += (uint32_t)bytes[j] * 58;
+            bytes[j] = (uint8_t)carry;
+            carry >>= 8;
+        }
+        if (carry)
+            return 0;
+    }
+    if (bytes[0] != 0)
+        return 0;
+    memcpy(out, bytes + 1, 20);
+    return 1;
+}
+
+// ---- Serialization -----------------------------------------------------------------
+
+uint32_t emu_field_header(uint8_t* out, uint32_t field_code)
+{
+    uint32_t type = field_code >> 16, field = field_code & 0xFFFF;
+    if (type < 16 && field < 16) {
+        out[0] = (uint8_t)(type << 4 | field);
+        return 1;
+    }
+    if (type < 16) {
+        out[0] = (uint8_t)(type << 4);
+        out[1] = (uint8_t)field;
+        return 2;
+    }
+    if (field < 16) {
+        out[0] = (uint8_t)field;
+        out[1] = (uint8_t)type;
+        return 2;
+    }
+    out[0] = 0;
+    out[1] = (uint8_t)type;
+    out[2] = (uint8_t)field;
+    return 3;
+}
+
+static uint32_t put_vl(uint8_t* out, uint32_t len)
+{
+    if (len <= 192) {
+        out[0] = (uint8_t)len;
+        return 1;
+    }
+    len -= 193;
+    out[0] = (uint8_t)(193 + (len >> 8));
+    out[1] = (uint8_t)len;
+    return 2;
+}
+
+static const uint8_t* skip_object(const uint8_t* p, const uint8_t* end, uint8_t marker);
+
+// Reads one field at p; returns the position after it, or 0 when malformed.
+// Objects and arrays yield their contents; a missing end marker ends them at `end`.
+static const uint8_t* read_field(const uint8_t* p, const uint8_t* end, uint32_t* field_code,
+                                 const uint8_t** value, uint32_t* value_len)
+{
+    if (p >= end)
+        return 0;
+    uint32_t type = p[0] >> 4, field = p[0] & 0xF;
+    p++;
+    if (type == 0) {
+        if (p >= end)
+            return 0;
+        type = *p++;
+    }
+    if (field == 0) {
+        if (p >= end)
+            return 0;
+        field = *p++;
+    }
+    *field_code = type << 16 | field;
+
+    uint32_t len;
+    switch (type) {
+    case 1: len = 2; break;
+    case 2: len = 4; break;
+    case 3: len = 8; break;
+    case 4: len = 16; break;
+    case 5: len = 32; break;
+    case 6: len = (p < end && (p[0] & 0x80)) ? 48 : 8; break;
+    case 16: len = 1; break;
+    case 17: len = 20; break;
+    case 7: case 8: case 19:
+        if (p >= end)
+            return 0;
+        len = *p++;
+        if (len > 192) {
+            if (p >= end)
+                return 0;
+            len = 193 + ((len - 193) << 8) + *p++;
+        }
+        break;
+    case 14: case 15: {
+        const uint8_t* close = skip_object(p, end, type == 14 ? 0xE1 : 0xF1);
+        if (!close)
+            return 0;
+        *value = p;
+        *value_len = (uint32_t)(close - p);
+        return close < end ? close + 1 : close;
+    }
+    default:
+        return 0;
+    }
+
+    if ((uint32_t)(end - p) < len)
+        return 0;
+    *value = p;
+    *value_len = len;
+    return p + len;
+}
+
+// Position of the end marker of the object or array starting at p (or `end`)
+static const uint8_t* skip_object(const uint8_t* p, const uint8_t* end, uint8_t marker)
+{
+    while (p < end && *p != marker) {
+        uint32_t code, len;
+        const uint8_t* value;
+        p = read_field(p, end, &code, &value, &len);
+        if (!p)
+            return 0;
+    }
+    return p;
+}
+
+static int find_field(const uint8_t* obj, uint32_t len, uint32_t field_code,
+                      const uint8_t** value, uint32_t* value_len)
+{
+    const uint8_t* p = obj;
+    const uint8_t* end = obj + len;
+    while (p && p < end) {
+        uint32_t code;
+        p = read_field(p, end, &code, value, value_len);
+        if (p && code == field_code)
+            return 1;
+    }
+    return 0;
+}
+
+static int parse_txn(const uint8_t* blob, uint32_t len, txn_fields* t)
+{
+    const uint8_t* v;
+    uint32_t n;
+    memset(t, 0, sizeof(*t));
+
+    if (!find_field(blob, len, sfTransactionType, &v, &n))
+        return 0;
+    t->type = (uint16_t)(v[0] << 8 | v[1]);
+    if (!find_field(blob, len, sfAccount, &t->account, &n) || n != 20)
+        return 0;
+    if (!find_field(blob, len, sfDestination, &t->destination, &n) || n != 20)
+        return 0;
+    if (!find_field(blob, len, sfAmount, &t->amount, &t->amount_len))
+        return 0;
+    if (!find_field(blob, len, sfFee, &v, &n) || n != 8 || (v[0] & 0x80))
+        return 0;
+    for (uint32_t i = 0; i < 8; i++)
+        t->fee = t->fee << 8 | v[i];
+    t->fee &= 0x3FFFFFFFFFFFFFFFULL;
+    return 1;
+}
+
+static uint64_t amount_drops(const uint8_t* amount)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+        v = v << 8 | amount[i];
+    return v & 0x3FFFFFFFFFFFFFFFULL;
+}
+
+void emu_amount_drops(uint8_t out[8], uint64_t drops)
+{
+    drops |= 1ULL << 62;
+    for (int i = 0; i < 8; i++)
+        out[i] = (uint8_t)(drops >> (56 - 8 * i));
+}
+
+// Copies through the stack so callers may pass heap buffers (float_sto takes 32-bit pointers)
+void emu_amount_iou(uint8_t out[48], int64_t xfl, const uint8_t currency[20], const uint8_t issuer[20])
+{
+    uint8_t amount[48], cur[20], iss[20];
+    memcpy(cur, currency, 20);
+    memcpy(iss, issuer, 20);
+    float_sto((uint32_t)(uintptr_t)amount, 48, (uint32_t)(uintptr_t)cur, 20,
+              (uint32_t)(uintptr_t)iss, 20, xfl, 0);
+    memcpy(out, amount, 48);
+}
+
+uint32_t emu_payment(uint8_t* out, const uint8_t from[20], const uint8_t to[20],
+                     const uint8_t* amount, uint32_t amount_len,
+                     const emu_memo* memos, uint32_t memo_count)
+{
+    return emu_payment_flags(out, from, to, amount, amount_len, 0, memos, memo_count);
+}
+
+uint32_t emu_payment_flags(uint8_t* out, const uint8_t from[20], const uint8_t to[20],
+                           const uint8_t* amount, uint32_t amount_len, uint32_t flags,
+                           const emu_memo* memos, uint32_t memo_count)
+{
+    uint8_t* p = out;
+    uint8_t amount_fee[8];
+
+    // Canonical order: type code, then field code
+    p += emu_field_header(p, sfTransactionType);
+    *p++ = 0;
+    *p++ = ttPAYMENT;
+    if (flags) {
+        p += emu_field_header(p, sfFlags);
+        for (int i = 0; i < 4; i++)
+            *p++ = (uint8_t)(flags >> (24 - 8 * i));
+    }
+    p += emu_field_header(p, sfAmount);
+    memcpy(p, amount, amount_len);
+    p += amount_len;
+    emu_amount_drops(amount_fee, config.base_fee);
+    p += emu_field_header(p, sfFee);
+    memcpy(p, amount_fee, 8);
+    p += 8;
+    p += emu_field_header(p, sfAccount);
+    *p++ = 20;
+    memcpy(p, from, 20);
+    p += 20;
+    p += emu_field_header(p, sfDestination);
+    *p++ = 20;
+    memcpy(p, to, 20);
+    p += 20;
+
+    if (memo_count) {
+        p += emu_field_header(p, sfMemos);
+        for (uint32_t i = 0; i < memo_count; i++) {
+            uint32_t type_len = (uint32_t)strlen(memos[i].type);
+            p += emu_field_header(p, sfMemo);
+            p += emu_field_header(p, sfMemoType);
+            p += put_vl(p, type_len);
+            memcpy(p, memos[i].type, type_len);
+            p += type_len;
+            if (memos[i].data_len) {
+                p += emu_field_header(p, sfMemoData);
+                p += put_vl(p, memos[i].data_len);
+                memcpy(p, memos[i].data, memos[i].data_len);
+                p += memos[i].data_len;
+            }
+            *p++ = 0xE1;
+        }
+        *p++ = 0xF1;
+    }
+    return (uint32_t)(p - out);
+}
+
+uint32_t emu_uri_token(uint8_t* out, const uint8_t owner[20], const uint8_t issuer[20],
+                       const uint8_t digest[32])
+{
+    uint8_t* p = out;
+
+    // Canonical order: type code, then field code
+    p += emu_field_header(p, sfLedgerEntryType);
+    *p++ = 0;
+    *p++ = 0x55;              // ltURI_TOKEN
+    p += emu_field_header(p, sfFlags);
+    memset(p, 0, 4);
+    p += 4;
+    p += emu_field_header(p, sfDigest);
+    memcpy(p, digest, 32);
+    p += 32;
+    p += emu_field_header(p, sfOwner);
+    *p++ = 20;
+    memcpy(p, owner, 20);
+    p += 20;
+    p += emu_field_header(p, sfIssuer);
+    *p++ = 20;
+    memcpy(p, issuer, 20);
+    p += 20;
+    return (uint32_t)(p - out);
+}
+
+// ---- Accounts, hooks and state -----------------------------------------------------
+
+static uint64_t id_hash(const uint8_t* id, uint32_t len)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (uint32_t i = 0; i < len; i++)
+        h = (h ^ id[i]) * 0x100000001b3ULL;
+    return h ^ (h >> 29);
+}
+
+static void accounts_grow(void)
+{
+    uint32_t old_capacity = account_capacity;
+    emu_account** old = accounts;
+    account_capacity = old_capacity ? old_capacity * 2 : 1024;
+    accounts = calloc(account_capacity, sizeof(*accounts));
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (!old[i])
+            continue;
+        uint32_t at = (uint32_t)id_hash(old[i]->id, 20) & (account_capacity - 1);
+        while (accounts[at])
+            at = (at + 1) & (account_capacity - 1);
+        accounts[at] = old[i];
+    }
+    free(old);
+}
+
+emu_account* emu_account_find(const uint8_t id[20])
+{
+    if (!account_capacity)
+        return 0;
+    uint32_t at = (uint32_t)id_hash(id, 20) & (account_capacity - 1);
+    while (accounts[at]) {
+        if (memcmp(accounts[at]->id, id, 20) == 0)
+            return accounts[at];
+        at = (at + 1) & (account_capacity - 1);
+    }
+    return 0;
+}
+
+emu_account* emu_account_add(const uint8_t id[20], int64_t drops)
+{
+    emu_account* a = emu_account_find(id);
+    if (a) {
+        a->drops += drops;
+        return a;
+    }
+    if ((account_count + 1) * 2 > account_capacity)
+        accounts_grow();
+
+    a = calloc(1, sizeof(*a));
+    memcpy(a->id, id, 20);
+    a->drops = drops;
+    uint32_t at = (uint32_t)id_hash(id, 20) & (account_capacity - 1);
+    while (accounts[at])
+        at = (at + 1) & (account_capacity - 1);
+    accounts[at] = a;
+    account_count++;
+    return a;
+}
+
+emu_hook* emu_hook_install(const char* name, const uint8_t account[20], emu_entry entry,
+                           uint8_t* data_start, uint8_t* data_end)
+{
+    if (!LOW_4G(entry) || !LOW_4G(data_end)) {
+        fprintf(stderr, "hookemu: %s is linked above 4 GB, link with -no-pie\n", name);
+        abort();
+    }
+    if (hook_count == sizeof(hooks) / sizeof(hooks[0])) {
+        fprintf(stderr, "hookemu: too many hooks\n");
+        abort();
+    }
+
+    emu_hook* h = calloc(1, sizeof(*h));
+    h->name = name;
+    memcpy(h->account, account, 20);
+    h->entry = entry;
+    h->data_start = data_start;
+    h->data_end = data_end;
+    h->initial = malloc((size_t)(data_end - data_start) + 1);
+    memcpy(h->initial, data_start, (size_t)(data_end - data_start));
+    h->state_capacity = 1024;
+    h->state = calloc(h->state_capacity, sizeof(*h->state));
+    hooks[hook_count++] = h;
+
+    emu_account_add(account, 0)->hook = h;
+    return h;
+}
+
+void emu_hook_param(emu_hook* hook, const char* name, const void* value, uint32_t len)
+{
+    uint32_t name_len = (uint32_t)strlen(name);
+    if (name_len > 32 || len > 256) {
+        fprintf(stderr, "hookemu: parameter %s too long\n", name);
+        abort();
+    }
+    hook->params = realloc(hook->params, (hook->param_count + 1) * sizeof(*hook->params));
+    struct emu_param* p = &hook->params[hook->param_count++];
+    memcpy(p->name, name, name_len);
+    p->name_len = name_len;
+    memcpy(p->value, value, len);
+    p->len = len;
+}
+
+static ledger_object* object_find(const uint8_t key[32])
+{
+    for (uint32_t i = 0; i < object_count; i++) {
+        if (memcmp(objects[i].key, key, 32) == 0)
+            return &objects[i];
+    }
+    return 0;
+}
+
+void emu_object_set(const uint8_t key[32], const uint8_t* data, uint32_t len)
+{
+    if (len > EMU_OBJECT_MAX) {
+        fprintf(stderr, "hookemu: ledger object too long\n");
+        abort();
+    }
+    ledger_object* o = object_find(key);
+    if (!o) {
+        objects = realloc(objects, (object_count + 1) * sizeof(*objects));
+        o = &objects[object_count++];
+        memcpy(o->key, key, 32);
+    }
+    memcpy(o->data, data, len);
+    o->len = len;
+}
+
+static struct emu_state* state_find(const emu_hook* h, const uint8_t key[32], int for_insert)
+{
+    uint32_t mask = h->state_capacity - 1;
+    uint32_t at = (uint32_t)id_hash(key, 32) & mask;
+    struct emu_state* reuse = 0;
+    for (;; at = (at + 1) & mask) {
+        struct emu_state* s = &h->state[at];
+        if (s->used == 0)
+            return for_insert ? (reuse ? reuse : s) : 0;
+        if (s->used == 2) {
+            if (!reuse)
+                reuse = s;
+            continue;
+        }
+        if (memcmp(s->key, key, 32) == 0)
+            return s;
+    }
+}
+
+static void state_grow(emu_hook* h)
+{
+    struct emu_state* old = h->state;
+    uint32_t old_capacity = h->state_capacity;
+    h->state_capacity = old_capacity * 2;
+    h->state = calloc(h->state_capacity, sizeof(*h->state));
+    h->state_used = 0;
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (old[i].used != 1)
+            continue;
+        *state_find(h, old[i].key, 1) = old[i];
+        h->state_used++;
+    }
+    free(old);
+}
+
+// Returns whether the stored state changed; writing the value already there does not
+static int state_commit(emu_hook* h, const journal_entry* j)
+{
+    struct emu_state* s = state_find(h, j->key, 0);
+    if (j->deleted) {
+        if (!s)
+            return 0;
+        s->used = 2;
+        h->state_entries--;
+        h->state_bytes -= s->len;
+        return 1;
+    }
+    if (s && s->len == j->len && memcmp(s->data, j->data, j->len) == 0)
+        return 0;
+    if (!s) {
+        if ((h->state_used + 1) * 10 > h->state_capacity * 7)
+            state_grow(h);
+        s = state_find(h, j->key, 1);
+        if (s->used == 0)
+            h->state_used++;
+        memcpy(s->key, j->key, 32);
+        s->used = 1;
+        s->len = 0;
+        h->state_entries++;
+    }
+    h->state_bytes += (uint64_t)j->len - s->len;
+    s->len = j->len;
+    memcpy(s->data, j->data, j->len);
+    return 1;
+}
+
+int emu_hook_state(const emu_hook* hook, const uint8_t key[32], uint8_t* out, uint32_t* len)
+{
+    struct emu_state* s = state_find(hook, key, 0);
+    if (!s)
+        return 0;
+    memcpy(out, s->data, s->len);
+    *len = s->len;
+    return 1;
+}
+
+int emu_hook_state_at(const emu_hook* hook, uint32_t i, const uint8_t** key, const uint8_t** data,
+                      uint32_t* len)
+{
+    const struct emu_state* s = &hook->state[i];
+    if (s->used != 1)
+        return 0;
+    *key = s->key;
+    *data = s->data;
+    *len = s->len;
+    return 1;
+}
+
+void emu_hook_state_set(emu_hook* hook, const uint8_t key[32], const uint8_t* data, uint32_t len)
+{
+    journal_entry j;
+    if (len > EMU_STATE_MAX) {
+        fprintf(stderr, "hookemu: state entry of %u bytes\n", len);
+        abort();
+    }
+    j.hook = hook;
+    memcpy(j.key, key, 32);
+    j.deleted = len == 0;
+    j.len = (uint16_t)len;
+    if (len)
+        memcpy(j.data, data, len);
+    state_commit(hook, &j);
+}
+
+// ---- Execution ---------------------------------------------------------------------
+
+static void count_reason(emu_hook* h, const char* message)
+{
+    int i;
+    for (i = 0; i < EMU_REASONS_MAX && h->reasons[i].count; i++) {
+        if (strcmp(h->reasons[i].message, message) == 0)
+            break;
+    }
+    if (i == EMU_REASONS_MAX) {
+        // Table full: the least frequent entry collects the rest
+        i = EMU_REASONS_MAX - 1;
+        snprintf(h->reasons[i].message, EMU_MESSAGE_MAX, "(other)");
+    } else if (!h->reasons[i].count) {
+        snprintf(h->reasons[i].message, EMU_MESSAGE_MAX, "%s", message);
+    }
+    h->reasons[i].count++;
+
+    // Keep the table ordered by count
+    while (i > 0 && h->reasons[i].count > h->reasons[i - 1].count) {
+        emu_reason t = h->reasons[i];
+        h->reasons[i] = h->reasons[i - 1];
+        h->reasons[i - 1] = t;
+        i--;
+    }
+}
+
+static void set_message(uint32_t ptr, uint32_t len)
+{
+    if (len >= EMU_MESSAGE_MAX)
+        len = EMU_MESSAGE_MAX - 1;
+    if (ptr)
+        memcpy(run.message, EMU_PTR(ptr), len);
+    else
+        len = 0;
+    run.message[len] = 0;
+}
+
+static int run_hook(emu_hook* h, const uint8_t* blob, uint32_t len, uint32_t generation,
+                    const uint8_t txid[32])
+{
+    uint8_t probe;
+    if (!LOW_4G(&probe)) {
+        fprintf(stderr, "hookemu: hooks must run inside emu_run()\n");
+        abort();
+    }
+
+    run.hook = h;
+    run.otxn = blob;
+    run.otxn_len = len;
+    run.generation = generation;
+    memcpy(run.otxn_id, txid, 32);
+    run.rolled_back = 0;
+    run.message[0] = 0;
+    memset(run.slots, 0, sizeof(run.slots));
+    run.guard_count = 0;
+    run.guard_total = 0;
+    run.reserved = -1;
+    run.emitted = 0;
+    run.nonce = 0;
+    run.details_ptr = 0;
+
+    // A fresh instance: globals back to their initial values
+    memcpy(h->data_start, h->initial, (size_t)(h->data_end - h->data_start));
+
+    h->runs++;
+    totals.hook_runs++;
+    ledger.hook_runs++;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (setjmp(run.exit) == 0) {
+        h->entry();
+        snprintf(run.message, EMU_MESSAGE_MAX, "returned without accept");
+        run.rolled_back = 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    emu_run_report* r = &report.runs[report.run_count++];
+    r->hook = h;
+    r->accepted = !run.rolled_back;
+    memcpy(r->message, run.message, EMU_MESSAGE_MAX);
+    r->guard_iterations = run.guard_total;
+    r->nanos = (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000u + (uint64_t)t1.tv_nsec - (uint64_t)t0.tv_nsec;
+    r->emitted = run.emitted;
+
+    if (run.guard_total > h->guard_max)
+        h->guard_max = run.guard_total;
+    if (run.rolled_back) {
+        h->rollbacks++;
+        count_reason(h, run.message);
+        return 0;
+    }
+    h->accepts++;
+    return 1;
+}
+
+static void queue_push(txn_queue* q, const queued_txn* t)
+{
+    if (q->count == q->capacity) {
+        q->capacity = q->capacity ? q->capacity * 2 : 256;
+        q->items = realloc(q->items, q->capacity * sizeof(*q->items));
+    }
+    q->items[q->count++] = *t;
+}
+
+static int apply_txn(const uint8_t* blob, uint32_t len, uint32_t generation, int emitted)
+{
+    txn_fields t;
+    memset(&report, 0, sizeof(report));
+    if (len > EMU_TXN_MAX || !parse_txn(blob, len, &t) || t.type != ttPAYMENT)
+        return EMU_MALFORMED;
+
+    emu_account* from = emu_account_find(t.account);
+    if (!from)
+        return EMU_MALFORMED;
+    emu_account* to = emu_account_add(t.destination, 0);
+    report.from = from;
+    report.to = to;
+
+    if (from->drops < (int64_t)t.fee)
+        return EMU_UNFUNDED;
+    from->drops -= (int64_t)t.fee;
+    report.fee = t.fee;
+    from->fees_paid += t.fee;
+    if (emitted)
+        totals.fees_emitted += t.fee;
+    else
+        totals.fees_origin += t.fee;
+
+    int native = t.amount_len == 8;
+    uint64_t drops = native ? amount_drops(t.amount) : 0;
+    if (native && from->drops < (int64_t)drops) {
+        if (emitted)
+            totals.emitted_unfunded_drops += drops;
+        return EMU_UNFUNDED;
+    }
+
+    uint8_t txid[32];
+    emu_sha512h(txid, blob, len);
+    journal_count = 0;
+    pending_count = 0;
+
+    int ok = 1;
+    if (from->hook)
+        ok = run_hook(from->hook, blob, len, generation, txid);
+    if (ok && to != from && to->hook)
+        ok = run_hook(to->hook, blob, len, generation, txid);
+    if (!ok)
+        return EMU_REJECTED;
+
+    report.emit_count = pending_count;
+    for (uint32_t i = 0; i < journal_count; i++) {
+        if (state_commit(journal[i].hook, &journal[i]))
+            report_state[report.state_count++] = i;
+    }
+    for (uint32_t i = 0; i < pending_count; i++) {
+        pending_emits[i].hook->emitted++;
+        queue_push(&queue_next, &pending_emits[i]);
+    }
+
+    if (native) {
+        from->drops -= (int64_t)drops;
+        to->drops += (int64_t)drops;
+    } else {
+        // Issued currency: the issuer mints and burns, everyone else transfers
+        uint8_t amount[48];
+        memcpy(amount, t.amount, 48);
+        double units = emu_xfl_to_units(float_sto_set((uint32_t)(uintptr_t)amount, 48));
+        const uint8_t* issuer = t.amount + 28;
+        if (memcmp(issuer, from->id, 20) != 0)
+            from->iou -= units;
+        if (memcmp(issuer, to->id, 20) != 0)
+            to->iou += units;
+    }
+    return EMU_SUCCESS;
+}
+
+int emu_submit(const uint8_t* blob, uint32_t len)
+{
+    int result = apply_txn(blob, len, 0, 0);
+    report.result = result;
+    if (observer)
+        observer(blob, len, 0, observer_arg);
+    totals.applied[result]++;
+    ledger.transactions++;
+    if (result == EMU_REJECTED)
+        ledger.rejected++;
+    return result;
+}
+
+void emu_ledger_begin(void)
+{
+    memset(&ledger, 0, sizeof(ledger));
+    ledger.seq = ledger_seq_now;
+
+    txn_queue t = queue_now;
+    queue_now = queue_next;
+    queue_next = t;
+    queue_next.count = 0;
+
+    for (uint32_t i = 0; i < queue_now.count; i++) {
+        queued_txn* q = &queue_now.items[i];
+        int result = apply_txn(q->blob, q->len, q->generation, 1);
+        report.result = result;
+        if (observer)
+            observer(q->blob, q->len, 1, observer_arg);
+        totals.emitted_applied[result]++;
+        ledger.emitted_applied++;
+        if (result == EMU_REJECTED)
+            ledger.rejected++;
+    }
+}
+
+const emu_ledger_stats* emu_ledger_close(void)
+{
+    ledger.emitted_queued = queue_next.count;
+    ledger_seq_now++;
+    close_time_now += config.ledger_interval;
+    return &ledger;
+}
+
+const emu_report* emu_last_report(void) { return &report; }
+
+void emu_observe(emu_observer fn, void* arg)
+{
+    observer = fn;
+    observer_arg = arg;
+}
+
+void emu_report_state(uint32_t i, const emu_hook** hook, const uint8_t** key,
+                      const uint8_t** data, uint32_t* len)
+{
+    const journal_entry* j = &journal[report_state[i]];
+    *hook = j->hook;
+    *key = j->key;
+    *data = j->deleted ? 0 : j->data;
+    *len = j->len;
+}
+
+const uint8_t* emu_report_emit(uint32_t i, uint32_t* len)
+{
+    *len = pending_emits[i].len;
+    return pending_emits[i].blob;
+}
+
+uint32_t emu_txn_strip(uint8_t* out, const uint8_t* blob, uint32_t len)
+{
+    const uint8_t* p = blob;
+    const uint8_t* end = blob + len;
+    uint32_t n = 0;
+    while (p < end) {
+        uint32_t code, value_len;
+        const uint8_t* value;
+        const uint8_t* next = read_field(p, end, &code, &value, &value_len);
+        if (!next)
+            return 0;
+        if (code != (6 << 16 | 8) && code != (14 << 16 | 13)) {
+            memcpy(out + n, p, (size_t)(next - p));
+            n += (uint32_t)(next - p);
+        }
+        p = next;
+    }
+    return n;
+}
+
+void emu_ledger_set(uint32_t seq, uint32_t close_time)
+{
+    ledger_seq_now = seq;
+    close_time_now = close_time;
+}
+
+uint32_t emu_ledger_seq(void) { return ledger_seq_now; }
+uint32_t emu_close_time(void) { return close_time_now; }
+const emu_totals* emu_get_totals(void) { return &totals; }
+
+void emu_init(const emu_config* c)
+{
+    config = *c;
+    ledger_seq_now = c->ledger_seq;
+    close_time_now = c->close_time;
+    memset(&totals, 0, sizeof(totals));
+}
+
+void emu_free(void)
+{
+    for (uint32_t i = 0; i < account_capacity; i++)
+        free(accounts[i]);
+    free(accounts);
+    accounts = 0;
+    account_capacity = account_count = 0;
+
+    for (uint32_t i = 0; i < hook_count; i++) {
+        free(hooks[i]->initial);
+        free(hooks[i]->params);
+        free(hooks[i]->state);
+        free(hooks[i]);
+    }
+    hook_count = 0;
+
+    free(objects);
+    objects = 0;
+    object_count = 0;
+
+    free(queue_now.items);
+    free(queue_next.items);
+    memset(&queue_now, 0, sizeof(queue_now));
+    memset(&queue_next, 0, sizeof(queue_next));
+}
+
+typedef struct {
+    int (*fn)(void*);
+    void* arg;
+    int result;
+} run_args;
+
+static void* run_thread(void* p)
+{
+    run_args* a = p;
+    a->result = a->fn(a->arg);
+    return 0;
+}
+
+int emu_run(int (*fn)(void*), void* arg)
+{
+    void* stack = mmap(0, EMU_STACK_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT | MAP_NORESERVE, -1, 0);
+    if (stack == MAP_FAILED || !LOW_4G((uint8_t*)stack + EMU_STACK_SIZE)) {
+        fprintf(stderr, "hookemu: no stack below 4 GB\n");
+        return -1;
+    }
+
+    pthread_attr_t attr;
+    pthread_t thread;
+    run_args a = { fn, arg, -1 };
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, EMU_STACK_SIZE);
+    if (pthread_create(&thread, &attr, run_thread, &a) == 0)
+        pthread_join(thread, 0);
+    pthread_attr_destroy(&attr);
+    munmap(stack, EMU_STACK_SIZE);
+    return a.result;
+}
+
+// ---- Host functions ----------------------------------------------------------------
+
+int32_t _g(uint32_t id, uint32_t maxiter)
+{
+    uint32_t i;
+    for (i = 0; i < run.guard_count; i++) {
+        if (run.guards[i].id == id)
+            break;
+    }
+    if (i == run.guard_count) {
+        if (run.guard_count == EMU_GUARDS)
+            i = EMU_GUARDS - 1;
+        else
+            run.guard_count++;
+        run.guards[i].id = id;
+        run.guards[i].count = 0;
+    }
+    run.guard_total++;
+    if (++run.guards[i].count > maxiter) {
+        // GUARD ids are (1 << 31) + __LINE__
+        snprintf(run.message, EMU_MESSAGE_MAX, "guard violation (line %u)", id & 0x7FFFFFFF);
+        run.rolled_back = 1;
+        longjmp(run.exit, 1);
+    }
+    return 1;
+}
+
+int64_t accept(uint32_t read_ptr, uint32_t read_len, int64_t error_code)
+{
+    (void)error_code;
+    set_message(read_ptr, read_len);
+    run.rolled_back = 0;
+    longjmp(run.exit, 1);
+}
+
+int64_t rollback(uint32_t read_ptr, uint32_t read_len, int64_t error_code)
+{
+    (void)error_code;
+    set_message(read_ptr, read_len);
+    run.rolled_back = 1;
+    longjmp(run.exit, 1);
+}
+
+int64_t hook_account(uint32_t write_ptr, uint32_t write_len)
+{
+    if (write_len < 20)
+        return TOO_SMALL;
+    memcpy(EMU_PTR(write_ptr), run.hook->account, 20);
+    return 20;
+}
+
+int64_t hook_param(uint32_t write_ptr, uint32_t write_len, uint32_t read_ptr, uint32_t read_len)
+{
+    if (read_len == 0)
+        return TOO_SMALL;
+    if (read_len > 32)
+        return TOO_BIG;
+    for (uint32_t i = 0; i < run.hook->param_count; i++) {
+        struct emu_param* p = &run.hook->params[i];
+        if (p->name_len != read_len || memcmp(p->name, EMU_PTR(read_ptr), read_len) != 0)
+            continue;
+        if (write_len < p->len)
+            return TOO_SMALL;
+        memcpy(EMU_PTR(write_ptr), p->value, p->len);
+        return p->len;
+    }
+    return DOESNT_EXIST;
+}
+
+int64_t ledger_seq(void)
+{
+    return ledger_seq_now;
+}
+
+int64_t ledger_last_time(void)
+{
+    return close_time_now;
+}
+
+int64_t otxn_type(void)
+{
+    const uint8_t* v;
+    uint32_t n;
+    if (!find_field(run.otxn, run.otxn_len, sfTransactionType, &v, &n))
+        return INVALID_TXN;
+    return v[0] << 8 | v[1];
+}
+
+int64_t otxn_field(uint32_t write_ptr, uint32_t write_len, uint32_t field_id)
+{
+    const uint8_t* v;
+    uint32_t n;
+    if (!find_field(run.otxn, run.otxn_len, field_id, &v, &n))
+        return DOESNT_EXIST;
+    if (write_len < n)
+        return TOO_SMALL;
+    memcpy(EMU_PTR(write_ptr), v, n);
+    return n;
+}
+
+static int64_t slot_alloc(uint32_t slot_no)
+{
+    if (slot_no >= EMU_SLOTS)
+        return INVALID_ARGUMENT;
+    if (slot_no)
+        return slot_no;
+    for (uint32_t i = 1; i < EMU_SLOTS; i++) {
+        if (run.slots[i].kind == SLOT_EMPTY)
+            return i;
+    }
+    return NO_FREE_SLOTS;
+}
+
+static int slot_kind(uint32_t field_code)
+{
+    uint32_t type = field_code >> 16;
+    return type == 14 ? SLOT_OBJECT : type == 15 ? SLOT_ARRAY : SLOT_LEAF;
+}
+
+int64_t otxn_slot(uint32_t slot_no)
+{
+    int64_t s = slot_alloc(slot_no);
+    if (s < 0)
+        return s;
+    run.slots[s] = (slot_entry){ run.otxn, run.otxn_len, SLOT_OBJECT };
+    return s;
+}
+
+int64_t slot(uint32_t write_ptr, uint32_t write_len, uint32_t slot_no)
+{
+    if (slot_no >= EMU_SLOTS || run.slots[slot_no].kind == SLOT_EMPTY)
+        return DOESNT_EXIST;
+    slot_entry* s = &run.slots[slot_no];
+    if (!write_ptr)
+        return s->len;
+    if (write_len < s->len)
+        return TOO_SMALL;
+    memcpy(EMU_PTR(write_ptr), s->data, s->len);
+    return s->len;
+}
+
+int64_t slot_subfield(uint32_t parent_slot, uint32_t field_id, uint32_t new_slot)
+{
+    if (parent_slot >= EMU_SLOTS || run.slots[parent_slot].kind == SLOT_EMPTY)
+        return DOESNT_EXIST;
+    slot_entry* parent = &run.slots[parent_slot];
+    if (parent->kind != SLOT_OBJECT)
+        return NOT_AN_OBJECT;
+
+    const uint8_t* v;
+    uint32_t n;
+    if (!find_field(parent->data, parent->len, field_id, &v, &n))
+        return DOESNT_EXIST;
+
+    int64_t s = slot_alloc(new_slot);
+    if (s < 0)
+        return s;
+    run.slots[s] = (slot_entry){ v, n, slot_kind(field_id) };
+    return s;
+}
+
+// An array element is slotted whole (header and all), so slot_subfield(element, sfMemo)
+// reaches the inner object the way the hooks read memos
+int64_t slot_subarray(uint32_t parent_slot, uint32_t array_id, uint32_t new_slot)
+{
+    if (parent_slot >= EMU_SLOTS || run.slots[parent_slot].kind == SLOT_EMPTY)
+        return DOESNT_EXIST;
+    slot_entry* parent = &run.slots[parent_slot];
+    if (parent->kind != SLOT_ARRAY)
+        return NOT_AN_ARRAY;
+
+    const uint8_t* p = parent->data;
+    const uint8_t* end = parent->data + parent->len;
+    for (uint32_t i = 0; p && p < end; i++) {
+        uint32_t code, n;
+        const uint8_t* v;
+        const uint8_t* next = read_field(p, end, &code, &v, &n);
+        if (!next)
+            break;
+        if (i == array_id) {
+            int64_t s = slot_alloc(new_slot);
+            if (s < 0)
+                return s;
+            run.slots[s] = (slot_entry){ p, (uint32_t)(next - p), SLOT_OBJECT };
+            return s;
+        }
+        p = next;
+    }
+    return DOESNT_EXIST;
+}
+
+// Only the objects added with emu_object_set exist; a keylet is looked up by its key
+int64_t slot_set(uint32_t read_ptr, uint32_t read_len, uint32_t slot_no)
+{
+    if (read_len != 32 && read_len != 34)
+        return INVALID_ARGUMENT;
+    if (slot_no >= EMU_SLOTS)
+        return INVALID_ARGUMENT;
+    const ledger_object* o = object_find(EMU_PTR(read_ptr) + read_len - 32);
+    if (!o)
+        return DOESNT_EXIST;
+
+    int64_t s = slot_alloc(slot_no);
+    if (s < 0)
+        return s;
+    run.slots[s] = (slot_entry){ o->data, o->len, SLOT_OBJECT };
+    return s;
+}
+
+int64_t util_keylet(uint32_t write_ptr, uint32_t write_len, uint32_t keylet_type,
+                    uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t e, uint32_t f)
+{
+    (void)c; (void)d; (void)e; (void)f;
+    if (write_len < 34)
+        return TOO_SMALL;
+    if (keylet_type != KEYLET_UNCHECKED || b != 32)
+        return INVALID_ARGUMENT;
+    uint8_t* out = EMU_PTR(write_ptr);
+    out[0] = 0;
+    out[1] = 0;
+    memcpy(out + 2, EMU_PTR(a), 32);
+    return 34;
+}
+
+int64_t util_accid(uint32_t write_ptr, uint32_t write_len, uint32_t read_ptr, uint32_t read_len)
+{
+    char address[40];
+    if (write_len < 20)
+        return TOO_SMALL;
+    if (read_len >= sizeof(address))
+        return TOO_BIG;
+    memcpy(address, EMU_PTR(read_ptr), read_len);
+    address[read_len] = 0;
+    if (!emu_decode_address(EMU_PTR(write_ptr), address))
+        return INVALID_ARGUMENT;
+    return 20;
+}
+
+int64_t util_sha512h(uint32_t write_ptr, uint32_t write_len, uint32_t read_ptr, uint32_t read_len)
+{
+    if (write_len < 32)
+        return TOO_SMALL;
+    emu_sha512h(EMU_PTR(write_ptr), EMU_PTR(read_ptr), read_len);
+    return 32;
+}
+
+static void pad_key(uint8_t key[32], uint32_t ptr, uint32_t len)
+{
+    memset(key, 0, 32);
+    memcpy(key + 32 - len, EMU_PTR(ptr), len);
+}
+
+static journal_entry* journal_find(const emu_hook* h, const uint8_t key[32])
+{
+    for (uint32_t i = journal_count; i-- > 0;) {
+        if (journal[i].hook == h && memcmp(journal[i].key, key, 32) == 0)
+            return &journal[i];
+    }
+    return 0;
+}
+
+int64_t state(uint32_t write_ptr, uint32_t write_len, uint32_t kread_ptr, uint32_t kread_len)
+{
+    uint8_t key[32];
+    if (kread_len == 0 || kread_len > 32)
+        return INVALID_ARGUMENT;
+    pad_key(key, kread_ptr, kread_len);
+
+    const uint8_t* data;
+    uint32_t len;
+    journal_entry* j = journal_find(run.hook, key);
+    if (j) {
+        if (j->deleted)
+            return DOESNT_EXIST;
+        data = j->data;
+        len = j->len;
+    } else {
+        struct emu_state* s = state_find(run.hook, key, 0);
+        if (!s)
+            return DOESNT_EXIST;
+        data = s->data;
+        len = s->len;
+    }
+
+    if (write_len < len)
+        return TOO_SMALL;
+    memcpy(EMU_PTR(write_ptr), data, len);
+    return len;
+}
+
+int64_t state_set(uint32_t read_ptr, uint32_t read_len, uint32_t kread_ptr, uint32_t kread_len)
+{
+    uint8_t key[32];
+    if (kread_len == 0 || kread_len > 32)
+        return INVALID_ARGUMENT;
+    if (read_len > EMU_STATE_MAX)
+        return TOO_BIG;
+    pad_key(key, kread_ptr, kread_len);
+
+    journal_entry* j = journal_find(run.hook, key);
+    if (!j) {
+        if (journal_count == EMU_JOURNAL_MAX)
+            return TOO_BIG;
+        j = &journal[journal_count++];
+        j->hook = run.hook;
+        memcpy(j->key, key, 32);
+    }
+    j->deleted = read_ptr == 0 || read_len == 0;
+    j->len = (uint16_t)(j->deleted ? 0 : read_len);
+    memcpy(j->data, EMU_PTR(read_ptr), j->len);
+    return j->len;
+}
+
+int64_t etxn_reserve(uint32_t count)
+{
+    if (run.reserved >= 0)
+        return ALREADY_SET;
+    if (count > 255)
+        return TOO_BIG;
+    run.reserved = count;
+    return count;
+}
+
+static uint32_t details_size(void)
+{
+    return EMU_DETAILS_SIZE + (run.hook->has_callback ? EMU_CALLBACK_SIZE : 0);
+}
+
+// Writes the EmitDetails a node produces, clipped to the emit buffer that holds it;
+// a clipped write is counted, on a node those bytes land past the buffer
+static void write_details(uint8_t* out, uint32_t avail)
+{
+    uint8_t d[EMU_DETAILS_SIZE + EMU_CALLBACK_SIZE];
+    uint8_t seed[56];
+    uint32_t n = 0;
+
+    d[n++] = 0xED;
+    d[n++] = 0x20;
+    d[n++] = 0x2E;
+    uint32_t generation = run.generation + 1;
+    for (int i = 0; i < 4; i++)
+        d[n++] = (uint8_t)(generation >> (24 - 8 * i));
+    d[n++] = 0x3D;
+    for (int i = 0; i < 7; i++)
+        d[n++] = 0;
+    d[n++] = 1;
+    d[n++] = 0x5B;
+    memcpy(d + n, run.otxn_id, 32);
+    n += 32;
+    d[n++] = 0x5C;
+    memcpy(seed, run.otxn_id, 32);
+    memcpy(seed + 32, run.hook->account, 20);
+    memcpy(seed + 52, &run.nonce, 4);
+    run.nonce++;
+    emu_sha512h(d + n, seed, sizeof(seed));
+    n += 32;
+    d[n++] = 0x5D;
+    emu_sha512h(d + n, (const uint8_t*)run.hook->name, (uint32_t)strlen(run.hook->name));
+    n += 32;
+    if (run.hook->has_callback) {
+        d[n++] = 0x8A;
+        d[n++] = 0x14;
+        memcpy(d + n, run.hook->account, 20);
+        n += 20;
+    }
+    d[n++] = 0xE1;
+
+    if (avail < n) {
+        run.hook->details_short++;
+        if (n - avail > run.hook->details_short_bytes)
+            run.hook->details_short_bytes = n - avail;
+    }
+    memcpy(out, d, avail < n ? avail : n);
+}
+
+// The hooks pass the whole emit buffer as write_len, so the details are written when
+// the buffer bounds are known: at etxn_fee_base or emit
+int64_t etxn_details(uint32_t write_ptr, uint32_t write_len)
+{
+    if (run.reserved < 0)
+        return PREREQUISITE_NOT_MET;
+    if (write_len < details_size())
+        return TOO_SMALL;
+    run.details_ptr = EMU_PTR(write_ptr);
+    return details_size();
+}
+
+static void flush_details(uint8_t* blob, uint32_t len)
+{
+    if (!run.details_ptr)
+        return;
+    if (run.details_ptr >= blob && run.details_ptr < blob + len)
+        write_details(run.details_ptr, (uint32_t)(blob + len - run.details_ptr));
+    run.details_ptr = 0;
+}
+
+static uint64_t emitted_fee(const txn_fields* t)
+{
+    emu_account* to = emu_account_find(t->destination);
+    uint64_t runs = 1 + (to && to->hook && memcmp(t->destination, t->account, 20) != 0);
+    return config.base_fee + config.hook_fee * runs;
+}
+
+int64_t etxn_fee_base(uint32_t read_ptr, uint32_t read_len)
+{
+    uint8_t* blob = EMU_PTR(read_ptr);
+    flush_details(blob, read_len);
+
+    const uint8_t* dest;
+    uint32_t n;
+    if (!find_field(blob, read_len, sfDestination, &dest, &n) || n != 20)
+        return config.base_fee + config.hook_fee;
+
+    txn_fields t = { 0 };
+    t.account = run.hook->account;
+    t.destination = dest;
+    return emitted_fee(&t);
+}
+
+int64_t emit(uint32_t write_ptr, uint32_t write_len, uint32_t read_ptr, uint32_t read_len)
+{
+    uint8_t* blob = EMU_PTR(read_ptr);
+    flush_details(blob, read_len);
+
+    if (run.reserved < 0)
+        return PREREQUISITE_NOT_MET;
+    if (run.emitted >= run.reserved || pending_count == EMU_EMIT_MAX)
+        return TOO_MANY_EMITTED_TXN;
+    if (write_len < 32)
+        return TOO_SMALL;
+    if (read_len > EMU_TXN_MAX)
+        return TOO_BIG;
+    if (run.generation + 1 > EMU_MAX_GENERATION)
+        return EMISSION_FAILURE;
+
+    txn_fields t;
+    if (!parse_txn(blob, read_len, &t) || memcmp(t.account, run.hook->account, 20) != 0)
+        return EMISSION_FAILURE;
+    if (t.fee < emitted_fee(&t))
+        return EMISSION_FAILURE;
+
+    queued_txn* q = &pending_emits[pending_count++];
+    memcpy(q->blob, blob, read_len);
+    q->len = read_len;
+    q->generation = run.generation + 1;
+    q->hook = run.hook;
+    run.emitted++;
+
+    emu_sha512h(EMU_PTR(write_ptr), blob, read_len);
+    return 32;
+}
+
+int64_t trace(uint32_t mread_ptr, uint32_t mread_len, uint32_t dread_ptr, uint32_t dread_len,
+              uint32_t as_hex)
+{
+    if (!config.trace)
+        return 0;
+    fprintf(stderr, "[%s] %.*s: ", run.hook->name, (int)mread_len, (const char*)EMU_PTR(mread_ptr));
+    for (uint32_t i = 0; i < dread_len; i++) {
+        uint8_t c = EMU_PTR(dread_ptr)[i];
+        if (as_hex)
+            fprintf(stderr, "%02X", c);
+        else if (c)
+            fputc(c, stderr);
+    }
+    fputc('\n', stderr);
+    return 0;
+}
+
+int64_t trace_num(uint32_t read_ptr, uint32_t read_len, int64_t number)
+{
+    if (config.trace)
+        fprintf(stderr, "[%s] %.*s: %lld\n", run.hook->name, (int)read_len,
+                (const char*)EMU_PTR(read_ptr), (long long)number);
+    return 0;
+}
+
+int64_t trace_float(uint32_t read_ptr, uint32_t read_len, int64_t float1)
+{
+    if (config.trace)
+        fprintf(stderr, "[%s] %.*s: %g\n", run.hook->name, (int)read_len,
+                (const char*)EMU_PTR(read_ptr), emu_xfl_to_units(float1));
+    return 0;
+}
@@ -0,0 +1,235 @@
+// Hook API emulator: runs the hooks compiled natively against an in-memory ledger
+//
+// The hooks are built with the host compiler instead of clang --target=wasm32 and call
+// the functions in hookemu.c and xfl.c in place of the Xahau host functions. What is
+// modelled:
+//   accounts   native balance (drops) and one issued-currency balance per account
+//   hooks      one hook per account, its HookParameters and its state (key -> value)
+//   payments   the hook on the sending account runs first, then the one on the
+//              destination; a rollback rejects the transaction and discards the state
+//              changes and emissions of both
+//   emission   etxn_reserve/etxn_details/etxn_fee_base/emit; emitted transactions are
+//              applied at the start of the next ledger, with their own hook runs
+//   guards     _g counts iterations per guard id and rolls back past the limit
+//   fees       base fee plus a fixed fee per hook the transaction runs (emu_config)
+//   objects    ledger entries added with emu_object_set (e.g. URITokens), which the
+//              hooks read through slot_set; transactions never change them
+//
+// Not modelled: account roots and other ledger objects nobody added (slot_set finds
+// nothing), trustline limits and issued-currency funding, paths, and the instruction
+// budget of a hook.
+//
+// Hook API pointers are 32-bit. Hook code and data must be linked below 4 GB (-no-pie)
+// and hooks run on a stack mapped there, so everything here runs inside emu_run().
+// Hook globals are restored from a snapshot before every execution, the way a wasm
+// instance starts fresh, so each hook's writable data has to be in a section of its
+// own (see the sim rules in the Makefile).
+
+#ifndef HOOKEMU_H
+#define HOOKEMU_H
+
+#include <stdint.h>
+
+#define EMU_TXN_MAX 1024
+#define EMU_STATE_MAX 256
+#define EMU_MESSAGE_MAX 64
+#define EMU_REASONS_MAX 16
+#define EMU_OBJECT_MAX 256
+
+typedef int64_t (*emu_entry)(void);
+
+typedef struct {
+    uint64_t base_fee;        // drops per transaction
+    uint64_t hook_fee;        // drops per hook the transaction runs
+    uint32_t ledger_seq;      // first ledger
+    uint32_t close_time;      // first ledger close time, seconds since the Ripple epoch
+    uint32_t ledger_interval; // seconds between ledgers
+    int trace;                // print trace/trace_num/trace_float to stderr
+} emu_config;
+
+typedef struct {
+    char message[EMU_MESSAGE_MAX];
+    uint64_t count;
+} emu_reason;
+
+typedef struct {
+    const char* name;
+    uint8_t account[20];
+    emu_entry entry;
+
+    // Hook globals, restored from `initial` before each run
+    uint8_t* data_start;
+    uint8_t* data_end;
+    uint8_t* initial;
+
+    struct emu_param* params;
+    uint32_t param_count;
+
+    struct emu_state* state;   // open addressing on the key
+    uint32_t state_capacity;
+    uint32_t state_used;       // live entries and tombstones
+    uint32_t state_entries;
+    uint64_t state_bytes;
+
+    // A node writes the callback account into EmitDetails when the hook exports cbak
+    int has_callback;
+    uint64_t details_short;    // emits whose buffer had no room for all of EmitDetails
+    uint32_t details_short_bytes;
+
+    uint64_t runs;
+    uint64_t accepts;
+    uint64_t rollbacks;
+    uint64_t emitted;
+    uint64_t guard_max;        // most guard iterations in one run
+    emu_reason reasons[EMU_REASONS_MAX];  // rollback messages, most frequent first
+} emu_hook;
+
+typedef struct {
+    uint8_t id[20];
+    int64_t drops;
+    double iou;               // issued-currency balance, in units
+    emu_hook* hook;
+    uint64_t fees_paid;
+} emu_account;
+
+typedef struct {
+    const char* type;
+    const uint8_t* data;
+    uint32_t data_len;
+} emu_memo;
+
+enum {
+    EMU_SUCCESS = 0,
+    EMU_REJECTED,             // a hook rolled back
+    EMU_UNFUNDED,             // fee or amount above the sender's balance
+    EMU_MALFORMED
+};
+
+typedef struct {
+    uint64_t applied[4];      // by result, originating transactions
+    uint64_t emitted_applied[4];
+    uint64_t hook_runs;
+    uint64_t fees_origin;     // drops paid by originating transactions
+    uint64_t fees_emitted;    // drops paid by hook accounts for emitted transactions
+    uint64_t emitted_unfunded_drops;
+} emu_totals;
+
+// One hook execution of the last transaction applied
+typedef struct {
+    const emu_hook* hook;
+    int accepted;
+    char message[EMU_MESSAGE_MAX];   // the accept or rollback string
+    uint64_t guard_iterations;
+    uint64_t nanos;                  // host time spent in the hook
+    uint32_t emitted;
+} emu_run_report;
+
+// What the last transaction applied did (see emu_last_report)
+typedef struct {
+    int result;                      // EMU_*
+    const emu_account* from;         // NULL when malformed
+    const emu_account* to;
+    uint64_t fee;                    // drops charged, 0 when the fee could not be paid
+    uint32_t run_count;
+    emu_run_report runs[2];          // the sending account's hook first
+    uint32_t state_count;            // state entries changed, one per hook and key
+    uint32_t emit_count;             // transactions queued for the next ledger
+} emu_report;
+
+// Per ledger, reset by emu_ledger_begin
+typedef struct {
+    uint32_t seq;
+    uint32_t transactions;
+    uint32_t hook_runs;
+    uint32_t emitted_applied;
+    uint32_t emitted_queued;
+    uint32_t rejected;
+} emu_ledger_stats;
+
+void emu_init(const emu_config* config);
+void emu_free(void);
+
+// Runs fn(arg) on a thread whose stack is below 4 GB; returns fn's result
+int emu_run(int (*fn)(void*), void* arg);
+
+emu_account* emu_account_add(const uint8_t id[20], int64_t drops);
+emu_account* emu_account_find(const uint8_t id[20]);
+
+emu_hook* emu_hook_install(const char* name, const uint8_t account[20], emu_entry entry,
+                           uint8_t* data_start, uint8_t* data_end);
+void emu_hook_param(emu_hook* hook, const char* name, const void* value, uint32_t len);
+int emu_hook_state(const emu_hook* hook, const uint8_t key[32], uint8_t* out, uint32_t* len);
+// State entry in slot i (0 to state_capacity - 1) of the hook's table; returns 0 when
+// the slot holds none
+int emu_hook_state_at(const emu_hook* hook, uint32_t i, const uint8_t** key, const uint8_t** data,
+                      uint32_t* len);
+// Writes (len > 0) or deletes a state entry outside any transaction, e.g. to load a
+// recorded pre-state
+void emu_hook_state_set(emu_hook* hook, const uint8_t key[32], const uint8_t* data, uint32_t len);
+
+// Adds or replaces the ledger object under key; slot_set takes the key or a 34-byte
+// keylet ending in it
+void emu_object_set(const uint8_t key[32], const uint8_t* data, uint32_t len);
+// Serialized URIToken ledger entry; returns its length
+uint32_t emu_uri_token(uint8_t* out, const uint8_t owner[20], const uint8_t issuer[20],
+                       const uint8_t digest[32]);
+
+// Serialized Payment; amount is 8 bytes (drops) or 48 (issued currency)
+uint32_t emu_payment(uint8_t* out, const uint8_t from[20], const uint8_t to[20],
+                     const uint8_t* amount, uint32_t amount_len,
+                     const emu_memo* memos, uint32_t memo_count);
+#ifndef tfPartialPayment
+#define tfPartialPayment 0x00020000UL
+#endif
+// Same, with a Flags field when flags is non-zero (e.g. tfPartialPayment)
+uint32_t emu_payment_flags(uint8_t* out, const uint8_t from[20], const uint8_t to[20],
+                           const uint8_t* amount, uint32_t amount_len, uint32_t flags,
+                           const emu_memo* memos, uint32_t memo_count);
+void emu_amount_drops(uint8_t out[8], uint64_t drops);
+void emu_amount_iou(uint8_t out[48], int64_t xfl, const uint8_t currency[20], const uint8_t issuer[20]);
+
+// Applies an originating transaction to the open ledger; returns EMU_*
+int emu_submit(const uint8_t* blob, uint32_t len);
+
+// The last transaction applied, originating or emitted; valid until the next one. State
+// changes and emissions are listed only when every hook accepted: emu_report_state()
+// gives the i-th write (data NULL for a delete), emu_report_emit() the i-th emission.
+const emu_report* emu_last_report(void);
+void emu_report_state(uint32_t i, const emu_hook** hook, const uint8_t** key,
+                      const uint8_t** data, uint32_t* len);
+const uint8_t* emu_report_emit(uint32_t i, uint32_t* len);
+
+// Copies a serialized transaction without Fee and EmitDetails, which depend on the
+// node's fee settings and the emitting run, to compare emissions across runs; returns
+// the length, 0 when malformed
+uint32_t emu_txn_strip(uint8_t* out, const uint8_t* blob, uint32_t len);
+
+// Called after every transaction applied, originating or emitted, whatever the result;
+// emu_last_report() describes it during the call
+typedef void (*emu_observer)(const uint8_t* blob, uint32_t len, int emitted, void* arg);
+void emu_observe(emu_observer fn, void* arg);
+
+// Emitted transactions queued by the previous ledger are applied by emu_ledger_begin
+void emu_ledger_begin(void);
+const emu_ledger_stats* emu_ledger_close(void);
+
+// Sequence and close time of the next ledger, in place of the ledger_interval cadence;
+// call before emu_ledger_begin
+void emu_ledger_set(uint32_t seq, uint32_t close_time);
+
+uint32_t emu_ledger_seq(void);
+uint32_t emu_close_time(void);
+const emu_totals* emu_get_totals(void);
+
+// Address helpers used by the simulator
+int emu_decode_address(uint8_t out[20], const char* address);
+void emu_sha512h(uint8_t out[32], const uint8_t* data, uint32_t len);
+
+// Serialized field id (1 to 3 bytes); returns its length
+uint32_t emu_field_header(uint8_t* out, uint32_t field_code);
+
+// XFL helpers (xfl.c)
+int64_t emu_xfl_from_units(double units);
+double emu_xfl_to_units(int64_t xfl);
+
+#endif
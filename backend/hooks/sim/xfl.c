@@ -0,0 +1,306 @@
+// XFL arithmetic for the hook API emulator (float_* host functions)
+//
+// An XFL is an int64 holding a normalized decimal float:
+//   bit 62       1 = positive
+//   bits 54..61  exponent + 97 (exponent -96 .. 80)
+//   bits 0..53   mantissa, 10^15 .. 10^16 - 1
+// Zero is 0. The serialized issued-currency amount is the same layout with bit 63 set.
+//
+// Results are truncated toward zero after each operation, like the host functions.
+// Only the float_* calls the DRIPPY hooks import are provided.
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hookapi.h"
+#include "hookemu.h"
+
+#define XFL_MANT_MIN 1000000000000000ULL
+#define XFL_MANT_MAX 9999999999999999ULL
+#define XFL_EXP_MIN -96
+#define XFL_EXP_MAX 80
+#define XFL_MANT_MASK ((1ULL << 54) - 1)
+#define XFL_POSITIVE (1ULL << 62)
+
+typedef unsigned __int128 u128;
+
+typedef struct {
+    int negative;
+    int32_t exponent;
+    uint64_t mantissa;        // 0 for zero
+} xfl_parts;
+
+static int64_t xfl_make(int negative, int32_t exponent, u128 mantissa)
+{
+    if (mantissa == 0)
+        return 0;
+    while (mantissa > XFL_MANT_MAX) {
+        mantissa /= 10;
+        exponent++;
+    }
+    while (mantissa < XFL_MANT_MIN) {
+        mantissa *= 10;
+        exponent--;
+    }
+    if (exponent < XFL_EXP_MIN)
+        return 0;
+    if (exponent > XFL_EXP_MAX)
+        return OVERFLOW;
+    return (int64_t)((negative ? 0 : XFL_POSITIVE) | ((uint64_t)(exponent + 97) << 54) |
+                     (uint64_t)mantissa);
+}
+
+static int xfl_split(int64_t f, xfl_parts* p)
+{
+    if (f < 0)
+        return 0;
+    p->negative = 0;
+    p->exponent = 0;
+    p->mantissa = 0;
+    if (f == 0)
+        return 1;
+    p->negative = !((uint64_t)f & XFL_POSITIVE);
+    p->exponent = (int32_t)(((uint64_t)f >> 54) & 0xFF) - 97;
+    p->mantissa = (uint64_t)f & XFL_MANT_MASK;
+    return 1;
+}
+
+static u128 pow10_u128(int n)
+{
+    u128 r = 1;
+    while (n-- > 0)
+        r *= 10;
+    return r;
+}
+
+int64_t float_set(int32_t exponent, int64_t mantissa)
+{
+    if (mantissa == 0)
+        return 0;
+    int negative = mantissa < 0;
+    uint64_t m = negative ? (uint64_t)(-(mantissa + 1)) + 1 : (uint64_t)mantissa;
+    return xfl_make(negative, exponent, m);
+}
+
+int64_t float_one(void)
+{
+    return float_set(0, 1);
+}
+
+int64_t float_negate(int64_t f)
+{
+    if (f == 0)
+        return 0;
+    if (f < 0)
+        return INVALID_FLOAT;
+    return (int64_t)((uint64_t)f ^ XFL_POSITIVE);
+}
+
+int64_t float_sum(int64_t a, int64_t b)
+{
+    xfl_parts x, y;
+    if (!xfl_split(a, &x) || !xfl_split(b, &y))
+        return INVALID_FLOAT;
+    if (x.mantissa == 0)
+        return b;
+    if (y.mantissa == 0)
+        return a;
+
+    // Bring both to the smaller exponent; a term 17+ digits down does not register
+    if (x.exponent < y.exponent) {
+        xfl_parts t = x;
+        x = y;
+        y = t;
+    }
+    int shift = x.exponent - y.exponent;
+    if (shift > 17)
+        return xfl_make(x.negative, x.exponent, x.mantissa);
+
+    u128 mx = (u128)x.mantissa * pow10_u128(shift);
+    u128 my = y.mantissa;
+    if (x.negative == y.negative)
+        return xfl_make(x.negative, y.exponent, mx + my);
+    if (mx >= my)
+        return xfl_make(x.negative, y.exponent, mx - my);
+    return xfl_make(y.negative, y.exponent, my - mx);
+}
+
+int64_t float_mulratio(int64_t f, uint32_t round_up, uint32_t numerator, uint32_t denominator)
+{
+    xfl_parts x;
+    if (!xfl_split(f, &x))
+        return INVALID_FLOAT;
+    if (denominator == 0)
+        return DIVISION_BY_ZERO;
+    if (x.mantissa == 0 || numerator == 0)
+        return 0;
+
+    // 10^16 * 2^32 * 10^12 stays below 2^128
+    u128 scaled = (u128)x.mantissa * numerator * pow10_u128(12);
+    u128 q = scaled / denominator;
+    if (round_up && q * denominator != scaled)
+        q++;
+    return xfl_make(x.negative, x.exponent - 12, q);
+}
+
+int64_t float_int(int64_t f, uint32_t decimal_places, uint32_t absolute)
+{
+    xfl_parts x;
+    if (!xfl_split(f, &x) || decimal_places > 15)
+        return INVALID_ARGUMENT;
+    if (x.negative && !absolute)
+        return CANT_RETURN_NEGATIVE;
+
+    int shift = x.exponent + (int)decimal_places;
+    u128 v = x.mantissa;
+    if (shift < 0)
+        v = shift < -17 ? 0 : v / pow10_u128(-shift);
+    else if (shift > 3)
+        return TOO_BIG;
+    else
+        v *= pow10_u128(shift);
+    return v > INT64_MAX ? TOO_BIG : (int64_t)v;
+}
+
+int64_t float_compare(int64_t a, int64_t b, uint32_t mode)
+{
+    if (mode == 0 || (mode & ~7U) || mode == 7)
+        return INVALID_ARGUMENT;
+
+    xfl_parts x, y;
+    if (!xfl_split(a, &x) || !xfl_split(b, &y))
+        return INVALID_FLOAT;
+
+    int cmp;
+    if (a == b) {
+        cmp = 0;
+    } else if (x.mantissa == 0) {
+        cmp = y.negative ? 1 : -1;
+    } else if (y.mantissa == 0) {
+        cmp = x.negative ? -1 : 1;
+    } else if (x.negative != y.negative) {
+        cmp = x.negative ? -1 : 1;
+    } else {
+        // Normalized: the exponent decides first, then the mantissa
+        int mag = x.exponent != y.exponent ? (x.exponent < y.exponent ? -1 : 1)
+                                           : (x.mantissa < y.mantissa ? -1 : 1);
+        cmp = x.negative ? -mag : mag;
+    }
+
+    return ((mode & COMPARE_EQUAL) && cmp == 0) ||
+           ((mode & COMPARE_LESS) && cmp < 0) ||
+           ((mode & COMPARE_GREATER) && cmp > 0);
+}
+
+// Drops held by an XFL, truncated; negative results are errors
+static int64_t xfl_to_drops(int64_t f)
+{
+    xfl_parts x;
+    if (!xfl_split(f, &x) || x.negative)
+        return CANT_RETURN_NEGATIVE;
+    u128 v = x.mantissa;
+    int32_t e = x.exponent;
+    while (e < 0 && v) {
+        v /= 10;
+        e++;
+    }
+    while (e > 0) {
+        v *= 10;
+        e--;
+        if (v > 0x3FFFFFFFFFFFFFFFULL)
+            return OVERFLOW;
+    }
+    return (int64_t)v;
+}
+
+int64_t float_sto(uint32_t write_ptr, uint32_t write_len, uint32_t cread_ptr, uint32_t cread_len,
+                  uint32_t iread_ptr, uint32_t iread_len, int64_t f, uint32_t field_code)
+{
+    uint8_t* out = (uint8_t*)(uintptr_t)write_ptr;
+    int is_native = cread_len == 0 && iread_len == 0;
+    if (!is_native && (cread_len != 20 || iread_len != 20))
+        return INVALID_ARGUMENT;
+    if (f < 0)
+        return INVALID_FLOAT;
+
+    uint8_t header[3];
+    uint32_t header_len = (field_code == 0 || field_code == 0xFFFFFFFFU) ? 0
+                                                                          : emu_field_header(header, field_code);
+    uint32_t total = header_len + (is_native || field_code == 0xFFFFFFFFU ? 8 : 48);
+    if (write_len < total)
+        return TOO_SMALL;
+
+    memcpy(out, header, header_len);
+    uint8_t* p = out + header_len;
+
+    uint64_t raw;
+    if (is_native) {
+        int64_t drops = xfl_to_drops(f);
+        if (drops < 0)
+            return drops;
+        raw = (uint64_t)drops | XFL_POSITIVE;
+    } else {
+        raw = f == 0 ? (1ULL << 63) : ((uint64_t)f | (1ULL << 63));
+    }
+    for (int i = 0; i < 8; i++)
+        p[i] = (uint8_t)(raw >> (56 - 8 * i));
+
+    if (total - header_len == 48) {
+        memcpy(p + 8, (const uint8_t*)(uintptr_t)cread_ptr, 20);
+        memcpy(p + 28, (const uint8_t*)(uintptr_t)iread_ptr, 20);
+    }
+    return total;
+}
+
+// Amounts of 8 or 48 bytes are read as they are (the hooks pass otxn_field output);
+// other lengths start with a field header
+int64_t float_sto_set(uint32_t read_ptr, uint32_t read_len)
+{
+    const uint8_t* p = (const uint8_t*)(uintptr_t)read_ptr;
+    if (read_len < 8)
+        return NOT_AN_OBJECT;
+    if (read_len != 8 && read_len != 48) {
+        uint8_t hi = p[0] >> 4, lo = p[0] & 0xF;
+        uint32_t skip = (hi == 0 && lo == 0) ? 3 : (hi == 0 || lo == 0) ? 2 : 1;
+        if (read_len < skip + 8)
+            return NOT_AN_OBJECT;
+        p += skip;
+    }
+
+    uint64_t raw = 0;
+    for (int i = 0; i < 8; i++)
+        raw = raw << 8 | p[i];
+
+    int negative = !(raw & XFL_POSITIVE);
+    if (!(raw & (1ULL << 63))) {
+        uint64_t drops = raw & 0x3FFFFFFFFFFFFFFFULL;
+        return float_set(0, negative ? -(int64_t)drops : (int64_t)drops);
+    }
+
+    uint64_t mantissa = raw & XFL_MANT_MASK;
+    if (mantissa == 0)
+        return 0;
+    int32_t exponent = (int32_t)((raw >> 54) & 0xFF) - 97;
+    return xfl_make(negative, exponent, mantissa);
+}
+
+int64_t emu_xfl_from_units(double units)
+{
+    if (units == 0)
+        return 0;
+    int negative = units < 0;
+    double v = fabs(units);
+    int32_t exponent = (int32_t)floor(log10(v)) - 15;
+    double m = v / pow(10, exponent);
+    return xfl_make(negative, exponent, (u128)(m + 0.5));
+}
+
+double emu_xfl_to_units(int64_t f)
+{
+    xfl_parts x;
+    if (!xfl_split(f, &x) || x.mantissa == 0)
+        return 0;
+    double v = (double)x.mantissa * pow(10, x.exponent);
+    return x.negative ? -v : v;
+}
@@ -17,6 +17,7 @@
 #define HAVE_SIMPLE_EMIT 1
 
 #define KEYLEN 32
+#define MEMOS_MAX 8
 
 // Util: parse memo blobs by type/format (simple example)
 static int memo_has_type(uint32_t memo_slot, const char* type) {
@@ -25,7 +26,7 @@ static int memo_has_type(uint32_t memo_slot, const char* type) {
     uint8_t buf[32]; int64_t len = slot(SBUF(buf), type_slot);
     if (len <= 0) return 0;
     // Compare (case-sensitive) up to buffer size
-    int i=0; for (; type[i] && i<len && i<32; ++i) { if (buf[i] != (uint8_t)type[i]) return 0; }
+    int i=0; for (; GUARD(MEMOS_MAX * 3 * 32), type[i] && i<len && i<32; ++i) { if (buf[i] != (uint8_t)type[i]) return 0; }
     return type[i] == '\0';
 }
 
@@ -39,8 +40,17 @@ static int read_memo_data(uint32_t memo_slot, uint8_t* out, int64_t max) {
 static void make_state_key(uint8_t key[KEYLEN], const uint8_t* acct20) {
     // Namespace: "DRIPPY:CLAIM:v1\0\0\0\0\0\0\0\0" (12 bytes)
     uint8_t prefix[12] = { 'D','R','I','P','P','Y',':','C','L','A','I','M' };
-    for (int i=0;i<12;i++) key[i]=prefix[i];
-    for (int j=0;j<20;j++) key[12+j]=acct20[j];
+    for (int i=0;GUARD(12),i<12;i++) key[i]=prefix[i];
+    for (int j=0;GUARD(20),j<20;j++) key[12+j]=acct20[j];
+}
+
+// Read HookParameter by ascii name
+static int param_read(uint8_t* out, int64_t outlen, const char* name) {
+    return hook_param(out, outlen, (uint8_t*)name, (int64_t)strlen(name));
+}
+
+static int is_equal20(const uint8_t* a, const uint8_t* b){
+    int i=0; for(;GUARD(20),i<20;i++){ if(a[i]!=b[i]) return 0; } return 1;
 }
 
 int64_t hook(int64_t reserved) {
@@ -59,8 +69,8 @@ int64_t hook(int64_t reserved) {
     if (has_memos) {
         // Iterate array of memos
         // sfMemos is an array of memo objects: each has sfMemo with subfields
-        for (int i=0;;++i) {
-            uint32_t memo_arr = slot_subarray(memos_slot, i);
+        for (int i=0;GUARD(MEMOS_MAX),i<MEMOS_MAX;++i) {
+            uint32_t memo_arr = slot_subarray(memos_slot, i, 0);
             if (memo_arr == DOESNT_EXIST) break;
             uint32_t memo_obj = slot_subfield(memo_arr, sfMemo, 0);
             if (memo_obj == DOESNT_EXIST) continue;
@@ -83,10 +93,6 @@ int64_t hook(int64_t reserved) {
         if (acc_hex_len && amt_hex_len) op = OP_ACC;
     }
 
-    // Fetch source/destination
-    uint8_t dst_accid[20];
-    otxn_field(SBUF(dst_accid), sfDestination);
-
     if (op == OP_CLAIM) {
         // Claimant is the transaction Account (source)
         uint8_t claimant[20];
@@ -110,7 +116,7 @@ int64_t hook(int64_t reserved) {
         uint8_t cooldbuf[8]; int has_coold = (param_read(SBUF(cooldbuf), "COOLD") == 8);
         uint64_t coold = has_coold ? UINT64_FROM_BUF(cooldbuf) : 0;
         if (coold) {
-            uint64_t now = (uint64_t)ledger_time();
+            uint64_t now = (uint64_t)ledger_last_time();
             if (last_claim && now < last_claim + coold)
                 return rollback(SBUF("cooldown"), 1);
         }
@@ -126,23 +132,24 @@ int64_t hook(int64_t reserved) {
         // Use simple emit helpers from official toolchain if available
 #ifdef HAVE_SIMPLE_EMIT
         if (has_cur && has_iss) {
-            // IOU payout; here we encode integer value (no decimal scaling). Adjust to your currency decimals as needed.
-            p += PREPARE_PAYMENT_SIMPLE_ISSUED(p, (int64_t)(payment + sizeof(payment) - p), dst_accid, claimant, cur20, issuer20, pay_amt);
+            // IOU payout; accrual is in millionths of the currency (same 6-decimal scale as drops)
+            p += PREPARE_PAYMENT_SIMPLE_ISSUED(p, (int64_t)(payment + sizeof(payment) - p), 0, claimant, cur20, issuer20, pay_amt);
         } else {
-            p += PREPARE_PAYMENT_SIMPLE_DROPS(p, (int64_t)(payment + sizeof(payment) - p), dst_accid, claimant, pay_amt);
+            p += PREPARE_PAYMENT_SIMPLE_DROPS(p, (int64_t)(payment + sizeof(payment) - p), 0, claimant, pay_amt);
         }
 #else
         // If helper macros not available, abort with clear message for build-time
         return rollback(SBUF("emit helpers missing"), 1);
 #endif
-        int64_t emit_result = emit(SBUF(payment));
+        uint8_t emithash[32];
+        int64_t emit_result = emit(SBUF(emithash), payment, p - payment);
         if (emit_result < 0) return rollback(SBUF("emit failed"), 1);
 
         // subtract payout and set last claim epoch
         uint64_t remain = drops - pay_amt;
         uint8_t outstate[16] = {0};
         UINT64_TO_BUF(outstate, remain);
-        UINT64_TO_BUF(outstate + 8, (uint64_t)ledger_time());
+        UINT64_TO_BUF(outstate + 8, (uint64_t)ledger_last_time());
         if (state_set(SBUF(outstate), key, KEYLEN) < 0) {
             return rollback(SBUF("state_set fail"), 1);
         }
@@ -166,17 +173,9 @@ int64_t hook(int64_t reserved) {
         uint8_t amtbuf[8] = {0};
         int hexlen = amt_hex_len; if (hexlen > 16) hexlen = 16;
         // place right-aligned in amtbuf
-// Read HookParameter by ascii name
-static int param_read(uint8_t* out, int64_t outlen, const char* name) {
-    return hook_param(out, outlen, (uint8_t*)name, (int64_t)strlen(name));
-}
-
-static int is_equal20(const uint8_t* a, const uint8_t* b){
-    int i=0; for(;i<20;i++){ if(a[i]!=b[i]) return 0; } return 1;
-}
         if (hexlen > 0) {
             int bytes = (hexlen+1)/2; // round up
-            if (unhexlify(amtbuf + (8 - bytes), amt_hex, hexlen) != bytes) return rollback(SBUF("bad val"), 1);
+            if (unhexlify(amtbuf + (8 - bytes), bytes, amt_hex, hexlen) != bytes) return rollback(SBUF("bad val"), 1);
         }
         uint64_t add = UINT64_FROM_BUF(amtbuf);
 
@@ -5,7 +5,8 @@
 // Supported Operations:
 //   "CLAIM"     : User claims their accumulated rewards
 //   "ACC_A"+"ACC_V" : Admin adds accrual for account (requires ADMIN auth)
-//   "BOOST"     : Admin sets NFT boost multiplier for account
+//   "ACC_A"+"BOOST" : Admin sets NFT boost multiplier for account
+//   "NFTS"      : Optional with CLAIM - URIToken IDs held by the claimant (32 bytes each)
 //   "INFO"      : Query account information (read-only)
 //
 // HookParameters (hex values):
@@ -17,16 +18,90 @@
 //   DAILY_MAX : 8-byte u64 max daily claims per account (0 = unlimited)
 //   MIN_CLAIM : 8-byte u64 minimum claimable amount (default 1000000 = 1 XRP)
 //   BOOST_MAX : 4-byte u32 maximum boost multiplier (default 500 = 5x)
+//   NFT_TBL   : up to 8 x 26-byte entries enabling on-chain boost derivation:
+//               [0..19] issuer, [20..23] u32 taxon (0xFFFFFFFF = any), [24..25] u16 multiplier
+//
+// On-chain NFT boost (NFT_TBL set):
+//   The claimant lists the URITokens they hold in an "NFTS" memo (32-byte IDs,
+//   max 8). Each token is loaded via util_keylet/slot_set and must be a
+//   URIToken owned by the claimant. URITokens carry no taxon, so the first 4 bytes
+//   of the token Digest are used as its taxon. Each matching token adds
+//   (multiplier - 100) to the 1x base, capped at BOOST_MAX, and the result replaces
+//   the stored admin BOOST for that claim.
 //
 // Enhanced State Layout per account (32 bytes):
 //   [0..7]   = u64 accrued_drops (total accumulated rewards)
 //   [8..15]  = u64 last_claim_epoch (timestamp of last claim)
 //   [16..19] = u32 claim_count (total number of claims)
 //   [20..23] = u32 boost_multiplier (NFT boost factor, 100 = 1x, 200 = 2x)
-//   [24..31] = u64 daily_claimed (amount claimed today, resets at midnight)
+//   [24..31] = u64 daily_claimed (amount claimed on the day of last_claim_epoch)
+//
+// The payout decision itself (minimum, cooldown, per-claim and daily caps, boost) is in
+// include/drippy_claim_rules.h, which the backend compiles too for claim previews.
+//
+// Every claim, accrual and boost change is also appended to the change log
+// (include/drippy_changes.h) so indexers can follow balances from a cursor. Claims
+// paid are added to the hourly/daily metric buckets (include/drippy_metrics.h).
+//
+// Feature selection:
+//   Every feature is compiled in by default. A profile (-DCLAIM_PROFILE_MIN,
+//   _COOLDOWN or _FULL, see `make claim-min` etc.) or individual
+//   -DCLAIM_FEATURE_<NAME>=0 switches remove the code and its parameters entirely.
+//   The state layout is shared by all profiles, so a pool can move between them.
+//     COOLDOWN      : COOLD parameter
+//     DAILY_CAP     : DAILY_MAX parameter
+//     BOOST         : stored boost multiplier, BOOST memo (target in ACC_A), BOOST_MAX
+//     NFT_BOOST     : NFTS memo and NFT_TBL (requires BOOST)
+//     IOU           : CUR/ISSUER issued-currency payouts
+//     ADMIN_ACCRUAL : ACC_A/ACC_V admin accrual memos
+//   claim-min keeps claims and admin accrual with native payouts; claim-cooldown
+//   adds COOLDOWN and DAILY_CAP; claim-full is everything.
+
+#if defined(CLAIM_PROFILE_MIN) || defined(CLAIM_PROFILE_COOLDOWN)
+#if defined(CLAIM_PROFILE_MIN) && !defined(CLAIM_FEATURE_COOLDOWN)
+#define CLAIM_FEATURE_COOLDOWN 0
+#endif
+#if defined(CLAIM_PROFILE_MIN) && !defined(CLAIM_FEATURE_DAILY_CAP)
+#define CLAIM_FEATURE_DAILY_CAP 0
+#endif
+#ifndef CLAIM_FEATURE_BOOST
+#define CLAIM_FEATURE_BOOST 0
+#endif
+#ifndef CLAIM_FEATURE_IOU
+#define CLAIM_FEATURE_IOU 0
+#endif
+#endif
+
+#ifndef CLAIM_FEATURE_COOLDOWN
+#define CLAIM_FEATURE_COOLDOWN 1
+#endif
+#ifndef CLAIM_FEATURE_DAILY_CAP
+#define CLAIM_FEATURE_DAILY_CAP 1
+#endif
+#ifndef CLAIM_FEATURE_BOOST
+#define CLAIM_FEATURE_BOOST 1
+#endif
+#ifndef CLAIM_FEATURE_NFT_BOOST
+#define CLAIM_FEATURE_NFT_BOOST CLAIM_FEATURE_BOOST
+#endif
+#ifndef CLAIM_FEATURE_IOU
+#define CLAIM_FEATURE_IOU 1
+#endif
+#ifndef CLAIM_FEATURE_ADMIN_ACCRUAL
+#define CLAIM_FEATURE_ADMIN_ACCRUAL 1
+#endif
+
+#if CLAIM_FEATURE_NFT_BOOST && !CLAIM_FEATURE_BOOST
+#error "CLAIM_FEATURE_NFT_BOOST requires CLAIM_FEATURE_BOOST"
+#endif
 
+// The hook exports cbak, so the node adds the callback account to EmitDetails
+#define HAS_CALLBACK
 #include "hookapi.h"
 #include "simple_emit.h"
+#include "drippy_changes.h"
+#include "drippy_metrics.h"
+#include "drippy_claim_rules.h"
 #define HAVE_SIMPLE_EMIT 1
 
 #define KEYLEN 32
@@ -42,29 +117,38 @@
 // Default values
 #define DEFAULT_MIN_CLAIM 1000000  // 1 XRP in drops
 #define DEFAULT_BOOST_MAX 500      // 5x maximum boost
-#define SECONDS_PER_DAY 86400
-
-// Error messages
-static const char* ERR_NO_ACCRUAL = "no accrual";
-static const char* ERR_COOLDOWN = "cooldown active";
-static const char* ERR_DAILY_LIMIT = "daily limit exceeded";
-static const char* ERR_MIN_AMOUNT = "below minimum";
-static const char* ERR_ADMIN_ONLY = "admin required";
-static const char* ERR_EMIT_FAILED = "emit failed";
-static const char* ERR_STATE_FAILED = "state update failed";
-static const char* ERR_INVALID_ACCOUNT = "invalid account";
-static const char* ERR_INVALID_AMOUNT = "invalid amount";
+
+// On-chain NFT boost table
+#define NFT_TBL_ENTRY CLAIM_NFT_ROW
+#define NFT_TBL_MAX CLAIM_NFT_ROWS_MAX
+#define NFT_IDS_MAX CLAIM_NFT_IDS_MAX
+#define ltURI_TOKEN 0x0055U
+
+// Memo parsing bounds (memo_has_type is tried for up to 5 types per memo)
+#define MEMOS_MAX 8
+#define MEMO_TYPE_MAX 32
+
+// Error messages; arrays, so SBUF() passes the whole text and not a pointer's width
+static const char ERR_COOLDOWN[] = "cooldown active";
+static const char ERR_DAILY_LIMIT[] = "daily limit exceeded";
+static const char ERR_MIN_AMOUNT[] = "below minimum";
+static const char ERR_ADMIN_ONLY[] = "admin required";
+static const char ERR_EMIT_FAILED[] = "emit failed";
+static const char ERR_STATE_FAILED[] = "state update failed";
+static const char ERR_INVALID_ACCOUNT[] = "invalid account";
+static const char ERR_INVALID_AMOUNT[] = "invalid amount";
+static const char ERR_NFT_INVALID[] = "nft not owned";
 
 // Utility functions
 static int memo_has_type(uint32_t memo_slot, const char* type) {
     uint32_t type_slot = slot_subfield(memo_slot, sfMemoType, 0);
     if (type_slot == DOESNT_EXIST) return 0;
 
-    uint8_t buf[32];
+    uint8_t buf[MEMO_TYPE_MAX];
     int64_t len = slot(SBUF(buf), type_slot);
     if (len <= 0 || len != strlen(type)) return 0;
 
-    for (int i = 0; i < len; ++i) {
+    for (int i = 0; GUARD(MEMOS_MAX * 5 * MEMO_TYPE_MAX), i < len; ++i) {
         if (buf[i] != (uint8_t)type[i]) return 0;
     }
     return 1;
@@ -99,20 +183,20 @@ static int read_param_account(const char* name, uint8_t account[20]) {
 // State key: DRIPPY:CLAIM:v2 + 20-byte account ID
 static void make_state_key(uint8_t key[KEYLEN], const uint8_t* acct20) {
     // Enhanced namespace for v2
-    uint8_t prefix[12] = {'D','R','I','P','P','Y',':','C','L','A','I','M','2'};
+    uint8_t prefix[12] = {'D','R','I','P','P','Y',':','C','L','A','I','M'};
     memcpy(key, prefix, 12);
     memcpy(key + 12, acct20, 20);
 }
 
 // Read account state with full structure
-static int read_account_state(const uint8_t* account, uint8_t state[STATE_SIZE]) {
+static int read_account_state(const uint8_t* account, uint8_t out[STATE_SIZE]) {
     uint8_t key[KEYLEN];
     make_state_key(key, account);
 
-    int result = state(state, STATE_SIZE, key, KEYLEN);
+    int result = state(out, STATE_SIZE, key, KEYLEN);
     if (result < 0) {
         // Initialize empty state
-        memset(state, 0, STATE_SIZE);
+        memset(out, 0, STATE_SIZE);
         return 0;
     }
     return result;
@@ -125,27 +209,10 @@ static int write_account_state(const uint8_t* account, const uint8_t state[STATE
     return state_set(state, STATE_SIZE, key, KEYLEN);
 }
 
-// Get current day (for daily limits)
-static uint32_t get_current_day() {
-    return (uint32_t)(ledger_time() / SECONDS_PER_DAY);
-}
-
-// Check if we need to reset daily counter
-static void check_daily_reset(uint8_t state[STATE_SIZE]) {
-    static uint32_t last_reset_day = 0;
-    uint32_t current_day = get_current_day();
-
-    if (last_reset_day != current_day) {
-        // Reset daily claimed amount
-        UINT64_TO_BUF(state + OFFSET_DAILY_CLAIMED, 0);
-        last_reset_day = current_day;
-    }
-}
-
 // Validate account ID format
 static int is_valid_account(const uint8_t* account) {
     // Basic validation - account should not be all zeros
-    for (int i = 0; i < 20; i++) {
+    for (int i = 0; GUARD(20), i < 20; i++) {
         if (account[i] != 0) return 1;
     }
     return 0;
@@ -159,9 +226,72 @@ static int is_admin_authorized() {
     uint8_t sender[20];
     otxn_field(SBUF(sender), sfAccount);
 
-    return memcmp(admin_account, sender, 20) == 0;
+    return BUFFER_EQUAL_20(admin_account, sender);
 }
 
+#if CLAIM_FEATURE_NFT_BOOST
+// Derive the boost multiplier from URITokens the claimant holds.
+// Returns 0 when NFT_TBL is not configured (stored boost applies), 1 when derived,
+// and -1 when a listed token is missing, duplicated or not owned by the claimant.
+static int derive_nft_boost(const uint8_t* claimant, const uint8_t* ids, int id_count,
+                            uint32_t* boost_out) {
+    uint8_t table[NFT_TBL_ENTRY * NFT_TBL_MAX];
+    int64_t table_len = hook_param(SBUF(table), (uint8_t*)"NFT_TBL", 7);
+    if (table_len < NFT_TBL_ENTRY) return 0;
+    int entries = (int)(table_len / NFT_TBL_ENTRY);
+
+    uint32_t boost = 100;
+    uint32_t max_boost = read_param_u32("BOOST_MAX", DEFAULT_BOOST_MAX);
+    uint32_t token_slot = 0;
+
+    for (int i = 0; GUARD(NFT_IDS_MAX), i < id_count; ++i) {
+        const uint8_t* id = ids + i * 32;
+
+        // Reject a token listed twice
+        for (int j = 0; GUARD(NFT_IDS_MAX * NFT_IDS_MAX), j < i; ++j) {
+            if (BUFFER_EQUAL_32(id, ids + j * 32)) return -1;
+        }
+
+        uint8_t keylet[34];
+        if (util_keylet(SBUF(keylet), KEYLET_UNCHECKED, (uint32_t)id, 32, 0, 0, 0, 0) != 34)
+            return -1;
+
+        int64_t slot_no = slot_set(SBUF(keylet), token_slot);
+        if (slot_no < 0) return -1;
+        token_slot = (uint32_t)slot_no;
+
+        uint8_t entry_type[2];
+        int64_t type_slot = slot_subfield(token_slot, sfLedgerEntryType, 0);
+        if (type_slot < 0 || slot(SBUF(entry_type), type_slot) != 2 ||
+            UINT16_FROM_BUF(entry_type) != ltURI_TOKEN)
+            return -1;
+
+        uint8_t owner[20];
+        int64_t owner_slot = slot_subfield(token_slot, sfOwner, 0);
+        if (owner_slot < 0 || slot(SBUF(owner), owner_slot) != 20 ||
+            !BUFFER_EQUAL_20(owner, claimant))
+            return -1;
+
+        uint8_t issuer[20];
+        int64_t issuer_slot = slot_subfield(token_slot, sfIssuer, 0);
+        if (issuer_slot < 0 || slot(SBUF(issuer), issuer_slot) != 20)
+            return -1;
+
+        uint32_t taxon = 0;
+        uint8_t digest[32];
+        int64_t digest_slot = slot_subfield(token_slot, sfDigest, 0);
+        if (digest_slot >= 0 && slot(SBUF(digest), digest_slot) == 32)
+            taxon = UINT32_FROM_BUF(digest);
+
+        boost += claim_nft_bonus(table, entries, issuer, taxon);
+    }
+
+    if (boost > max_boost) boost = max_boost;
+    *boost_out = boost;
+    return 1;
+}
+#endif
+
 // Emit reward payment (supports both XRP and IOU)
 static int emit_reward_payment(const uint8_t* recipient, uint64_t amount) {
     if (amount == 0) return 1;  // Nothing to emit
@@ -171,17 +301,20 @@ static int emit_reward_payment(const uint8_t* recipient, uint64_t amount) {
     uint8_t payment[512];
     uint8_t* p = payment;
 
+#ifdef HAVE_SIMPLE_EMIT
+#if CLAIM_FEATURE_IOU
     // Check if we should pay in IOU
     uint8_t currency[20], issuer[20];
     int has_currency = read_param_account("CUR", currency);
     int has_issuer = read_param_account("ISSUER", issuer);
 
-#ifdef HAVE_SIMPLE_EMIT
     if (has_currency && has_issuer) {
         // IOU payment
         p += PREPARE_PAYMENT_SIMPLE_ISSUED(p, (int64_t)(payment + sizeof(payment) - p),
                                           0, recipient, currency, issuer, amount);
-    } else {
+    } else
+#endif
+    {
         // XRP payment
         p += PREPARE_PAYMENT_SIMPLE_DROPS(p, (int64_t)(payment + sizeof(payment) - p),
                                          0, recipient, amount);
@@ -190,92 +323,72 @@ static int emit_reward_payment(const uint8_t* recipient, uint64_t amount) {
     return 0;  // Emit helpers required
 #endif
 
-    int64_t result = emit(SBUF(payment));
+    uint8_t emithash[32];
+    int64_t result = emit(SBUF(emithash), payment, p - payment);
     return result >= 0;
 }
 
 // Process claim operation
-static int process_claim(const uint8_t* claimant) {
+static int process_claim(const uint8_t* claimant, const uint8_t* nft_ids, int nft_count) {
     uint8_t account_state[STATE_SIZE];
     if (read_account_state(claimant, account_state) < 0) {
         return rollback(SBUF(ERR_STATE_FAILED), 1);
     }
 
-    // Check daily reset
-    check_daily_reset(account_state);
-
-    // Extract state values
-    uint64_t accrued = UINT64_FROM_BUF(account_state + OFFSET_ACCRUED);
-    uint64_t last_claim = UINT64_FROM_BUF(account_state + OFFSET_LAST_CLAIM);
-    uint32_t claim_count = UINT32_FROM_BUF(account_state + OFFSET_CLAIM_COUNT);
-    uint32_t boost_mult = UINT32_FROM_BUF(account_state + OFFSET_BOOST_MULT);
-    uint64_t daily_claimed = UINT64_FROM_BUF(account_state + OFFSET_DAILY_CLAIMED);
-
-    // Set default boost if not set
-    if (boost_mult == 0) boost_mult = 100;  // 1x default
+    claim_rules rules = { 0 };
+    rules.min_claim = read_param_u64("MIN_CLAIM", DEFAULT_MIN_CLAIM);
+    rules.max_claim = read_param_u64("MAXP", 0);
+#if CLAIM_FEATURE_COOLDOWN
+    rules.cooldown = read_param_u64("COOLD", 0);
+#endif
+#if CLAIM_FEATURE_DAILY_CAP
+    rules.daily_max = read_param_u64("DAILY_MAX", 0);
+    rules.features |= CLAIM_RULE_DAILY_CAP;
+#endif
+#if CLAIM_FEATURE_BOOST
+    rules.features |= CLAIM_RULE_BOOST;
+#endif
 
-    // Check minimum claimable amount
-    uint64_t min_claim = read_param_u64("MIN_CLAIM", DEFAULT_MIN_CLAIM);
-    if (accrued < min_claim) {
-        return rollback(SBUF(ERR_MIN_AMOUNT), 1);
+#if CLAIM_FEATURE_NFT_BOOST
+    // On-chain boost replaces the admin-set value when NFT_TBL is configured
+    uint32_t nft_boost = 0;
+    int nft_mode = derive_nft_boost(claimant, nft_ids, nft_count, &nft_boost);
+    if (nft_mode < 0) {
+        return rollback(SBUF(ERR_NFT_INVALID), 1);
     }
+    if (nft_mode > 0) rules.boost = nft_boost;
+#endif
 
-    // Check cooldown
-    uint64_t cooldown = read_param_u64("COOLD", 0);
-    if (cooldown > 0) {
-        uint64_t now = (uint64_t)ledger_time();
-        if (last_claim && (now < last_claim + cooldown)) {
+    // Minimum, cooldown, per-claim and daily caps, boost; updates the state on success
+    claim_outcome outcome;
+    switch (claim_apply(account_state, &rules, (uint64_t)ledger_last_time(), &outcome)) {
+        case CLAIM_BELOW_MINIMUM:
+            return rollback(SBUF(ERR_MIN_AMOUNT), 1);
+        case CLAIM_COOLDOWN:
             return rollback(SBUF(ERR_COOLDOWN), 1);
-        }
-    }
-
-    // Calculate payout amount
-    uint64_t max_claim = read_param_u64("MAXP", 0);
-    uint64_t daily_max = read_param_u64("DAILY_MAX", 0);
-
-    uint64_t payout = accrued;
-
-    // Apply per-claim limit
-    if (max_claim > 0 && payout > max_claim) {
-        payout = max_claim;
-    }
-
-    // Apply daily limit
-    if (daily_max > 0) {
-        uint64_t daily_remaining = daily_max > daily_claimed ? daily_max - daily_claimed : 0;
-        if (payout > daily_remaining) {
-            payout = daily_remaining;
-        }
-    }
-
-    if (payout == 0) {
-        return rollback(SBUF(ERR_DAILY_LIMIT), 1);
+        case CLAIM_DAILY_LIMIT:
+            return rollback(SBUF(ERR_DAILY_LIMIT), 1);
+        default:
+            break;
     }
 
-    // Apply NFT boost to payout (not to accrued balance)
-    uint64_t boosted_payout = (payout * boost_mult) / 100;
-
     // Emit payment
-    if (!emit_reward_payment(claimant, boosted_payout)) {
+    if (!emit_reward_payment(claimant, outcome.paid)) {
         return rollback(SBUF(ERR_EMIT_FAILED), 1);
     }
 
-    // Update state
-    uint64_t remaining = accrued - payout;
-    uint64_t now = (uint64_t)ledger_time();
-
-    UINT64_TO_BUF(account_state + OFFSET_ACCRUED, remaining);
-    UINT64_TO_BUF(account_state + OFFSET_LAST_CLAIM, now);
-    UINT32_TO_BUF(account_state + OFFSET_CLAIM_COUNT, claim_count + 1);
-    UINT64_TO_BUF(account_state + OFFSET_DAILY_CLAIMED, daily_claimed + payout);
-
     if (write_account_state(claimant, account_state) < 0) {
         return rollback(SBUF(ERR_STATE_FAILED), 1);
     }
 
+    change_record(CHG_ACCRUED, claimant, UINT64_FROM_BUF(account_state + OFFSET_ACCRUED),
+                  UINT32_FROM_BUF(account_state + OFFSET_CLAIM_COUNT));
+    metrics_record(0, 0, outcome.paid, 1);
+
     return accept(SBUF("claimed"), 0);
 }
 
+#if CLAIM_FEATURE_ADMIN_ACCRUAL
 // Process admin accrual addition
 static int process_accrual(const uint8_t* target_account, uint64_t add_amount) {
     if (!is_admin_authorized()) {
@@ -305,9 +418,14 @@ static int process_accrual(const uint8_t* target_account, uint64_t add_amount) {
         return rollback(SBUF(ERR_STATE_FAILED), 1);
     }
 
+    change_record(CHG_ACCRUED, target_account, new_accrued,
+                  UINT32_FROM_BUF(account_state + OFFSET_CLAIM_COUNT));
+
     return accept(SBUF("accrual added"), 0);
 }
+#endif
 
+#if CLAIM_FEATURE_BOOST
 // Process boost multiplier setting
 static int process_boost(const uint8_t* target_account, uint32_t boost_multiplier) {
     if (!is_admin_authorized()) {
@@ -334,8 +452,11 @@ static int process_boost(const uint8_t* target_account, uint32_t boost_multiplie
         return rollback(SBUF(ERR_STATE_FAILED), 1);
     }
 
+    change_record(CHG_BOOST, target_account, boost_multiplier, 0);
+
     return accept(SBUF("boost updated"), 0);
 }
+#endif
 
 // Main hook function
 int64_t hook(int64_t reserved) {
@@ -352,13 +473,25 @@ int64_t hook(int64_t reserved) {
 
     // Operation variables
     enum { OP_NONE, OP_CLAIM, OP_ACCRUAL, OP_BOOST, OP_INFO } operation = OP_NONE;
-    uint8_t target_account[20];
+    // Zero until a CLAIM or ACC_A memo names it; process_* reject the zero account
+    uint8_t target_account[20] = {0};
+#if CLAIM_FEATURE_ADMIN_ACCRUAL
     uint64_t amount_value = 0;
+#endif
+#if CLAIM_FEATURE_BOOST
     uint32_t boost_value = 0;
+#endif
+#if CLAIM_FEATURE_NFT_BOOST
+    uint8_t nft_ids[32 * NFT_IDS_MAX];
+    int nft_count = 0;
+#else
+    const uint8_t* nft_ids = 0;
+    int nft_count = 0;
+#endif
 
     // Parse memo operations
-    for (int i = 0; ; ++i) {
-        uint32_t memo_arr = slot_subarray(memos_slot, i);
+    for (int i = 0; GUARD(MEMOS_MAX), i < MEMOS_MAX; ++i) {
+        uint32_t memo_arr = slot_subarray(memos_slot, i, 0);
         if (memo_arr == DOESNT_EXIST) break;
 
         uint32_t memo_obj = slot_subfield(memo_arr, sfMemo, 0);
@@ -368,16 +501,21 @@ int64_t hook(int64_t reserved) {
             operation = OP_CLAIM;
             memcpy(target_account, source, 20);  // Claimant is sender
         }
+#if CLAIM_FEATURE_ADMIN_ACCRUAL || CLAIM_FEATURE_BOOST
         else if (memo_has_type(memo_obj, "ACC_A")) {
-            // Account hex in memo data
+            // Account hex in memo data; also the target of a BOOST memo
             uint8_t acc_hex[40];
             int len = read_memo_data(memo_obj, acc_hex, 40);
             if (len == 40) {
                 if (unhexlify(target_account, 20, acc_hex, 40) == 20) {
+#if CLAIM_FEATURE_ADMIN_ACCRUAL
                     operation = OP_ACCRUAL;
+#endif
                 }
             }
         }
+#endif
+#if CLAIM_FEATURE_ADMIN_ACCRUAL
         else if (memo_has_type(memo_obj, "ACC_V")) {
             // Amount hex in memo data
             uint8_t amt_hex[16];
@@ -385,11 +523,22 @@ int64_t hook(int64_t reserved) {
             if (len > 0 && len <= 16) {
                 uint8_t amt_buf[8] = {0};
                 int bytes = (len + 1) / 2;
-                if (unhexlify(amt_buf + (8 - bytes), amt_hex, len) == bytes) {
+                if (unhexlify(amt_buf + (8 - bytes), bytes, amt_hex, len) == bytes) {
                     amount_value = UINT64_FROM_BUF(amt_buf);
                 }
             }
         }
+#endif
+#if CLAIM_FEATURE_NFT_BOOST
+        else if (memo_has_type(memo_obj, "NFTS")) {
+            // Concatenated 32-byte URIToken IDs
+            int len = read_memo_data(memo_obj, nft_ids, sizeof(nft_ids));
+            if (len > 0 && len % 32 == 0) {
+                nft_count = len / 32;
+            }
+        }
+#endif
+#if CLAIM_FEATURE_BOOST
         else if (memo_has_type(memo_obj, "BOOST")) {
             // Boost multiplier as hex
             uint8_t boost_hex[8];
@@ -397,27 +546,32 @@ int64_t hook(int64_t reserved) {
             if (len > 0 && len <= 8) {
                 uint8_t boost_buf[4] = {0};
                 int bytes = (len + 1) / 2;
-                if (unhexlify(boost_buf + (4 - bytes), boost_hex, len) == bytes) {
+                if (unhexlify(boost_buf + (4 - bytes), bytes, boost_hex, len) == bytes) {
                     boost_value = UINT32_FROM_BUF(boost_buf);
                     operation = OP_BOOST;
                 }
             }
         }
+#endif
     }
 
     // Execute operation
     switch (operation) {
         case OP_CLAIM:
-            return process_claim(target_account);
+            return process_claim(target_account, nft_ids, nft_count);
 
+#if CLAIM_FEATURE_ADMIN_ACCRUAL
         case OP_ACCRUAL:
             if (amount_value > 0) {
                 return process_accrual(target_account, amount_value);
             }
             break;
+#endif
 
+#if CLAIM_FEATURE_BOOST
         case OP_BOOST:
             return process_boost(target_account, boost_value);
+#endif
 
         case OP_INFO:
             // Read-only operation, just return state info
@@ -13,13 +13,46 @@
 //   TREA_POOL : 20-byte treasury pool account
 //   AMM_POOL  : 20-byte AMM pool account
 //   MIN_AMOUNT: 8-byte u64 minimum amount to trigger routing (drops)
-//   ANTI_SNIPE: 8-byte u64 anti-sniping end epoch (0 = disabled)
+//   ANTI_SNIPE: 8-byte u64 anti-sniping end, Ripple-epoch seconds (0 = disabled)
 //   FEE_BPS   : 4-byte u32 fee in basis points (100 = 1%)
+//   IOU_WL    : up to 6 x 40-byte entries [currency(20) | issuer(20)] routed as IOU
+//   IOU_DUST  : 8-byte XFL minimum per-pool IOU emit (default: 1 unit)
+//   SNIPE_BURST : 4-byte u32 trades an account may make back to back in the window (default: 3)
+//   SNIPE_REFILL: 4-byte u32 ledgers to earn one more trade (default: 10)
+//   SNIPE_VOL   : 8-byte u64 drops accepted per ledger from non-whitelisted accounts (0 = no cap)
 //
-// State tracking total distributions and anti-sniping
+// IOU routing:
+//   Issued-currency fees in IOU_WL are parsed with float_sto_set and split with
+//   float_mulratio (allocation % as basis points). Shares below IOU_DUST are carried
+//   forward per currency and pool in state and added to the next fee instead of
+//   being emitted. Currencies not whitelisted are accepted without routing.
+//
+// Anti-sniping throttle (only while ANTI_SNIPE has not passed):
+//   Whitelist: one state entry per account, key "DRIPPY:WL:v1" + account id, so a lookup
+//   is a single state() read. ADMIN adds/removes accounts with a Payment carrying a
+//   WLADD / WLDEL memo whose data is up to 8 concatenated 20-byte account ids.
+//   Token bucket: SNIPE_SLOTS shared entries, key "DRIPPY:TB:v2" + slot (last byte of the
+//   account id mod SNIPE_SLOTS) -> [account id | u32 ledger seq | u32 tokens]. An account
+//   whose slot holds another account's bucket starts a fresh one there, so the throttle
+//   never holds more than SNIPE_SLOTS entries however many accounts trade.
+//   Volume cap: "DRIPPY:ROUTER:v1:LEDGER_VOL" -> [u32 ledger seq | u64 drops], reset on
+//   the first transaction of each ledger. Issued-currency fees count against the bucket only.
+//
+// State tracking total distributions and anti-sniping. Routed fees and whitelist edits
+// are appended to the change log (include/drippy_changes.h) for indexers, and every
+// routed fee is added to the hourly/daily metric buckets (include/drippy_metrics.h):
+// volume, NFT/HOLD/TREA/AMM pool amounts in that order, then the routed issued-currency
+// amount in millionths of a unit (all whitelisted currencies together).
+//
+// Payments sent by the hook account itself, including the pool payments it emits, are
+// accepted without routing.
 
+// The hook exports cbak, so the node adds the callback account to EmitDetails
+#define HAS_CALLBACK
 #include "hookapi.h"
 #include "simple_emit.h"
+#include "drippy_changes.h"
+#include "drippy_metrics.h"
 #define HAVE_SIMPLE_EMIT 1
 
 #define KEYLEN 32
@@ -35,12 +68,26 @@ static const char* STATE_PREFIX = "DRIPPY:ROUTER:v1";
 #define DEFAULT_AMM_ALLOC 10
 #define DEFAULT_FEE_BPS 100  // 1%
 
-// Error messages
-static const char* ERR_INSUFFICIENT = "amount too small";
-static const char* ERR_ANTI_SNIPE = "anti-sniping active";
-static const char* ERR_INVALID_ALLOC = "invalid allocation";
-static const char* ERR_EMIT_FAILED = "emit failed";
-static const char* ERR_STATE_FAILED = "state update failed";
+// IOU routing
+#define IOU_WL_ENTRY 40
+#define IOU_WL_MAX 6
+#define AMOUNT_IOU_LEN 48
+
+// Anti-sniping throttle
+#define DEFAULT_SNIPE_BURST 3
+#define DEFAULT_SNIPE_REFILL 10  // ledgers per token
+#define SNIPE_SLOTS 64            // token buckets held in state at most
+#define WL_BATCH_MAX 8
+#define SNIPE_THROTTLED 1
+#define SNIPE_LEDGER_CAP 2
+
+// Error messages; arrays, so SBUF() passes the whole text and not a pointer's width
+static const char ERR_INSUFFICIENT[] = "amount too small";
+static const char ERR_THROTTLED[] = "anti-sniping: trade rate exceeded";
+static const char ERR_LEDGER_CAP[] = "anti-sniping: ledger volume cap reached";
+static const char ERR_INVALID_ALLOC[] = "invalid allocation";
+static const char ERR_EMIT_FAILED[] = "emit failed";
+static const char ERR_STATE_FAILED[] = "state update failed";
 
 // Utility function: read parameter with default
 static uint32_t read_param_u32(const char* name, uint32_t default_val) {
@@ -92,10 +139,141 @@ static int set_state_u64(const char* key_suffix, uint64_t value) {
     uint8_t key[KEYLEN];
     make_state_key(key, key_suffix);
 
+    // Not named buf: the macro declares its own buf
+    uint8_t data[8];
+    UINT64_TO_BUF(data, value);
+
+    return state_set(SBUF(data), key, KEYLEN);
+}
+
+// IOU dust carry key: "DC" + pool index + first 29 bytes of sha512h(currency | issuer)
+static void make_dust_key(uint8_t key[KEYLEN], const uint8_t* cur_issuer, int pool) {
+    uint8_t hash[32];
+    util_sha512h(SBUF(hash), cur_issuer, 40);
+    key[0] = 'D';
+    key[1] = 'C';
+    key[2] = (uint8_t)pool;
+    memcpy(key + 3, hash, KEYLEN - 3);
+}
+
+static int64_t get_dust_xfl(const uint8_t* cur_issuer, int pool) {
+    uint8_t key[KEYLEN];
+    make_dust_key(key, cur_issuer, pool);
+
     uint8_t buf[8];
-    UINT64_TO_BUF(buf, value);
+    if (state(SBUF(buf), key, KEYLEN) == 8) {
+        return INT64_FROM_BUF(buf);
+    }
+    return 0;
+}
+
+static int set_dust_xfl(const uint8_t* cur_issuer, int pool, int64_t xfl) {
+    uint8_t key[KEYLEN];
+    make_dust_key(key, cur_issuer, pool);
+
+    // Deleting the entry when empty keeps the reserve footprint bounded
+    if (xfl == 0) return state_set(0, 0, key, KEYLEN);
+
+    // Not named buf: the macro declares its own buf
+    uint8_t data[8];
+    INT64_TO_BUF(data, xfl);
+    return state_set(SBUF(data), key, KEYLEN);
+}
+
+// Check currency/issuer pair against the IOU_WL parameter
+static int is_whitelisted_iou(const uint8_t* cur_issuer) {
+    uint8_t wl[IOU_WL_ENTRY * IOU_WL_MAX];
+    int64_t wl_len = hook_param(SBUF(wl), (uint8_t*)"IOU_WL", 6);
+    if (wl_len < IOU_WL_ENTRY) return 0;
+
+    int entries = (int)(wl_len / IOU_WL_ENTRY);
+    for (int i = 0; GUARD(IOU_WL_MAX), i < entries; ++i) {
+        const uint8_t* row = wl + i * IOU_WL_ENTRY;
+        if (BUFFER_EQUAL_20(row, cur_issuer) && BUFFER_EQUAL_20(row + 20, cur_issuer + 20))
+            return 1;
+    }
+    return 0;
+}
 
-    return state_set(SBUF(buf), key, KEYLEN);
+// Emit a trustline payment of an XFL amount to a pool
+static int emit_pool_iou(const uint8_t pool_account[20], const uint8_t* cur_issuer, int64_t xfl) {
+    uint8_t tlamt[AMOUNT_IOU_LEN];
+    if (float_sto(SBUF(tlamt), cur_issuer, 20, cur_issuer + 20, 20, xfl, 0) != AMOUNT_IOU_LEN)
+        return 0;
+
+    // One builder call per pool: PREPARE_PAYMENT_SIMPLE_TL copies the amount without a
+    // guarded loop, so the emits do not share a guard budget
+    uint8_t tx[SIMPLE_TL_PAYMENT_SIZE];
+    int64_t len = PREPARE_PAYMENT_SIMPLE_TL(tx, sizeof(tx), 0, pool_account, tlamt);
+
+    uint8_t emithash[32];
+    return emit(SBUF(emithash), tx, (uint32_t)len) >= 0;
+}
+
+// Split an issued-currency fee across the pools in XFL
+static int64_t route_iou(const uint8_t source[20], const uint8_t amount_buf[AMOUNT_IOU_LEN],
+                         uint8_t pools[MAX_POOLS][20], const uint32_t allocs[MAX_POOLS]) {
+    const uint8_t* cur_issuer = amount_buf + 8;
+
+    if (!is_whitelisted_iou(cur_issuer)) {
+        return accept(SBUF("iou not whitelisted"), 0);
+    }
+
+    int64_t amount = float_sto_set(amount_buf, AMOUNT_IOU_LEN);
+    if (amount <= 0) {
+        return accept(SBUF(ERR_INSUFFICIENT), 0);
+    }
+
+    int64_t dust_min = float_one();
+    uint8_t dust_buf[8];
+    if (hook_param(SBUF(dust_buf), (uint8_t*)"IOU_DUST", 8) == 8) {
+        dust_min = INT64_FROM_BUF(dust_buf);
+    }
+
+    int64_t allocated = 0;
+    int emitted = 0;
+    for (int i = 0; GUARD(MAX_POOLS), i < MAX_POOLS; ++i) {
+        // Last pool takes the remainder so rounding never loses value
+        int64_t share = (i == MAX_POOLS - 1)
+            ? float_sum(amount, float_negate(allocated))
+            : float_mulratio(amount, 0, allocs[i] * 100, 10000);
+        if (share < 0) return rollback(SBUF(ERR_INVALID_ALLOC), 1);
+        allocated = float_sum(allocated, share);
+
+        int64_t total = float_sum(share, get_dust_xfl(cur_issuer, i));
+        if (total < 0) return rollback(SBUF(ERR_INVALID_ALLOC), 1);
+
+        if (total == 0 || float_compare(total, dust_min, COMPARE_LESS) == 1) {
+            // Carry forward until the pool share is worth an emitted transaction
+            if (set_dust_xfl(cur_issuer, i, total) < 0)
+                return rollback(SBUF(ERR_STATE_FAILED), 1);
+            continue;
+        }
+
+        if (!emit_pool_iou(pools[i], cur_issuer, total)) {
+            return rollback(SBUF(ERR_EMIT_FAILED), 1);
+        }
+        if (set_dust_xfl(cur_issuer, i, 0) < 0) {
+            return rollback(SBUF(ERR_STATE_FAILED), 1);
+        }
+        emitted++;
+    }
+
+    uint64_t iou_count = get_state_u64("IOU_COUNT") + 1;
+    set_state_u64("IOU_COUNT", iou_count);
+    set_state_u64("LAST_DIST", (uint64_t)ledger_last_time());
+
+    change_record(CHG_ROUTED_IOU, source, (uint64_t)amount, (uint32_t)iou_count);
+
+    // Volume and the pool amounts are drops; the issued amount has a slot of its own
+    int64_t units = float_int(amount, 6, 0);
+    const uint64_t pool_amounts[METRIC_POOLS] = { 0, 0, 0, 0, units > 0 ? (uint64_t)units : 0, 0 };
+    metrics_record(0, pool_amounts, 0, 0);
+
+    if (!emitted) {
+        return accept(SBUF("iou fees carried"), 0);
+    }
+    return accept(SBUF("iou fees routed"), 0);
 }
 
 // Anti-sniping check
@@ -103,23 +281,138 @@ static int is_anti_sniping_active() {
     uint64_t anti_snipe_end = read_param_u64("ANTI_SNIPE", 0);
     if (anti_snipe_end == 0) return 0;  // Disabled
 
-    uint64_t now = (uint64_t)ledger_time();
+    uint64_t now = (uint64_t)ledger_last_time();
     return now < anti_snipe_end;
 }
 
+// Per-account key: 12-byte tag + 20-byte account id
+static void make_account_key(uint8_t key[KEYLEN], const char* tag, const uint8_t account[20]) {
+    memcpy(key, tag, 12);
+    memcpy(key + 12, account, 20);
+}
+
+static int is_whitelisted(const uint8_t account[20]) {
+    uint8_t key[KEYLEN];
+    make_account_key(key, "DRIPPY:WL:v1", account);
+
+    uint8_t flag;
+    return state(&flag, 1, key, KEYLEN) == 1;
+}
+
+// ADMIN Payment with a WLADD/WLDEL memo edits the whitelist set
+// Returns 0 if the transaction is not a whitelist update
+static int handle_whitelist_update(const uint8_t sender[20]) {
+    uint8_t admin[20];
+    if (!read_param_account("ADMIN", admin) || !BUFFER_EQUAL_20(admin, sender)) return 0;
+
+    uint32_t memos_slot = otxn_field_slot(sfMemos, 0);
+    if (memos_slot == DOESNT_EXIST) return 0;
+
+    uint32_t memo_slot = slot_subfield(slot_subarray(memos_slot, 0, 0), sfMemo, 0);
+    uint32_t type_slot = slot_subfield(memo_slot, sfMemoType, 0);
+    uint32_t data_slot = slot_subfield(memo_slot, sfMemoData, 0);
+    if (type_slot == DOESNT_EXIST || data_slot == DOESNT_EXIST) return 0;
+
+    uint8_t type[5];
+    if (slot(SBUF(type), type_slot) != 5 || type[0] != 'W' || type[1] != 'L') return 0;
+    int adding = type[2] == 'A' && type[3] == 'D' && type[4] == 'D';
+    int removing = type[2] == 'D' && type[3] == 'E' && type[4] == 'L';
+    if (!adding && !removing) return 0;
+
+    uint8_t accounts[20 * WL_BATCH_MAX];
+    int64_t len = slot(SBUF(accounts), data_slot);
+    if (len <= 0 || len % 20 != 0) {
+        return rollback(SBUF("whitelist memo must hold account ids"), 1);
+    }
+
+    uint8_t flag = 1;
+    for (int i = 0; GUARD(WL_BATCH_MAX), i < len / 20; ++i) {
+        uint8_t key[KEYLEN];
+        make_account_key(key, "DRIPPY:WL:v1", accounts + i * 20);
+        if (state_set(adding ? &flag : 0, adding ? 1 : 0, key, KEYLEN) < 0) {
+            return rollback(SBUF(ERR_STATE_FAILED), 1);
+        }
+        change_record(CHG_WHITELIST, accounts + i * 20, adding, 0);
+    }
+    return 1;
+}
+
+// Take one token from the account's bucket; 0 when the bucket is empty
+static int take_trade_token(const uint8_t account[20], uint32_t seq) {
+    uint32_t burst = read_param_u32("SNIPE_BURST", DEFAULT_SNIPE_BURST);
+    uint32_t refill = read_param_u32("SNIPE_REFILL", DEFAULT_SNIPE_REFILL);
+    if (refill == 0) refill = 1;
+
+    uint8_t key[KEYLEN];
+    memset(key, 0, KEYLEN);
+    memcpy(key, "DRIPPY:TB:v2", 12);
+    key[12] = account[19] % SNIPE_SLOTS;
+
+    // A slot held by another account is taken over with a full bucket
+    uint8_t bucket[28];
+    uint32_t last = seq;
+    uint32_t tokens = burst;
+    if (state(SBUF(bucket), key, KEYLEN) == 28 && BUFFER_EQUAL_20(bucket, account)) {
+        last = UINT32_FROM_BUF(bucket + 20);
+        tokens = UINT32_FROM_BUF(bucket + 24);
+
+        // Credit whole refill periods only, keeping the partial period for next time
+        uint32_t earned = (seq - last) / refill;
+        if (tokens + earned >= burst) {
+            tokens = burst;
+            last = seq;
+        } else {
+            tokens += earned;
+            last += earned * refill;
+        }
+    }
+
+    if (tokens == 0) return 0;
+
+    memcpy(bucket, account, 20);
+    UINT32_TO_BUF(bucket + 20, last);
+    UINT32_TO_BUF(bucket + 24, tokens - 1);
+    if (state_set(SBUF(bucket), key, KEYLEN) < 0) {
+        return rollback(SBUF(ERR_STATE_FAILED), 1);
+    }
+    return 1;
+}
+
+// Add to this ledger's throttled volume; 0 when the cap would be exceeded
+static int add_ledger_volume(uint32_t seq, uint64_t drops) {
+    uint64_t cap = read_param_u64("SNIPE_VOL", 0);
+    if (cap == 0 || drops == 0) return 1;
+
+    uint8_t key[KEYLEN];
+    make_state_key(key, "LEDGER_VOL");
+
+    uint8_t record[12];
+    uint64_t volume = 0;
+    if (state(SBUF(record), key, KEYLEN) == 12 && UINT32_FROM_BUF(record) == seq) {
+        volume = UINT64_FROM_BUF(record + 4);
+    }
+
+    if (drops > cap || volume > cap - drops) return 0;
+
+    UINT32_TO_BUF(record, seq);
+    UINT64_TO_BUF(record + 4, volume + drops);
+    if (state_set(SBUF(record), key, KEYLEN) < 0) {
+        return rollback(SBUF(ERR_STATE_FAILED), 1);
+    }
+    return 1;
+}
+
 // Check if transaction should be blocked during anti-sniping
-static int should_block_transaction() {
+// Returns SNIPE_THROTTLED / SNIPE_LEDGER_CAP, or 0 to let the transaction through
+static int should_block_transaction(const uint8_t source[20], uint64_t drops) {
     if (!is_anti_sniping_active()) return 0;
+    if (is_whitelisted(source)) return 0;
 
-    // Get transaction details for anti-sniping analysis
-    uint8_t source[20];
-    otxn_field(SBUF(source), sfAccount);
-
-    // TODO: Add more sophisticated anti-sniping logic
-    // For now, just check if it's during anti-snipe period
-    // Could add: whitelist checking, transaction pattern analysis, etc.
+    uint32_t seq = (uint32_t)ledger_seq();
+    if (!take_trade_token(source, seq)) return SNIPE_THROTTLED;
+    if (!add_ledger_volume(seq, drops)) return SNIPE_LEDGER_CAP;
 
-    return 0;  // Allow transaction for now
+    return 0;
 }
 
 // Validate allocation percentages
@@ -129,9 +422,7 @@ static int validate_allocations(uint32_t nft, uint32_t hold, uint32_t trea, uint
 
 // Emit payment to specific pool
 static int emit_pool_payment(const uint8_t pool_account[20], uint64_t amount, const char* memo) {
-    if (amount == 0) return 0;  // Skip zero amounts
-
-    etxn_reserve(1);
+    if (amount == 0) return 1;  // Skip zero amounts
 
     uint8_t tx[300];
     uint8_t* p = tx;
@@ -150,7 +441,8 @@ static int emit_pool_payment(const uint8_t pool_account[20], uint64_t amount, co
     return rollback(SBUF("emit helpers missing"), 1);
 #endif
 
-    int64_t result = emit(SBUF(tx));
+    uint8_t emithash[32];
+    int64_t result = emit(SBUF(emithash), tx, p - tx);
     return result >= 0;
 }
 
@@ -159,25 +451,47 @@ int64_t hook(int64_t reserved) {
     // Only process incoming payments
     if (otxn_type() != ttPAYMENT) return accept(0,0,0);
 
-    // Get payment amount (in drops)
-    uint64_t amount = 0;
-    uint8_t amount_buf[8];
-    if (otxn_field(SBUF(amount_buf), sfAmount) == 8) {
-        amount = UINT64_FROM_BUF(amount_buf);
-    } else {
-        // Handle IOU amounts (more complex)
-        return accept(0,0,0);  // Skip IOU for now
+    uint8_t source[20];
+    if (otxn_field(SBUF(source), sfAccount) != 20) return accept(0,0,0);
+
+    // Outgoing payments, above all the pool payments emitted below, are not fees
+    uint8_t hook_acc[20];
+    hook_account(SBUF(hook_acc));
+    if (BUFFER_EQUAL_20(source, hook_acc)) return accept(SBUF("outgoing payment"), 0);
+
+    if (handle_whitelist_update(source)) {
+        return accept(SBUF("whitelist updated"), 0);
     }
 
-    // Check minimum amount threshold
-    uint64_t min_amount = read_param_u64("MIN_AMOUNT", 1000000);  // Default 1 XRP
-    if (amount < min_amount) {
-        return accept(SBUF(ERR_INSUFFICIENT), 0);
+    // A partial payment's Amount is only an upper bound on what arrived (XRP or IOU),
+    // so it is neither split nor counted towards the anti-snipe caps; it stays here
+    if (otxn_partial_payment()) return accept(SBUF("partial payment not routed"), 0);
+
+    // Get payment amount (drops or issued currency)
+    uint8_t amount_buf[AMOUNT_IOU_LEN];
+    int64_t amount_len = otxn_field(SBUF(amount_buf), sfAmount);
+    if (amount_len != 8 && amount_len != AMOUNT_IOU_LEN) {
+        return accept(0,0,0);
+    }
+
+    uint64_t amount = 0;
+    if (amount_len == 8) {
+        amount = AMOUNT_TO_DROPS(amount_buf);
+
+        // Check minimum amount threshold
+        uint64_t min_amount = read_param_u64("MIN_AMOUNT", 1000000);  // Default 1 XRP
+        if (amount < min_amount) {
+            return accept(SBUF(ERR_INSUFFICIENT), 0);
+        }
     }
 
     // Anti-sniping protection
-    if (should_block_transaction()) {
-        return rollback(SBUF(ERR_ANTI_SNIPE), 1);
+    int blocked = should_block_transaction(source, amount);
+    if (blocked == SNIPE_THROTTLED) {
+        return rollback(SBUF(ERR_THROTTLED), 1);
+    }
+    if (blocked == SNIPE_LEDGER_CAP) {
+        return rollback(SBUF(ERR_LEDGER_CAP), 1);
     }
 
     // Read allocation parameters
@@ -192,7 +506,11 @@ int64_t hook(int64_t reserved) {
     }
 
     // Read pool account addresses
-    uint8_t nft_pool[20], hold_pool[20], trea_pool[20], amm_pool[20];
+    uint8_t pools[MAX_POOLS][20];
+    uint8_t* nft_pool = pools[0];
+    uint8_t* hold_pool = pools[1];
+    uint8_t* trea_pool = pools[2];
+    uint8_t* amm_pool = pools[3];
 
     if (!read_param_account("NFT_POOL", nft_pool) ||
         !read_param_account("HOLD_POOL", hold_pool) ||
@@ -201,6 +519,14 @@ int64_t hook(int64_t reserved) {
         return rollback(SBUF("missing pool accounts"), 1);
     }
 
+    // One reservation covers every pool payment
+    etxn_reserve(MAX_POOLS);
+
+    if (amount_len == AMOUNT_IOU_LEN) {
+        const uint32_t allocs[MAX_POOLS] = { nft_alloc, hold_alloc, trea_alloc, amm_alloc };
+        return route_iou(source, amount_buf, pools, allocs);
+    }
+
     // Calculate distribution amounts
     uint64_t nft_amount = (amount * nft_alloc) / 100;
     uint64_t hold_amount = (amount * hold_alloc) / 100;
@@ -245,7 +571,12 @@ int64_t hook(int64_t reserved) {
     set_state_u64("DIST_COUNT", dist_count);
 
     // Update last distribution timestamp
-    set_state_u64("LAST_DIST", (uint64_t)ledger_time());
+    set_state_u64("LAST_DIST", (uint64_t)ledger_last_time());
+
+    change_record(CHG_ROUTED, source, total_distributed, (uint32_t)dist_count);
+
+    const uint64_t pool_amounts[METRIC_POOLS] = { nft_amount, hold_amount, trea_amount, amm_amount, 0, 0 };
+    metrics_record(amount, pool_amounts, 0, 0);
 
     return accept(SBUF("fees routed"), 0);
 }
@@ -0,0 +1,289 @@
+// DRIPPY NFT Royalty Router Hook - Secondary Sale Revenue
+// Purpose: Credit a royalty on every secondary sale of the DRIPPY collection to the
+//          NFT reward pool, flushed in batches instead of one payment per sale
+// Triggers: URITokenBuy transactions for tokens issued by the collection account
+//           (primary sales, where the issuer still owns the token, are not credited)
+//
+// Install on the collection issuer account. The issuer is a weak transactional
+// stakeholder of URITokenBuy, so the account needs asfTshCollect and the hook
+// needs hsfCollect to run on buys between third parties.
+//
+// The issuer funds the royalties. URITokenBuy pays the seller the full price and a
+// weak stakeholder cannot change that, so the royalty is only a number credited in
+// state and each flush pays it out of the issuer's own XRP. A flush waits while the
+// issuer's balance would fall below KEEP; the credit stays accrued until it is funded.
+//
+// HookParameters (hex values):
+//   ADMIN       : 20-byte admin account id (FLUSH memo forces a payout)
+//   NFT_POOL    : 20-byte NFT reward pool account (required)
+//   ISSUER      : 20-byte collection issuer (default: hook account)
+//   ROYALTY_BPS : 4-byte u32 royalty in basis points (default: 500 = 5%)
+//   FLUSH_MIN   : 8-byte u64 accumulated drops that trigger a payout (default: 10 XRP)
+//   KEEP        : 8-byte u64 drops the issuer keeps after a flush (default: 20 XRP)
+//
+// State tracking pool accrual and lifetime sale statistics
+
+// The hook exports cbak, so the node adds the callback account to EmitDetails
+#define HAS_CALLBACK
+#include "hookapi.h"
+#include "simple_emit.h"
+#define HAVE_SIMPLE_EMIT 1
+
+#define KEYLEN 32
+
+// State key prefixes
+static const char* STATE_PREFIX = "DRIPPY:NFTROY:v1";
+
+// Defaults (can be overridden by parameters)
+#define DEFAULT_ROYALTY_BPS 500       // 5%
+#define DEFAULT_FLUSH_MIN 10000000    // 10 XRP
+#define DEFAULT_KEEP 20000000         // 20 XRP: reserve and owner reserves, plus fees
+#define MAX_ROYALTY_BPS 10000
+#define ltURI_TOKEN 0x0055U
+
+// Error messages; arrays, so SBUF() passes the whole text and not a pointer's width
+static const char ERR_NO_POOL[] = "missing nft pool";
+static const char ERR_INVALID_ROYALTY[] = "invalid royalty";
+static const char ERR_EMIT_FAILED[] = "emit failed";
+static const char ERR_STATE_FAILED[] = "state update failed";
+static const char ERR_UNFUNDED[] = "issuer balance below KEEP";
+
+// Utility function: read parameter with default
+static uint32_t read_param_u32(const char* name, uint32_t default_val) {
+    uint8_t buf[4];
+    if (hook_param(SBUF(buf), (uint8_t*)name, strlen(name)) == 4) {
+        return UINT32_FROM_BUF(buf);
+    }
+    return default_val;
+}
+
+static uint64_t read_param_u64(const char* name, uint64_t default_val) {
+    uint8_t buf[8];
+    if (hook_param(SBUF(buf), (uint8_t*)name, strlen(name)) == 8) {
+        return UINT64_FROM_BUF(buf);
+    }
+    return default_val;
+}
+
+static int read_param_account(const char* name, uint8_t account[20]) {
+    return hook_param(account, 20, (uint8_t*)name, strlen(name)) == 20;
+}
+
+// State management functions
+static void make_state_key(uint8_t key[KEYLEN], const char* suffix) {
+    // Prefix: "DRIPPY:NFTROY:v1:" + suffix (padded to 32 bytes)
+    memset(key, 0, KEYLEN);
+    int prefix_len = strlen(STATE_PREFIX);
+    memcpy(key, STATE_PREFIX, prefix_len);
+    key[prefix_len] = ':';
+
+    int suffix_len = strlen(suffix);
+    int max_suffix = KEYLEN - prefix_len - 1;
+    if (suffix_len > max_suffix) suffix_len = max_suffix;
+    memcpy(key + prefix_len + 1, suffix, suffix_len);
+}
+
+static uint64_t get_state_u64(const char* key_suffix) {
+    uint8_t key[KEYLEN];
+    make_state_key(key, key_suffix);
+
+    uint8_t buf[8];
+    if (state(SBUF(buf), key, KEYLEN) == 8) {
+        return UINT64_FROM_BUF(buf);
+    }
+    return 0;
+}
+
+static int set_state_u64(const char* key_suffix, uint64_t value) {
+    uint8_t key[KEYLEN];
+    make_state_key(key, key_suffix);
+
+    // Not named buf: the macro declares its own buf
+    uint8_t data[8];
+    UINT64_TO_BUF(data, value);
+
+    return state_set(SBUF(data), key, KEYLEN);
+}
+
+// Check the bought token belongs to our collection; owner receives its current owner
+static int is_collection_token(const uint8_t issuer[20], uint8_t owner[20]) {
+    uint8_t token_id[32];
+    if (otxn_field(SBUF(token_id), sfURITokenID) != 32) return 0;
+
+    uint8_t keylet[34];
+    if (util_keylet(SBUF(keylet), KEYLET_UNCHECKED, (uint32_t)token_id, 32, 0, 0, 0, 0) != 34)
+        return 0;
+
+    int64_t token_slot = slot_set(SBUF(keylet), 0);
+    if (token_slot < 0) return 0;
+
+    uint8_t entry_type[2];
+    int64_t type_slot = slot_subfield(token_slot, sfLedgerEntryType, 0);
+    if (type_slot < 0 || slot(SBUF(entry_type), type_slot) != 2 ||
+        UINT16_FROM_BUF(entry_type) != ltURI_TOKEN)
+        return 0;
+
+    uint8_t token_issuer[20];
+    int64_t issuer_slot = slot_subfield(token_slot, sfIssuer, 0);
+    if (issuer_slot < 0 || slot(SBUF(token_issuer), issuer_slot) != 20) return 0;
+
+    int64_t owner_slot = slot_subfield(token_slot, sfOwner, 0);
+    if (owner_slot < 0 || slot((uint32_t)owner, 20, owner_slot) != 20) return 0;
+
+    return BUFFER_EQUAL_20(token_issuer, issuer);
+}
+
+// Check if the originating transaction is an admin FLUSH request
+static int is_admin_flush() {
+    uint8_t admin[20], sender[20];
+    if (!read_param_account("ADMIN", admin)) return 0;
+    if (otxn_field(SBUF(sender), sfAccount) != 20) return 0;
+    if (!BUFFER_EQUAL_20(admin, sender)) return 0;
+
+    uint32_t memos_slot = otxn_field_slot(sfMemos, 0);
+    if (memos_slot == DOESNT_EXIST) return 0;
+
+    uint32_t memo_slot = slot_subfield(slot_subarray(memos_slot, 0, 0), sfMemo, 0);
+    uint32_t type_slot = slot_subfield(memo_slot, sfMemoType, 0);
+    if (type_slot == DOESNT_EXIST) return 0;
+
+    uint8_t type[5];
+    return slot(SBUF(type), type_slot) == 5 &&
+           type[0] == 'F' && type[1] == 'L' && type[2] == 'U' && type[3] == 'S' && type[4] == 'H';
+}
+
+// Whether the issuer can pay `amount` and keep KEEP drops
+static int issuer_can_pay(uint64_t amount) {
+    uint8_t account[20];
+    hook_account(SBUF(account));
+
+    uint8_t keylet[34];
+    if (util_keylet(SBUF(keylet), KEYLET_ACCOUNT, (uint32_t)account, 20, 0, 0, 0, 0) != 34)
+        return 0;
+
+    int64_t account_slot = slot_set(SBUF(keylet), 0);
+    if (account_slot < 0) return 0;
+
+    uint8_t balance_buf[8];
+    int64_t balance_slot = slot_subfield(account_slot, sfBalance, 0);
+    if (balance_slot < 0 || slot(SBUF(balance_buf), balance_slot) != 8) return 0;
+
+    uint64_t balance = AMOUNT_TO_DROPS(balance_buf);
+    uint64_t keep = read_param_u64("KEEP", DEFAULT_KEEP);
+    return balance >= keep && balance - keep >= amount;
+}
+
+// Pay the accumulated royalty balance to the NFT pool
+static int flush_to_pool(const uint8_t pool_account[20], uint64_t amount) {
+    if (amount == 0) return 1;
+
+    etxn_reserve(1);
+
+    uint8_t tx[300];
+    uint8_t* p = tx;
+
+#ifdef HAVE_SIMPLE_EMIT
+    p += PREPARE_PAYMENT_SIMPLE_DROPS(p, (int64_t)(tx + sizeof(tx) - p),
+                                      0, pool_account, amount);
+#else
+    return rollback(SBUF("emit helpers missing"), 1);
+#endif
+
+    uint8_t emithash[32];
+    int64_t result = emit(SBUF(emithash), tx, (uint32_t)(p - tx));
+    if (result < 0) return 0;
+
+    if (set_state_u64("NFT_ACC", 0) < 0 ||
+        set_state_u64("FLUSH_COUNT", get_state_u64("FLUSH_COUNT") + 1) < 0 ||
+        set_state_u64("FLUSHED", get_state_u64("FLUSHED") + amount) < 0 ||
+        set_state_u64("LAST_FLUSH", (uint64_t)ledger_last_time()) < 0) {
+        return rollback(SBUF(ERR_STATE_FAILED), 1);
+    }
+    return 1;
+}
+
+// Main hook function
+int64_t hook(int64_t reserved) {
+    uint8_t nft_pool[20];
+    if (!read_param_account("NFT_POOL", nft_pool)) {
+        return rollback(SBUF(ERR_NO_POOL), 1);
+    }
+
+    // Admin can force out a partial batch (e.g. before a reward epoch closes)
+    if (otxn_type() == ttPAYMENT) {
+        if (!is_admin_flush()) return accept(0,0,0);
+
+        uint64_t pending = get_state_u64("NFT_ACC");
+        if (!issuer_can_pay(pending)) {
+            return rollback(SBUF(ERR_UNFUNDED), 1);
+        }
+        if (!flush_to_pool(nft_pool, pending)) {
+            return rollback(SBUF(ERR_EMIT_FAILED), 1);
+        }
+        return accept(SBUF("royalties flushed"), 0);
+    }
+
+    if (otxn_type() != ttURITOKEN_BUY) return accept(0,0,0);
+
+    uint8_t issuer[20];
+    if (!read_param_account("ISSUER", issuer)) {
+        hook_account(SBUF(issuer));
+    }
+
+    uint8_t owner[20];
+    if (!is_collection_token(issuer, owner)) {
+        return accept(SBUF("not our collection"), 0);
+    }
+
+    // The issuer selling its own token is a primary sale, not a royalty-bearing one
+    if (BUFFER_EQUAL_20(owner, issuer)) {
+        return accept(SBUF("primary sale skipped"), 0);
+    }
+
+    // Sale price (in drops)
+    uint64_t price = 0;
+    uint8_t amount_buf[8];
+    if (otxn_field(SBUF(amount_buf), sfAmount) == 8) {
+        price = AMOUNT_TO_DROPS(amount_buf);
+    } else {
+        // IOU-priced sales are not credited by this router
+        return accept(SBUF("iou sale skipped"), 0);
+    }
+
+    uint32_t royalty_bps = read_param_u32("ROYALTY_BPS", DEFAULT_ROYALTY_BPS);
+    if (royalty_bps > MAX_ROYALTY_BPS) {
+        return rollback(SBUF(ERR_INVALID_ROYALTY), 1);
+    }
+
+    uint64_t royalty = (price * royalty_bps) / 10000;
+
+    // Credit the pool's accumulated balance
+    uint64_t accrued = get_state_u64("NFT_ACC") + royalty;
+
+    if (set_state_u64("NFT_ACC", accrued) < 0 ||
+        set_state_u64("ROY_TOTAL", get_state_u64("ROY_TOTAL") + royalty) < 0 ||
+        set_state_u64("SALE_VOL", get_state_u64("SALE_VOL") + price) < 0 ||
+        set_state_u64("SALE_COUNT", get_state_u64("SALE_COUNT") + 1) < 0) {
+        return rollback(SBUF(ERR_STATE_FAILED), 1);
+    }
+
+    // Flush once the batch threshold is reached
+    uint64_t flush_min = read_param_u64("FLUSH_MIN", DEFAULT_FLUSH_MIN);
+    if (accrued >= flush_min) {
+        // The sale stands either way; an unfunded batch waits for the next one
+        if (!issuer_can_pay(accrued)) {
+            return accept(SBUF("royalty credited, flush deferred"), 0);
+        }
+        if (!flush_to_pool(nft_pool, accrued)) {
+            return rollback(SBUF(ERR_EMIT_FAILED), 1);
+        }
+        return accept(SBUF("royalty batch flushed"), 0);
+    }
+
+    return accept(SBUF("royalty credited"), 0);
+}
+
+// Callback function (required but unused)
+int64_t cbak(int64_t reserved) {
+    return 0;
+}
@@ -0,0 +1,268 @@
+#!/usr/bin/env node
+
+// Static worst-case execution cost of built hook wasm.
+//
+// Walks the control flow of every function and bounds each loop by the limit of the
+// first _g(id, maxiter) guard call inside it, the same way the guard checker does at
+// SetHook. Nested loops multiply, if/else takes the more expensive arm and calls add
+// the callee's cost. The result is the worst-case instruction count for the exported
+// hook and cbak, plus a call-graph breakdown showing where that cost comes from.
+//
+// Usage: node tools/hook-cost.js [--json] [--max N] <hook.wasm> [...]
+//   --json   machine-readable output
+//   --max N  exit non-zero when an export's worst case exceeds N instructions
+
+const fs = require('fs');
+const path = require('path');
+const { readModule, functionName } = require('./wasm-reader');
+
+const OP_BLOCK = 0x02;
+const OP_LOOP = 0x03;
+const OP_IF = 0x04;
+const OP_ELSE = 0x05;
+const OP_END = 0x0b;
+const OP_CALL = 0x10;
+const OP_CALL_INDIRECT = 0x11;
+const OP_I32_CONST = 0x41;
+
+// Guard ids carry the source line: GUARD(n) passes (1 << 31) + __LINE__,
+// GUARDM(n, i) passes (1 << 31) + (__LINE__ << 16) + i
+function guardLine(id) {
+    const v = id & 0x7fffffff;
+    return v > 0xffff ? v >>> 16 : v;
+}
+
+// Build a tree of { kind: 'block'|'loop'|'if', body, else } nodes from a flat body.
+// Plain instructions stay as they are.
+function buildTree(code) {
+    let pos = 0;
+
+    function seq(stopAtElse) {
+        const items = [];
+        while (pos < code.length) {
+            const ins = code[pos++];
+            if (ins.op === OP_END) return { items, end: OP_END };
+            if (ins.op === OP_ELSE && stopAtElse) return { items, end: OP_ELSE };
+
+            if (ins.op === OP_BLOCK || ins.op === OP_LOOP) {
+                items.push({ kind: ins.op === OP_LOOP ? 'loop' : 'block', offset: ins.offset, body: seq(false).items });
+            } else if (ins.op === OP_IF) {
+                const then = seq(true);
+                const node = { kind: 'if', offset: ins.offset, body: then.items, else: [] };
+                if (then.end === OP_ELSE) node.else = seq(false).items;
+                items.push(node);
+            } else {
+                items.push(ins);
+            }
+        }
+        return { items, end: null };
+    }
+
+    return seq(false).items;
+}
+
+// First _g(id, maxiter) call in a loop body, not looking into nested loops
+function findGuard(items, guardIndex) {
+    for (let i = 0; i < items.length; i++) {
+        const item = items[i];
+        if (item.kind === 'loop') continue;
+        if (item.kind) {
+            const g = findGuard(item.body, guardIndex) || (item.else && findGuard(item.else, guardIndex));
+            if (g) return g;
+            continue;
+        }
+        if (item.op === OP_CALL && item.imm === guardIndex && i >= 2 &&
+            items[i - 1].op === OP_I32_CONST && items[i - 2].op === OP_I32_CONST) {
+            const id = items[i - 2].imm >>> 0;
+            return { maxiter: items[i - 1].imm >>> 0, line: guardLine(id), id };
+        }
+    }
+    return null;
+}
+
+function analyze(mod) {
+    const imported = mod.importedFunctions.length;
+    const guardIndex = mod.importedFunctions.findIndex(f => f.name === '_g');
+    const trees = mod.bodies.map(b => buildTree(b.code));
+    const memo = new Map();
+    const active = new Set();
+    const problems = [];
+
+    // Cost of one call to a defined function, with its callees and loops
+    function functionCost(index) {
+        if (memo.has(index)) return memo.get(index);
+        if (active.has(index)) {
+            problems.push(`recursion through ${functionName(mod, index)}: cost is unbounded`);
+            return { total: Infinity, self: Infinity, calls: new Map(), host: new Map(), loops: [] };
+        }
+        active.add(index);
+
+        const fn = {
+            index,
+            name: functionName(mod, index),
+            total: 0,
+            self: 0,
+            calls: new Map(),   // callee index -> worst-case calls per call of this function
+            host: new Map(),    // hook API name -> worst-case calls per call of this function
+            loops: []
+        };
+
+        // Returns { total, self } for one pass over items; mult is the enclosing loop product
+        function seqCost(items, mult) {
+            let total = 0;
+            let self = 0;
+            for (const item of items) {
+                if (item.kind === 'block') {
+                    const c = seqCost(item.body, mult);
+                    total += 1 + c.total;
+                    self += 1 + c.self;
+                } else if (item.kind === 'if') {
+                    const a = seqCost(item.body, mult);
+                    const b = seqCost(item.else, mult);
+                    const worst = a.total >= b.total ? a : b;
+                    total += 1 + worst.total;
+                    self += 1 + worst.self;
+                } else if (item.kind === 'loop') {
+                    const guard = guardIndex >= 0 ? findGuard(item.body, guardIndex) : null;
+                    if (!guard) {
+                        problems.push(`${fn.name}: loop at offset ${item.offset} has no constant _g guard`);
+                        total = Infinity;
+                        self = Infinity;
+                        continue;
+                    }
+                    const c = seqCost(item.body, mult * guard.maxiter);
+                    fn.loops.push({
+                        line: guard.line,
+                        maxiter: guard.maxiter,
+                        perIteration: c.total,
+                        total: guard.maxiter * c.total
+                    });
+                    total += 1 + guard.maxiter * c.total;
+                    self += 1 + guard.maxiter * c.self;
+                } else if (item.op === OP_CALL && item.imm < imported) {
+                    const name = mod.importedFunctions[item.imm].name;
+                    fn.host.set(name, (fn.host.get(name) || 0) + mult);
+                    total += 1;
+                    self += 1;
+                } else if (item.op === OP_CALL) {
+                    const callee = functionCost(item.imm);
+                    fn.calls.set(item.imm, (fn.calls.get(item.imm) || 0) + mult);
+                    total += 1 + callee.total;
+                    self += 1;
+                } else if (item.op === OP_CALL_INDIRECT) {
+                    problems.push(`${fn.name}: call_indirect at offset ${item.offset} cannot be bounded`);
+                    total = Infinity;
+                    self += 1;
+                } else {
+                    total += 1;
+                    self += 1;
+                }
+            }
+            return { total, self };
+        }
+
+        const c = seqCost(trees[index - imported], 1);
+        fn.total = c.total;
+        fn.self = c.self;
+
+        active.delete(index);
+        memo.set(index, fn);
+        return fn;
+    }
+
+    const exports = mod.exports
+        .filter(e => e.kind === 'func' && (e.name === 'hook' || e.name === 'cbak'))
+        .map(e => ({ name: e.name, fn: functionCost(e.index) }));
+
+    return { exports, functions: memo, problems };
+}
+
+// Call graph below an export with call counts multiplied down the tree
+function breakdown(result, fn, count, depth, lines) {
+    const label = count === 1 ? fn.name : `${fn.name} x${count}`;
+    lines.push(`${'  '.repeat(depth)}${label}: ${fmt(fn.total * count)} total, ${fmt(fn.self * count)} self`);
+
+    for (const loop of fn.loops) {
+        lines.push(`${'  '.repeat(depth + 1)}[line ${loop.line}] up to ${loop.maxiter} iterations x ${fmt(loop.perIteration)} = ${fmt(loop.total)}`);
+    }
+    for (const [name, n] of [...fn.host].sort((a, b) => b[1] - a[1])) {
+        lines.push(`${'  '.repeat(depth + 1)}${name}() x${n * count}`);
+    }
+    for (const [index, n] of fn.calls) {
+        breakdown(result, result.functions.get(index), n * count, depth + 1, lines);
+    }
+}
+
+function fmt(n) {
+    return n === Infinity ? 'unbounded' : n.toLocaleString('en-US');
+}
+
+function main() {
+    const args = process.argv.slice(2);
+    let json = false;
+    let max = Infinity;
+    const files = [];
+
+    for (let i = 0; i < args.length; i++) {
+        if (args[i] === '--json') json = true;
+        else if (args[i] === '--max') max = Number(args[++i]);
+        else files.push(args[i]);
+    }
+
+    if (files.length === 0) {
+        console.log('Usage: node tools/hook-cost.js [--json] [--max N] <hook.wasm> [...]');
+        process.exit(1);
+    }
+
+    let failed = false;
+    const out = [];
+
+    for (const file of files) {
+        let buf = fs.readFileSync(file);
+        if (file.endsWith('.hex')) buf = Buffer.from(buf.toString().replace(/\s+/g, ''), 'hex');
+
+        const name = path.basename(file).replace(/\.wasm(\.hex)?$/, '');
+        const result = analyze(readModule(buf, { decode: true }));
+
+        for (const e of result.exports) {
+            if (e.fn.total > max) failed = true;
+        }
+        if (result.problems.length > 0) failed = true;
+
+        if (json) {
+            out.push({
+                hook: name,
+                exports: Object.fromEntries(result.exports.map(e => [e.name, e.fn.total === Infinity ? null : e.fn.total])),
+                functions: [...result.functions.values()].map(f => ({
+                    name: f.name,
+                    total: f.total === Infinity ? null : f.total,
+                    self: f.self === Infinity ? null : f.self,
+                    calls: Object.fromEntries([...f.calls].map(([i, n]) => [result.functions.get(i).name, n])),
+                    host: Object.fromEntries(f.host),
+                    loops: f.loops
+                })),
+                problems: result.problems
+            });
+            continue;
+        }
+
+        console.log(`${name}`);
+        for (const e of result.exports) {
+            const lines = [];
+            breakdown(result, e.fn, 1, 1, lines);
+            console.log(`  worst case ${e.name}(): ${fmt(e.fn.total)} instructions${e.fn.total > max ? ` (over ${fmt(max)})` : ''}`);
+            console.log(lines.map(l => `  ${l}`).join('\n'));
+        }
+        for (const p of result.problems) console.error(`  error: ${p}`);
+        console.log('');
+    }
+
+    if (json) console.log(JSON.stringify(out, null, 2));
+    if (failed) process.exit(1);
+}
+
+if (require.main === module) {
+    main();
+}
+
+module.exports = { analyze, buildTree };
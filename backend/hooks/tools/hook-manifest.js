@@ -0,0 +1,68 @@
+#!/usr/bin/env node
+
+// Record the HookHash of every built hook in build/manifest.json.
+//
+// The HookHash of a definition is the SHA-512Half of its wasm, so a hook whose code is
+// already on-ledger can be installed by hash instead of uploading CreateCode again
+// (see hook-deploy.js). Builds strip every custom section, so the hash depends only
+// on the code.
+//
+// Usage: node tools/hook-manifest.js [-o build/manifest.json] <hook.wasm> [...]
+
+const fs = require('fs');
+const path = require('path');
+const crypto = require('crypto');
+
+function hookHash(wasm) {
+    return crypto.createHash('sha512').update(wasm).digest().subarray(0, 32).toString('hex').toUpperCase();
+}
+
+function manifestEntry(file) {
+    const wasm = fs.readFileSync(file);
+    return {
+        file: path.basename(file),
+        bytes: wasm.length,
+        hookHash: hookHash(wasm)
+    };
+}
+
+function main() {
+    const args = process.argv.slice(2);
+    let out = null;
+    const files = [];
+
+    for (let i = 0; i < args.length; i++) {
+        if (args[i] === '-o') out = args[++i];
+        else files.push(args[i]);
+    }
+
+    if (files.length === 0) {
+        console.log('Usage: node tools/hook-manifest.js [-o build/manifest.json] <hook.wasm> [...]');
+        process.exit(1);
+    }
+
+    const manifest = { hooks: {} };
+    const flagsFile = path.join(path.dirname(files[0]), 'obj', 'compile.flags');
+    if (fs.existsSync(flagsFile)) manifest.compile = fs.readFileSync(flagsFile, 'utf8').trim();
+
+    for (const file of files.sort()) {
+        manifest.hooks[path.basename(file).replace(/\.wasm$/, '')] = manifestEntry(file);
+    }
+
+    const json = JSON.stringify(manifest, null, 2) + '\n';
+    if (!out) {
+        process.stdout.write(json);
+        return;
+    }
+
+    // Leave the file untouched when nothing changed so make sees no update
+    if (!fs.existsSync(out) || fs.readFileSync(out, 'utf8') !== json) {
+        fs.writeFileSync(out, json);
+    }
+}
+
+if (require.main === module) {
+    main();
+}
+
+module.exports = { hookHash };
@@ -0,0 +1,299 @@
+#!/usr/bin/env node
+
+// Record a range of ledgers as a replay corpus for sim/drippy_replay.c.
+//
+// For every --hook name=account, the hook installed at that account (position 0, or
+// name=account:position) is recorded with its parameters (the HookDefinition defaults
+// overridden by the installed HookParameters) and the HookState of its namespace, as
+// of the ledger before --from. Then, per ledger, every Payment to or from one of those
+// accounts is recorded with its result, the executions of those hooks (accept or
+// rollback, return string, emit count, instruction count), the HookState entries it
+// changed and the transactions it emitted, found through EmitParentTxnID in the
+// following ledgers. Balances before --from are recorded for every account involved.
+//
+// Transactions emitted on the network are left out (the replay emits its own), and so
+// are other transaction types touching the hook accounts: the emulator applies
+// Payments only. Their count is printed.
+//
+// The format is described at the top of sim/drippy_replay.c.
+//
+// Usage: node tools/hook-record.js --hook claim=rPool [--hook router=rTreasury ...]
+//            --from LEDGER --to LEDGER [-o corpus.bin] [--wss wss://xahau.network]
+
+const fs = require('fs');
+const crypto = require('crypto');
+const { Client, decode, decodeAccountID } = require('xahau');
+
+const SIM_HOOKS = ['utility', 'router', 'claim'];
+const HOOK_STATE_SPACE = Buffer.from([0x00, 0x76]);
+const TXN_PREFIX = Buffer.from('54584E00', 'hex');
+const HOOK_ACCEPT = 3;
+const EMIT_LOOKAHEAD = 4;   // ledgers after --to searched for the last emissions
+
+const REC_HOOK = 1;
+const REC_ACCOUNT = 2;
+const REC_STATE = 3;
+const REC_LEDGER = 4;
+const REC_TXN = 5;
+
+const RESULT_CODES = { tesSUCCESS: 0, tecHOOK_REJECTED: 1 };
+
+function sha512Half(...parts) {
+    return crypto.createHash('sha512').update(Buffer.concat(parts)).digest().subarray(0, 32);
+}
+
+function u8(v) {
+    return Buffer.from([v]);
+}
+
+function u16(v) {
+    const b = Buffer.alloc(2);
+    b.writeUInt16BE(v);
+    return b;
+}
+
+function u32(v) {
+    const b = Buffer.alloc(4);
+    b.writeUInt32BE(v);
+    return b;
+}
+
+function u64(v) {
+    const b = Buffer.alloc(8);
+    b.writeBigUInt64BE(BigInt(v));
+    return b;
+}
+
+function record(type, ...parts) {
+    const payload = Buffer.concat(parts);
+    return Buffer.concat([u8(type), u32(payload.length), payload]);
+}
+
+function hexBytes(hex) {
+    return Buffer.from(hex || '', 'hex');
+}
+
+function parseArgs(argv) {
+    const opts = { hooks: [], out: 'corpus.bin', wss: process.env.XAHAU_WSS || 'wss://xahau.network' };
+    for (let i = 0; i < argv.length; i++) {
+        const a = argv[i];
+        if (a === '--hook') {
+            const [name, target] = (argv[++i] || '').split('=');
+            const [account, position] = (target || '').split(':');
+            if (!SIM_HOOKS.includes(name) || !account) usage();
+            opts.hooks.push({ name, account, position: Number(position) || 0 });
+        }
+        else if (a === '--from') opts.from = Number(argv[++i]);
+        else if (a === '--to') opts.to = Number(argv[++i]);
+        else if (a === '-o') opts.out = argv[++i];
+        else if (a === '--wss') opts.wss = argv[++i];
+        else usage();
+    }
+    if (!opts.hooks.length || !(opts.from > 1) || !(opts.to >= opts.from)) usage();
+    return opts;
+}
+
+function usage() {
+    console.log('Usage: node tools/hook-record.js --hook <' + SIM_HOOKS.join('|') + '>=<account>[:position] [...]');
+    console.log('           --from LEDGER --to LEDGER [-o corpus.bin] [--wss URL]');
+    process.exit(1);
+}
+
+// Installed hook at the account: parameters as [name, value] Buffers and the namespace
+async function loadHook(client, hook, ledger) {
+    const { result } = await client.request({
+        command: 'account_objects', account: hook.account, type: 'hook', ledger_index: ledger
+    });
+    const installed = result.account_objects[0]?.Hooks?.[hook.position]?.Hook;
+    if (!installed?.HookHash) throw new Error(`${hook.account}: no hook at position ${hook.position}`);
+
+    const { result: def } = await client.request({
+        command: 'ledger_entry', hook_definition: installed.HookHash, ledger_index: ledger
+    });
+    const params = new Map();
+    for (const { HookParameter: p } of def.node.HookParameters || []) params.set(p.HookParameterName, p.HookParameterValue);
+    // An installed parameter without a value removes the default
+    for (const { HookParameter: p } of installed.HookParameters || []) {
+        if (p.HookParameterValue === undefined) params.delete(p.HookParameterName);
+        else params.set(p.HookParameterName, p.HookParameterValue);
+    }
+
+    return {
+        ...hook,
+        id: Buffer.from(decodeAccountID(hook.account)),
+        hookHash: installed.HookHash,
+        namespace: hexBytes(installed.HookNamespace || def.node.HookNamespace),
+        params: [...params].map(([name, value]) => [hexBytes(name), hexBytes(value)])
+    };
+}
+
+async function loadState(client, hook, ledger) {
+    const entries = [];
+    let marker;
+    do {
+        const { result } = await client.request({
+            command: 'account_namespace', account: hook.account, namespace_id: hook.namespace.toString('hex').toUpperCase(),
+            ledger_index: ledger, marker
+        });
+        entries.push(...(result.namespace_entries || []));
+        marker = result.marker;
+    } while (marker);
+    return entries.map((e) => [hexBytes(e.HookStateKey), hexBytes(e.HookStateData)]);
+}
+
+async function loadBalance(client, account, ledger) {
+    try {
+        const { result } = await client.request({ command: 'account_info', account, ledger_index: ledger });
+        return BigInt(result.account_data.Balance);
+    } catch (e) {
+        if (e.data?.error === 'actNotFound') return null;
+        throw e;
+    }
+}
+
+// Ledger header and its transactions in TransactionIndex order, decoded
+async function loadLedger(client, ledger) {
+    const { result: header } = await client.request({ command: 'ledger', ledger_index: ledger });
+    const { result } = await client.request({
+        command: 'ledger', ledger_index: ledger, transactions: true, expand: true, binary: true
+    });
+    const txns = (result.ledger.transactions || []).map((t) => {
+        const blob = hexBytes(t.tx_blob);
+        return { blob, hash: sha512Half(TXN_PREFIX, blob), tx: decode(t.tx_blob), meta: decode(t.meta) };
+    });
+    txns.sort((a, b) => a.meta.TransactionIndex - b.meta.TransactionIndex);
+    return { seq: Number(header.ledger.ledger_index), parentCloseTime: header.ledger.parent_close_time, txns };
+}
+
+// HookState nodes a transaction changed on the hook accounts, found by their keylet
+function stateChanges(meta, hooks) {
+    const changes = [];
+    for (const affected of meta.AffectedNodes || []) {
+        const [kind, node] = Object.entries(affected)[0];
+        if (node.LedgerEntryType !== 'HookState') continue;
+        const fields = node.NewFields || node.FinalFields || {};
+        if (!fields.HookStateKey) continue;
+        const key = hexBytes(fields.HookStateKey);
+        const index = hexBytes(node.LedgerIndex);
+        const hook = hooks.find((h) => sha512Half(HOOK_STATE_SPACE, h.id, key, h.namespace).equals(index));
+        if (!hook) continue;
+        const deleted = kind === 'DeletedNode';
+        changes.push({ hook, key, deleted, data: deleted ? Buffer.alloc(0) : hexBytes(fields.HookStateData) });
+    }
+    return changes;
+}
+
+function txnRecord(t) {
+    const parts = [t.hash, u8(t.result), u16(t.blob.length), t.blob, u8(t.runs.length)];
+    for (const r of t.runs) {
+        parts.push(r.hook.id, u8(r.accepted ? 1 : 0), u16(r.emitted), u64(r.instructions),
+            u8(r.message.length), r.message);
+    }
+    parts.push(u16(t.state.length));
+    for (const s of t.state) parts.push(s.hook.id, s.key, u8(s.deleted ? 1 : 0), u16(s.data.length), s.data);
+    parts.push(u16(t.emitted.length));
+    for (const e of t.emitted) parts.push(u16(e.length), e);
+    return record(REC_TXN, ...parts);
+}
+
+async function main() {
+    const opts = parseArgs(process.argv.slice(2));
+    const client = new Client(opts.wss, { connectionTimeout: 10000 });
+    await client.connect();
+
+    const before = opts.from - 1;
+    const hooks = [];
+    for (const h of opts.hooks) hooks.push(await loadHook(client, h, before));
+    const byAddress = new Map(hooks.map((h) => [h.account, h]));
+
+    const ledgers = [];
+    const accounts = new Set(byAddress.keys());
+    const awaiting = new Map();   // parent hash -> transaction still missing emissions
+    const skipped = {};
+    let emittedSeen = 0;
+
+    for (let seq = opts.from; seq <= opts.to + EMIT_LOOKAHEAD; seq++) {
+        if (seq > opts.to && awaiting.size === 0) break;
+        const ledger = await loadLedger(client, seq);
+        const recorded = [];
+
+        for (const { blob, hash, tx, meta } of ledger.txns) {
+            if (tx.EmitDetails) {
+                const parent = awaiting.get(tx.EmitDetails.EmitParentTxnID);
+                if (parent) {
+                    parent.emitted.push(blob);
+                    if (parent.emitted.length >= parent.expected) awaiting.delete(tx.EmitDetails.EmitParentTxnID);
+                }
+                continue;
+            }
+            if (seq > opts.to || !(byAddress.has(tx.Account) || byAddress.has(tx.Destination))) continue;
+            if (tx.TransactionType !== 'Payment') {
+                skipped[tx.TransactionType] = (skipped[tx.TransactionType] || 0) + 1;
+                continue;
+            }
+
+            const runs = [];
+            for (const { HookExecution: e } of meta.HookExecutions || []) {
+                const hook = byAddress.get(e.HookAccount);
+                if (!hook || e.HookHash !== hook.hookHash) continue;
+                runs.push({
+                    hook,
+                    accepted: e.HookResult === HOOK_ACCEPT,
+                    emitted: e.HookEmitCount || 0,
+                    instructions: BigInt('0x' + (e.HookInstructionCount || '0')),
+                    message: hexBytes(e.HookReturnString).subarray(0, 255)
+                });
+            }
+            const result = RESULT_CODES[meta.TransactionResult] ?? 2;
+            const t = {
+                hash, blob, result, runs,
+                state: result === 0 ? stateChanges(meta, hooks) : [],
+                emitted: [],
+                expected: result === 0 ? runs.reduce((n, r) => n + r.emitted, 0) : 0
+            };
+            if (t.expected) awaiting.set(hash.toString('hex').toUpperCase(), t);
+            accounts.add(tx.Account);
+            accounts.add(tx.Destination);
+            recorded.push(t);
+            emittedSeen += t.expected;
+        }
+        if (seq <= opts.to) ledgers.push({ seq, parentCloseTime: ledger.parentCloseTime, txns: recorded });
+        process.stderr.write(`\rledger ${seq}`);
+    }
+    process.stderr.write('\n');
+
+    const out = [Buffer.from('DRIPCORP'), u32(1)];
+    for (const h of hooks) {
+        const params = h.params.flatMap(([name, value]) => [u8(name.length), name, u16(value.length), value]);
+        out.push(record(REC_HOOK, h.id, u8(h.name.length), Buffer.from(h.name), u16(h.params.length), ...params));
+    }
+    for (const account of accounts) {
+        const drops = await loadBalance(client, account, before);
+        if (drops !== null) out.push(record(REC_ACCOUNT, Buffer.from(decodeAccountID(account)), u64(drops)));
+    }
+    for (const h of hooks) {
+        for (const [key, data] of await loadState(client, h, before)) {
+            out.push(record(REC_STATE, h.id, key, u16(data.length), data));
+        }
+    }
+    let txnCount = 0;
+    for (const l of ledgers) {
+        out.push(record(REC_LEDGER, u32(l.seq), u32(l.parentCloseTime)));
+        for (const t of l.txns) out.push(txnRecord(t));
+        txnCount += l.txns.length;
+    }
+    await client.disconnect();
+
+    fs.writeFileSync(opts.out, Buffer.concat(out));
+    console.log(`${opts.out}: ${ledgers.length} ledgers, ${txnCount} payments, ${accounts.size} accounts`);
+    const missing = [...awaiting.values()].reduce((n, t) => n + t.expected - t.emitted.length, 0);
+    if (missing) console.log(`  ${missing} of ${emittedSeen} emitted transactions not found within ${EMIT_LOOKAHEAD} ledgers`);
+    for (const [type, n] of Object.entries(skipped)) console.log(`  skipped ${n} ${type} (not replayed)`);
+}
+
+if (require.main === module) {
+    main().catch((e) => {
+        console.error(e.message);
+        process.exit(1);
+    });
+}
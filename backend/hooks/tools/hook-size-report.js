@@ -0,0 +1,174 @@
+#!/usr/bin/env node
+
+// Per-hook size report for built hook wasm, checked against hook-budgets.txt.
+// SetHook fees and install cost scale with code size, so the build fails when a hook
+// grows past its budget.
+//
+// Usage: node tools/hook-size-report.js [--budgets file] [--update] [--quiet] <hook.wasm> [...]
+//   --budgets file  budget file ("<hook> <max_bytes> <max_instructions>" per line)
+//   --update        rewrite the budgets of the given hooks to their current size plus headroom
+//   --quiet         only print budget violations
+
+const fs = require('fs');
+const path = require('path');
+const { readModule } = require('./wasm-reader');
+
+// Headroom given by --update so unrelated small changes do not fail the build
+const UPDATE_HEADROOM = 1.05;
+const BYTES_ROUND = 64;
+const INSTR_ROUND = 16;
+
+const HOOK_EXPORTS = ['hook', 'cbak'];
+
+function hookName(file) {
+    return path.basename(file).replace(/\.wasm(\.hex)?$/, '');
+}
+
+function measure(file) {
+    let buf = fs.readFileSync(file);
+    if (file.endsWith('.hex')) buf = Buffer.from(buf.toString().replace(/\s+/g, ''), 'hex');
+
+    const mod = readModule(buf, { decode: true });
+    const codeSection = mod.sections.find(s => s.name === 'code');
+
+    return {
+        name: hookName(file),
+        bytes: mod.size,
+        functions: mod.functions.length,
+        imports: mod.importedFunctions.length,
+        instructions: mod.bodies.reduce((sum, b) => sum + b.code.length, 0),
+        code: codeSection ? codeSection.size : 0,
+        data: mod.data.reduce((sum, d) => sum + d.size, 0),
+        custom: mod.custom.reduce((sum, c) => sum + c.size, 0),
+        extraExports: mod.exports
+            .filter(e => e.kind === 'func' && !HOOK_EXPORTS.includes(e.name))
+            .map(e => e.name)
+    };
+}
+
+function readBudgets(file) {
+    const budgets = new Map();
+    if (!file || !fs.existsSync(file)) return budgets;
+
+    for (const line of fs.readFileSync(file, 'utf8').split('\n')) {
+        const fields = line.replace(/#.*/, '').trim().split(/\s+/);
+        if (fields.length < 2) continue;
+        budgets.set(fields[0], {
+            bytes: parseInt(fields[1], 10),
+            instructions: fields[2] ? parseInt(fields[2], 10) : Infinity
+        });
+    }
+    return budgets;
+}
+
+function roundUp(value, step) {
+    return Math.ceil(value / step) * step;
+}
+
+// Rewrite budget lines in place, keeping comments and hooks that were not measured
+function updateBudgets(file, reports) {
+    const lines = fs.existsSync(file) ? fs.readFileSync(file, 'utf8').replace(/\n$/, '').split('\n') : [];
+    const pending = new Map(reports.map(r => [r.name, r]));
+    const format = r => [
+        r.name.padEnd(28),
+        String(roundUp(r.bytes * UPDATE_HEADROOM, BYTES_ROUND)).padStart(8),
+        String(roundUp(r.instructions * UPDATE_HEADROOM, INSTR_ROUND)).padStart(8)
+    ].join(' ');
+
+    const out = lines.map(line => {
+        const name = line.replace(/#.*/, '').trim().split(/\s+/)[0];
+        if (!pending.has(name)) return line;
+        const r = pending.get(name);
+        pending.delete(name);
+        return format(r);
+    });
+    for (const r of pending.values()) out.push(format(r));
+
+    fs.writeFileSync(file, out.join('\n') + '\n');
+}
+
+function main() {
+    const args = process.argv.slice(2);
+    let budgetFile = null;
+    let update = false;
+    let quiet = false;
+    const files = [];
+
+    for (let i = 0; i < args.length; i++) {
+        if (args[i] === '--budgets') budgetFile = args[++i];
+        else if (args[i] === '--update') update = true;
+        else if (args[i] === '--quiet') quiet = true;
+        else files.push(args[i]);
+    }
+
+    if (files.length === 0) {
+        console.log('Usage: node tools/hook-size-report.js [--budgets file] [--update] [--quiet] <hook.wasm> [...]');
+        process.exit(1);
+    }
+
+    const reports = files.map(measure);
+
+    if (update) {
+        if (!budgetFile) {
+            console.error('--update needs --budgets <file>');
+            process.exit(1);
+        }
+        updateBudgets(budgetFile, reports);
+        console.log(`Updated ${reports.length} budget(s) in ${budgetFile}`);
+        return;
+    }
+
+    const budgets = readBudgets(budgetFile);
+    const failures = [];
+
+    if (!quiet) {
+        console.log(['hook'.padEnd(28), 'bytes', 'budget', 'funcs', 'instrs', 'budget', 'code', 'data', 'custom']
+            .map((h, i) => (i === 0 ? h : h.padStart(7))).join(' '));
+    }
+
+    for (const r of reports) {
+        const budget = budgets.get(r.name);
+
+        if (budget && r.bytes > budget.bytes) {
+            failures.push(`${r.name}: ${r.bytes} bytes exceeds budget of ${budget.bytes}`);
+        }
+        if (budget && r.instructions > budget.instructions) {
+            failures.push(`${r.name}: ${r.instructions} instructions exceeds budget of ${budget.instructions}`);
+        }
+        if (r.extraExports.length > 0) {
+            console.warn(`warning: ${r.name} exports ${r.extraExports.join(', ')} (only hook/cbak are needed)`);
+        }
+        if (r.custom > 0) {
+            console.warn(`warning: ${r.name} still carries ${r.custom} bytes of custom sections`);
+        }
+        if (!budget && budgetFile) {
+            console.warn(`warning: ${r.name} has no budget in ${budgetFile}`);
+        }
+
+        if (!quiet) {
+            console.log([
+                r.name.padEnd(28),
+                r.bytes,
+                budget ? budget.bytes : '-',
+                r.functions,
+                r.instructions,
+                budget && budget.instructions !== Infinity ? budget.instructions : '-',
+                r.code,
+                r.data,
+                r.custom
+            ].map((v, i) => (i === 0 ? v : String(v).padStart(7))).join(' '));
+        }
+    }
+
+    if (failures.length > 0) {
+        for (const f of failures) console.error(`error: ${f}`);
+        console.error(`Raise the budget in ${budgetFile} only for intended growth (make size-budgets).`);
+        process.exit(1);
+    }
+}
+
+if (require.main === module) {
+    main();
+}
+
+module.exports = { measure, readBudgets };
@@ -0,0 +1,314 @@
+// Minimal WebAssembly module reader for hook tooling (size reports, cost analysis).
+// Decodes the sections a hook can contain and, on request, each function body into
+// a flat instruction list. MVP opcodes plus the 0xFC (saturating / bulk memory) prefix.
+
+const SECTION_NAMES = [
+    'custom', 'type', 'import', 'function', 'table', 'memory',
+    'global', 'export', 'start', 'element', 'code', 'data', 'datacount'
+];
+
+const EXTERNAL_KIND = ['func', 'table', 'memory', 'global'];
+
+class Reader {
+    constructor(buf, pos = 0, end = buf.length) {
+        this.buf = buf;
+        this.pos = pos;
+        this.end = end;
+    }
+
+    eof() {
+        return this.pos >= this.end;
+    }
+
+    byte() {
+        if (this.pos >= this.end) throw new Error(`unexpected end of wasm at ${this.pos}`);
+        return this.buf[this.pos++];
+    }
+
+    bytes(n) {
+        if (this.pos + n > this.end) throw new Error(`unexpected end of wasm at ${this.pos}`);
+        const out = this.buf.subarray(this.pos, this.pos + n);
+        this.pos += n;
+        return out;
+    }
+
+    u32() {
+        let result = 0;
+        let shift = 0;
+        for (;;) {
+            const b = this.byte();
+            result += (b & 0x7f) * 2 ** shift;
+            if ((b & 0x80) === 0) return result;
+            shift += 7;
+            if (shift > 35) throw new Error(`bad LEB128 at ${this.pos}`);
+        }
+    }
+
+    // Signed LEB128 as BigInt (i64.const, s33 block types)
+    sleb() {
+        let result = 0n;
+        let shift = 0n;
+        let b;
+        do {
+            b = this.byte();
+            result |= BigInt(b & 0x7f) << shift;
+            shift += 7n;
+        } while (b & 0x80);
+        if (b & 0x40) result -= 1n << shift;
+        return result;
+    }
+
+    name() {
+        return Buffer.from(this.bytes(this.u32())).toString('utf8');
+    }
+}
+
+function readLimits(r) {
+    const flags = r.byte();
+    const min = r.u32();
+    const max = flags & 1 ? r.u32() : undefined;
+    return { min, max }
+}
+
+// Constant expression (global init, data/element offsets): returns the i32/i64 value if simple
+function readConstExpr(r) {
+    let value;
+    for (;;) {
+        const op = r.byte();
+        if (op === 0x0b) return value;
+        if (op === 0x41) value = Number(r.sleb());
+        else if (op === 0x42) value = r.sleb();
+        else if (op === 0x43) r.bytes(4);
+        else if (op === 0x44) r.bytes(8);
+        else if (op === 0x23) value = { global: r.u32() };
+        else if (op === 0xd0) r.byte();
+        else if (op === 0xd2) value = { func: r.u32() };
+        else throw new Error(`unsupported opcode 0x${op.toString(16)} in constant expression`);
+    }
+}
+
+// Decode one function body into instructions: { op, offset, imm }
+// op is the opcode byte, or 0xfc00 + subop for the 0xFC prefix
+function decodeBody(r) {
+    const code = [];
+    while (!r.eof()) {
+        const offset = r.pos;
+        const op = r.byte();
+        let imm;
+
+        switch (op) {
+            case 0x02: case 0x03: case 0x04: {
+                const bt = r.buf[r.pos];
+                if (bt === 0x40 || (bt >= 0x6f && bt <= 0x7f)) r.pos++;
+                else imm = Number(r.sleb());
+                break;
+            }
+            case 0x0c: case 0x0d:
+                imm = r.u32();
+                break;
+            case 0x0e: {
+                const n = r.u32();
+                const targets = [];
+                for (let i = 0; i < n; i++) targets.push(r.u32());
+                imm = { targets, fallback: r.u32() };
+                break;
+            }
+            case 0x10:
+                imm = r.u32();
+                break;
+            case 0x11:
+                imm = { type: r.u32(), table: r.u32() };
+                break;
+            case 0x1c: {
+                const n = r.u32();
+                r.bytes(n);
+                break;
+            }
+            case 0x20: case 0x21: case 0x22: case 0x23: case 0x24: case 0x25: case 0x26:
+                imm = r.u32();
+                break;
+            case 0x3f: case 0x40:
+                r.byte();
+                break;
+            case 0x41:
+                imm = Number(BigInt.asIntN(32, r.sleb()));
+                break;
+            case 0x42:
+                imm = BigInt.asIntN(64, r.sleb());
+                break;
+            case 0x43:
+                r.bytes(4);
+                break;
+            case 0x44:
+                r.bytes(8);
+                break;
+            case 0xd0:
+                r.byte();
+                break;
+            case 0xd2:
+                imm = r.u32();
+                break;
+            case 0xfc: {
+                const sub = r.u32();
+                if (sub === 8) { imm = r.u32(); r.byte(); }
+                else if (sub === 9 || sub === 13 || (sub >= 15 && sub <= 17)) imm = r.u32();
+                else if (sub === 10) r.bytes(2);
+                else if (sub === 11) r.byte();
+                else if (sub === 12 || sub === 14) { r.u32(); r.u32(); }
+                else if (sub > 7) throw new Error(`unsupported 0xfc opcode ${sub} at ${offset}`);
+                code.push({ op: 0xfc00 + sub, offset, imm });
+                continue;
+            }
+            default:
+                if (op >= 0x28 && op <= 0x3e) {
+                    imm = { align: r.u32(), offset: r.u32() };
+                } else if (!(op <= 0x01 || op === 0x05 || op === 0x0b || op === 0x0f ||
+                         op === 0x1a || op === 0x1b || (op >= 0x45 && op <= 0xc4) || op === 0xd1)) {
+                    throw new Error(`unsupported opcode 0x${op.toString(16)} at ${offset}`);
+                }
+        }
+        code.push({ op, offset, imm });
+    }
+    return code;
+}
+
+// Parse a module. With { decode: true } function bodies are decoded into instructions.
+function readModule(buf, { decode = false } = {}) {
+    if (buf.length < 8 || buf.readUInt32LE(0) !== 0x6d736100) {
+        throw new Error('not a wasm module');
+    }
+    if (buf.readUInt32LE(4) !== 1) throw new Error(`unsupported wasm version ${buf.readUInt32LE(4)}`);
+
+    const mod = {
+        size: buf.length,
+        sections: [],
+        types: [],
+        imports: [],
+        functions: [],
+        exports: [],
+        memories: [],
+        globals: [],
+        data: [],
+        custom: [],
+        bodies: []
+    };
+
+    const r = new Reader(buf, 8);
+    while (!r.eof()) {
+        const id = r.byte();
+        const size = r.u32();
+        const start = r.pos;
+        const end = start + size;
+        const s = new Reader(buf, start, end);
+        mod.sections.push({ id, name: SECTION_NAMES[id] || `unknown(${id})`, offset: start, size });
+
+        switch (id) {
+            case 0: {
+                const name = s.name();
+                mod.custom.push({ name, size });
+                break;
+            }
+            case 1: {
+                const n = s.u32();
+                for (let i = 0; i < n; i++) {
+                    if (s.byte() !== 0x60) throw new Error('bad function type');
+                    const params = Array.from(s.bytes(s.u32()));
+                    const results = Array.from(s.bytes(s.u32()));
+                    mod.types.push({ params, results });
+                }
+                break;
+            }
+            case 2: {
+                const n = s.u32();
+                for (let i = 0; i < n; i++) {
+                    const module = s.name();
+                    const name = s.name();
+                    const kind = EXTERNAL_KIND[s.byte()];
+                    const imp = { module, name, kind };
+                    if (kind === 'func') imp.type = s.u32();
+                    else if (kind === 'table') { s.byte(); imp.limits = readLimits(s); }
+                    else if (kind === 'memory') imp.limits = readLimits(s);
+                    else { imp.valtype = s.byte(); imp.mutable = s.byte() === 1; }
+                    mod.imports.push(imp);
+                }
+                break;
+            }
+            case 3: {
+                const n = s.u32();
+                for (let i = 0; i < n; i++) mod.functions.push(s.u32());
+                break;
+            }
+            case 5: {
+                const n = s.u32();
+                for (let i = 0; i < n; i++) mod.memories.push(readLimits(s));
+                break;
+            }
+            case 6: {
+                const n = s.u32();
+                for (let i = 0; i < n; i++) {
+                    const valtype = s.byte();
+                    const mutable = s.byte() === 1;
+                    mod.globals.push({ valtype, mutable, init: readConstExpr(s) });
+                }
+                break;
+            }
+            case 7: {
+                const n = s.u32();
+                for (let i = 0; i < n; i++) {
+                    const name = s.name();
+                    const kind = EXTERNAL_KIND[s.byte()];
+                    mod.exports.push({ name, kind, index: s.u32() });
+                }
+                break;
+            }
+            case 10: {
+                const n = s.u32();
+                for (let i = 0; i < n; i++) {
+                    const bodySize = s.u32();
+                    const bodyEnd = s.pos + bodySize;
+                    const b = new Reader(buf, s.pos, bodyEnd);
+                    const localGroups = b.u32();
+                    let locals = 0;
+                    for (let j = 0; j < localGroups; j++) {
+                        locals += b.u32();
+                        b.byte();
+                    }
+                    const body = { size: bodySize, locals, codeOffset: b.pos };
+                    if (decode) body.code = decodeBody(b);
+                    mod.bodies.push(body);
+                    s.pos = bodyEnd;
+                }
+                break;
+            }
+            case 11: {
+                const n = s.u32();
+                for (let i = 0; i < n; i++) {
+                    const flags = s.u32();
+                    let offset;
+                    if (flags === 2) s.u32();
+                    if (flags !== 1) offset = readConstExpr(s);
+                    const len = s.u32();
+                    s.bytes(len);
+                    mod.data.push({ offset, size: len, passive: flags === 1 });
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        r.pos = end;
+    }
+
+    mod.importedFunctions = mod.imports.filter(i => i.kind === 'func');
+    return mod;
+}
+
+// Name for a function index (imports first, then exports, then func[N])
+function functionName(mod, index) {
+    if (index < mod.importedFunctions.length) return mod.importedFunctions[index].name;
+    const exp = mod.exports.find(e => e.kind === 'func' && e.index === index);
+    return exp ? exp.name : `func[${index}]`;
+}
+
+module.exports = { readModule, functionName, decodeBody, Reader };
+
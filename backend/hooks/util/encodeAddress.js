@@ -1,17 +1,40 @@
-// Encode classic r-address to 20-byte hex for Hook Parameters
-const xrpl = require('xrpl')
+// Encode classic r-addresses to 20-byte hex for Hook Parameters, or back with --to-address
+//
+// Addresses come from the arguments, or one per line on stdin when there are none, and
+// are converted in one batch by backend/native (decodeAccounts / encodeAccounts).
+const { decodeAccounts, encodeAccounts } = require('../../native')
 
-const addr = process.argv[2]
-if (!addr) {
-  console.error('Usage: node hooks/util/encodeAddress.js rADDRESS')
-  process.exit(1)
+const args = process.argv.slice(2)
+const toAddress = args[0] === '--to-address'
+if (toAddress) args.shift()
+
+function convert(items) {
+  if (toAddress) {
+    if (!items.every(id => /^[0-9A-Fa-f]{40}$/.test(id))) throw new Error('account ids must be 40 hex digits')
+    return encodeAccounts(Buffer.from(items.join(''), 'hex'))
+  }
+  const ids = decodeAccounts(items)
+  return items.map((_, i) => ids.subarray(20 * i, 20 * i + 20).toString('hex').toUpperCase())
 }
 
-try {
-  const decoded = xrpl.decodeAccountID(addr) // returns Buffer
-  console.log(Buffer.from(decoded).toString('hex').toUpperCase())
-} catch (e) {
-  console.error('Invalid address:', e.message)
-  process.exit(2)
+function run(items) {
+  if (!items.length) {
+    console.error('Usage: node hooks/util/encodeAddress.js [--to-address] [rADDRESS|HEX ...] (or one per line on stdin)')
+    process.exit(1)
+  }
+  try {
+    console.log(convert(items).join('\n'))
+  } catch (e) {
+    console.error('Invalid address:', e.message)
+    process.exit(2)
+  }
 }
 
+if (args.length || process.stdin.isTTY) {
+  run(args)
+} else {
+  let input = ''
+  process.stdin.setEncoding('utf8')
+  process.stdin.on('data', chunk => { input += chunk })
+  process.stdin.on('end', () => run(input.split(/\s+/).filter(Boolean)))
+}
@@ -0,0 +1,27 @@
+{
+  "targets": [
+    {
+      "target_name": "drippy_native",
+      "sources": [
+        "src/addon.c",
+        "src/records.c",
+        "src/prorata.c",
+        "src/stcodec.c",
+        "src/base58.c",
+        "src/codec.c",
+        "src/balances.c",
+        "src/snapshot.c",
+        "src/preview.c",
+        "src/signer.c",
+        "src/accounts.c",
+        "src/boosts.c"
+      ],
+      "include_dirs": ["../hooks/carbon", "../hooks/include"],
+      "cflags": ["-O3", "-Wall", "-pthread"],
+      "ldflags": ["-pthread"],
+      "xcode_settings": {
+        "OTHER_CFLAGS": ["-O3", "-Wall"]
+      }
+    }
+  ]
+}
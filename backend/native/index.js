@@ -0,0 +1,769 @@
+/**
+ * drippy_native loader
+ *
+ * Loads the N-API addon built by `npm run build:native` (node-gyp, sources in src/).
+ * Every function has a JavaScript fallback with the same results, so the backend runs
+ * unchanged where the addon has not been built; `native` tells which one is in use.
+ * The exception is claimPreview, which runs the claim hook's own rules compiled from
+ * hooks/include and is null without the addon.
+ */
+
+const crypto = require('crypto')
+const fs = require('fs')
+
+const RING_RECORD_SIZE = 48
+const RING_HEAD_SIZE = 12
+const HOLDER_RECORD_SIZE = 36
+const DELTA_RECORD_SIZE = 64
+const CLAIM_KEY_PREFIX = Buffer.from('DRIPPY:CLAIM')
+const SNAPSHOT_MAGIC = Buffer.from('DRIPSNAP')
+const SNAPSHOT_HEADER_SIZE = 64
+const SNAPSHOT_RECORD_SIZE = 52
+const SECP256K1_N = 0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141n
+const ED25519_PKCS8_PREFIX = Buffer.from('302e020100300506032b657004220420', 'hex')
+
+let binding = null
+try {
+  binding = require('./build/Release/drippy_native.node')
+} catch (error) {
+  binding = null
+}
+
+// Records from hooks/include/drippy_ring.h, concatenated
+function decodeRecords(buf) {
+  if (buf.length % RING_RECORD_SIZE !== 0) {
+    throw new RangeError('record data must be a multiple of 48 bytes')
+  }
+  const records = []
+  for (let off = 0; off < buf.length; off += RING_RECORD_SIZE) {
+    records.push({
+      seq: Number(buf.readBigUInt64BE(off)),
+      ledger: buf.readUInt32BE(off + 8),
+      op: buf[off + 12],
+      result: buf[off + 13],
+      account: buf.subarray(off + 16, off + 36).toString('hex').toUpperCase(),
+      value: buf.readBigUInt64BE(off + 36),
+      aux: buf.readUInt32BE(off + 44)
+    })
+  }
+  return records
+}
+
+function decodeHead(buf) {
+  if (buf.length !== RING_HEAD_SIZE) return null
+  return { next: Number(buf.readBigUInt64BE(0)), slots: buf.readUInt32BE(8) }
+}
+
+// Holder snapshot for distribute(): { account (20 bytes or hex), balance, nfts, boost }
+// account may also be a classic address; those are decoded in one decodeAccounts() call
+function packHolders(holders) {
+  const buf = Buffer.alloc(holders.length * HOLDER_RECORD_SIZE)
+  const isAddress = (a) => typeof a === 'string' && a[0] === 'r'
+  const addresses = holders.filter(h => isAddress(h.account)).map(h => h.account)
+  const ids = addresses.length ? module.exports.decodeAccounts(addresses) : null
+  let next = 0
+  holders.forEach((h, i) => {
+    const off = i * HOLDER_RECORD_SIZE
+    let account
+    if (isAddress(h.account)) account = ids.subarray(20 * next, 20 * ++next)
+    else account = Buffer.isBuffer(h.account) ? h.account : Buffer.from(h.account, 'hex')
+    if (account.length !== 20) throw new RangeError('account must be 20 bytes')
+    account.copy(buf, off)
+    buf.writeBigUInt64BE(BigInt(h.balance || 0), off + 20)
+    buf.writeUInt32BE(h.nfts || 0, off + 28)
+    buf.writeUInt32BE(h.boost || 100, off + 32)
+  })
+  return buf
+}
+
+// Same rounding as src/prorata.c: floor shares, leftover to the largest remainders
+function distribute(snapshot, pool, options = {}) {
+  if (snapshot.length % HOLDER_RECORD_SIZE !== 0) {
+    throw new RangeError('snapshot must be a multiple of 36 bytes')
+  }
+  const basis = options.basis || 'balance'
+  if (basis !== 'balance' && basis !== 'nfts') {
+    throw new RangeError("basis must be 'balance' or 'nfts'")
+  }
+  pool = BigInt(pool)
+  if (pool < 0n || pool > 0xFFFFFFFFFFFFFFFFn) throw new RangeError('pool must fit in 64 bits')
+
+  const buf = Buffer.from(snapshot.buffer, snapshot.byteOffset, snapshot.length)
+  const n = buf.length / HOLDER_RECORD_SIZE
+  const weights = new Array(n)
+  let total = 0n
+  for (let i = 0; i < n; i++) {
+    const off = i * HOLDER_RECORD_SIZE
+    const amount = basis === 'nfts' ? BigInt(buf.readUInt32BE(off + 28)) : buf.readBigUInt64BE(off + 20)
+    const boost = BigInt(buf.readUInt32BE(off + 32) || 100)
+    const weight = amount * boost
+    if (weight > 0xFFFFFFFFFFFFFFFFn) {
+      throw new RangeError('holder weight (basis x boost) exceeds 64 bits')
+    }
+    weights[i] = weight
+    total += weight
+  }
+
+  const shares = new BigUint64Array(n)
+  let distributed = 0n
+  if (total > 0n && pool > 0n) {
+    const rems = new Array(n)
+    let floors = 0n
+    for (let i = 0; i < n; i++) {
+      const product = pool * weights[i]
+      shares[i] = product / total
+      rems[i] = product % total
+      floors += shares[i]
+    }
+    const order = [...Array(n).keys()].sort((a, b) => (rems[a] > rems[b] ? -1 : rems[a] < rems[b] ? 1 : a - b))
+    for (let j = 0; j < Number(pool - floors); j++) shares[order[j]] += 1n
+    distributed = pool
+  }
+
+  let paid = 0
+  for (let i = 0; i < n; i++) if (shares[i] !== 0n) paid++
+
+  let deltas = null
+  if (options.deltas !== false) {
+    deltas = Buffer.alloc(paid * DELTA_RECORD_SIZE)
+    let off = 0
+    for (let i = 0; i < n; i++) {
+      if (shares[i] === 0n) continue
+      CLAIM_KEY_PREFIX.copy(deltas, off)
+      buf.copy(deltas, off + 12, i * HOLDER_RECORD_SIZE, i * HOLDER_RECORD_SIZE + 20)
+      deltas.writeBigUInt64BE(shares[i], off + 32)
+      off += DELTA_RECORD_SIZE
+    }
+  }
+
+  return { shares, deltas, distributed, totalWeight: total, paid }
+}
+
+// Binary codec fallback: the Xahau build of xrpl.js's codec, loaded on first use
+let xahauCodec = null
+function codec() {
+  if (!xahauCodec) xahauCodec = require('xahau')
+  return xahauCodec
+}
+
+function decodeTx(buf) {
+  return codec().decode(Buffer.from(buf).toString('hex'))
+}
+
+function readField(buf, name) {
+  return decodeTx(buf)[name]
+}
+
+function encodeTx(obj, options = {}) {
+  const hex = options.signing ? codec().encodeForSigning(obj) : codec().encode(obj)
+  return Buffer.from(hex, 'hex')
+}
+
+const XFL_MANT_MIN = 1000000000000000n
+const XFL_MANT_MASK = (1n << 54n) - 1n
+const XFL_POSITIVE = 1n << 62n
+
+// Same formatting as st_xfl_to_string() in src/stcodec.c
+function xflToString(xfl) {
+  xfl = BigInt(xfl)
+  if (xfl < 0n) throw new RangeError('not a valid XFL')
+  let mantissa = xfl & XFL_MANT_MASK
+  if (mantissa === 0n) return '0'
+  let exponent = Number((xfl >> 54n) & 0xFFn) - 97
+  while (mantissa % 10n === 0n) {
+    mantissa /= 10n
+    exponent++
+  }
+  const digits = mantissa.toString()
+  const sign = xfl & XFL_POSITIVE ? '' : '-'
+  const point = digits.length + exponent
+  if (exponent >= 0 && point <= 28) return sign + digits + '0'.repeat(exponent)
+  if (exponent < 0 && point > 0) return sign + digits.slice(0, point) + '.' + digits.slice(point)
+  if (exponent < 0 && point > -20) return sign + '0.' + '0'.repeat(-point) + digits
+  return sign + digits + 'e' + exponent
+}
+
+function xflFromString(s) {
+  const m = /^([+-]?)(\d*)(?:\.(\d*))?(?:[eE]([+-]?\d+))?$/.exec(String(s))
+  if (!m || (m[2] + (m[3] || '')) === '') {
+    throw new RangeError('not a decimal of at most 16 significant digits in XFL range')
+  }
+  let digits = (m[2] + (m[3] || '')).replace(/^0+/, '')
+  let exponent = Number(m[4] || 0) - (m[3] || '').length
+  if (digits === '') return 0n
+  const trailing = digits.length - digits.replace(/0+$/, '').length
+  const extra = Math.max(0, digits.length - 16)
+  if (extra > trailing) throw new RangeError('not a decimal of at most 16 significant digits in XFL range')
+  digits = digits.slice(0, digits.length - extra)
+  exponent += extra
+  let mantissa = BigInt(digits)
+  while (mantissa < XFL_MANT_MIN) {
+    mantissa *= 10n
+    exponent--
+  }
+  if (exponent < -96 || exponent > 80) {
+    throw new RangeError('not a decimal of at most 16 significant digits in XFL range')
+  }
+  return (m[1] === '-' ? 0n : XFL_POSITIVE) | (BigInt(exponent + 97) << 54n) | mantissa
+}
+
+// a + b truncated to 16 digits, as st_xfl_sum() in src/stcodec.c
+function xflSum(a, b) {
+  const split = (f) => ({
+    negative: !(f & XFL_POSITIVE),
+    exponent: Number((f >> 54n) & 0xFFn) - 97,
+    mantissa: f & XFL_MANT_MASK
+  })
+  const make = (negative, exponent, mantissa) => {
+    if (mantissa === 0n) return 0n
+    while (mantissa > 9999999999999999n) {
+      mantissa /= 10n
+      exponent++
+    }
+    while (mantissa < XFL_MANT_MIN) {
+      mantissa *= 10n
+      exponent--
+    }
+    if (exponent < -96) return 0n
+    if (exponent > 80) exponent = 80
+    return (negative ? 0n : XFL_POSITIVE) | (BigInt(exponent + 97) << 54n) | mantissa
+  }
+  if (a <= 0n || (a & XFL_MANT_MASK) === 0n) return b > 0n && (b & XFL_MANT_MASK) ? b : 0n
+  if (b <= 0n || (b & XFL_MANT_MASK) === 0n) return a
+  let x = split(a)
+  let y = split(b)
+  if (x.exponent < y.exponent) [x, y] = [y, x]
+  const gap = x.exponent - y.exponent
+  if (gap > 19) return make(x.negative, x.exponent, x.mantissa)
+  const mx = x.mantissa * 10n ** BigInt(gap)
+  if (x.negative === y.negative) return make(x.negative, y.exponent, mx + y.mantissa)
+  if (mx >= y.mantissa) return make(x.negative, y.exponent, mx - y.mantissa)
+  return make(y.negative, y.exponent, y.mantissa - mx)
+}
+
+function xflNegate(xfl) {
+  return xfl > 0n ? xfl ^ XFL_POSITIVE : 0n
+}
+
+// Same walk as src/balances.c over the decoded metadata
+function balanceChanges(meta) {
+  const changes = []
+  for (const wrapper of decodeTx(meta).AffectedNodes || []) {
+    const kind = Object.keys(wrapper)[0]
+    const node = wrapper[kind]
+    const type = node.LedgerEntryType
+    if (type !== 'AccountRoot' && type !== 'RippleState' && type !== 0x61 && type !== 0x72) continue
+    const fields = node.FinalFields || node.NewFields
+    if (!fields || fields.Balance === undefined) continue
+    const before = node.PreviousFields && node.PreviousFields.Balance
+    if (kind !== 'CreatedNode' && before === undefined) continue
+
+    if (typeof fields.Balance === 'string') {
+      const drops = BigInt(fields.Balance) - (before === undefined ? 0n : BigInt(before))
+      if (drops !== 0n) changes.push({ account: fields.Account, currency: 'XRP', drops })
+      continue
+    }
+    const after = xflFromString(fields.Balance.value)
+    const xfl = xflSum(after, xflNegate(before === undefined ? 0n : xflFromString(before.value)))
+    if (xfl === 0n) continue
+    const currency = fields.Balance.currency
+    const low = fields.LowLimit.issuer
+    const high = fields.HighLimit.issuer
+    changes.push({ account: low, currency, issuer: high, value: xflToString(xfl), xfl })
+    const negated = xflNegate(xfl)
+    changes.push({ account: high, currency, issuer: low, value: xflToString(negated), xfl: negated })
+  }
+  return changes
+}
+
+function ledgerVolume(entries) {
+  const volumes = new Map()
+  for (const { tx, meta } of entries) {
+    const account = readField(tx, 'Account')
+    if (!account) throw new RangeError('transaction without an Account')
+    let moved = 0n
+    for (const change of balanceChanges(meta)) {
+      if (change.drops !== undefined) moved += change.drops < 0n ? -change.drops : change.drops
+    }
+    const v = volumes.get(account) || { account, drops: 0n, transactions: 0 }
+    v.drops += moved
+    v.transactions++
+    volumes.set(account, v)
+  }
+  return [...volumes.values()]
+}
+
+function accountId(account) {
+  if (typeof account === 'string') {
+    if (/^[0-9A-Fa-f]{40}$/.test(account)) return Buffer.from(account, 'hex')
+    try {
+      return Buffer.from(codec().decodeAccountID(account))
+    } catch (error) {}
+  } else if (account && account.length === 20) {
+    return Buffer.from(account)
+  }
+  throw new TypeError('account must be a classic address, 40 hex digits or 20 bytes')
+}
+
+// Same results as src/accounts.c, with a bounded Map in place of its cache
+const ACCOUNT_CACHE_MAX = 65536
+const addressCache = new Map()
+
+function cacheAddress(address, id) {
+  if (addressCache.size >= ACCOUNT_CACHE_MAX) addressCache.clear()
+  addressCache.set(address, id)
+}
+
+function encodeAccounts(ids) {
+  if (ids.length % 20 !== 0) throw new RangeError('ids must be a multiple of 20 bytes')
+  const addresses = new Array(ids.length / 20)
+  for (let i = 0; i < addresses.length; i++) {
+    const id = Buffer.from(ids.subarray(20 * i, 20 * i + 20))
+    addresses[i] = codec().encodeAccountID(id)
+    cacheAddress(addresses[i], id)
+  }
+  return addresses
+}
+
+function decodeAccounts(addresses) {
+  if (!Array.isArray(addresses)) throw new TypeError('decodeAccounts(addresses)')
+  const ids = Buffer.alloc(addresses.length * 20)
+  addresses.forEach((address, i) => {
+    let id = addressCache.get(address)
+    if (!id) {
+      try {
+        id = Buffer.from(codec().decodeAccountID(address))
+      } catch (error) {
+        throw new TypeError(`addresses[${i}] is not a classic address`)
+      }
+      cacheAddress(address, id)
+    }
+    id.copy(ids, 20 * i)
+  })
+  return ids
+}
+
+function writeSnapshot(path, records, ledger, cursor) {
+  const buf = Buffer.alloc(SNAPSHOT_HEADER_SIZE + records.length * SNAPSHOT_RECORD_SIZE)
+  SNAPSHOT_MAGIC.copy(buf, 0)
+  buf.writeUInt32BE(SNAPSHOT_RECORD_SIZE, 8)
+  buf.writeUInt32BE(records.length, 12)
+  buf.writeUInt32BE(ledger, 16)
+  buf.writeBigUInt64BE(BigInt(cursor), 20)
+  records.forEach((r, i) => r.copy(buf, SNAPSHOT_HEADER_SIZE + i * SNAPSHOT_RECORD_SIZE))
+  fs.writeFileSync(`${path}.tmp`, buf)
+  fs.renameSync(`${path}.tmp`, path)
+}
+
+// Same file and results as src/snapshot.c; the file is read into memory and every
+// apply() rewrites it whole
+class ClaimSnapshot {
+  constructor(path) {
+    this.path = path
+    if (!fs.existsSync(path)) writeSnapshot(path, [], 0, 0)
+    this.load()
+  }
+
+  load() {
+    const buf = fs.readFileSync(this.path)
+    if (buf.length < SNAPSHOT_HEADER_SIZE || !buf.subarray(0, 8).equals(SNAPSHOT_MAGIC) ||
+        buf.readUInt32BE(8) !== SNAPSHOT_RECORD_SIZE ||
+        buf.length !== SNAPSHOT_HEADER_SIZE + buf.readUInt32BE(12) * SNAPSHOT_RECORD_SIZE) {
+      throw new Error('not a claim snapshot')
+    }
+    this.buf = buf
+  }
+
+  find(account) {
+    if (!this.buf) throw new Error('snapshot is closed')
+    const id = accountId(account)
+    let lo = 0
+    let hi = this.buf.readUInt32BE(12)
+    while (lo < hi) {
+      const mid = (lo + hi) >>> 1
+      const off = SNAPSHOT_HEADER_SIZE + mid * SNAPSHOT_RECORD_SIZE
+      const c = this.buf.compare(id, 0, 20, off, off + 20)
+      if (c === 0) return off + 20
+      if (c > 0) hi = mid
+      else lo = mid + 1
+    }
+    return -1
+  }
+
+  get(account) {
+    const off = this.find(account)
+    if (off < 0) return null
+    return {
+      accrued: this.buf.readBigUInt64BE(off),
+      lastClaim: Number(this.buf.readBigUInt64BE(off + 8)),
+      claimCount: this.buf.readUInt32BE(off + 16),
+      boost: this.buf.readUInt32BE(off + 20),
+      dailyClaimed: this.buf.readBigUInt64BE(off + 24)
+    }
+  }
+
+  record(account) {
+    const off = this.find(account)
+    return off < 0 ? null : Buffer.from(this.buf.subarray(off, off + 32))
+  }
+
+  apply(records, options = {}) {
+    const { ledger, cursor } = this.info()
+    const next = { ledger, cursor, replace: false, ...(options || {}) }
+    if (!Number.isInteger(next.ledger) || next.ledger < 0 || next.ledger > 0xFFFFFFFF) {
+      throw new TypeError('ledger must be a ledger index')
+    }
+    if (!Number.isSafeInteger(next.cursor) || next.cursor < 0) {
+      throw new RangeError('cursor must be a non-negative integer')
+    }
+    if (records.length % SNAPSHOT_RECORD_SIZE !== 0) {
+      throw new RangeError('records must be a multiple of 52 bytes')
+    }
+
+    const merged = new Map()
+    if (!next.replace) {
+      for (let off = SNAPSHOT_HEADER_SIZE; off < this.buf.length; off += SNAPSHOT_RECORD_SIZE) {
+        merged.set(this.buf.toString('hex', off, off + 20), this.buf.subarray(off, off + SNAPSHOT_RECORD_SIZE))
+      }
+    }
+    const existing = new Set(merged.keys())
+    const inserted = new Set()
+    let updated = 0
+    const buf = Buffer.from(records.buffer, records.byteOffset, records.length)
+    for (let off = 0; off < buf.length; off += SNAPSHOT_RECORD_SIZE) {
+      const key = buf.toString('hex', off, off + 20)
+      if (existing.has(key)) updated++
+      else inserted.add(key)
+      merged.set(key, buf.subarray(off, off + SNAPSHOT_RECORD_SIZE))
+    }
+
+    const sorted = [...merged.keys()].sort().map(key => merged.get(key))
+    writeSnapshot(this.path, sorted, next.ledger, next.cursor)
+    this.load()
+    return { updated, inserted: inserted.size }
+  }
+
+  info() {
+    if (!this.buf) throw new Error('snapshot is closed')
+    return {
+      count: this.buf.readUInt32BE(12),
+      ledger: this.buf.readUInt32BE(16),
+      cursor: Number(this.buf.readBigUInt64BE(20))
+    }
+  }
+
+  close() {
+    this.buf = null
+  }
+}
+
+function sha512Half(data) {
+  return crypto.createHash('sha512').update(data).digest().subarray(0, 32)
+}
+
+function toScalar(bytes) {
+  return BigInt('0x' + Buffer.from(bytes).toString('hex'))
+}
+
+function fromScalar(k) {
+  return Buffer.from(k.toString(16).padStart(64, '0'), 'hex')
+}
+
+function modPow(base, exp, mod) {
+  let result = 1n
+  base %= mod
+  for (; exp > 0n; exp >>= 1n) {
+    if (exp & 1n) result = (result * base) % mod
+    base = (base * base) % mod
+  }
+  return result
+}
+
+// k * G, compressed; Node's ECDH does the point multiplication
+function secp256k1Public(k) {
+  const ecdh = crypto.createECDH('secp256k1')
+  ecdh.setPrivateKey(fromScalar(k))
+  return ecdh.getPublicKey(null, 'compressed')
+}
+
+// First SHA512Half(prefix | u32 seq) that is a valid secp256k1 scalar
+function deriveScalar(prefix) {
+  const buf = Buffer.alloc(prefix.length + 4)
+  prefix.copy(buf, 0)
+  for (let seq = 0; seq < 0xFFFFFFFF; seq++) {
+    buf.writeUInt32BE(seq, prefix.length)
+    const k = toScalar(sha512Half(buf))
+    if (k > 0n && k < SECP256K1_N) return k
+  }
+  throw new Error('key derivation failed')
+}
+
+function derInteger(v) {
+  let bytes = fromScalar(v)
+  let skip = 0
+  while (skip < 31 && bytes[skip] === 0) skip++
+  bytes = bytes.subarray(skip)
+  if (bytes[0] & 0x80) bytes = Buffer.concat([Buffer.from([0]), bytes])
+  return Buffer.concat([Buffer.from([0x02, bytes.length]), bytes])
+}
+
+// Same keys and signatures as src/signer.c
+class TxSigner {
+  #secret
+  #key
+
+  constructor(seed) {
+    let decoded
+    try {
+      decoded = codec().decodeSeed(seed)
+    } catch (error) {
+      throw new TypeError('not a family seed')
+    }
+    const entropy = Buffer.from(decoded.bytes)
+    let publicKey
+    if (decoded.type === 'ed25519') {
+      const der = Buffer.concat([ED25519_PKCS8_PREFIX, sha512Half(entropy)])
+      this.#key = crypto.createPrivateKey({ key: der, format: 'der', type: 'pkcs8' })
+      const spki = crypto.createPublicKey(this.#key).export({ format: 'der', type: 'spki' })
+      publicKey = Buffer.concat([Buffer.from([0xED]), spki.subarray(spki.length - 32)])
+      this.algorithm = 'ed25519'
+    } else {
+      const root = deriveScalar(entropy)
+      const tweak = deriveScalar(Buffer.concat([secp256k1Public(root), Buffer.alloc(4)]))
+      this.#secret = (root + tweak) % SECP256K1_N
+      publicKey = secp256k1Public(this.#secret)
+      this.algorithm = 'secp256k1'
+    }
+    this.publicKey = publicKey.toString('hex').toUpperCase()
+    const id = crypto.createHash('ripemd160').update(crypto.createHash('sha256').update(publicKey).digest()).digest()
+    this.address = codec().encodeAccountID(id)
+  }
+
+  sign(message) {
+    if (this.#key) return crypto.sign(null, Buffer.from(message), this.#key)
+
+    const n = SECP256K1_N
+    const z = toScalar(sha512Half(Buffer.from(message)))
+    for (;;) {
+      const k = toScalar(crypto.randomBytes(32))
+      if (k === 0n || k >= n) continue
+      const r = toScalar(secp256k1Public(k).subarray(1)) % n
+      if (r === 0n) continue
+      let s = (modPow(k, n - 2n, n) * ((z + r * this.#secret) % n)) % n
+      if (s === 0n) continue
+      if (s > n >> 1n) s = n - s
+      const body = Buffer.concat([derInteger(r), derInteger(s)])
+      return Buffer.concat([Buffer.from([0x30, body.length]), body])
+    }
+  }
+}
+
+// Same holdings and reports as src/boosts.c, over decoded metadata
+class BoostIndex {
+  constructor({ issuer, taxon, tiers } = {}) {
+    this.issuer = accountAddress(issuer, 'issuer')
+    this.issuerId = module.exports.decodeAccounts([this.issuer])
+    if (taxon !== undefined && (!Number.isInteger(taxon) || taxon < 0 || taxon > 0xFFFFFFFF)) {
+      throw new TypeError('taxon must be a u32')
+    }
+    this.taxon = taxon === undefined ? null : taxon
+    if (!Array.isArray(tiers) || tiers.length === 0 || tiers.length > 32) {
+      throw new TypeError('tiers must be 1 to 32 [count, boost] pairs')
+    }
+    tiers.forEach(([count, boost], t) => {
+      const u32 = (v) => Number.isInteger(v) && v >= 0 && v <= 0xFFFFFFFF
+      if (!u32(count) || !u32(boost) || count === 0 || (t > 0 && count <= tiers[t - 1][0])) {
+        throw new RangeError('tiers must be [count, boost] with counts ascending from 1')
+      }
+    })
+    this.tiers = tiers.map(([count, boost]) => [count, boost])
+    this.owners = new Map()
+    this.holders = new Map()
+    this.pending = new Set()
+  }
+
+  #inCollection(id) {
+    if (!id.subarray(4, 24).equals(this.issuerId)) return false
+    if (this.taxon === null) return true
+    const sequence = id.readUInt32BE(28)
+    return ((id.readUInt32BE(24) ^ (Math.imul(384160001, sequence) + 2459)) >>> 0) === this.taxon
+  }
+
+  #boostFor(count) {
+    let boost = 100
+    for (const [min, b] of this.tiers) if (min <= count) boost = b
+    return boost
+  }
+
+  #holder(account) {
+    let h = this.holders.get(account)
+    if (!h) {
+      h = { count: 0, reported: 100 }
+      this.holders.set(account, h)
+    }
+    return h
+  }
+
+  #left(id, account) {
+    if (this.owners.get(id) !== account) return
+    this.owners.delete(id)
+    this.#holder(account).count--
+    this.pending.add(account)
+  }
+
+  #joined(id, account) {
+    const from = this.owners.get(id)
+    if (from === account) return
+    if (from !== undefined) {
+      this.#holder(from).count--
+      this.pending.add(from)
+    }
+    this.owners.set(id, account)
+    this.#holder(account).count++
+    this.pending.add(account)
+  }
+
+  #tokenId(id) {
+    if (typeof id === 'string' && /^[0-9A-Fa-f]{64}$/.test(id)) return Buffer.from(id, 'hex')
+    if (id && typeof id !== 'string' && id.length === 32) return Buffer.from(id)
+    throw new TypeError('token id must be 64 hex digits or 32 bytes')
+  }
+
+  load(tokens) {
+    if (!Array.isArray(tokens)) throw new TypeError('load(tokens)')
+    const entries = tokens.map(({ id, owner }) => [this.#tokenId(id), accountAddress(owner, 'owner')])
+    const reported = new Map([...this.holders].map(([account, h]) => [account, h.reported]))
+    this.owners = new Map()
+    this.holders = new Map()
+    this.pending = new Set()
+    for (const [account, boost] of reported) {
+      this.#holder(account).reported = boost
+      this.pending.add(account)
+    }
+    for (const [id, owner] of entries) {
+      if (this.#inCollection(id)) this.#joined(id.toString('hex').toUpperCase(), owner)
+    }
+  }
+
+  baseline(entries) {
+    if (!Array.isArray(entries)) throw new TypeError('baseline(entries)')
+    for (const { account, boost } of entries) {
+      const address = accountAddress(account, 'account')
+      if (!Number.isInteger(boost) || boost < 0 || boost > 0xFFFFFFFF) throw new TypeError('boost must be a u32')
+      this.#holder(address).reported = boost || 100
+      this.pending.add(address)
+    }
+  }
+
+  apply(metas) {
+    if (!Array.isArray(metas)) throw new TypeError('apply(metas)')
+    for (const meta of metas) {
+      let pages
+      try {
+        pages = nftPageChanges(decodeTx(meta))
+      } catch (error) {
+        throw new RangeError('malformed metadata')
+      }
+      const ids = (tokens) => (tokens || []).map(t => Buffer.from(t.NFToken.NFTokenID, 'hex'))
+        .filter(id => this.#inCollection(id)).map(id => id.toString('hex').toUpperCase())
+      const owners = module.exports.encodeAccounts(Buffer.concat(pages.map(p => p.owner)))
+      pages.forEach((p, i) => ids(p.before).forEach(id => this.#left(id, owners[i])))
+      pages.forEach((p, i) => ids(p.after).forEach(id => this.#joined(id, owners[i])))
+    }
+    return this.flush()
+  }
+
+  flush() {
+    const out = []
+    for (const account of this.pending) {
+      const h = this.holders.get(account)
+      const boost = this.#boostFor(h.count)
+      if (boost === h.reported) continue
+      h.reported = boost
+      out.push({ account, count: h.count, boost })
+    }
+    this.pending.clear()
+    return out
+  }
+
+  holder(account) {
+    const h = this.holders.get(accountAddress(account, 'account'))
+    const count = h ? h.count : 0
+    return { count, boost: this.#boostFor(count) }
+  }
+
+  info() {
+    let holders = 0
+    for (const h of this.holders.values()) if (h.count > 0) holders++
+    return { tokens: this.owners.size, holders }
+  }
+}
+
+function accountAddress(account, what) {
+  if (typeof account === 'string') {
+    try {
+      module.exports.decodeAccounts([account])
+      return account
+    } catch (error) {}
+  }
+  throw new TypeError(`${what} must be a classic address`)
+}
+
+// NFTokens before and after of each NFTokenPage in decoded metadata, as in src/boosts.c
+function nftPageChanges(meta) {
+  const pages = []
+  for (const wrapper of meta.AffectedNodes || []) {
+    const kind = Object.keys(wrapper)[0]
+    const node = wrapper[kind]
+    if (node.LedgerEntryType !== 'NFTokenPage' && node.LedgerEntryType !== 0x50) continue
+    const owner = Buffer.from(node.LedgerIndex, 'hex').subarray(0, 20)
+    const fields = node.FinalFields || node.NewFields || {}
+    const previous = node.PreviousFields || {}
+    if (kind === 'CreatedNode') {
+      pages.push({ owner, before: null, after: fields.NFTokens })
+    } else if (kind === 'DeletedNode') {
+      pages.push({ owner, before: previous.NFTokens || fields.NFTokens, after: null })
+    } else if (previous.NFTokens) {
+      pages.push({ owner, before: previous.NFTokens, after: fields.NFTokens })
+    }
+  }
+  return pages
+}
+
+module.exports = {
+  native: binding !== null,
+  decodeRecords: binding ? binding.decodeRecords : decodeRecords,
+  decodeHead: binding ? binding.decodeHead : decodeHead,
+  distribute: binding ? binding.distribute : distribute,
+  packHolders,
+  decodeTx: binding ? binding.decodeTx : decodeTx,
+  readField: binding ? binding.readField : readField,
+  encodeTx: binding ? binding.encodeTx : encodeTx,
+  xflToString: binding ? binding.xflToString : xflToString,
+  xflFromString: binding ? binding.xflFromString : xflFromString,
+  balanceChanges: binding ? binding.balanceChanges : balanceChanges,
+  ledgerVolume: binding ? binding.ledgerVolume : ledgerVolume,
+  ClaimSnapshot: binding ? binding.ClaimSnapshot : ClaimSnapshot,
+  claimPreview: binding ? binding.claimPreview : null,
+  TxSigner: binding ? binding.TxSigner : TxSigner,
+  encodeAccounts: binding ? binding.encodeAccounts : encodeAccounts,
+  decodeAccounts: binding ? binding.decodeAccounts : decodeAccounts,
+  BoostIndex: binding ? binding.BoostIndex : BoostIndex,
+  js: {
+    decodeRecords,
+    decodeHead,
+    distribute,
+    decodeTx,
+    readField,
+    encodeTx,
+    xflToString,
+    xflFromString,
+    balanceChanges,
+    ledgerVolume,
+    ClaimSnapshot,
+    TxSigner,
+    encodeAccounts,
+    decodeAccounts,
+    BoostIndex
+  }
+}
@@ -0,0 +1,417 @@
+/**
+ * drippy_native parity checks
+ *
+ * Every function with a JavaScript fallback runs through both the addon and the
+ * fallback (module.exports.js) on seeded random inputs and fixed vectors; any
+ * difference fails the check. The fallbacks are what the backend runs where the addon
+ * has not been built, so they must give the same results.
+ *
+ *   distribute  pro-rata shares and claim deltas, both bases, boosts, empty and 64-bit pools
+ *   records     change log records and ring heads
+ *   xfl         XFL to and from decimal strings
+ *   accounts    batch r-address encode/decode, bad checksums rejected
+ *   codec       encodeTx / decodeTx / readField on Payments with memos and IOU amounts
+ *   balances    balanceChanges and ledgerVolume over encoded metadata
+ *   snapshot    ClaimSnapshot files, lookups and merges
+ *   signer      TxSigner keys and addresses; ed25519 signatures byte for byte, secp256k1
+ *               signatures checked against the public key
+ *   boosts      BoostIndex holdings and boost reports after load()
+ *
+ * Prints one line per check and exits 1 when any fails. Without a built addon there
+ * is nothing to compare; it says so and exits 0.
+ *
+ * Run from backend: npm test (after `npm run build:native`), or node native/parity.js
+ */
+
+const assert = require('assert')
+const crypto = require('crypto')
+const fs = require('fs')
+const os = require('os')
+const path = require('path')
+
+const drippy = require('.')
+const js = drippy.js
+
+const SEED = 0x44524950  // 'DRIP'
+const ROUNDS = 40
+
+// mulberry32: the same inputs on every run
+let rngState = SEED
+function rng() {
+  rngState = (rngState + 0x6D2B79F5) >>> 0
+  let t = rngState
+  t = Math.imul(t ^ (t >>> 15), t | 1)
+  t ^= t + Math.imul(t ^ (t >>> 7), t | 61)
+  return ((t ^ (t >>> 14)) >>> 0)
+}
+
+const below = (n) => rng() % n
+const bytes = (n) => Buffer.from(Array.from({ length: n }, () => below(256)))
+const bigBelow = (bits) => BigInt('0x' + bytes(8).toString('hex')) & ((1n << BigInt(bits)) - 1n)
+
+// Runs fn on the addon and on the fallback; both must throw or both return the same.
+// Random inputs are drawn before the call, so both see the same bytes
+function same(fn, what) {
+  let native, fallback, nativeError, fallbackError
+  try { native = fn(drippy) } catch (error) { nativeError = error }
+  try { fallback = fn(js) } catch (error) { fallbackError = error }
+  if (nativeError || fallbackError) {
+    assert.ok(nativeError && fallbackError,
+      `${what}: ${nativeError ? 'addon' : 'fallback'} threw ${(nativeError || fallbackError).message}`)
+    return null
+  }
+  assert.deepStrictEqual(fallback, native, what)
+  return native
+}
+
+// ---- distribute --------------------------------------------------------------------
+
+function randomHolders(n) {
+  return Array.from({ length: n }, () => ({
+    account: bytes(20),
+    balance: below(8) === 0 ? 0n : bigBelow(40),
+    nfts: below(4) === 0 ? 0 : below(20),
+    boost: below(3) === 0 ? 0 : 100 + below(200)
+  }))
+}
+
+function checkDistribute() {
+  for (let round = 0; round < ROUNDS; round++) {
+    const snapshot = drippy.packHolders(randomHolders(below(300)))
+    const pool = round === 0 ? 0n : round === 1 ? 0xFFFFFFFFFFFFFFFFn : bigBelow(50)
+    for (const basis of ['balance', 'nfts']) {
+      for (const deltas of [true, false]) {
+        same(m => m.distribute(snapshot, pool, { basis, deltas }), `distribute round ${round} ${basis}`)
+      }
+    }
+  }
+  same(m => m.distribute(Buffer.alloc(0), 1000n), 'distribute of no holders')
+  same(m => m.distribute(Buffer.alloc(35), 1000n), 'distribute of a cut record')
+  same(m => m.distribute(Buffer.alloc(36), 1000n, { basis: 'stake' }), 'distribute with a bad basis')
+}
+
+// ---- records -----------------------------------------------------------------------
+
+function checkRecords() {
+  for (let round = 0; round < ROUNDS; round++) {
+    const data = bytes(48 * below(64))
+    same(m => m.decodeRecords(data), `decodeRecords round ${round}`)
+  }
+  const cut = bytes(47)
+  const head = bytes(12)
+  same(m => m.decodeRecords(cut), 'decodeRecords of a cut record')
+  same(m => m.decodeHead(head), 'decodeHead')
+  same(m => m.decodeHead(head.subarray(1)), 'decodeHead of a cut head')
+}
+
+// ---- xfl ---------------------------------------------------------------------------
+
+function randomXfl() {
+  const mantissa = 1000000000000000n + bigBelow(53) % 9000000000000000n
+  const exponent = BigInt(below(160))  // biased by 97
+  return (below(2) ? 1n << 62n : 0n) | (exponent << 54n) | mantissa
+}
+
+function checkXfl() {
+  for (let round = 0; round < ROUNDS * 10; round++) {
+    const xfl = randomXfl()
+    const text = same(m => m.xflToString(xfl), `xflToString ${xfl}`)
+    same(m => m.xflFromString(text), `xflFromString ${text}`)
+  }
+  for (const text of ['0', '1', '-1', '1.5', '0.000001', '123456789012345678', '1e10', '-0.25', 'abc', '']) {
+    same(m => m.xflFromString(text), `xflFromString '${text}'`)
+  }
+  same(m => m.xflToString(0n), 'xflToString 0')
+}
+
+// ---- accounts ----------------------------------------------------------------------
+
+function checkAccounts() {
+  const ids = bytes(20 * 500)
+  const addresses = same(m => m.encodeAccounts(ids), 'encodeAccounts')
+  const decoded = same(m => m.decodeAccounts(addresses), 'decodeAccounts')
+  assert.ok(Buffer.from(decoded).equals(ids), 'decodeAccounts(encodeAccounts(ids)) is not ids')
+
+  // One character off breaks the checksum
+  const broken = addresses[0].slice(0, -1) + (addresses[0].endsWith('h') ? 'j' : 'h')
+  same(m => m.decodeAccounts([addresses[1], broken]), 'decodeAccounts with a bad checksum')
+  same(m => m.encodeAccounts(ids.subarray(1, 20)), 'encodeAccounts of a cut id')
+}
+
+// ---- codec -------------------------------------------------------------------------
+
+function randomPayment(addresses) {
+  const tx = {
+    TransactionType: 'Payment',
+    Account: addresses[below(addresses.length)],
+    Destination: addresses[below(addresses.length)],
+    Amount: String(1 + below(1000000000)),
+    Fee: String(10 + below(1000)),
+    Sequence: 0,
+    TicketSequence: 1 + below(100000),
+    LastLedgerSequence: 1 + below(100000000),
+    NetworkID: 21337,
+    SigningPubKey: bytes(33).toString('hex').toUpperCase()
+  }
+  if (below(2)) {
+    tx.Amount = {
+      currency: '4452495050590000000000000000000000000000',
+      issuer: addresses[below(addresses.length)],
+      value: drippy.xflToString(randomXfl() & ~(1n << 62n) | (1n << 62n))
+    }
+  }
+  if (below(2)) {
+    tx.Memos = Array.from({ length: 1 + below(3) }, () => ({
+      Memo: { MemoType: bytes(1 + below(8)).toString('hex').toUpperCase(), MemoData: bytes(below(64)).toString('hex').toUpperCase() }
+    }))
+  }
+  return tx
+}
+
+function checkCodec() {
+  const addresses = drippy.encodeAccounts(bytes(20 * 16))
+  for (let round = 0; round < ROUNDS; round++) {
+    const tx = randomPayment(addresses)
+    const blob = same(m => Buffer.from(m.encodeTx(tx)), `encodeTx round ${round}`)
+    same(m => Buffer.from(m.encodeTx(tx, { signing: true })), `encodeTx signing round ${round}`)
+    same(m => m.decodeTx(blob), `decodeTx round ${round}`)
+    for (const field of ['Account', 'Destination', 'Amount', 'Fee', 'TicketSequence', 'Memos', 'Flags']) {
+      same(m => m.readField(blob, field), `readField ${field} round ${round}`)
+    }
+  }
+  const junk = bytes(7)
+  same(m => m.decodeTx(junk), 'decodeTx of random bytes')
+}
+
+// ---- balances ----------------------------------------------------------------------
+
+function randomMeta(addresses) {
+  const nodes = []
+  for (let i = 0; i < 1 + below(6); i++) {
+    const account = addresses[below(addresses.length)]
+    const index = bytes(32).toString('hex').toUpperCase()
+    const before = BigInt(below(1000000000))
+    const after = before + BigInt(below(2000000)) - 1000000n
+    if (below(3)) {
+      nodes.push({ ModifiedNode: {
+        LedgerEntryType: 0x61, LedgerIndex: index,
+        FinalFields: { Account: account, Balance: String(after < 0n ? 0n : after), Flags: 0, OwnerCount: 0, Sequence: 1 },
+        PreviousFields: { Balance: String(before) }
+      } })
+    } else {
+      const value = () => `${below(2) ? '-' : ''}${below(1000000)}.${below(1000000)}`
+      const limit = (issuer) => ({ currency: '4452495050590000000000000000000000000000', issuer, value: '0' })
+      nodes.push({ ModifiedNode: {
+        LedgerEntryType: 0x72, LedgerIndex: index,
+        FinalFields: {
+          Balance: { currency: '4452495050590000000000000000000000000000', issuer: 'rrrrrrrrrrrrrrrrrrrrBZbvji', value: value() },
+          Flags: 0,
+          LowLimit: limit(account),
+          HighLimit: limit(addresses[below(addresses.length)])
+        },
+        PreviousFields: {
+          Balance: { currency: '4452495050590000000000000000000000000000', issuer: 'rrrrrrrrrrrrrrrrrrrrBZbvji', value: value() }
+        }
+      } })
+    }
+  }
+  return { AffectedNodes: nodes, TransactionIndex: below(100), TransactionResult: 0 }
+}
+
+function checkBalances() {
+  const addresses = drippy.encodeAccounts(bytes(20 * 16))
+  const entries = []
+  for (let round = 0; round < ROUNDS; round++) {
+    const meta = Buffer.from(drippy.encodeTx(randomMeta(addresses)))
+    same(m => m.balanceChanges(meta), `balanceChanges round ${round}`)
+    entries.push({ tx: Buffer.from(drippy.encodeTx(randomPayment(addresses))), meta })
+  }
+  same(m => m.ledgerVolume(entries), 'ledgerVolume')
+}
+
+// ---- snapshot ----------------------------------------------------------------------
+
+function checkSnapshot() {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'drippy-parity-'))
+  try {
+    const files = { native: path.join(dir, 'native.snap'), js: path.join(dir, 'js.snap') }
+    const snapshots = { native: new drippy.ClaimSnapshot(files.native), js: new js.ClaimSnapshot(files.js) }
+    const accounts = Array.from({ length: 64 }, () => bytes(20))
+    for (let round = 0; round < ROUNDS / 4; round++) {
+      const records = Buffer.concat(Array.from({ length: below(32) }, () =>
+        Buffer.concat([accounts[below(accounts.length)], bytes(32)])))
+      const options = { ledger: 1000 + round, cursor: round * 7, replace: round === 5 }
+      const results = {}
+      for (const kind of ['native', 'js']) results[kind] = snapshots[kind].apply(records, options)
+      assert.deepStrictEqual(results.js, results.native, `ClaimSnapshot apply round ${round}`)
+      assert.ok(fs.readFileSync(files.js).equals(fs.readFileSync(files.native)), `snapshot files differ after round ${round}`)
+      assert.deepStrictEqual(snapshots.js.info(), snapshots.native.info(), `ClaimSnapshot info round ${round}`)
+      for (const account of accounts.slice(0, 16)) {
+        const hex = account.toString('hex')
+        assert.deepStrictEqual(snapshots.js.get(hex), snapshots.native.get(hex), `ClaimSnapshot get round ${round}`)
+        assert.deepStrictEqual(snapshots.js.record(hex), snapshots.native.record(hex), `ClaimSnapshot record round ${round}`)
+      }
+    }
+    for (const kind of ['native', 'js']) snapshots[kind].close()
+  } finally {
+    fs.rmSync(dir, { recursive: true, force: true })
+  }
+}
+
+// ---- signer ------------------------------------------------------------------------
+
+// Minimal secp256k1 ECDSA verification over SHA-512Half, to check signatures that
+// carry a random nonce
+const P = 0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFFC2Fn
+const N = 0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141n
+const G = [0x79BE667EF9DCBBAC55A06295CE870B07029BFCDB2DCE28D959F2815B16F81798n,
+  0x483ADA7726A3C4655DA4FBFC0E1108A8FD17B448A68554199C47D08FFB10D4B8n]
+
+const mod = (a, m) => ((a % m) + m) % m
+function pow(b, e, m) {
+  let r = 1n
+  for (b = mod(b, m); e > 0n; e >>= 1n, b = b * b % m) if (e & 1n) r = r * b % m
+  return r
+}
+function add(a, b) {
+  if (!a) return b
+  if (!b) return a
+  if (a[0] === b[0] && mod(a[1] + b[1], P) === 0n) return null
+  const l = a[0] === b[0]
+    ? 3n * a[0] * a[0] * pow(2n * a[1], P - 2n, P)
+    : (b[1] - a[1]) * pow(b[0] - a[0], P - 2n, P)
+  const x = mod(l * l - a[0] - b[0], P)
+  return [x, mod(l * (a[0] - x) - a[1], P)]
+}
+function mul(k, point) {
+  let r = null
+  for (; k > 0n; k >>= 1n, point = add(point, point)) if (k & 1n) r = add(r, point)
+  return r
+}
+const scalar = (buf) => BigInt('0x' + (buf.toString('hex') || '0'))
+
+function verifySecp256k1(publicKeyHex, message, der) {
+  const key = Buffer.from(publicKeyHex, 'hex')
+  const x = scalar(key.subarray(1))
+  let y = pow(x * x * x + 7n, (P + 1n) / 4n, P)
+  if ((y & 1n) !== BigInt(key[0] & 1)) y = P - y
+
+  assert.strictEqual(der[0], 0x30, 'signature is not a DER sequence')
+  assert.strictEqual(der[1], der.length - 2, 'DER sequence length')
+  const rLen = der[3]
+  const r = scalar(der.subarray(4, 4 + rLen))
+  const s = scalar(der.subarray(6 + rLen, 6 + rLen + der[5 + rLen]))
+  assert.ok(s <= N >> 1n, 'signature S is not canonical (low S)')
+
+  const z = scalar(crypto.createHash('sha512').update(message).digest().subarray(0, 32))
+  const w = pow(s, N - 2n, N)
+  const point = add(mul(z * w % N, G), mul(r * w % N, [x, y]))
+  return point !== null && point[0] % N === r
+}
+
+// Genesis account of every XRPL-family test network (passphrase "masterpassphrase")
+const GENESIS = {
+  seed: 'snoPBrXtMeMyMHUVTgbuqAfg1SUTb',
+  address: 'rHb9CJAWyB4rj91VRWn96DkukG4bwdtyTh',
+  publicKey: '0330E7FC9D56BB25D6893BA3F317AE5BCF33B3291BD63DB32654A313222F7FD020'
+}
+const ED25519_SEEDS = ['sEdTM1uX8pu2do5XvTnutH6HsouMaM2', 'sEdSKaCy2JT7JaM7v95H9SxkhP9wS2r']
+
+function checkSigner() {
+  const keys = (m, seed) => {
+    const signer = new m.TxSigner(seed)
+    return { address: signer.address, publicKey: signer.publicKey, algorithm: signer.algorithm }
+  }
+  const genesis = same(m => keys(m, GENESIS.seed), 'TxSigner genesis keys')
+  assert.strictEqual(genesis.address, GENESIS.address, 'genesis address')
+  assert.strictEqual(genesis.publicKey, GENESIS.publicKey, 'genesis public key')
+  same(m => keys(m, 'sNotASeed'), 'TxSigner of a bad seed')
+
+  const addresses = drippy.encodeAccounts(bytes(20 * 4))
+  for (let round = 0; round < 8; round++) {
+    const message = Buffer.from(drippy.encodeTx(randomPayment(addresses), { signing: true }))
+    for (const seed of ED25519_SEEDS) {
+      same(m => keys(m, seed), `TxSigner ${seed} keys`)
+      same(m => Buffer.from(new m.TxSigner(seed).sign(message)), `ed25519 signature round ${round}`)
+    }
+    for (const m of [drippy, js]) {
+      const signer = new m.TxSigner(GENESIS.seed)
+      const signature = Buffer.from(signer.sign(message))
+      assert.ok(verifySecp256k1(signer.publicKey, message, signature),
+        `${m === js ? 'fallback' : 'addon'} secp256k1 signature does not verify (round ${round})`)
+    }
+  }
+}
+
+// ---- boosts ------------------------------------------------------------------------
+
+function tokenId(issuerId, taxon, sequence) {
+  const id = Buffer.alloc(32)
+  id.writeUInt16BE(8, 0)
+  issuerId.copy(id, 4)
+  id.writeUInt32BE((taxon ^ (Math.imul(384160001, sequence) + 2459)) >>> 0, 24)
+  id.writeUInt32BE(sequence, 28)
+  return id.toString('hex').toUpperCase()
+}
+
+function checkBoosts() {
+  const addresses = drippy.encodeAccounts(bytes(20 * 24))
+  const issuer = addresses[0]
+  const issuerId = Buffer.from(drippy.decodeAccounts([issuer]))
+  const otherId = Buffer.from(drippy.decodeAccounts([addresses[1]]))
+  const options = { issuer, taxon: 7, tiers: [[1, 110], [3, 125], [5, 150]] }
+
+  const tokens = []
+  for (let sequence = 0; sequence < 200; sequence++) {
+    const id = below(5) === 0 ? tokenId(otherId, 7, sequence) : tokenId(issuerId, below(4) ? 7 : 8, sequence)
+    tokens.push({ id, owner: addresses[2 + below(22)] })
+  }
+
+  const indexes = { native: new drippy.BoostIndex(options), js: new js.BoostIndex(options) }
+  const run = (fn) => same(m => fn(m === js ? indexes.js : indexes.native), fn.toString())
+  run(index => index.baseline(addresses.slice(2, 8).map((account, i) => ({ account, boost: 100 + 10 * i }))))
+  run(index => index.load(tokens.slice(0, 120)))
+  run(index => index.flush())
+  run(index => index.info())
+  run(index => index.load(tokens))
+  run(index => index.flush())
+  for (const account of addresses.slice(2)) run(index => index.holder(account))
+  same(m => new m.BoostIndex({ ...options, tiers: [[3, 125], [1, 110]] }), 'BoostIndex with descending tiers')
+}
+
+// ---- Runner ------------------------------------------------------------------------
+
+const checks = [
+  ['distribute', checkDistribute],
+  ['records', checkRecords],
+  ['xfl', checkXfl],
+  ['accounts', checkAccounts],
+  ['codec', checkCodec],
+  ['balances', checkBalances],
+  ['snapshot', checkSnapshot],
+  ['signer', checkSigner],
+  ['boosts', checkBoosts]
+]
+
+function main() {
+  console.log('drippy_native parity checks')
+  if (!drippy.native) {
+    console.log('addon not built (npm run build:native): nothing to compare')
+    return 0
+  }
+  let failures = 0
+  for (const [name, fn] of checks) {
+    try {
+      fn()
+      console.log(`ok   ${name}`)
+    } catch (error) {
+      failures++
+      console.log(`FAIL ${name}`)
+      console.log(`       ${error.message.split('\n').slice(0, 12).join('\n       ')}`)
+    }
+  }
+  console.log(failures ? `${failures} of ${checks.length} checks failed` : `all ${checks.length} checks passed`)
+  return failures ? 1 : 0
+}
+
+process.exitCode = main()
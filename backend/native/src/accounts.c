@@ -0,0 +1,276 @@
+// Bulk account conversion and the address cache
+//
+// Holder snapshots and ledger walks convert the same accounts over and over. Every
+// id-to-address conversion in the addon (addon_account()) and every address it parses
+// (accounts_decode()) goes through a cache kept for the life of the Node environment;
+// the bulk functions below convert their misses eight at a time with base58.c's *_x8
+// functions.
+//
+//   encodeAccounts(ids)         Buffer of 20-byte account ids -> array of classic addresses
+//   decodeAccounts(addresses)   array of classic addresses -> Buffer of 20-byte ids;
+//                               throws a TypeError naming the first invalid one
+//
+// The cache is direct-mapped, ACCOUNT_CACHE_SLOTS entries in each direction indexed by
+// a hash of the id or of the address; a new entry replaces whatever held its slot. Each
+// environment (main thread, worker) has its own, freed with it.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "addon.h"
+#include "base58.h"
+
+#define ACCOUNT_CACHE_SLOTS (1 << 16)
+#define ADDRESS_INPUT_MAX 64
+
+typedef struct {
+    uint8_t id[20];
+    uint8_t len;                        // 0 = empty
+    char address[ACCOUNT_ADDRESS_MAX];
+} cache_entry;
+
+typedef struct {
+    cache_entry by_id[ACCOUNT_CACHE_SLOTS];
+    cache_entry by_address[ACCOUNT_CACHE_SLOTS];
+} account_cache;
+
+static void cache_finalize(napi_env env, void* data, void* hint)
+{
+    (void)env;
+    (void)hint;
+    free(data);
+}
+
+// The environment's cache, created on first use; NULL when it cannot be
+static account_cache* get_cache(napi_env env)
+{
+    account_cache* cache = NULL;
+    if (napi_get_instance_data(env, (void**)&cache) == napi_ok && cache) return cache;
+    cache = calloc(1, sizeof(account_cache));
+    if (cache && napi_set_instance_data(env, cache, cache_finalize, NULL) != napi_ok) {
+        free(cache);
+        cache = NULL;
+    }
+    return cache;
+}
+
+// Account ids are hash outputs already; their first bytes index well
+static uint32_t id_slot(const uint8_t id[20])
+{
+    return ((uint32_t)id[0] | (uint32_t)id[1] << 8 | (uint32_t)id[2] << 16) & (ACCOUNT_CACHE_SLOTS - 1);
+}
+
+// FNV-1a
+static uint32_t address_slot(const char* address, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+        h = (h ^ (uint8_t)address[i]) * 16777619u;
+    return h & (ACCOUNT_CACHE_SLOTS - 1);
+}
+
+static void cache_put(account_cache* cache, const uint8_t id[20], const char* address, size_t len)
+{
+    if (!cache || !len) return;
+    cache_entry* e = &cache->by_id[id_slot(id)];
+    memcpy(e->id, id, 20);
+    memcpy(e->address, address, len + 1);
+    e->len = (uint8_t)len;
+    cache->by_address[address_slot(address, len)] = *e;
+}
+
+static const cache_entry* cache_by_id(account_cache* cache, const uint8_t id[20])
+{
+    if (!cache) return NULL;
+    const cache_entry* e = &cache->by_id[id_slot(id)];
+    return e->len && memcmp(e->id, id, 20) == 0 ? e : NULL;
+}
+
+static const cache_entry* cache_by_address(account_cache* cache, const char* address, size_t len)
+{
+    if (!cache) return NULL;
+    const cache_entry* e = &cache->by_address[address_slot(address, len)];
+    return e->len == len && memcmp(e->address, address, len) == 0 ? e : NULL;
+}
+
+size_t accounts_encode(napi_env env, char* out, const uint8_t id[20])
+{
+    account_cache* cache = get_cache(env);
+    const cache_entry* e = cache_by_id(cache, id);
+    if (e) {
+        memcpy(out, e->address, e->len + 1);
+        return e->len;
+    }
+    size_t len = account_encode(out, id);
+    cache_put(cache, id, out, len);
+    return len;
+}
+
+int accounts_decode(napi_env env, uint8_t id[20], const char* address, size_t len)
+{
+    account_cache* cache = get_cache(env);
+    const cache_entry* e = cache_by_address(cache, address, len);
+    if (e) {
+        memcpy(id, e->id, 20);
+        return 1;
+    }
+    if (!account_decode(id, address, len)) return 0;
+    cache_put(cache, id, address, len);
+    return 1;
+}
+
+// Misses waiting for a full group of eight, and where their results go
+typedef struct {
+    size_t count;
+    size_t index[CHECKSUM_LANES];
+    const uint8_t* id[CHECKSUM_LANES];
+    char address[CHECKSUM_LANES][ADDRESS_INPUT_MAX];
+    size_t len[CHECKSUM_LANES];
+} pending_group;
+
+// Encodes the pending ids into `result`; a short group repeats its first id in the
+// unused lanes
+static int flush_encode(napi_env env, account_cache* cache, pending_group* g, napi_value result)
+{
+    char out[CHECKSUM_LANES][ACCOUNT_ADDRESS_MAX];
+    size_t len[CHECKSUM_LANES];
+    for (size_t l = g->count; l < CHECKSUM_LANES; l++)
+        g->id[l] = g->id[0];
+    account_encode_x8(out, len, g->id);
+
+    for (size_t l = 0; l < g->count; l++) {
+        napi_value s;
+        cache_put(cache, g->id[l], out[l], len[l]);
+        if (napi_create_string_latin1(env, out[l], len[l], &s) != napi_ok ||
+            napi_set_element(env, result, (uint32_t)g->index[l], s) != napi_ok)
+            return 0;
+    }
+    g->count = 0;
+    return 1;
+}
+
+static napi_value encode_accounts(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1], result;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "encodeAccounts(ids)");
+        return NULL;
+    }
+    const uint8_t* ids;
+    size_t len;
+    if (!addon_get_bytes(env, argv[0], &ids, &len)) return NULL;
+    if (len % 20 != 0) {
+        napi_throw_range_error(env, NULL, "ids must be a multiple of 20 bytes");
+        return NULL;
+    }
+
+    size_t n = len / 20;
+    account_cache* cache = get_cache(env);
+    pending_group g;
+    g.count = 0;
+    NAPI_CALL(env, napi_create_array_with_length(env, n, &result));
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t* id = ids + 20 * i;
+        const cache_entry* e = cache_by_id(cache, id);
+        if (e) {
+            napi_value s;
+            NAPI_CALL(env, napi_create_string_latin1(env, e->address, e->len, &s));
+            NAPI_CALL(env, napi_set_element(env, result, (uint32_t)i, s));
+            continue;
+        }
+        g.index[g.count] = i;
+        g.id[g.count++] = id;
+        if (g.count == CHECKSUM_LANES && !flush_encode(env, cache, &g, result)) {
+            napi_throw_error(env, NULL, "N-API call failed: encodeAccounts");
+            return NULL;
+        }
+    }
+    if (g.count && !flush_encode(env, cache, &g, result)) {
+        napi_throw_error(env, NULL, "N-API call failed: encodeAccounts");
+        return NULL;
+    }
+    return result;
+}
+
+static int throw_invalid(napi_env env, size_t index)
+{
+    char message[64];
+    snprintf(message, sizeof(message), "addresses[%zu] is not a classic address", index);
+    napi_throw_type_error(env, NULL, message);
+    return 0;
+}
+
+// Decodes the pending addresses into `ids`; throws on the first invalid one
+static int flush_decode(napi_env env, account_cache* cache, pending_group* g, uint8_t* ids)
+{
+    uint8_t out[CHECKSUM_LANES][20];
+    const char* address[CHECKSUM_LANES];
+    for (size_t l = 0; l < CHECKSUM_LANES; l++) {
+        size_t from = l < g->count ? l : 0;
+        address[l] = g->address[from];
+        g->len[l] = g->len[from];
+    }
+    int valid = account_decode_x8(out, address, g->len);
+
+    for (size_t l = 0; l < g->count; l++) {
+        if (!(valid & (1 << l))) return throw_invalid(env, g->index[l]);
+        memcpy(ids + 20 * g->index[l], out[l], 20);
+        cache_put(cache, out[l], g->address[l], g->len[l]);
+    }
+    g->count = 0;
+    return 1;
+}
+
+static napi_value decode_accounts(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1], result;
+    bool is_array = false;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 1 || napi_is_array(env, argv[0], &is_array) != napi_ok || !is_array) {
+        napi_throw_type_error(env, NULL, "decodeAccounts(addresses)");
+        return NULL;
+    }
+
+    uint32_t n;
+    uint8_t* ids = NULL;
+    NAPI_CALL(env, napi_get_array_length(env, argv[0], &n));
+    NAPI_CALL(env, napi_create_buffer(env, (size_t)n * 20, (void**)&ids, &result));
+
+    account_cache* cache = get_cache(env);
+    pending_group g;
+    g.count = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        napi_value v;
+        char* s = g.address[g.count];
+        size_t len;
+        NAPI_CALL(env, napi_get_element(env, argv[0], i, &v));
+        if (napi_get_value_string_latin1(env, v, s, ADDRESS_INPUT_MAX, &len) != napi_ok) {
+            // Earlier addresses still pending are checked first, to name the first bad one
+            if (g.count && !flush_decode(env, cache, &g, ids)) return NULL;
+            throw_invalid(env, i);
+            return NULL;
+        }
+
+        const cache_entry* e = cache_by_address(cache, s, len);
+        if (e) {
+            memcpy(ids + 20 * (size_t)i, e->id, 20);
+            continue;
+        }
+        g.index[g.count] = i;
+        g.len[g.count++] = len;
+        if (g.count == CHECKSUM_LANES && !flush_decode(env, cache, &g, ids)) return NULL;
+    }
+    if (g.count && !flush_decode(env, cache, &g, ids)) return NULL;
+    return result;
+}
+
+napi_value accounts_init(napi_env env, napi_value exports)
+{
+    NAPI_CALL(env, addon_export(env, exports, "encodeAccounts", encode_accounts));
+    NAPI_CALL(env, addon_export(env, exports, "decodeAccounts", decode_accounts));
+    return exports;
+}
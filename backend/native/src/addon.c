@@ -0,0 +1,89 @@
+// drippy_native module entry and shared N-API helpers
+
+#include "addon.h"
+#include "base58.h"
+
+napi_status addon_export(napi_env env, napi_value exports, const char* name, napi_callback fn)
+{
+    napi_value f;
+    napi_status status = napi_create_function(env, name, NAPI_AUTO_LENGTH, fn, NULL, &f);
+    if (status != napi_ok) return status;
+    return napi_set_named_property(env, exports, name, f);
+}
+
+int addon_get_bytes(napi_env env, napi_value value, const uint8_t** data, size_t* len)
+{
+    bool is_buffer = false;
+    bool is_typed = false;
+
+    napi_is_buffer(env, value, &is_buffer);
+    if (is_buffer) {
+        void* p = NULL;
+        if (napi_get_buffer_info(env, value, &p, len) != napi_ok) return 0;
+        *data = (const uint8_t*)p;
+        return 1;
+    }
+
+    napi_is_typedarray(env, value, &is_typed);
+    if (is_typed) {
+        napi_typedarray_type type;
+        void* p = NULL;
+        if (napi_get_typedarray_info(env, value, &type, len, &p, NULL, NULL) != napi_ok) return 0;
+        if (type == napi_uint8_array) {
+            *data = (const uint8_t*)p;
+            return 1;
+        }
+    }
+
+    napi_throw_type_error(env, NULL, "expected a Buffer or Uint8Array");
+    return 0;
+}
+
+napi_status addon_set_u32(napi_env env, napi_value obj, const char* name, uint32_t v)
+{
+    napi_value n;
+    napi_status status = napi_create_uint32(env, v, &n);
+    if (status != napi_ok) return status;
+    return napi_set_named_property(env, obj, name, n);
+}
+
+napi_status addon_set_hex(napi_env env, napi_value obj, const char* name, const uint8_t* data, size_t len)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    char hex[128];
+    napi_value s;
+
+    if (len * 2 > sizeof(hex)) return napi_invalid_arg;
+    for (size_t i = 0; i < len; i++) {
+        hex[2 * i] = digits[data[i] >> 4];
+        hex[2 * i + 1] = digits[data[i] & 0x0F];
+    }
+
+    napi_status status = napi_create_string_latin1(env, hex, len * 2, &s);
+    if (status != napi_ok) return status;
+    return napi_set_named_property(env, obj, name, s);
+}
+
+napi_value addon_account(napi_env env, const uint8_t* id)
+{
+    char address[ACCOUNT_ADDRESS_MAX];
+    napi_value s;
+    size_t len = accounts_encode(env, address, id);
+    return napi_create_string_latin1(env, address, len, &s) == napi_ok ? s : NULL;
+}
+
+static napi_value init(napi_env env, napi_value exports)
+{
+    if (!records_init(env, exports)) return NULL;
+    if (!prorata_init(env, exports)) return NULL;
+    if (!codec_init(env, exports)) return NULL;
+    if (!balances_init(env, exports)) return NULL;
+    if (!snapshot_init(env, exports)) return NULL;
+    if (!preview_init(env, exports)) return NULL;
+    if (!signer_init(env, exports)) return NULL;
+    if (!accounts_init(env, exports)) return NULL;
+    if (!boosts_init(env, exports)) return NULL;
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, init)
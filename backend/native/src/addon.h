@@ -0,0 +1,51 @@
+// drippy_native: N-API addon for hot backend paths
+//
+// Each module registers its functions on the exports object from its *_init(); addon.c
+// calls them in turn. Errors are thrown as JavaScript TypeError/RangeError and the
+// function returns NULL, as N-API expects.
+
+#ifndef DRIPPY_NATIVE_ADDON_H
+#define DRIPPY_NATIVE_ADDON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <node_api.h>
+
+#define NAPI_CALL(env, call)                                                   \
+    do {                                                                       \
+        if ((call) != napi_ok) {                                               \
+            napi_throw_error((env), NULL, "N-API call failed: " #call);         \
+            return NULL;                                                       \
+        }                                                                      \
+    } while (0)
+
+// Register `fn` as exports[name]
+napi_status addon_export(napi_env env, napi_value exports, const char* name, napi_callback fn);
+
+// Buffer or Uint8Array argument; throws and returns 0 when it is neither
+int addon_get_bytes(napi_env env, napi_value value, const uint8_t** data, size_t* len);
+
+napi_status addon_set_u32(napi_env env, napi_value obj, const char* name, uint32_t v);
+napi_status addon_set_hex(napi_env env, napi_value obj, const char* name, const uint8_t* data, size_t len);
+
+// Classic address string of a 20-byte account id; NULL when N-API fails
+napi_value addon_account(napi_env env, const uint8_t* id);
+
+// Account conversions through the environment's address cache (accounts.c).
+// accounts_encode() writes up to ACCOUNT_ADDRESS_MAX bytes and returns the length;
+// accounts_decode() returns 0 for an invalid address.
+size_t accounts_encode(napi_env env, char* out, const uint8_t id[20]);
+int accounts_decode(napi_env env, uint8_t id[20], const char* address, size_t len);
+
+// Module initializers
+napi_value records_init(napi_env env, napi_value exports);
+napi_value prorata_init(napi_env env, napi_value exports);
+napi_value codec_init(napi_env env, napi_value exports);
+napi_value balances_init(napi_env env, napi_value exports);
+napi_value snapshot_init(napi_env env, napi_value exports);
+napi_value preview_init(napi_env env, napi_value exports);
+napi_value signer_init(napi_env env, napi_value exports);
+napi_value accounts_init(napi_env env, napi_value exports);
+napi_value boosts_init(napi_env env, napi_value exports);
+
+#endif
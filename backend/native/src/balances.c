@@ -0,0 +1,324 @@
+// Balance changes from binary transaction metadata
+//
+// Walks AffectedNodes of a serialized TransactionMetaData (the `meta` blob of a binary
+// ledger or tx request) and reports what xrpl.js getBalanceChanges() does, without the
+// JSON round trip or floating point:
+//   AccountRoot   Balance after minus before, in drops
+//   RippleState   Balance after minus before as an XFL, reported for the low account
+//                 with the high account as issuer and negated for the high account
+// A node without a Balance in PreviousFields did not change; a created node starts at 0.
+//
+//   balanceChanges(meta)  -> [{ account, currency, issuer?, drops | value + xfl }]
+//     drops is a signed BigInt; value the decimal string of xfl (BigInt, hook float)
+//   ledgerVolume(entries) -> [{ account, drops, transactions }]
+//     entries are [{ tx, meta }] of one ledger; per sending Account (the beneficiary),
+//     the XRP moved by its transactions: the sum of |drops| over their balance changes.
+//     Accounts come out in the order they first appear.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "addon.h"
+#include "sfcodes.h"
+#include "stcodec.h"
+
+#define LT_ACCOUNT_ROOT 0x0061
+#define LT_RIPPLE_STATE 0x0072
+
+typedef struct {
+    uint8_t account[20];
+    uint8_t currency[20];      // zero for XRP
+    uint8_t issuer[20];
+    int native;
+    int64_t drops;
+    int64_t xfl;
+} balance_change;
+
+typedef struct {
+    balance_change* items;
+    size_t count;
+    size_t cap;
+} change_list;
+
+static int push_change(change_list* list, const balance_change* c)
+{
+    if (list->count == list->cap) {
+        size_t cap = list->cap ? list->cap * 2 : 16;
+        balance_change* items = realloc(list->items, cap * sizeof(*items));
+        if (!items) return 0;
+        list->items = items;
+        list->cap = cap;
+    }
+    list->items[list->count++] = *c;
+    return 1;
+}
+
+static int64_t signed_drops(const uint8_t* amount)
+{
+    int64_t drops = (int64_t)st_amount_drops(amount);
+    return st_amount_negative(amount) ? -drops : drops;
+}
+
+// The object fields of one affected node
+typedef struct {
+    uint16_t entry_type;
+    st_field fields;           // FinalFields or NewFields
+    st_field previous;
+    int has_fields;
+    int has_previous;
+    int created;
+} node_view;
+
+static int read_node(const st_field* node, node_view* v)
+{
+    st_reader r;
+    st_field f;
+    int status;
+    memset(v, 0, sizeof(*v));
+    v->created = node->code == sfCreatedNode;
+
+    st_enter(&r, node);
+    while ((status = st_next(&r, &f)) == ST_OK) {
+        if (f.code == sfLedgerEntryType && f.len == 2) {
+            v->entry_type = (uint16_t)(f.data[0] << 8 | f.data[1]);
+        } else if (f.code == sfFinalFields || f.code == sfNewFields) {
+            v->fields = f;
+            v->has_fields = 1;
+        } else if (f.code == sfPreviousFields) {
+            v->previous = f;
+            v->has_previous = 1;
+        }
+    }
+    return status != ST_ERROR;
+}
+
+static int find_in(const st_field* object, uint32_t code, st_field* out)
+{
+    return st_find(object->data, object->len, code, out) == ST_OK;
+}
+
+// Appends the balance changes of one metadata blob; 0 when it is malformed or memory ran out
+static int collect_changes(const uint8_t* meta, size_t len, change_list* list)
+{
+    st_field nodes, node;
+    st_reader r;
+    int status = st_find(meta, len, sfAffectedNodes, &nodes);
+    if (status == ST_ERROR) return 0;
+    if (status == ST_END) return 1;
+
+    st_enter(&r, &nodes);
+    while ((status = st_next(&r, &node)) == ST_OK) {
+        node_view v;
+        st_field balance, before, f;
+        if (!read_node(&node, &v)) return 0;
+        if (v.entry_type != LT_ACCOUNT_ROOT && v.entry_type != LT_RIPPLE_STATE) continue;
+        if (!v.has_fields || !find_in(&v.fields, sfBalance, &balance)) continue;
+
+        int has_before = v.has_previous && find_in(&v.previous, sfBalance, &before);
+        if (!v.created && !has_before) continue;
+
+        balance_change c;
+        memset(&c, 0, sizeof(c));
+        if (v.entry_type == LT_ACCOUNT_ROOT) {
+            if (balance.len != 8 || !find_in(&v.fields, sfAccount, &f) || f.len != 20) continue;
+            c.native = 1;
+            c.drops = signed_drops(balance.data) - (has_before ? signed_drops(before.data) : 0);
+            if (c.drops == 0) continue;
+            memcpy(c.account, f.data, 20);
+            if (!push_change(list, &c)) return 0;
+            continue;
+        }
+
+        st_field low, high;
+        if (balance.len != 48 || (has_before && before.len != 48)) continue;
+        if (!find_in(&v.fields, sfLowLimit, &low) || low.len != 48) continue;
+        if (!find_in(&v.fields, sfHighLimit, &high) || high.len != 48) continue;
+        int64_t after_xfl = st_amount_xfl(balance.data);
+        int64_t before_xfl = has_before ? st_amount_xfl(before.data) : 0;
+        c.xfl = st_xfl_sum(after_xfl, st_xfl_negate(before_xfl));
+        if (c.xfl == 0) continue;
+
+        memcpy(c.currency, balance.data + 8, 20);
+        memcpy(c.account, low.data + 28, 20);
+        memcpy(c.issuer, high.data + 28, 20);
+        if (!push_change(list, &c)) return 0;
+        memcpy(c.account, high.data + 28, 20);
+        memcpy(c.issuer, low.data + 28, 20);
+        c.xfl = st_xfl_negate(c.xfl);
+        if (!push_change(list, &c)) return 0;
+    }
+    return status != ST_ERROR;
+}
+
+static napi_value change_object(napi_env env, const balance_change* c)
+{
+    napi_value obj, v;
+    char text[ST_XFL_STRING_MAX];
+    char currency[41];
+    size_t len;
+
+    if (napi_create_object(env, &obj) != napi_ok) return NULL;
+    if (!(v = addon_account(env, c->account))) return NULL;
+    if (napi_set_named_property(env, obj, "account", v) != napi_ok) return NULL;
+
+    if (c->native) {
+        if (napi_create_string_latin1(env, "XRP", 3, &v) != napi_ok) return NULL;
+        if (napi_set_named_property(env, obj, "currency", v) != napi_ok) return NULL;
+        if (napi_create_bigint_int64(env, c->drops, &v) != napi_ok) return NULL;
+        if (napi_set_named_property(env, obj, "drops", v) != napi_ok) return NULL;
+        return obj;
+    }
+
+    len = st_currency_to_string(currency, c->currency);
+    if (napi_create_string_latin1(env, currency, len, &v) != napi_ok) return NULL;
+    if (napi_set_named_property(env, obj, "currency", v) != napi_ok) return NULL;
+    if (!(v = addon_account(env, c->issuer))) return NULL;
+    if (napi_set_named_property(env, obj, "issuer", v) != napi_ok) return NULL;
+    len = st_xfl_to_string(text, c->xfl);
+    if (napi_create_string_latin1(env, text, len, &v) != napi_ok) return NULL;
+    if (napi_set_named_property(env, obj, "value", v) != napi_ok) return NULL;
+    if (napi_create_bigint_int64(env, c->xfl, &v) != napi_ok) return NULL;
+    if (napi_set_named_property(env, obj, "xfl", v) != napi_ok) return NULL;
+    return obj;
+}
+
+static napi_value balance_changes(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "balanceChanges(meta)");
+        return NULL;
+    }
+
+    const uint8_t* meta;
+    size_t len;
+    change_list list = { 0 };
+    if (!addon_get_bytes(env, argv[0], &meta, &len)) return NULL;
+    if (!collect_changes(meta, len, &list)) {
+        free(list.items);
+        napi_throw_range_error(env, NULL, "malformed metadata");
+        return NULL;
+    }
+
+    napi_value out;
+    napi_status status = napi_create_array_with_length(env, list.count, &out);
+    for (size_t i = 0; status == napi_ok && i < list.count; i++) {
+        napi_value obj = change_object(env, &list.items[i]);
+        status = obj ? napi_set_element(env, out, (uint32_t)i, obj) : napi_generic_failure;
+    }
+    free(list.items);
+    NAPI_CALL(env, status);
+    return out;
+}
+
+typedef struct {
+    uint8_t account[20];
+    uint64_t drops;
+    uint32_t transactions;
+    uint32_t used;
+} volume_slot;
+
+static napi_value ledger_volume(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+
+    uint32_t n = 0;
+    bool is_array = false;
+    if (argc < 1 || napi_is_array(env, argv[0], &is_array) != napi_ok || !is_array) {
+        napi_throw_type_error(env, NULL, "ledgerVolume([{ tx, meta }])");
+        return NULL;
+    }
+    NAPI_CALL(env, napi_get_array_length(env, argv[0], &n));
+
+    // Open addressing on the account, at most half full; `order` keeps first appearance
+    size_t capacity = 16;
+    while (capacity < 2 * (size_t)n) capacity *= 2;
+    volume_slot* slots = calloc(capacity, sizeof(*slots));
+    uint32_t* order = malloc((n ? n : 1) * sizeof(*order));
+    change_list list = { 0 };
+    uint32_t accounts = 0;
+    const char* error = NULL;
+    if (!slots || !order) error = "out of memory";
+
+    for (uint32_t i = 0; i < n && !error; i++) {
+        napi_value entry, tx_v, meta_v;
+        const uint8_t *tx, *meta;
+        size_t tx_len, meta_len;
+        st_field account;
+
+        napi_get_element(env, argv[0], i, &entry);
+        if (napi_get_named_property(env, entry, "tx", &tx_v) != napi_ok ||
+            napi_get_named_property(env, entry, "meta", &meta_v) != napi_ok ||
+            !addon_get_bytes(env, tx_v, &tx, &tx_len) || !addon_get_bytes(env, meta_v, &meta, &meta_len)) {
+            free(slots);
+            free(order);
+            free(list.items);
+            return NULL;
+        }
+        if (st_find(tx, tx_len, sfAccount, &account) != ST_OK || account.len != 20) {
+            error = "transaction without an Account";
+            break;
+        }
+
+        list.count = 0;
+        if (!collect_changes(meta, meta_len, &list)) {
+            error = "malformed metadata";
+            break;
+        }
+        uint64_t moved = 0;
+        for (size_t k = 0; k < list.count; k++)
+            if (list.items[k].native)
+                moved += (uint64_t)(list.items[k].drops < 0 ? -list.items[k].drops : list.items[k].drops);
+
+        size_t h = 0;
+        for (int k = 0; k < 8; k++)
+            h = h << 8 | account.data[k];
+        h &= capacity - 1;
+        while (slots[h].used && memcmp(slots[h].account, account.data, 20) != 0)
+            h = (h + 1) & (capacity - 1);
+        if (!slots[h].used) {
+            slots[h].used = 1;
+            memcpy(slots[h].account, account.data, 20);
+            order[accounts++] = (uint32_t)h;
+        }
+        slots[h].drops += moved;
+        slots[h].transactions++;
+    }
+    free(list.items);
+
+    if (error) {
+        free(slots);
+        free(order);
+        napi_throw_range_error(env, NULL, error);
+        return NULL;
+    }
+
+    napi_value out;
+    napi_status status = napi_create_array_with_length(env, accounts, &out);
+    for (uint32_t i = 0; status == napi_ok && i < accounts; i++) {
+        const volume_slot* s = &slots[order[i]];
+        napi_value obj, v;
+        status = napi_create_object(env, &obj);
+        if (status == napi_ok) status = (v = addon_account(env, s->account)) ? napi_ok : napi_generic_failure;
+        if (status == napi_ok) status = napi_set_named_property(env, obj, "account", v);
+        if (status == napi_ok) status = napi_create_bigint_uint64(env, s->drops, &v);
+        if (status == napi_ok) status = napi_set_named_property(env, obj, "drops", v);
+        if (status == napi_ok) status = addon_set_u32(env, obj, "transactions", s->transactions);
+        if (status == napi_ok) status = napi_set_element(env, out, i, obj);
+    }
+    free(slots);
+    free(order);
+    NAPI_CALL(env, status);
+    return out;
+}
+
+napi_value balances_init(napi_env env, napi_value exports)
+{
+    NAPI_CALL(env, addon_export(env, exports, "balanceChanges", balance_changes));
+    NAPI_CALL(env, addon_export(env, exports, "ledgerVolume", ledger_volume));
+    return exports;
+}
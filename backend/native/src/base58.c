@@ -0,0 +1,376 @@
+// Base58Check in the XRPL alphabet: account addresses and family seeds
+//
+// A string is base58(version | payload | first 4 bytes of sha256(sha256(both))); an
+// address has version 0x00 and a 20-byte account id.
+//
+// The *_x8 functions convert eight addresses per call, the double SHA-256 of their
+// checksums running in vector lanes; accounts.c feeds bulk conversions through them.
+
+#include <string.h>
+
+#include "base58.h"
+
+static const char ALPHABET[] = "rpshnaf39wBUDNEGHJKLM4PQRST7VWXYZ2bcdeCg65jkm8oFqi1tuvAxyz";
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_block(uint32_t h[8], const uint8_t* p)
+{
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++)
+        w[i] = ((uint32_t)p[4 * i] << 24) | ((uint32_t)p[4 * i + 1] << 16) |
+               ((uint32_t)p[4 * i + 2] << 8) | p[4 * i + 3];
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = k + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+        uint32_t t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        k = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+    h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+}
+
+void sha256(uint8_t out[32], const uint8_t* data, size_t len)
+{
+    uint32_t h[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    size_t full = len & ~(size_t)63;
+    for (size_t off = 0; off < full; off += 64)
+        sha256_block(h, data + off);
+
+    // Padding: 0x80, zeros, bit length in the last 8 bytes
+    uint8_t tail[128] = { 0 };
+    size_t rest = len - full;
+    memcpy(tail, data + full, rest);
+    tail[rest] = 0x80;
+    size_t tail_len = rest < 56 ? 64 : 128;
+    uint64_t bits = (uint64_t)len * 8;
+    for (int i = 0; i < 8; i++)
+        tail[tail_len - 1 - i] = (uint8_t)(bits >> (8 * i));
+    sha256_block(h, tail);
+    if (tail_len == 128) sha256_block(h, tail + 64);
+
+    for (int i = 0; i < 8; i++) {
+        out[4 * i] = (uint8_t)(h[i] >> 24);
+        out[4 * i + 1] = (uint8_t)(h[i] >> 16);
+        out[4 * i + 2] = (uint8_t)(h[i] >> 8);
+        out[4 * i + 3] = (uint8_t)h[i];
+    }
+}
+
+static void checksum(uint8_t out[4], const uint8_t* data, size_t len)
+{
+    uint8_t h[32];
+    sha256(h, data, len);
+    sha256(h, h, 32);
+    memcpy(out, h, 4);
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+
+// Eight SHA-256 computations side by side, one per vector lane. The compiler maps the
+// vector type onto whatever SIMD the target has (SSE2, AVX2, NEON) or splits it.
+typedef uint32_t u32x8 __attribute__((vector_size(32)));
+
+#define VROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+// sha256 of eight messages of the same `len` (at most 55 bytes, one block)
+static void sha256_short_x8(uint8_t out[CHECKSUM_LANES][32], const uint8_t* const msg[CHECKSUM_LANES],
+                            size_t len)
+{
+    uint8_t block[CHECKSUM_LANES][64];
+    for (int l = 0; l < CHECKSUM_LANES; l++) {
+        memset(block[l], 0, 64);
+        memcpy(block[l], msg[l], len);
+        block[l][len] = 0x80;
+        block[l][62] = (uint8_t)(len >> 5);
+        block[l][63] = (uint8_t)(len << 3);
+    }
+
+    u32x8 w[64];
+    for (int i = 0; i < 16; i++)
+        for (int l = 0; l < CHECKSUM_LANES; l++) {
+            const uint8_t* p = block[l] + 4 * i;
+            w[i][l] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+        }
+    for (int i = 16; i < 64; i++) {
+        u32x8 s0 = VROTR(w[i - 15], 7) ^ VROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        u32x8 s1 = VROTR(w[i - 2], 17) ^ VROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    static const uint32_t H0[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    u32x8 h[8];
+    for (int i = 0; i < 8; i++)
+        h[i] = (u32x8){ 0 } + H0[i];
+    u32x8 a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+    for (int i = 0; i < 64; i++) {
+        u32x8 t1 = k + (VROTR(e, 6) ^ VROTR(e, 11) ^ VROTR(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+        u32x8 t2 = (VROTR(a, 2) ^ VROTR(a, 13) ^ VROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        k = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+    h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+
+    for (int l = 0; l < CHECKSUM_LANES; l++)
+        for (int i = 0; i < 8; i++) {
+            out[l][4 * i] = (uint8_t)(h[i][l] >> 24);
+            out[l][4 * i + 1] = (uint8_t)(h[i][l] >> 16);
+            out[l][4 * i + 2] = (uint8_t)(h[i][l] >> 8);
+            out[l][4 * i + 3] = (uint8_t)h[i][l];
+        }
+}
+
+void checksum_x8(uint8_t out[CHECKSUM_LANES][4], const uint8_t* const data[CHECKSUM_LANES], size_t len)
+{
+    uint8_t first[CHECKSUM_LANES][32], second[CHECKSUM_LANES][32];
+    const uint8_t* lanes[CHECKSUM_LANES];
+    if (len > 55) {
+        for (int l = 0; l < CHECKSUM_LANES; l++)
+            checksum(out[l], data[l], len);
+        return;
+    }
+    sha256_short_x8(first, data, len);
+    for (int l = 0; l < CHECKSUM_LANES; l++)
+        lanes[l] = first[l];
+    sha256_short_x8(second, lanes, 32);
+    for (int l = 0; l < CHECKSUM_LANES; l++)
+        memcpy(out[l], second[l], 4);
+}
+
+#else
+
+void checksum_x8(uint8_t out[CHECKSUM_LANES][4], const uint8_t* const data[CHECKSUM_LANES], size_t len)
+{
+    for (int l = 0; l < CHECKSUM_LANES; l++)
+        checksum(out[l], data[l], len);
+}
+
+#endif
+
+// Both conversions work five base58 digits at a time on 32-bit limbs: 58^5 < 2^32,
+// so a limb step is one 64-bit multiply or divide by a constant instead of five.
+#define B58_POW5 656356768u         // 58^5
+#define LIMBS_MAX ((BASE58CHECK_PAYLOAD_MAX + 4 + 3) / 4)
+
+// Base58 digits of `bytes` into `out` of `cap` characters with the terminator; 0 when
+// it does not fit
+static size_t base58_encode(char* out, size_t cap, const uint8_t* bytes, size_t len)
+{
+    size_t zeros = 0;
+    while (zeros < len && bytes[zeros] == 0)
+        zeros++;
+
+    // Big-endian limbs, the first one holding the bytes that do not fill a whole limb
+    uint32_t limb[LIMBS_MAX];
+    size_t limbs = (len + 3) / 4;
+    size_t first = len - 4 * (limbs - 1);
+    for (size_t i = 0, off = 0; i < limbs; i++) {
+        size_t take = i == 0 ? first : 4;
+        uint32_t v = 0;
+        for (size_t k = 0; k < take; k++)
+            v = v << 8 | bytes[off++];
+        limb[i] = v;
+    }
+
+    // Repeated division by 58^5, least significant group first
+    uint8_t digits[5 * (LIMBS_MAX * 32 / 29 + 2)];
+    size_t n = 0, top = 0;
+    while (top < limbs && limb[top] == 0)
+        top++;
+    while (top < limbs) {
+        uint64_t rem = 0;
+        for (size_t i = top; i < limbs; i++) {
+            uint64_t cur = rem << 32 | limb[i];
+            limb[i] = (uint32_t)(cur / B58_POW5);
+            rem = cur % B58_POW5;
+        }
+        uint32_t group = (uint32_t)rem;
+        for (int k = 0; k < 5; k++) {
+            digits[n++] = (uint8_t)(group % 58);
+            group /= 58;
+        }
+        while (top < limbs && limb[top] == 0)
+            top++;
+    }
+    while (n && digits[n - 1] == 0)
+        n--;
+    if (zeros + n + 1 > cap) return 0;
+
+    size_t out_len = 0;
+    while (zeros--)
+        out[out_len++] = ALPHABET[0];
+    while (n)
+        out[out_len++] = ALPHABET[digits[--n]];
+    out[out_len] = 0;
+    return out_len;
+}
+
+// Bytes of a base58 string, at most `cap`; returns the count, 0 on a bad character or
+// when it is longer
+static size_t base58_decode(uint8_t* out, size_t cap, const char* s, size_t len)
+{
+    static int8_t index[128];
+    static int ready;
+    if (!ready) {
+        memset(index, -1, sizeof(index));
+        for (int i = 0; i < 58; i++)
+            index[(uint8_t)ALPHABET[i]] = (int8_t)i;
+        ready = 1;
+    }
+    if (cap > BASE58CHECK_PAYLOAD_MAX + 4) return 0;
+
+    // Little-endian limbs, multiplied up by up to five digits at a time
+    uint32_t limb[LIMBS_MAX + 1];
+    size_t limbs = 0;
+    for (size_t i = 0; i < len; i += 5) {
+        uint32_t mult = 1, add = 0;
+        for (size_t k = i; k < len && k < i + 5; k++) {
+            uint8_t c = (uint8_t)s[k];
+            if (c >= 128 || index[c] < 0) return 0;
+            mult *= 58;
+            add = add * 58 + (uint32_t)index[c];
+        }
+        uint64_t carry = add;
+        for (size_t j = 0; j < limbs; j++) {
+            uint64_t t = (uint64_t)limb[j] * mult + carry;
+            limb[j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        if (carry) {
+            if (limbs == LIMBS_MAX + 1) return 0;
+            limb[limbs++] = (uint32_t)carry;
+        }
+    }
+
+    // Significant bytes of the value, most significant first
+    uint8_t value[4 * (LIMBS_MAX + 1)];
+    size_t n = 0;
+    for (size_t j = limbs; j-- > 0;)
+        for (int k = 3; k >= 0; k--) {
+            uint8_t byte = (uint8_t)(limb[j] >> (8 * k));
+            if (n || byte) value[n++] = byte;
+        }
+
+    // Each leading 'r' is a zero byte
+    size_t zeros = 0;
+    while (zeros < len && s[zeros] == ALPHABET[0])
+        zeros++;
+    size_t total = zeros + n;
+    if (total > cap) return 0;
+    memset(out, 0, zeros);
+    memcpy(out + zeros, value, n);
+    return total;
+}
+
+size_t base58check_encode(char* out, size_t cap, const uint8_t* payload, size_t len)
+{
+    uint8_t bytes[BASE58CHECK_PAYLOAD_MAX + 4];
+    if (len > BASE58CHECK_PAYLOAD_MAX) return 0;
+    memcpy(bytes, payload, len);
+    checksum(bytes + len, payload, len);
+    return base58_encode(out, cap, bytes, len + 4);
+}
+
+size_t base58check_decode(uint8_t* out, size_t cap, const char* s, size_t len)
+{
+    uint8_t bytes[BASE58CHECK_PAYLOAD_MAX + 4];
+    if (cap > BASE58CHECK_PAYLOAD_MAX) cap = BASE58CHECK_PAYLOAD_MAX;
+    size_t total = base58_decode(bytes, cap + 4, s, len);
+    if (total < 5) return 0;
+
+    uint8_t check[4];
+    checksum(check, bytes, total - 4);
+    if (memcmp(check, bytes + total - 4, 4) != 0) return 0;
+    memcpy(out, bytes, total - 4);
+    return total - 4;
+}
+
+size_t account_encode(char out[ACCOUNT_ADDRESS_MAX], const uint8_t id[20])
+{
+    uint8_t payload[21];
+    payload[0] = 0;
+    memcpy(payload + 1, id, 20);
+    return base58check_encode(out, ACCOUNT_ADDRESS_MAX, payload, sizeof(payload));
+}
+
+int account_decode(uint8_t id[20], const char* address, size_t len)
+{
+    uint8_t payload[21];
+    if (len < 25 || len > 35) return 0;
+    if (base58check_decode(payload, sizeof(payload), address, len) != 21 || payload[0] != 0) return 0;
+    memcpy(id, payload + 1, 20);
+    return 1;
+}
+
+void account_encode_x8(char out[CHECKSUM_LANES][ACCOUNT_ADDRESS_MAX], size_t len[CHECKSUM_LANES],
+                       const uint8_t* const id[CHECKSUM_LANES])
+{
+    uint8_t bytes[CHECKSUM_LANES][25], check[CHECKSUM_LANES][4];
+    const uint8_t* payload[CHECKSUM_LANES];
+    for (int l = 0; l < CHECKSUM_LANES; l++) {
+        bytes[l][0] = 0;
+        memcpy(bytes[l] + 1, id[l], 20);
+        payload[l] = bytes[l];
+    }
+    checksum_x8(check, payload, 21);
+    for (int l = 0; l < CHECKSUM_LANES; l++) {
+        memcpy(bytes[l] + 21, check[l], 4);
+        len[l] = base58_encode(out[l], ACCOUNT_ADDRESS_MAX, bytes[l], 25);
+    }
+}
+
+int account_decode_x8(uint8_t id[CHECKSUM_LANES][20], const char* const address[CHECKSUM_LANES],
+                      const size_t len[CHECKSUM_LANES])
+{
+    uint8_t bytes[CHECKSUM_LANES][25], check[CHECKSUM_LANES][4];
+    const uint8_t* payload[CHECKSUM_LANES];
+    int valid = 0;
+    for (int l = 0; l < CHECKSUM_LANES; l++) {
+        payload[l] = bytes[l];
+        if (len[l] >= 25 && len[l] <= 35 && base58_decode(bytes[l], 25, address[l], len[l]) == 25 &&
+            bytes[l][0] == 0)
+            valid |= 1 << l;
+        else
+            memset(bytes[l], 0, 25);
+    }
+    checksum_x8(check, payload, 21);
+    for (int l = 0; l < CHECKSUM_LANES; l++) {
+        if (memcmp(check[l], bytes[l] + 21, 4) != 0) valid &= ~(1 << l);
+        if (valid & (1 << l)) memcpy(id[l], bytes[l] + 1, 20);
+        else memset(id[l], 0, 20);
+    }
+    return valid;
+}
@@ -0,0 +1,42 @@
+// Base58Check strings (addresses r..., seeds s...) and the SHA-256 behind their checksum
+
+#ifndef DRIPPY_NATIVE_BASE58_H
+#define DRIPPY_NATIVE_BASE58_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ACCOUNT_ADDRESS_MAX 36     // 35 characters and the terminator
+#define BASE58CHECK_PAYLOAD_MAX 64
+#define CHECKSUM_LANES 8           // strings checked or encoded per *_x8 call
+
+void sha256(uint8_t out[32], const uint8_t* data, size_t len);
+
+// Base58Check of `payload` (version bytes included) into `out` of `cap` bytes, with the
+// terminator; returns the length, 0 when it does not fit
+size_t base58check_encode(char* out, size_t cap, const uint8_t* payload, size_t len);
+
+// Payload of a Base58Check string, checksum removed; returns its length, 0 on a bad
+// character or checksum or when it is longer than `cap`
+size_t base58check_decode(uint8_t* out, size_t cap, const char* s, size_t len);
+
+// Classic address of a 20-byte account id; returns its length
+size_t account_encode(char out[ACCOUNT_ADDRESS_MAX], const uint8_t id[20]);
+
+// Account id of a classic address; returns 0 on a bad character, length or checksum
+int account_decode(uint8_t id[20], const char* address, size_t len);
+
+// Base58Check checksums of eight payloads of the same length, the SHA-256 rounds of all
+// eight run together in SIMD lanes where the compiler has vector extensions
+void checksum_x8(uint8_t out[CHECKSUM_LANES][4], const uint8_t* const data[CHECKSUM_LANES], size_t len);
+
+// account_encode() of eight ids at once
+void account_encode_x8(char out[CHECKSUM_LANES][ACCOUNT_ADDRESS_MAX], size_t len[CHECKSUM_LANES],
+                       const uint8_t* const id[CHECKSUM_LANES]);
+
+// account_decode() of eight addresses at once; bit l of the result is set when
+// address[l] was valid, the ids of invalid ones are left zero
+int account_decode_x8(uint8_t id[CHECKSUM_LANES][20], const char* const address[CHECKSUM_LANES],
+                      const size_t len[CHECKSUM_LANES]);
+
+#endif
@@ -0,0 +1,717 @@
+// Incremental NFT boosts from ledger metadata
+//
+// Keeps who holds each token of one NFT collection (an issuer and taxon, read from the
+// NFTokenID itself) and how many each holder has, and maps that count to the boost the
+// claim hook's BOOST memo sets (src/drippy_enhanced_claim.c, 100 = 1x). Ledger
+// metadata moves tokens between holders: every NFTokenPage node in AffectedNodes names
+// its owner in the first 20 bytes of its LedgerIndex, and its NFTokens before and after
+// the transaction are the tokens that left and joined that owner. Mints, transfers
+// (NFTokenAcceptOffer) and burns all show up this way, and so do page splits and merges,
+// which leave the owner's count as it was. Removals only apply to the owner the index
+// has, so applying a ledger twice leaves the index unchanged.
+//
+// Only holders whose boost differs from the last one reported come out, so one BOOST
+// memo per changed holder keeps the hook current.
+//
+//   new BoostIndex({ issuer, taxon, tiers })
+//     tiers [[count, boost], ...] ascending by count: a holder of at least `count`
+//     tokens gets `boost`; below the first tier, 100
+//   load(tokens)        [{ id, owner }] replaces the holdings; every holder is pending
+//   baseline(entries)   [{ account, boost }] what the hook stores now; pending if it differs
+//   apply(metas)        metadata Buffers of validated transactions, in ledger order;
+//                       returns flush()
+//   flush()             -> [{ account, count, boost }] pending holders whose boost
+//                       differs from the one last reported, now reported
+//   holder(account)     -> { count, boost }
+//   info()              -> { tokens, holders }
+//
+// id is a 32-byte NFTokenID as 64 hex digits or a Buffer; owner and account are classic
+// addresses. Tokens of other collections are ignored everywhere.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "addon.h"
+#include "sfcodes.h"
+#include "stcodec.h"
+
+#define LT_NFTOKEN_PAGE 0x0050
+#define TAXON_ANY 0xFFFFFFFFu
+#define TIERS_MAX 32
+#define BOOST_BASE 100
+#define NO_OWNER 0xFFFFFFFFu
+
+typedef struct {
+    uint8_t id[32];
+    uint32_t owner;                     // holder index, NO_OWNER when burned or unknown
+    uint32_t used;
+} token_slot;
+
+typedef struct {
+    uint8_t account[20];
+    uint32_t count;
+    uint32_t reported;                  // boost the hook was last told
+    uint32_t pending;
+} holder;
+
+typedef struct {
+    uint8_t issuer[20];
+    uint32_t taxon;
+    uint32_t tier_count[TIERS_MAX];
+    uint32_t tier_boost[TIERS_MAX];
+    size_t tiers;
+
+    token_slot* tokens;                 // open addressing on the token id
+    size_t token_cap;
+    size_t token_count;
+
+    holder* holders;
+    size_t holder_count;
+    size_t holder_alloc;
+    uint32_t* holder_slots;             // open addressing on the account, holder index + 1
+    size_t holder_cap;
+
+    uint32_t* dirty;                    // holders pending, in the order they became so
+    size_t dirty_count;
+} boost_index;
+
+static uint32_t load_u32(const uint8_t* p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+// Taxons are stored scrambled with the token sequence (rippled nft::cipheredTaxon)
+static uint32_t token_taxon(const uint8_t id[32])
+{
+    uint32_t sequence = load_u32(id + 28);
+    return load_u32(id + 24) ^ (384160001u * sequence + 2459u);
+}
+
+static int in_collection(const boost_index* b, const uint8_t id[32])
+{
+    if (memcmp(id + 4, b->issuer, 20) != 0) return 0;
+    return b->taxon == TAXON_ANY || token_taxon(id) == b->taxon;
+}
+
+static uint32_t boost_for(const boost_index* b, uint32_t count)
+{
+    uint32_t boost = BOOST_BASE;
+    for (size_t t = 0; t < b->tiers && b->tier_count[t] <= count; t++)
+        boost = b->tier_boost[t];
+    return boost;
+}
+
+// Ids and accounts are hash outputs; their leading bytes index well
+static size_t slot_of(const uint8_t* key, size_t cap)
+{
+    size_t h = 0;
+    for (int k = 0; k < 8; k++)
+        h = h << 8 | key[k];
+    return h & (cap - 1);
+}
+
+static void index_clear(boost_index* b)
+{
+    free(b->tokens);
+    free(b->holders);
+    free(b->holder_slots);
+    free(b->dirty);
+    b->tokens = NULL;
+    b->holders = NULL;
+    b->holder_slots = NULL;
+    b->dirty = NULL;
+    b->token_cap = b->token_count = 0;
+    b->holder_count = b->holder_alloc = b->holder_cap = b->dirty_count = 0;
+}
+
+// Both tables are kept at most half full
+static int grow_tokens(boost_index* b)
+{
+    size_t cap = b->token_cap ? b->token_cap * 2 : 1024;
+    token_slot* tokens = calloc(cap, sizeof(*tokens));
+    if (!tokens) return 0;
+    for (size_t i = 0; i < b->token_cap; i++) {
+        if (!b->tokens[i].used) continue;
+        size_t h = slot_of(b->tokens[i].id, cap);
+        while (tokens[h].used)
+            h = (h + 1) & (cap - 1);
+        tokens[h] = b->tokens[i];
+    }
+    free(b->tokens);
+    b->tokens = tokens;
+    b->token_cap = cap;
+    return 1;
+}
+
+static token_slot* find_token(boost_index* b, const uint8_t id[32], int create)
+{
+    if (create && 2 * (b->token_count + 1) > b->token_cap && !grow_tokens(b)) return NULL;
+    if (!b->token_cap) return NULL;
+    size_t h = slot_of(id, b->token_cap);
+    while (b->tokens[h].used) {
+        if (memcmp(b->tokens[h].id, id, 32) == 0) return &b->tokens[h];
+        h = (h + 1) & (b->token_cap - 1);
+    }
+    if (!create) return NULL;
+    memcpy(b->tokens[h].id, id, 32);
+    b->tokens[h].owner = NO_OWNER;
+    b->tokens[h].used = 1;
+    b->token_count++;
+    return &b->tokens[h];
+}
+
+static int grow_holders(boost_index* b)
+{
+    size_t cap = b->holder_cap ? b->holder_cap * 2 : 1024;
+    uint32_t* slots = calloc(cap, sizeof(*slots));
+    if (!slots) return 0;
+    for (size_t i = 0; i < b->holder_count; i++) {
+        size_t h = slot_of(b->holders[i].account, cap);
+        while (slots[h])
+            h = (h + 1) & (cap - 1);
+        slots[h] = (uint32_t)i + 1;
+    }
+    free(b->holder_slots);
+    b->holder_slots = slots;
+    b->holder_cap = cap;
+
+    holder* holders = realloc(b->holders, (cap / 2) * sizeof(*holders));
+    uint32_t* dirty = holders ? realloc(b->dirty, (cap / 2) * sizeof(*dirty)) : NULL;
+    if (holders) b->holders = holders;
+    if (dirty) b->dirty = dirty;
+    if (!holders || !dirty) return 0;
+    b->holder_alloc = cap / 2;
+    return 1;
+}
+
+// Index of the holder with `account`; NO_OWNER when absent (and not created) or out of memory
+static uint32_t find_holder(boost_index* b, const uint8_t account[20], int create)
+{
+    if (create && b->holder_count + 1 > b->holder_alloc && !grow_holders(b)) return NO_OWNER;
+    if (!b->holder_cap) return NO_OWNER;
+    size_t h = slot_of(account, b->holder_cap);
+    while (b->holder_slots[h]) {
+        uint32_t i = b->holder_slots[h] - 1;
+        if (memcmp(b->holders[i].account, account, 20) == 0) return i;
+        h = (h + 1) & (b->holder_cap - 1);
+    }
+    if (!create) return NO_OWNER;
+    uint32_t i = (uint32_t)b->holder_count++;
+    holder* o = &b->holders[i];
+    memcpy(o->account, account, 20);
+    o->count = 0;
+    o->reported = BOOST_BASE;
+    o->pending = 0;
+    b->holder_slots[h] = i + 1;
+    return i;
+}
+
+static void mark_pending(boost_index* b, uint32_t i)
+{
+    if (b->holders[i].pending) return;
+    b->holders[i].pending = 1;
+    b->dirty[b->dirty_count++] = i;
+}
+
+// A token leaves `account`; ignored when the index has it elsewhere
+static void token_left(boost_index* b, const uint8_t id[32], const uint8_t account[20])
+{
+    token_slot* t = find_token(b, id, 0);
+    if (!t || t->owner == NO_OWNER) return;
+    holder* o = &b->holders[t->owner];
+    if (memcmp(o->account, account, 20) != 0) return;
+    o->count--;
+    mark_pending(b, t->owner);
+    t->owner = NO_OWNER;
+}
+
+// A token joins `account`; 0 when memory ran out
+static int token_joined(boost_index* b, const uint8_t id[32], const uint8_t account[20])
+{
+    token_slot* t = find_token(b, id, 1);
+    if (!t) return 0;
+    uint32_t i = find_holder(b, account, 1);
+    if (i == NO_OWNER) return 0;
+    if (t->owner == i) return 1;
+    if (t->owner != NO_OWNER) {
+        b->holders[t->owner].count--;
+        mark_pending(b, t->owner);
+    }
+    t->owner = i;
+    b->holders[i].count++;
+    mark_pending(b, i);
+    return 1;
+}
+
+// The NFTokens array of an object field, if it has one
+static int page_tokens(const st_field* object, st_field* tokens)
+{
+    return st_find(object->data, object->len, sfNFTokens, tokens) == ST_OK;
+}
+
+typedef struct {
+    uint8_t owner[20];
+    st_field before;
+    st_field after;
+    int has_before;
+    int has_after;
+} page_change;
+
+// NFTokens of one affected NFTokenPage before and after; 0 when the node is another
+// entry type or its tokens did not change, -1 when it is malformed
+static int read_page(const st_field* node, page_change* c)
+{
+    st_reader r;
+    st_field f, fields = { 0 }, previous = { 0 };
+    uint16_t entry_type = 0;
+    int has_fields = 0, has_previous = 0, has_index = 0, status;
+
+    memset(c, 0, sizeof(*c));
+    st_enter(&r, node);
+    while ((status = st_next(&r, &f)) == ST_OK) {
+        if (f.code == sfLedgerEntryType && f.len == 2) {
+            entry_type = (uint16_t)(f.data[0] << 8 | f.data[1]);
+        } else if (f.code == sfLedgerIndex && f.len == 32) {
+            memcpy(c->owner, f.data, 20);
+            has_index = 1;
+        } else if (f.code == sfFinalFields || f.code == sfNewFields) {
+            fields = f;
+            has_fields = 1;
+        } else if (f.code == sfPreviousFields) {
+            previous = f;
+            has_previous = 1;
+        }
+    }
+    if (status == ST_ERROR) return -1;
+    if (entry_type != LT_NFTOKEN_PAGE) return 0;
+    if (!has_index) return -1;
+
+    if (node->code == sfCreatedNode) {
+        c->has_after = has_fields && page_tokens(&fields, &c->after);
+    } else if (node->code == sfDeletedNode) {
+        c->has_before = (has_previous && page_tokens(&previous, &c->before)) ||
+                        (has_fields && page_tokens(&fields, &c->before));
+    } else {
+        // A page whose NFTokens did not change has no NFTokens in PreviousFields
+        if (!has_previous || !page_tokens(&previous, &c->before)) return 0;
+        c->has_before = 1;
+        c->has_after = has_fields && page_tokens(&fields, &c->after);
+    }
+    return c->has_before || c->has_after;
+}
+
+// Calls `fn` on each NFTokenID of an NFTokens array in the collection; 0 on a
+// malformed array or when `fn` fails
+static int each_token(boost_index* b, const st_field* tokens, const uint8_t owner[20],
+                      int (*fn)(boost_index*, const uint8_t*, const uint8_t*))
+{
+    st_reader r;
+    st_field token, id;
+    int status;
+    st_enter(&r, tokens);
+    while ((status = st_next(&r, &token)) == ST_OK) {
+        if (token.code != sfNFToken) continue;
+        if (st_find(token.data, token.len, sfNFTokenID, &id) != ST_OK || id.len != 32) return 0;
+        if (in_collection(b, id.data) && !fn(b, id.data, owner)) return 0;
+    }
+    return status != ST_ERROR;
+}
+
+static int left_fn(boost_index* b, const uint8_t* id, const uint8_t* owner)
+{
+    token_left(b, id, owner);
+    return 1;
+}
+
+// Applies one transaction's metadata. Every removal goes before any addition, so a
+// token moving between two pages of the same owner stays with that owner.
+static const char* apply_meta(boost_index* b, const uint8_t* meta, size_t len)
+{
+    st_field nodes, node;
+    st_reader r;
+    int status = st_find(meta, len, sfAffectedNodes, &nodes);
+    if (status == ST_ERROR) return "malformed metadata";
+    if (status == ST_END) return NULL;
+
+    for (int pass = 0; pass < 2; pass++) {
+        st_enter(&r, &nodes);
+        while ((status = st_next(&r, &node)) == ST_OK) {
+            page_change c;
+            int changed = read_page(&node, &c);
+            if (changed < 0) return "malformed metadata";
+            if (!changed) continue;
+            if (pass == 0 && c.has_before && !each_token(b, &c.before, c.owner, left_fn))
+                return "malformed metadata";
+            if (pass == 1 && c.has_after && !each_token(b, &c.after, c.owner, token_joined))
+                return "malformed metadata or out of memory";
+        }
+        if (status == ST_ERROR) return "malformed metadata";
+    }
+    return NULL;
+}
+
+static void index_finalize(napi_env env, void* data, void* hint)
+{
+    (void)env;
+    (void)hint;
+    index_clear(data);
+    free(data);
+}
+
+static boost_index* get_this(napi_env env, napi_callback_info info, size_t* argc, napi_value* argv)
+{
+    napi_value self;
+    boost_index* b = NULL;
+    if (napi_get_cb_info(env, info, argc, argv, &self, NULL) != napi_ok ||
+        napi_unwrap(env, self, (void**)&b) != napi_ok) {
+        napi_throw_type_error(env, NULL, "not a BoostIndex");
+        return NULL;
+    }
+    return b;
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int get_token_id(napi_env env, napi_value value, uint8_t id[32])
+{
+    napi_valuetype type;
+    if (napi_typeof(env, value, &type) == napi_ok && type == napi_string) {
+        char s[72];
+        size_t len;
+        if (napi_get_value_string_latin1(env, value, s, sizeof(s), &len) == napi_ok && len == 64) {
+            int ok = 1;
+            for (size_t i = 0; i < 32 && ok; i++) {
+                int hi = hex_value(s[2 * i]), lo = hex_value(s[2 * i + 1]);
+                ok = hi >= 0 && lo >= 0;
+                id[i] = (uint8_t)(hi << 4 | lo);
+            }
+            if (ok) return 1;
+        }
+    } else {
+        const uint8_t* data;
+        size_t len;
+        if (!addon_get_bytes(env, value, &data, &len)) return 0;
+        if (len == 32) {
+            memcpy(id, data, 32);
+            return 1;
+        }
+    }
+    napi_throw_type_error(env, NULL, "token id must be 64 hex digits or 32 bytes");
+    return 0;
+}
+
+// A classic address; `what` names it in the error thrown otherwise
+static int get_address(napi_env env, napi_value v, const char* what, uint8_t id[20])
+{
+    char s[64];
+    size_t len;
+    if (napi_get_value_string_latin1(env, v, s, sizeof(s), &len) != napi_ok ||
+        !accounts_decode(env, id, s, len)) {
+        char message[64];
+        snprintf(message, sizeof(message), "%s must be a classic address", what);
+        napi_throw_type_error(env, NULL, message);
+        return 0;
+    }
+    return 1;
+}
+
+static int get_u32(napi_env env, napi_value v, uint32_t* out)
+{
+    napi_valuetype type;
+    double d;
+    if (napi_typeof(env, v, &type) != napi_ok || type != napi_number) return 0;
+    if (napi_get_value_double(env, v, &d) != napi_ok) return 0;
+    if (d < 0 || d > 4294967295.0 || d != (double)(uint32_t)d) return 0;
+    *out = (uint32_t)d;
+    return 1;
+}
+
+static int read_tiers(napi_env env, napi_value tiers, boost_index* b)
+{
+    bool is_array = false;
+    uint32_t n = 0;
+    if (napi_is_array(env, tiers, &is_array) != napi_ok || !is_array ||
+        napi_get_array_length(env, tiers, &n) != napi_ok || n == 0 || n > TIERS_MAX) {
+        napi_throw_type_error(env, NULL, "tiers must be 1 to 32 [count, boost] pairs");
+        return 0;
+    }
+    for (uint32_t t = 0; t < n; t++) {
+        napi_value pair, count, boost;
+        if (napi_get_element(env, tiers, t, &pair) != napi_ok ||
+            napi_get_element(env, pair, 0, &count) != napi_ok ||
+            napi_get_element(env, pair, 1, &boost) != napi_ok ||
+            !get_u32(env, count, &b->tier_count[t]) || !get_u32(env, boost, &b->tier_boost[t]) ||
+            b->tier_count[t] == 0 || (t > 0 && b->tier_count[t] <= b->tier_count[t - 1])) {
+            napi_throw_range_error(env, NULL, "tiers must be [count, boost] with counts ascending from 1");
+            return 0;
+        }
+    }
+    b->tiers = n;
+    return 1;
+}
+
+static napi_value index_new(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1], self, v;
+    napi_valuetype type = napi_undefined;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, &self, NULL));
+    if (argc < 1 || napi_typeof(env, argv[0], &type) != napi_ok || type != napi_object) {
+        napi_throw_type_error(env, NULL, "new BoostIndex({ issuer, taxon, tiers })");
+        return NULL;
+    }
+
+    boost_index* b = calloc(1, sizeof(boost_index));
+    if (!b) {
+        napi_throw_error(env, NULL, "out of memory");
+        return NULL;
+    }
+    b->taxon = TAXON_ANY;
+    int ok = napi_get_named_property(env, argv[0], "issuer", &v) == napi_ok &&
+             get_address(env, v, "issuer", b->issuer);
+    if (ok && napi_get_named_property(env, argv[0], "taxon", &v) == napi_ok &&
+        napi_typeof(env, v, &type) == napi_ok && type != napi_undefined && !get_u32(env, v, &b->taxon)) {
+        napi_throw_type_error(env, NULL, "taxon must be a u32");
+        ok = 0;
+    }
+    ok = ok && napi_get_named_property(env, argv[0], "tiers", &v) == napi_ok && read_tiers(env, v, b);
+    if (ok && napi_wrap(env, self, b, index_finalize, NULL, NULL) != napi_ok) {
+        napi_throw_error(env, NULL, "N-API call failed: napi_wrap");
+        ok = 0;
+    }
+    if (!ok) {
+        free(b);
+        return NULL;
+    }
+    return self;
+}
+
+static napi_value holder_object(napi_env env, const holder* o, uint32_t boost)
+{
+    napi_value obj, v;
+    if (napi_create_object(env, &obj) != napi_ok) return NULL;
+    if (!(v = addon_account(env, o->account))) return NULL;
+    if (napi_set_named_property(env, obj, "account", v) != napi_ok) return NULL;
+    if (addon_set_u32(env, obj, "count", o->count) != napi_ok) return NULL;
+    if (addon_set_u32(env, obj, "boost", boost) != napi_ok) return NULL;
+    return obj;
+}
+
+static napi_value flush_pending(napi_env env, boost_index* b)
+{
+    napi_value out;
+    uint32_t n = 0;
+    NAPI_CALL(env, napi_create_array(env, &out));
+    for (size_t d = 0; d < b->dirty_count; d++) {
+        holder* o = &b->holders[b->dirty[d]];
+        uint32_t boost = boost_for(b, o->count);
+        o->pending = 0;
+        if (boost == o->reported) continue;
+        o->reported = boost;
+        napi_value obj = holder_object(env, o, boost);
+        if (!obj || napi_set_element(env, out, n++, obj) != napi_ok) {
+            // The rest stay pending for the next flush
+            b->dirty_count -= d + 1;
+            memmove(b->dirty, b->dirty + d + 1, b->dirty_count * sizeof(*b->dirty));
+            napi_throw_error(env, NULL, "N-API call failed: flush");
+            return NULL;
+        }
+    }
+    b->dirty_count = 0;
+    return out;
+}
+
+static napi_value index_load(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1] = { NULL }, result;
+    bool is_array = false;
+    boost_index* b = get_this(env, info, &argc, argv);
+    if (!b) return NULL;
+    if (argc < 1 || napi_is_array(env, argv[0], &is_array) != napi_ok || !is_array) {
+        napi_throw_type_error(env, NULL, "load(tokens)");
+        return NULL;
+    }
+
+    // Boosts already reported survive the reload
+    boost_index fresh = *b;
+    fresh.tokens = NULL;
+    fresh.holders = NULL;
+    fresh.holder_slots = NULL;
+    fresh.dirty = NULL;
+    fresh.token_cap = fresh.token_count = 0;
+    fresh.holder_count = fresh.holder_alloc = fresh.holder_cap = fresh.dirty_count = 0;
+    for (size_t i = 0; i < b->holder_count; i++) {
+        uint32_t h = find_holder(&fresh, b->holders[i].account, 1);
+        if (h == NO_OWNER) {
+            index_clear(&fresh);
+            napi_throw_error(env, NULL, "out of memory");
+            return NULL;
+        }
+        fresh.holders[h].reported = b->holders[i].reported;
+        mark_pending(&fresh, h);
+    }
+
+    uint32_t n;
+    NAPI_CALL(env, napi_get_array_length(env, argv[0], &n));
+    for (uint32_t i = 0; i < n; i++) {
+        napi_value entry, id_v, owner_v;
+        uint8_t id[32], owner[20];
+        if (napi_get_element(env, argv[0], i, &entry) != napi_ok ||
+            napi_get_named_property(env, entry, "id", &id_v) != napi_ok ||
+            napi_get_named_property(env, entry, "owner", &owner_v) != napi_ok ||
+            !get_token_id(env, id_v, id) || !get_address(env, owner_v, "owner", owner)) {
+            index_clear(&fresh);
+            return NULL;
+        }
+        if (!in_collection(&fresh, id)) continue;
+        if (!token_joined(&fresh, id, owner)) {
+            index_clear(&fresh);
+            napi_throw_error(env, NULL, "out of memory");
+            return NULL;
+        }
+    }
+    index_clear(b);
+    *b = fresh;
+    NAPI_CALL(env, napi_get_undefined(env, &result));
+    return result;
+}
+
+static napi_value index_baseline(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1] = { NULL }, result;
+    bool is_array = false;
+    boost_index* b = get_this(env, info, &argc, argv);
+    if (!b) return NULL;
+    if (argc < 1 || napi_is_array(env, argv[0], &is_array) != napi_ok || !is_array) {
+        napi_throw_type_error(env, NULL, "baseline(entries)");
+        return NULL;
+    }
+
+    uint32_t n;
+    NAPI_CALL(env, napi_get_array_length(env, argv[0], &n));
+    for (uint32_t i = 0; i < n; i++) {
+        napi_value entry, v;
+        uint8_t account[20];
+        uint32_t boost;
+        if (napi_get_element(env, argv[0], i, &entry) != napi_ok ||
+            napi_get_named_property(env, entry, "account", &v) != napi_ok ||
+            !get_address(env, v, "account", account)) return NULL;
+        if (napi_get_named_property(env, entry, "boost", &v) != napi_ok || !get_u32(env, v, &boost)) {
+            napi_throw_type_error(env, NULL, "boost must be a u32");
+            return NULL;
+        }
+        uint32_t h = find_holder(b, account, 1);
+        if (h == NO_OWNER) {
+            napi_throw_error(env, NULL, "out of memory");
+            return NULL;
+        }
+        // A stored 0 is what the hook has before any BOOST: 1x
+        b->holders[h].reported = boost ? boost : BOOST_BASE;
+        mark_pending(b, h);
+    }
+    NAPI_CALL(env, napi_get_undefined(env, &result));
+    return result;
+}
+
+static napi_value index_apply(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1] = { NULL };
+    bool is_array = false;
+    boost_index* b = get_this(env, info, &argc, argv);
+    if (!b) return NULL;
+    if (argc < 1 || napi_is_array(env, argv[0], &is_array) != napi_ok || !is_array) {
+        napi_throw_type_error(env, NULL, "apply(metas)");
+        return NULL;
+    }
+
+    uint32_t n;
+    NAPI_CALL(env, napi_get_array_length(env, argv[0], &n));
+    for (uint32_t i = 0; i < n; i++) {
+        napi_value v;
+        const uint8_t* meta;
+        size_t len;
+        NAPI_CALL(env, napi_get_element(env, argv[0], i, &v));
+        if (!addon_get_bytes(env, v, &meta, &len)) return NULL;
+        // Metadata before the failing one stays applied; its holders stay pending
+        const char* error = apply_meta(b, meta, len);
+        if (error) {
+            napi_throw_range_error(env, NULL, error);
+            return NULL;
+        }
+    }
+    return flush_pending(env, b);
+}
+
+static napi_value index_flush(napi_env env, napi_callback_info info)
+{
+    size_t argc = 0;
+    boost_index* b = get_this(env, info, &argc, NULL);
+    if (!b) return NULL;
+    return flush_pending(env, b);
+}
+
+static napi_value index_holder(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1] = { NULL }, result;
+    boost_index* b = get_this(env, info, &argc, argv);
+    uint8_t account[20];
+    if (!b) return NULL;
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "holder(account)");
+        return NULL;
+    }
+    if (!get_address(env, argv[0], "account", account)) return NULL;
+
+    uint32_t h = find_holder(b, account, 0);
+    uint32_t count = h == NO_OWNER ? 0 : b->holders[h].count;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    NAPI_CALL(env, addon_set_u32(env, result, "count", count));
+    NAPI_CALL(env, addon_set_u32(env, result, "boost", boost_for(b, count)));
+    return result;
+}
+
+static napi_value index_info(napi_env env, napi_callback_info info)
+{
+    size_t argc = 0;
+    napi_value result;
+    boost_index* b = get_this(env, info, &argc, NULL);
+    if (!b) return NULL;
+
+    uint32_t tokens = 0, holders = 0;
+    for (size_t i = 0; i < b->token_cap; i++)
+        tokens += b->tokens[i].used && b->tokens[i].owner != NO_OWNER;
+    for (size_t i = 0; i < b->holder_count; i++)
+        holders += b->holders[i].count > 0;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    NAPI_CALL(env, addon_set_u32(env, result, "tokens", tokens));
+    NAPI_CALL(env, addon_set_u32(env, result, "holders", holders));
+    return result;
+}
+
+napi_value boosts_init(napi_env env, napi_value exports)
+{
+    napi_property_descriptor methods[] = {
+        { "load", NULL, index_load, NULL, NULL, NULL, napi_default, NULL },
+        { "baseline", NULL, index_baseline, NULL, NULL, NULL, napi_default, NULL },
+        { "apply", NULL, index_apply, NULL, NULL, NULL, napi_default, NULL },
+        { "flush", NULL, index_flush, NULL, NULL, NULL, napi_default, NULL },
+        { "holder", NULL, index_holder, NULL, NULL, NULL, napi_default, NULL },
+        { "info", NULL, index_info, NULL, NULL, NULL, napi_default, NULL }
+    };
+    napi_value cls;
+    NAPI_CALL(env, napi_define_class(env, "BoostIndex", NAPI_AUTO_LENGTH, index_new, NULL,
+                                     sizeof(methods) / sizeof(methods[0]), methods, &cls));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "BoostIndex", cls));
+    return exports;
+}
@@ -0,0 +1,719 @@
+// Binary codec binding: XRPL transactions and ledger objects to JSON and back
+//
+// Field names and codes come from hooks/carbon/sfcodes.h (stcodec.c); the JSON shapes are
+// the ones xrpl.js decode() produces, so the results can stand in for it:
+//   UInt8/16/32  number (TransactionType by name)
+//   UInt64       16 hex digits
+//   Hash*, Blob  upper-case hex
+//   AccountID    classic address
+//   Amount       drops as a decimal string, or { currency, issuer, value }
+//   STObject     object; STArray: [{ FieldName: value }]
+//   Vector256    array of hex; PathSet: [[{ account, currency, issuer }]]
+//
+//   decodeTx(buf)                       -> object
+//   readField(buf, name)                -> the value of one top-level field, or undefined;
+//                                          skips the rest without decoding it
+//   encodeTx(obj, { signing })          -> Buffer; signing prefixes STX\0 and leaves out
+//                                          the signature fields
+//   xflToString(xfl) / xflFromString(s) -> hook float (BigInt) and decimal string
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "addon.h"
+#include "base58.h"
+#include "stcodec.h"
+
+#define MAX_DEPTH 32
+#define STRING_STACK 128
+
+static const uint8_t SIGNING_PREFIX[4] = { 0x53, 0x54, 0x58, 0x00 };
+
+static const char HEX[] = "0123456789ABCDEF";
+
+static napi_value make_string(napi_env env, const char* s, size_t len)
+{
+    napi_value v;
+    return napi_create_string_latin1(env, s, len, &v) == napi_ok ? v : NULL;
+}
+
+static napi_value make_hex(napi_env env, const uint8_t* data, size_t len)
+{
+    char stack[2 * STRING_STACK];
+    char* hex = len <= STRING_STACK ? stack : malloc(2 * len);
+    napi_value s;
+    if (!len) return make_string(env, "", 0);
+    if (!hex) {
+        napi_throw_error(env, NULL, "out of memory");
+        return NULL;
+    }
+    for (size_t i = 0; i < len; i++) {
+        hex[2 * i] = HEX[data[i] >> 4];
+        hex[2 * i + 1] = HEX[data[i] & 0x0F];
+    }
+    napi_status status = napi_create_string_latin1(env, hex, 2 * len, &s);
+    if (hex != stack) free(hex);
+    return status == napi_ok ? s : NULL;
+}
+
+static int throw_malformed(napi_env env)
+{
+    napi_throw_range_error(env, NULL, "malformed serialized object");
+    return 0;
+}
+
+static napi_value decode_fields(napi_env env, st_reader* r, int depth);
+
+static napi_value decode_amount(napi_env env, const uint8_t* a)
+{
+    char text[ST_XFL_STRING_MAX];
+    if (st_amount_is_native(a)) {
+        int n = snprintf(text, sizeof(text), "%s%llu", st_amount_negative(a) ? "-" : "",
+                         (unsigned long long)st_amount_drops(a));
+        return make_string(env, text, (size_t)n);
+    }
+
+    napi_value obj, v;
+    char currency[41];
+    if (napi_create_object(env, &obj) != napi_ok) return NULL;
+    if (!(v = make_string(env, currency, st_currency_to_string(currency, a + 8)))) return NULL;
+    if (napi_set_named_property(env, obj, "currency", v) != napi_ok) return NULL;
+    if (!(v = addon_account(env, a + 28))) return NULL;
+    if (napi_set_named_property(env, obj, "issuer", v) != napi_ok) return NULL;
+    if (!(v = make_string(env, text, st_xfl_to_string(text, st_amount_xfl(a))))) return NULL;
+    if (napi_set_named_property(env, obj, "value", v) != napi_ok) return NULL;
+    return obj;
+}
+
+static napi_value decode_pathset(napi_env env, const uint8_t* p, size_t len)
+{
+    const uint8_t* end = p + len;
+    napi_value paths, path;
+    uint32_t path_count = 0, step_count = 0;
+    if (napi_create_array(env, &paths) != napi_ok) return NULL;
+    if (napi_create_array(env, &path) != napi_ok) return NULL;
+
+    while (p < end) {
+        uint8_t t = *p++;
+        if (t == 0x00 || t == 0xFF) {
+            if (napi_set_element(env, paths, path_count++, path) != napi_ok) return NULL;
+            if (t == 0x00) break;
+            if (napi_create_array(env, &path) != napi_ok) return NULL;
+            step_count = 0;
+            continue;
+        }
+        napi_value step, v;
+        char currency[41];
+        if (napi_create_object(env, &step) != napi_ok) return NULL;
+        if (t & 0x01) {
+            if (!(v = addon_account(env, p))) return NULL;
+            if (napi_set_named_property(env, step, "account", v) != napi_ok) return NULL;
+            p += 20;
+        }
+        if (t & 0x10) {
+            if (!(v = make_string(env, currency, st_currency_to_string(currency, p)))) return NULL;
+            if (napi_set_named_property(env, step, "currency", v) != napi_ok) return NULL;
+            p += 20;
+        }
+        if (t & 0x20) {
+            if (!(v = addon_account(env, p))) return NULL;
+            if (napi_set_named_property(env, step, "issuer", v) != napi_ok) return NULL;
+            p += 20;
+        }
+        if (napi_set_element(env, path, step_count++, step) != napi_ok) return NULL;
+    }
+    return paths;
+}
+
+static napi_value decode_value(napi_env env, const st_field* f, int depth)
+{
+    napi_value v;
+    st_reader inner;
+    uint64_t u = 0;
+
+    switch (ST_TYPE(f->code)) {
+    case ST_UINT8:
+    case ST_UINT16:
+    case ST_UINT32:
+        for (size_t i = 0; i < f->len; i++)
+            u = u << 8 | f->data[i];
+        if (f->code == ST_CODE(ST_UINT16, 2)) {
+            const char* name = st_tx_type_name((uint16_t)u);
+            if (name) return make_string(env, name, strlen(name));
+        }
+        return napi_create_uint32(env, (uint32_t)u, &v) == napi_ok ? v : NULL;
+    case ST_UINT64:
+    case ST_HASH128:
+    case ST_HASH160_SF:
+    case ST_HASH160:
+    case ST_HASH256:
+    case ST_VL:
+        return make_hex(env, f->data, f->len);
+    case ST_ACCOUNT:
+        return f->len == 20 ? addon_account(env, f->data) : make_hex(env, f->data, f->len);
+    case ST_AMOUNT:
+        return decode_amount(env, f->data);
+    case ST_OBJECT:
+        st_enter(&inner, f);
+        return decode_fields(env, &inner, depth + 1);
+    case ST_ARRAY: {
+        st_field element;
+        uint32_t i = 0;
+        int status;
+        if (napi_create_array(env, &v) != napi_ok) return NULL;
+        st_enter(&inner, f);
+        while ((status = st_next(&inner, &element)) == ST_OK) {
+            napi_value wrapper, value;
+            const st_field_def* def = st_field_by_code(element.code);
+            if (!def) {
+                throw_malformed(env);
+                return NULL;
+            }
+            if (!(value = decode_value(env, &element, depth + 1))) return NULL;
+            if (napi_create_object(env, &wrapper) != napi_ok) return NULL;
+            if (napi_set_named_property(env, wrapper, def->name, value) != napi_ok) return NULL;
+            if (napi_set_element(env, v, i++, wrapper) != napi_ok) return NULL;
+        }
+        if (status == ST_ERROR) {
+            throw_malformed(env);
+            return NULL;
+        }
+        return v;
+    }
+    case ST_VECTOR256:
+        if (f->len % 32 != 0) {
+            throw_malformed(env);
+            return NULL;
+        }
+        if (napi_create_array_with_length(env, f->len / 32, &v) != napi_ok) return NULL;
+        for (size_t i = 0; i < f->len / 32; i++) {
+            napi_value h = make_hex(env, f->data + 32 * i, 32);
+            if (!h || napi_set_element(env, v, (uint32_t)i, h) != napi_ok) return NULL;
+        }
+        return v;
+    case ST_PATHSET:
+        return decode_pathset(env, f->data, f->len);
+    }
+    throw_malformed(env);
+    return NULL;
+}
+
+static napi_value decode_fields(napi_env env, st_reader* r, int depth)
+{
+    napi_value obj;
+    st_field f;
+    int status;
+    if (depth > MAX_DEPTH) {
+        throw_malformed(env);
+        return NULL;
+    }
+    if (napi_create_object(env, &obj) != napi_ok) return NULL;
+
+    while ((status = st_next(r, &f)) == ST_OK) {
+        napi_value value = decode_value(env, &f, depth);
+        if (!value) return NULL;
+
+        const st_field_def* def = st_field_by_code(f.code);
+        char unknown[16];
+        const char* name = def ? def->name : unknown;
+        if (!def) snprintf(unknown, sizeof(unknown), "%u:%u", ST_TYPE(f.code), ST_NTH(f.code));
+        if (napi_set_named_property(env, obj, name, value) != napi_ok) return NULL;
+    }
+    if (status == ST_ERROR) {
+        throw_malformed(env);
+        return NULL;
+    }
+    return obj;
+}
+
+static napi_value decode_tx(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "decodeTx(buffer)");
+        return NULL;
+    }
+
+    const uint8_t* data;
+    size_t len;
+    st_reader r;
+    if (!addon_get_bytes(env, argv[0], &data, &len)) return NULL;
+    st_reader_init(&r, data, len);
+    napi_value obj = decode_fields(env, &r, 0);
+    if (obj && r.p != r.end) {
+        throw_malformed(env);
+        return NULL;
+    }
+    return obj;
+}
+
+// String argument in `stack` when it fits, else malloc'ed; the caller frees when != stack
+static char* get_string(napi_env env, napi_value value, char* stack, size_t stack_size, size_t* len)
+{
+    if (napi_get_value_string_utf8(env, value, NULL, 0, len) != napi_ok) return NULL;
+    char* s = *len < stack_size ? stack : malloc(*len + 1);
+    if (!s) return NULL;
+    if (napi_get_value_string_utf8(env, value, s, *len + 1, len) != napi_ok) {
+        if (s != stack) free(s);
+        return NULL;
+    }
+    return s;
+}
+
+static napi_value read_field(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value argv[2];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 2) {
+        napi_throw_type_error(env, NULL, "readField(buffer, name)");
+        return NULL;
+    }
+
+    const uint8_t* data;
+    size_t len, name_len;
+    char name[64];
+    if (!addon_get_bytes(env, argv[0], &data, &len)) return NULL;
+    if (napi_get_value_string_utf8(env, argv[1], name, sizeof(name), &name_len) != napi_ok) {
+        napi_throw_type_error(env, NULL, "field name must be a string");
+        return NULL;
+    }
+    const st_field_def* def = st_field_by_name(name, name_len);
+    if (!def) {
+        napi_throw_range_error(env, NULL, "unknown field name");
+        return NULL;
+    }
+
+    st_field f;
+    napi_value result;
+    int status = st_find(data, len, def->code, &f);
+    if (status == ST_ERROR) {
+        throw_malformed(env);
+        return NULL;
+    }
+    if (status == ST_END) {
+        NAPI_CALL(env, napi_get_undefined(env, &result));
+        return result;
+    }
+    return decode_value(env, &f, 0);
+}
+
+static int throw_field(napi_env env, const char* field, const char* problem)
+{
+    char message[128];
+    snprintf(message, sizeof(message), "%s: %s", field, problem);
+    napi_throw_type_error(env, NULL, message);
+    return 0;
+}
+
+enum { HEX_FIELD, HEX_VL, HEX_RAW };
+
+// Hex string of exactly `expect` bytes (any length when expect is 0) appended to w as a
+// fixed-size field, a length-prefixed field or bare bytes
+static int put_hex(napi_env env, st_writer* w, uint32_t code, napi_value value, size_t expect,
+                   int mode, const char* field)
+{
+    char stack[STRING_STACK];
+    size_t len;
+    char* s = get_string(env, value, stack, sizeof(stack), &len);
+    if (!s) return throw_field(env, field, "expected a hex string");
+
+    int ok = len % 2 == 0 && (!expect || len == 2 * expect);
+    uint8_t small[STRING_STACK / 2];
+    uint8_t* bytes = len / 2 <= sizeof(small) ? small : malloc(len / 2 + 1);
+    for (size_t i = 0; ok && bytes && i < len / 2; i++) {
+        char hi = s[2 * i], lo = s[2 * i + 1];
+        int h = hi <= '9' ? hi - '0' : (hi | 0x20) - 'a' + 10;
+        int l = lo <= '9' ? lo - '0' : (lo | 0x20) - 'a' + 10;
+        if (h < 0 || h > 15 || l < 0 || l > 15) ok = 0;
+        else bytes[i] = (uint8_t)(h << 4 | l);
+    }
+    if (ok && bytes) {
+        if (mode == HEX_VL) st_put_vl(w, code, bytes, len / 2);
+        else if (mode == HEX_FIELD) st_put_bytes(w, code, bytes, len / 2);
+        else st_put_raw(w, bytes, len / 2);
+    }
+    if (bytes != small) free(bytes);
+    if (s != stack) free(s);
+    if (!bytes) {
+        napi_throw_error(env, NULL, "out of memory");
+        return 0;
+    }
+    return ok ? 1 : throw_field(env, field, expect ? "expected a hex string of the field's size"
+                                                   : "expected a hex string");
+}
+
+static int get_account(napi_env env, napi_value value, uint8_t id[20], const char* field)
+{
+    char s[64];
+    size_t len;
+    if (napi_get_value_string_utf8(env, value, s, sizeof(s), &len) != napi_ok ||
+        !accounts_decode(env, id, s, len))
+        return throw_field(env, field, "expected a classic address");
+    return 1;
+}
+
+static int get_named(napi_env env, napi_value obj, const char* key, napi_value* out)
+{
+    bool has = false;
+    return napi_has_named_property(env, obj, key, &has) == napi_ok && has &&
+           napi_get_named_property(env, obj, key, out) == napi_ok;
+}
+
+static int get_currency(napi_env env, napi_value value, uint8_t currency[20], const char* field)
+{
+    char s[48];
+    size_t len;
+    if (napi_get_value_string_utf8(env, value, s, sizeof(s), &len) != napi_ok ||
+        !st_currency_from_string(currency, s, len))
+        return throw_field(env, field, "expected a currency code");
+    return 1;
+}
+
+static int put_amount(napi_env env, st_writer* w, uint32_t code, napi_value value, const char* field)
+{
+    napi_valuetype type;
+    napi_typeof(env, value, &type);
+
+    if (type == napi_string) {
+        char s[32];
+        size_t len;
+        char* end;
+        if (napi_get_value_string_utf8(env, value, s, sizeof(s), &len) != napi_ok || len == 0 ||
+            len > 18 || s[0] < '0' || s[0] > '9')
+            return throw_field(env, field, "expected drops as an integer string");
+        unsigned long long drops = strtoull(s, &end, 10);
+        if (*end) return throw_field(env, field, "expected drops as an integer string");
+        st_put_drops(w, code, drops);
+        return 1;
+    }
+    if (type != napi_object) return throw_field(env, field, "expected drops or { currency, issuer, value }");
+
+    napi_value currency_v, issuer_v, value_v;
+    uint8_t currency[20], issuer[20];
+    char s[64];
+    size_t len;
+    int64_t xfl;
+    if (!get_named(env, value, "currency", &currency_v) || !get_named(env, value, "issuer", &issuer_v) ||
+        !get_named(env, value, "value", &value_v))
+        return throw_field(env, field, "expected { currency, issuer, value }");
+    if (!get_currency(env, currency_v, currency, field)) return 0;
+    if (!get_account(env, issuer_v, issuer, field)) return 0;
+    if (napi_get_value_string_utf8(env, value_v, s, sizeof(s), &len) != napi_ok ||
+        !st_xfl_from_string(s, len, &xfl))
+        return throw_field(env, field, "value must be a decimal string of at most 16 digits");
+    st_put_iou(w, code, xfl, currency, issuer);
+    return 1;
+}
+
+static int put_uint(napi_env env, st_writer* w, uint32_t code, napi_value value, const char* field)
+{
+    napi_valuetype type;
+    napi_typeof(env, value, &type);
+    uint64_t v = 0;
+
+    if (code == ST_CODE(ST_UINT16, 2) && type == napi_string) {
+        char s[48];
+        size_t len;
+        napi_get_value_string_utf8(env, value, s, sizeof(s), &len);
+        int tt = st_tx_type_code(s, len);
+        if (tt < 0) return throw_field(env, field, "unknown transaction type");
+        v = (uint64_t)tt;
+    } else if (type == napi_number) {
+        double d;
+        napi_get_value_double(env, value, &d);
+        if (d < 0 || d > 9007199254740991.0 || d != (double)(uint64_t)d)
+            return throw_field(env, field, "expected a non-negative integer");
+        v = (uint64_t)d;
+    } else if (type == napi_bigint) {
+        bool lossless;
+        napi_get_value_bigint_uint64(env, value, &v, &lossless);
+        if (!lossless) return throw_field(env, field, "out of range");
+    } else if (type == napi_string && ST_TYPE(code) == ST_UINT64) {
+        char s[24];
+        size_t len;
+        char* end;
+        napi_get_value_string_utf8(env, value, s, sizeof(s), &len);
+        v = strtoull(s, &end, 16);
+        if (len == 0 || len > 16 || *end) return throw_field(env, field, "expected up to 16 hex digits");
+    } else {
+        return throw_field(env, field, "expected an integer");
+    }
+
+    st_put_uint(w, code, v);
+    if (w->failed) return throw_field(env, field, "out of range");
+    return 1;
+}
+
+static int put_pathset(napi_env env, st_writer* w, uint32_t code, napi_value value, const char* field)
+{
+    uint32_t paths = 0;
+    if (napi_get_array_length(env, value, &paths) != napi_ok)
+        return throw_field(env, field, "expected an array of paths");
+    st_put_header(w, code);
+
+    for (uint32_t i = 0; i < paths; i++) {
+        napi_value path;
+        uint32_t steps = 0;
+        uint8_t sep = 0xFF;
+        if (i) st_put_raw(w, &sep, 1);
+        napi_get_element(env, value, i, &path);
+        if (napi_get_array_length(env, path, &steps) != napi_ok)
+            return throw_field(env, field, "expected an array of paths");
+        for (uint32_t j = 0; j < steps; j++) {
+            napi_value step, v;
+            uint8_t account[20], currency[20], issuer[20], t = 0;
+            napi_get_element(env, path, j, &step);
+            if (get_named(env, step, "account", &v)) {
+                if (!get_account(env, v, account, field)) return 0;
+                t |= 0x01;
+            }
+            if (get_named(env, step, "currency", &v)) {
+                if (!get_currency(env, v, currency, field)) return 0;
+                t |= 0x10;
+            }
+            if (get_named(env, step, "issuer", &v)) {
+                if (!get_account(env, v, issuer, field)) return 0;
+                t |= 0x20;
+            }
+            st_put_raw(w, &t, 1);
+            if (t & 0x01) st_put_raw(w, account, 20);
+            if (t & 0x10) st_put_raw(w, currency, 20);
+            if (t & 0x20) st_put_raw(w, issuer, 20);
+        }
+    }
+    uint8_t end = 0x00;
+    st_put_raw(w, &end, 1);
+    return 1;
+}
+
+static int encode_object(napi_env env, napi_value obj, st_writer* w, int signing, int depth);
+
+static int put_field(napi_env env, st_writer* w, const st_field_def* def, napi_value value,
+                     int signing, int depth)
+{
+    uint32_t code = def->code;
+    switch (ST_TYPE(code)) {
+    case ST_UINT8:
+    case ST_UINT16:
+    case ST_UINT32:
+    case ST_UINT64:
+        return put_uint(env, w, code, value, def->name);
+    case ST_HASH128: return put_hex(env, w, code, value, 16, HEX_FIELD, def->name);
+    case ST_HASH160_SF:
+    case ST_HASH160: return put_hex(env, w, code, value, 20, HEX_FIELD, def->name);
+    case ST_HASH256: return put_hex(env, w, code, value, 32, HEX_FIELD, def->name);
+    case ST_VL: return put_hex(env, w, code, value, 0, HEX_VL, def->name);
+    case ST_ACCOUNT: {
+        uint8_t id[20];
+        if (!get_account(env, value, id, def->name)) return 0;
+        st_put_vl(w, code, id, 20);
+        return 1;
+    }
+    case ST_AMOUNT:
+        return put_amount(env, w, code, value, def->name);
+    case ST_OBJECT:
+        st_put_header(w, code);
+        if (!encode_object(env, value, w, signing, depth + 1)) return 0;
+        st_put_end(w, ST_OBJECT);
+        return 1;
+    case ST_ARRAY: {
+        uint32_t n = 0;
+        if (napi_get_array_length(env, value, &n) != napi_ok)
+            return throw_field(env, def->name, "expected an array");
+        st_put_header(w, code);
+        for (uint32_t i = 0; i < n; i++) {
+            napi_value element;
+            napi_get_element(env, value, i, &element);
+            // Each element is { FieldName: value }, encoded like a one-field object
+            if (!encode_object(env, element, w, signing, depth + 1)) return 0;
+        }
+        st_put_end(w, ST_ARRAY);
+        return 1;
+    }
+    case ST_VECTOR256: {
+        uint32_t n = 0;
+        if (napi_get_array_length(env, value, &n) != napi_ok)
+            return throw_field(env, def->name, "expected an array of hashes");
+        st_writer hashes;
+        st_writer_init(&hashes);
+        for (uint32_t i = 0; i < n; i++) {
+            napi_value h;
+            napi_get_element(env, value, i, &h);
+            if (!put_hex(env, &hashes, code, h, 32, HEX_RAW, def->name)) {
+                st_writer_free(&hashes);
+                return 0;
+            }
+        }
+        st_put_vl(w, code, hashes.data, hashes.len);
+        st_writer_free(&hashes);
+        return 1;
+    }
+    case ST_PATHSET:
+        return put_pathset(env, w, code, value, def->name);
+    }
+    return throw_field(env, def->name, "unsupported field type");
+}
+
+typedef struct {
+    const st_field_def* def;
+    napi_value value;
+} pending_field;
+
+static int compare_pending(const void* a, const void* b)
+{
+    uint32_t x = ((const pending_field*)a)->def->code;
+    uint32_t y = ((const pending_field*)b)->def->code;
+    return x < y ? -1 : x > y;
+}
+
+static int is_signature_field(uint32_t code)
+{
+    const st_field_def* sig = st_field_by_name("TxnSignature", 12);
+    const st_field_def* signers = st_field_by_name("Signers", 7);
+    return (sig && code == sig->code) || (signers && code == signers->code);
+}
+
+// Fields of a JS object in canonical order
+static int encode_object(napi_env env, napi_value obj, st_writer* w, int signing, int depth)
+{
+    napi_value keys;
+    uint32_t n = 0;
+    if (depth > MAX_DEPTH) {
+        napi_throw_range_error(env, NULL, "object nested too deeply");
+        return 0;
+    }
+    if (napi_get_property_names(env, obj, &keys) != napi_ok ||
+        napi_get_array_length(env, keys, &n) != napi_ok) {
+        napi_throw_type_error(env, NULL, "expected an object");
+        return 0;
+    }
+
+    pending_field stack[64];
+    pending_field* fields = n <= 64 ? stack : malloc(n * sizeof(*fields));
+    if (!fields) {
+        napi_throw_error(env, NULL, "out of memory");
+        return 0;
+    }
+
+    uint32_t count = 0;
+    int ok = 1;
+    for (uint32_t i = 0; i < n && ok; i++) {
+        napi_value key;
+        char name[64];
+        size_t len;
+        napi_get_element(env, keys, i, &key);
+        if (napi_get_value_string_utf8(env, key, name, sizeof(name), &len) != napi_ok) continue;
+
+        const st_field_def* def = st_field_by_name(name, len);
+        if (!def) {
+            ok = throw_field(env, name, "unknown field");
+            break;
+        }
+        if (signing && is_signature_field(def->code)) continue;
+        fields[count].def = def;
+        napi_get_named_property(env, obj, name, &fields[count].value);
+        count++;
+    }
+
+    if (ok) {
+        qsort(fields, count, sizeof(*fields), compare_pending);
+        for (uint32_t i = 0; i < count && ok; i++)
+            ok = put_field(env, w, fields[i].def, fields[i].value, signing, depth);
+    }
+    if (fields != stack) free(fields);
+    return ok;
+}
+
+static napi_value encode_tx(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value argv[2];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "encodeTx(object, options?)");
+        return NULL;
+    }
+
+    int signing = 0;
+    napi_value v;
+    if (argc > 1 && get_named(env, argv[1], "signing", &v)) {
+        bool b = false;
+        napi_get_value_bool(env, v, &b);
+        signing = b;
+    }
+
+    st_writer w;
+    st_writer_init(&w);
+    if (signing) st_put_raw(&w, SIGNING_PREFIX, sizeof(SIGNING_PREFIX));
+    if (!encode_object(env, argv[0], &w, signing, 0)) {
+        st_writer_free(&w);
+        return NULL;
+    }
+    if (w.failed) {
+        st_writer_free(&w);
+        napi_throw_range_error(env, NULL, "value out of range or out of memory");
+        return NULL;
+    }
+
+    napi_value result;
+    void* out = NULL;
+    napi_status status = napi_create_buffer_copy(env, w.len, w.data, &out, &result);
+    st_writer_free(&w);
+    NAPI_CALL(env, status);
+    return result;
+}
+
+static napi_value xfl_to_string(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+
+    int64_t xfl = 0;
+    bool lossless = false;
+    if (argc < 1 || napi_get_value_bigint_int64(env, argv[0], &xfl, &lossless) != napi_ok || !lossless) {
+        napi_throw_type_error(env, NULL, "xflToString(bigint)");
+        return NULL;
+    }
+    if (xfl < 0) {
+        napi_throw_range_error(env, NULL, "not a valid XFL");
+        return NULL;
+    }
+    char text[ST_XFL_STRING_MAX];
+    return make_string(env, text, st_xfl_to_string(text, xfl));
+}
+
+static napi_value xfl_from_string(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1], result;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+
+    char s[64];
+    size_t len;
+    int64_t xfl;
+    if (argc < 1 || napi_get_value_string_utf8(env, argv[0], s, sizeof(s), &len) != napi_ok) {
+        napi_throw_type_error(env, NULL, "xflFromString(string)");
+        return NULL;
+    }
+    if (!st_xfl_from_string(s, len, &xfl)) {
+        napi_throw_range_error(env, NULL, "not a decimal of at most 16 significant digits in XFL range");
+        return NULL;
+    }
+    NAPI_CALL(env, napi_create_bigint_int64(env, xfl, &result));
+    return result;
+}
+
+napi_value codec_init(napi_env env, napi_value exports)
+{
+    NAPI_CALL(env, addon_export(env, exports, "decodeTx", decode_tx));
+    NAPI_CALL(env, addon_export(env, exports, "readField", read_field));
+    NAPI_CALL(env, addon_export(env, exports, "encodeTx", encode_tx));
+    NAPI_CALL(env, addon_export(env, exports, "xflToString", xfl_to_string));
+    NAPI_CALL(env, addon_export(env, exports, "xflFromString", xfl_from_string));
+    return exports;
+}
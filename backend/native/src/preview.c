@@ -0,0 +1,320 @@
+// Claim dry run: the claim hook's payout rules (hooks/include/drippy_claim_rules.h)
+// compiled into the addon
+//
+// claimPreview() runs claim_apply(), the function src/drippy_enhanced_claim.c calls, on
+// an account's current 32-byte state with the hook's live parameters, so its answer is
+// the hook's own arithmetic. What the hook reads from the ledger is passed in: the
+// close time of the last ledger and, for NFT_TBL boosts, the issuer and taxon of the
+// URITokens the claimant would list (ownership is checked by the caller).
+//
+//   claimPreview(state, { params, now, profile, nfts })
+//     -> { ok, error, payout, paid, boost, remaining, claimCount, nextEligible, state }
+//
+// state      32-byte claim state, or null when the account has none
+// params     HookParameters by name, values as Buffers or hex; read like hook_param()
+//            does: MIN_CLAIM/MAXP/COOLD/DAILY_MAX count only at exactly 8 bytes,
+//            BOOST_MAX at 4, NFT_TBL up to 8 rows
+// now        ledger_last_time(): close time of the last ledger, Ripple epoch seconds
+// profile    the build the hook runs: 'full' (default), 'cooldown' or 'min'
+// nfts       [{ issuer, taxon }], at most 8, as the claimant's NFTS memo would list them
+//
+// error is the hook's rollback message. payout leaves the accrued balance, paid is what
+// the hook emits. nextEligible is the first time the cooldown and daily cap allow a
+// claim (after this one when ok); it does not wait for accruals to reach MIN_CLAIM.
+// state is what the hook would store.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "addon.h"
+#include "base58.h"
+#include "drippy_claim_rules.h"
+
+#define DEFAULT_MIN_CLAIM 1000000
+#define DEFAULT_BOOST_MAX 500
+#define PARAM_VALUE_MAX 256
+
+enum { PROFILE_MIN, PROFILE_COOLDOWN, PROFILE_FULL };
+
+// Rollback messages of src/drippy_enhanced_claim.c by claim_apply() result
+static const char* const claim_errors[] = {
+    NULL, "below minimum", "cooldown active", "daily limit exceeded"
+};
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Bytes of a Buffer or hex string value; -1 (and a thrown error) when it is neither
+static int64_t get_value(napi_env env, napi_value value, uint8_t* out, size_t max, const char* what)
+{
+    napi_valuetype type;
+    if (napi_typeof(env, value, &type) != napi_ok) return -1;
+    if (type == napi_string) {
+        char hex[2 * PARAM_VALUE_MAX + 2];
+        size_t len;
+        if (napi_get_value_string_utf8(env, value, hex, sizeof(hex), &len) != napi_ok ||
+            len % 2 || len / 2 > max)
+            goto bad;
+        for (size_t i = 0; i < len / 2; i++) {
+            int hi = hex_value(hex[2 * i]), lo = hex_value(hex[2 * i + 1]);
+            if (hi < 0 || lo < 0) goto bad;
+            out[i] = (uint8_t)(hi << 4 | lo);
+        }
+        return (int64_t)(len / 2);
+    }
+
+    const uint8_t* data;
+    size_t len;
+    if (!addon_get_bytes(env, value, &data, &len)) return -1;
+    if (len > max) goto bad;
+    memcpy(out, data, len);
+    return (int64_t)len;
+
+bad: {
+        char message[96];
+        snprintf(message, sizeof(message), "%s must be a Buffer or hex string of at most %u bytes",
+                 what, (unsigned)max);
+        napi_throw_type_error(env, NULL, message);
+        return -1;
+    }
+}
+
+static int get_property(napi_env env, napi_value obj, const char* name, napi_value* out)
+{
+    bool has = false;
+    napi_valuetype type = napi_undefined;
+    if (napi_has_named_property(env, obj, name, &has) != napi_ok || !has) return 0;
+    if (napi_get_named_property(env, obj, name, out) != napi_ok) return 0;
+    napi_typeof(env, *out, &type);
+    return type != napi_undefined && type != napi_null;
+}
+
+// A HookParameter value as hook_param() would return its length into a buffer of `max`
+// bytes: the length when it fits, -1 when absent or too long. Throws on bad input.
+static int read_param(napi_env env, napi_value params, const char* name, uint8_t* out, size_t max,
+                      int* failed)
+{
+    napi_value v;
+    uint8_t value[PARAM_VALUE_MAX];
+    if (*failed) return -1;
+    if (!params || !get_property(env, params, name, &v)) return -1;
+    int64_t len = get_value(env, v, value, sizeof(value), name);
+    if (len < 0) {
+        *failed = 1;
+        return -1;
+    }
+    if ((size_t)len > max) return -1;
+    memcpy(out, value, (size_t)len);
+    return (int)len;
+}
+
+static uint64_t param_u64(napi_env env, napi_value params, const char* name, uint64_t fallback,
+                          int* failed)
+{
+    uint8_t buf[8];
+    return read_param(env, params, name, buf, sizeof(buf), failed) == 8 ? be_load_u64(buf) : fallback;
+}
+
+static uint32_t param_u32(napi_env env, napi_value params, const char* name, uint32_t fallback,
+                          int* failed)
+{
+    uint8_t buf[4];
+    return read_param(env, params, name, buf, sizeof(buf), failed) == 4 ? be_load_u32(buf) : fallback;
+}
+
+static int read_profile(napi_env env, napi_value options, int* profile)
+{
+    napi_value v;
+    char name[16];
+    size_t len = 0;
+    if (!get_property(env, options, "profile", &v)) return 1;
+    if (napi_get_value_string_utf8(env, v, name, sizeof(name), &len) == napi_ok) {
+        if (strcmp(name, "full") == 0) *profile = PROFILE_FULL;
+        else if (strcmp(name, "cooldown") == 0) *profile = PROFILE_COOLDOWN;
+        else if (strcmp(name, "min") == 0) *profile = PROFILE_MIN;
+        else len = 0;
+    }
+    if (!len) napi_throw_range_error(env, NULL, "profile must be 'full', 'cooldown' or 'min'");
+    return len != 0;
+}
+
+// Issuer of one nfts entry: classic address, 40 hex digits or 20 bytes
+static int read_issuer(napi_env env, napi_value value, uint8_t issuer[20])
+{
+    napi_valuetype type;
+    char s[64];
+    size_t len;
+    if (napi_typeof(env, value, &type) == napi_ok && type == napi_string &&
+        napi_get_value_string_utf8(env, value, s, sizeof(s), &len) == napi_ok &&
+        len != 40 && accounts_decode(env, issuer, s, len))
+        return 1;
+    int64_t got = get_value(env, value, issuer, 20, "nft issuer");
+    if (got == 20) return 1;
+    if (got >= 0) napi_throw_type_error(env, NULL, "nft issuer must be a classic address or 20 bytes");
+    return 0;
+}
+
+// Boost from NFT_TBL and the listed tokens, the way derive_nft_boost() sums it: 0 when
+// the table is not configured, so the stored boost applies
+static int nft_boost(napi_env env, napi_value options, const uint8_t* table, int rows,
+                     uint32_t max_boost, uint32_t* boost)
+{
+    napi_value list, item, v;
+    uint32_t count = 0;
+    *boost = 0;
+    if (rows == 0) return 1;
+
+    *boost = 100;
+    if (!get_property(env, options, "nfts", &list)) return 1;
+    bool is_array = false;
+    if (napi_is_array(env, list, &is_array) != napi_ok || !is_array) {
+        napi_throw_type_error(env, NULL, "nfts must be an array of { issuer, taxon }");
+        return 0;
+    }
+    if (napi_get_array_length(env, list, &count) != napi_ok) return 0;
+    if (count > CLAIM_NFT_IDS_MAX) {
+        napi_throw_range_error(env, NULL, "a claim lists at most 8 NFTs");
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t issuer[20];
+        uint32_t taxon = 0;
+        if (napi_get_element(env, list, i, &item) != napi_ok) return 0;
+        if (!get_property(env, item, "issuer", &v)) {
+            napi_throw_type_error(env, NULL, "nfts must be an array of { issuer, taxon }");
+            return 0;
+        }
+        if (!read_issuer(env, v, issuer)) return 0;
+        if (get_property(env, item, "taxon", &v) && napi_get_value_uint32(env, v, &taxon) != napi_ok) {
+            napi_throw_type_error(env, NULL, "nft taxon must be a u32");
+            return 0;
+        }
+        *boost += claim_nft_bonus(table, rows, issuer, taxon);
+    }
+    if (*boost > max_boost) *boost = max_boost;
+    return 1;
+}
+
+// First time at or after `now` the cooldown and daily cap allow a claim from `state`
+static uint64_t next_eligible(const uint8_t* state, const claim_rules* rules, uint64_t now)
+{
+    uint64_t last = be_load_u64(state + 8);
+    uint64_t t = now;
+    if (rules->cooldown > 0 && last && t < last + rules->cooldown) t = last + rules->cooldown;
+    if ((rules->features & CLAIM_RULE_DAILY_CAP) && rules->daily_max > 0 &&
+        t / CLAIM_SECONDS_PER_DAY == last / CLAIM_SECONDS_PER_DAY &&
+        be_load_u64(state + 24) >= rules->daily_max)
+        t = (last / CLAIM_SECONDS_PER_DAY + 1) * CLAIM_SECONDS_PER_DAY;
+    return t;
+}
+
+static napi_value claim_preview(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value argv[2];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 2) {
+        napi_throw_type_error(env, NULL, "claimPreview(state, { params, now, profile, nfts })");
+        return NULL;
+    }
+
+    uint8_t state[CLAIM_STATE_SIZE] = { 0 };
+    napi_valuetype type;
+    NAPI_CALL(env, napi_typeof(env, argv[0], &type));
+    if (type != napi_null && type != napi_undefined) {
+        const uint8_t* data;
+        size_t len;
+        if (!addon_get_bytes(env, argv[0], &data, &len)) return NULL;
+        if (len != CLAIM_STATE_SIZE) {
+            napi_throw_range_error(env, NULL, "state must be 32 bytes");
+            return NULL;
+        }
+        memcpy(state, data, CLAIM_STATE_SIZE);
+    }
+
+    napi_value options = argv[1], params = NULL, v;
+    NAPI_CALL(env, napi_typeof(env, options, &type));
+    if (type != napi_object) {
+        napi_throw_type_error(env, NULL, "options must be an object");
+        return NULL;
+    }
+    if (get_property(env, options, "params", &v)) params = v;
+
+    double now_value = -1;
+    if (!get_property(env, options, "now", &v) || napi_get_value_double(env, v, &now_value) != napi_ok ||
+        now_value < 0 || now_value > 9007199254740991.0 || now_value != (double)(uint64_t)now_value) {
+        napi_throw_range_error(env, NULL, "now must be the last ledger close time in seconds");
+        return NULL;
+    }
+    uint64_t now = (uint64_t)now_value;
+
+    int profile = PROFILE_FULL;
+    if (!read_profile(env, options, &profile)) return NULL;
+
+    // The parameters process_claim() reads, per feature
+    int failed = 0;
+    claim_rules rules = { 0 };
+    rules.min_claim = param_u64(env, params, "MIN_CLAIM", DEFAULT_MIN_CLAIM, &failed);
+    rules.max_claim = param_u64(env, params, "MAXP", 0, &failed);
+    if (profile != PROFILE_MIN) {
+        rules.cooldown = param_u64(env, params, "COOLD", 0, &failed);
+        rules.daily_max = param_u64(env, params, "DAILY_MAX", 0, &failed);
+        rules.features |= CLAIM_RULE_DAILY_CAP;
+    }
+    if (profile == PROFILE_FULL) {
+        uint8_t table[CLAIM_NFT_ROW * CLAIM_NFT_ROWS_MAX];
+        int table_len = read_param(env, params, "NFT_TBL", table, sizeof(table), &failed);
+        int rows = table_len >= CLAIM_NFT_ROW ? table_len / CLAIM_NFT_ROW : 0;
+        uint32_t max_boost = param_u32(env, params, "BOOST_MAX", DEFAULT_BOOST_MAX, &failed);
+        if (failed) return NULL;
+        if (!nft_boost(env, options, table, rows, max_boost, &rules.boost)) return NULL;
+        rules.features |= CLAIM_RULE_BOOST;
+    }
+    if (failed) return NULL;
+
+    uint8_t before[CLAIM_STATE_SIZE];
+    claim_outcome outcome = { 0 };
+    memcpy(before, state, CLAIM_STATE_SIZE);
+    int status = claim_apply(state, &rules, now, &outcome);
+    if (status != CLAIM_OK) memcpy(state, before, CLAIM_STATE_SIZE);
+
+    // Cooldown and daily cap are measured from the state after the claim when it pays
+    uint8_t from[CLAIM_STATE_SIZE];
+    memcpy(from, state, CLAIM_STATE_SIZE);
+    if (status != CLAIM_OK && (rules.features & CLAIM_RULE_DAILY_CAP) &&
+        be_load_u64(from + 8) / CLAIM_SECONDS_PER_DAY != now / CLAIM_SECONDS_PER_DAY)
+        be_store_u64(from + 24, 0);
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    NAPI_CALL(env, napi_get_boolean(env, status == CLAIM_OK, &v));
+    NAPI_CALL(env, napi_set_named_property(env, result, "ok", v));
+    if (status == CLAIM_OK) NAPI_CALL(env, napi_get_null(env, &v));
+    else NAPI_CALL(env, napi_create_string_utf8(env, claim_errors[status], NAPI_AUTO_LENGTH, &v));
+    NAPI_CALL(env, napi_set_named_property(env, result, "error", v));
+    NAPI_CALL(env, napi_create_bigint_uint64(env, outcome.payout, &v));
+    NAPI_CALL(env, napi_set_named_property(env, result, "payout", v));
+    NAPI_CALL(env, napi_create_bigint_uint64(env, outcome.paid, &v));
+    NAPI_CALL(env, napi_set_named_property(env, result, "paid", v));
+    NAPI_CALL(env, addon_set_u32(env, result, "boost", outcome.boost));
+    NAPI_CALL(env, napi_create_bigint_uint64(env, be_load_u64(state), &v));
+    NAPI_CALL(env, napi_set_named_property(env, result, "remaining", v));
+    NAPI_CALL(env, addon_set_u32(env, result, "claimCount", be_load_u32(state + 16)));
+    NAPI_CALL(env, napi_create_double(env, (double)next_eligible(from, &rules, now), &v));
+    NAPI_CALL(env, napi_set_named_property(env, result, "nextEligible", v));
+    NAPI_CALL(env, napi_create_buffer_copy(env, CLAIM_STATE_SIZE, state, NULL, &v));
+    NAPI_CALL(env, napi_set_named_property(env, result, "state", v));
+    return result;
+}
+
+napi_value preview_init(napi_env env, napi_value exports)
+{
+    NAPI_CALL(env, addon_export(env, exports, "claimPreview", claim_preview));
+    return exports;
+}
@@ -0,0 +1,462 @@
+// Fixed-point pro-rata distribution of a reward pool over a holder snapshot
+//
+// The snapshot is a Buffer of 36-byte holder records (packHolders() in index.js):
+//   [0..20)  account id
+//   [20..28) balance, u64 BE (token units at a fixed scale, e.g. millionths)
+//   [28..32) NFT count, u32 BE
+//   [32..36) boost multiplier, u32 BE (100 = 1x, 0 reads as 1x like the claim hook)
+//
+// weight = basis * boost, where basis is the balance or the NFT count. Each holder gets
+//   floor(pool * weight / total_weight)
+// computed exactly in 128-bit integers, and the drops left over by the floors (fewer than
+// the number of holders) go one each to the largest remainders, ties to the earlier
+// record. The shares add up to the pool exactly, never more.
+//
+// The work is split over threads by record range: weights (summed in 32-bit halves so
+// the compiler vectorizes the loop), shares and remainders, then the +1 pass. Largest
+// remainder needs no sort: a 16-bit histogram of the normalized remainders finds the
+// cut-off bucket and only that bucket is ranked exactly.
+//
+//   distribute(snapshot, pool, { basis: 'balance' | 'nfts', threads, deltas })
+//     -> { shares: BigUint64Array, deltas: Buffer, distributed, totalWeight, paid }
+//
+// deltas holds one 64-byte entry per holder with a non-zero share, in the claim hook's
+// state layout (src/drippy_enhanced_claim.c): HookStateKey "DRIPPY:CLAIM" + account, then
+// a 32-byte record with the share in accrued_drops [0..8) and every other field zero.
+// `deltas: false` skips it.
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "addon.h"
+
+#define HOLDER_RECORD_SIZE 36
+#define DELTA_RECORD_SIZE 64
+#define MAX_THREADS 64
+#define KEY_BUCKETS 65536
+#define MIN_PART 65536         // records per thread before another thread pays off
+
+static const uint8_t CLAIM_KEY_PREFIX[12] = { 'D', 'R', 'I', 'P', 'P', 'Y', ':', 'C', 'L', 'A', 'I', 'M' };
+
+typedef unsigned __int128 u128;
+
+enum { BASIS_BALANCE, BASIS_NFTS };
+
+typedef struct {
+    // Shared inputs
+    const uint8_t* snapshot;
+    uint64_t* weights;
+    uint64_t* shares;
+    uint16_t* keys;
+    uint8_t* deltas;
+    int basis;
+    uint64_t pool;
+    u128 total;
+    int shift;
+    uint16_t cut;              // bucket above which every holder gets +1
+    size_t begin, end;
+
+    // Outputs of this part
+    int overflow;
+    u128 weight_sum;
+    uint64_t share_sum;
+    uint32_t* histogram;
+    size_t paid;
+    size_t delta_offset;
+} prorata_part;
+
+typedef void (*part_fn)(prorata_part*);
+
+static uint32_t load_u32(const uint8_t* b)
+{
+    return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+}
+
+static uint64_t load_u64(const uint8_t* b)
+{
+    return ((uint64_t)load_u32(b) << 32) | load_u32(b + 4);
+}
+
+static void store_u64(uint8_t* b, uint64_t v)
+{
+    for (int i = 0; i < 8; i++)
+        b[i] = (uint8_t)(v >> (56 - 8 * i));
+}
+
+static int clz128(u128 v)
+{
+    uint64_t hi = (uint64_t)(v >> 64);
+    if (hi) return __builtin_clzll(hi);
+    return 64 + __builtin_clzll((uint64_t)v);
+}
+
+// Phase 1: weights and their sum
+static void weigh_part(prorata_part* p)
+{
+    for (size_t i = p->begin; i < p->end; i++) {
+        const uint8_t* r = p->snapshot + i * HOLDER_RECORD_SIZE;
+        uint64_t basis = p->basis == BASIS_NFTS ? load_u32(r + 28) : load_u64(r + 20);
+        uint32_t boost = load_u32(r + 32);
+        if (boost == 0) boost = 100;
+        if (basis > UINT64_MAX / boost) {
+            p->overflow = 1;
+            return;
+        }
+        p->weights[i] = basis * boost;
+    }
+
+    // Halves summed in 64-bit lanes cannot carry out below 2^32 records
+    uint64_t lo = 0, hi = 0;
+    const uint64_t* w = p->weights;
+    for (size_t i = p->begin; i < p->end; i++) {
+        lo += w[i] & 0xFFFFFFFFULL;
+        hi += w[i] >> 32;
+    }
+    p->weight_sum = ((u128)hi << 32) + lo;
+}
+
+// Phase 2: floor shares, remainder keys and their histogram
+static void split_part(prorata_part* p)
+{
+    uint64_t sum = 0;
+    memset(p->histogram, 0, KEY_BUCKETS * sizeof(uint32_t));
+    for (size_t i = p->begin; i < p->end; i++) {
+        u128 product = (u128)p->pool * p->weights[i];
+        uint64_t share = (uint64_t)(product / p->total);
+        u128 rem = product - (u128)share * p->total;
+        uint16_t key = (uint16_t)((rem << p->shift) >> 112);
+        p->shares[i] = share;
+        p->keys[i] = key;
+        p->histogram[key]++;
+        sum += share;
+    }
+    p->share_sum = sum;
+}
+
+// Phase 3: +1 above the cut-off bucket, count the holders paid
+static void round_part(prorata_part* p)
+{
+    size_t paid = 0;
+    for (size_t i = p->begin; i < p->end; i++) {
+        p->shares[i] += p->keys[i] > p->cut;
+        paid += p->shares[i] != 0;
+    }
+    p->paid = paid;
+}
+
+// Phase 4: state deltas of the holders paid
+static void delta_part(prorata_part* p)
+{
+    uint8_t* out = p->deltas + p->delta_offset * DELTA_RECORD_SIZE;
+    for (size_t i = p->begin; i < p->end; i++) {
+        if (!p->shares[i]) continue;
+        memcpy(out, CLAIM_KEY_PREFIX, 12);
+        memcpy(out + 12, p->snapshot + i * HOLDER_RECORD_SIZE, 20);
+        memset(out + 32, 0, 32);
+        store_u64(out + 32, p->shares[i]);
+        out += DELTA_RECORD_SIZE;
+    }
+}
+
+static void* part_thread(void* arg)
+{
+    void** a = arg;
+    ((part_fn)a[0])((prorata_part*)a[1]);
+    return NULL;
+}
+
+// Runs fn on every part, the last one on the calling thread
+static int run_parts(prorata_part* parts, int count, part_fn fn)
+{
+    pthread_t threads[MAX_THREADS];
+    void* args[MAX_THREADS][2];
+    int started = 0;
+
+    for (int t = 0; t < count - 1; t++) {
+        args[t][0] = (void*)fn;
+        args[t][1] = &parts[t];
+        if (pthread_create(&threads[t], NULL, part_thread, args[t]) != 0) break;
+        started++;
+    }
+    // Parts whose thread failed to start run here
+    for (int t = started; t < count; t++)
+        fn(&parts[t]);
+    for (int t = 0; t < started; t++)
+        pthread_join(threads[t], NULL);
+    return started;
+}
+
+typedef struct {
+    u128 rem;
+    size_t index;
+} candidate;
+
+static int compare_candidates(const void* a, const void* b)
+{
+    const candidate* x = a;
+    const candidate* y = b;
+    if (x->rem != y->rem) return x->rem > y->rem ? -1 : 1;
+    return x->index < y->index ? -1 : x->index > y->index;
+}
+
+// The `need` largest remainders in the cut-off bucket get +1
+static int rank_cut_bucket(prorata_part* ctx, size_t n, uint64_t need)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++)
+        count += ctx->keys[i] == ctx->cut;
+
+    candidate* c = malloc((count ? count : 1) * sizeof(*c));
+    if (!c) return 0;
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (ctx->keys[i] != ctx->cut) continue;
+        u128 product = (u128)ctx->pool * ctx->weights[i];
+        c[k].rem = product - (u128)ctx->shares[i] * ctx->total;
+        c[k].index = i;
+        k++;
+    }
+    qsort(c, count, sizeof(*c), compare_candidates);
+    for (uint64_t j = 0; j < need && j < count; j++)
+        ctx->shares[c[j].index]++;
+    free(c);
+    return 1;
+}
+
+static int default_threads(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) return 1;
+    return n > MAX_THREADS ? MAX_THREADS : (int)n;
+}
+
+static int read_pool(napi_env env, napi_value value, uint64_t* pool)
+{
+    napi_valuetype type;
+    if (napi_typeof(env, value, &type) != napi_ok) return 0;
+
+    if (type == napi_bigint) {
+        bool lossless = false;
+        if (napi_get_value_bigint_uint64(env, value, pool, &lossless) != napi_ok || !lossless) {
+            napi_throw_range_error(env, NULL, "pool must fit in 64 bits");
+            return 0;
+        }
+        return 1;
+    }
+    if (type == napi_number) {
+        double d;
+        napi_get_value_double(env, value, &d);
+        if (d < 0 || d > 9007199254740991.0 || d != (double)(uint64_t)d) {
+            napi_throw_range_error(env, NULL, "pool must be a non-negative safe integer or a BigInt");
+            return 0;
+        }
+        *pool = (uint64_t)d;
+        return 1;
+    }
+    napi_throw_type_error(env, NULL, "pool must be a BigInt or a number");
+    return 0;
+}
+
+// Reads { basis, threads, deltas }; missing fields keep their defaults
+static int read_options(napi_env env, napi_value options, int* basis, int* threads, int* deltas)
+{
+    napi_valuetype type;
+    if (napi_typeof(env, options, &type) != napi_ok) return 0;
+    if (type == napi_undefined || type == napi_null) return 1;
+    if (type != napi_object) {
+        napi_throw_type_error(env, NULL, "options must be an object");
+        return 0;
+    }
+
+    napi_value v;
+    bool has = false;
+    if (napi_has_named_property(env, options, "basis", &has) == napi_ok && has) {
+        char name[16];
+        size_t len = 0;
+        napi_get_named_property(env, options, "basis", &v);
+        if (napi_get_value_string_utf8(env, v, name, sizeof(name), &len) != napi_ok) {
+            napi_throw_type_error(env, NULL, "basis must be 'balance' or 'nfts'");
+            return 0;
+        }
+        if (strcmp(name, "balance") == 0) *basis = BASIS_BALANCE;
+        else if (strcmp(name, "nfts") == 0) *basis = BASIS_NFTS;
+        else {
+            napi_throw_range_error(env, NULL, "basis must be 'balance' or 'nfts'");
+            return 0;
+        }
+    }
+    if (napi_has_named_property(env, options, "threads", &has) == napi_ok && has) {
+        int32_t n = 0;
+        napi_get_named_property(env, options, "threads", &v);
+        if (napi_get_value_int32(env, v, &n) != napi_ok || n < 1) {
+            napi_throw_range_error(env, NULL, "threads must be a positive integer");
+            return 0;
+        }
+        *threads = n > MAX_THREADS ? MAX_THREADS : n;
+    }
+    if (napi_has_named_property(env, options, "deltas", &has) == napi_ok && has) {
+        bool b = true;
+        napi_get_named_property(env, options, "deltas", &v);
+        if (napi_get_value_bool(env, v, &b) != napi_ok) {
+            napi_throw_type_error(env, NULL, "deltas must be a boolean");
+            return 0;
+        }
+        *deltas = b;
+    }
+    return 1;
+}
+
+static napi_value distribute(napi_env env, napi_callback_info info)
+{
+    size_t argc = 3;
+    napi_value argv[3];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 2) {
+        napi_throw_type_error(env, NULL, "distribute(snapshot, pool, options?)");
+        return NULL;
+    }
+
+    const uint8_t* snapshot;
+    size_t len;
+    uint64_t pool;
+    int basis = BASIS_BALANCE, threads = default_threads(), want_deltas = 1;
+    if (!addon_get_bytes(env, argv[0], &snapshot, &len)) return NULL;
+    if (len % HOLDER_RECORD_SIZE != 0) {
+        napi_throw_range_error(env, NULL, "snapshot must be a multiple of 36 bytes");
+        return NULL;
+    }
+    if (!read_pool(env, argv[1], &pool)) return NULL;
+    if (argc > 2 && !read_options(env, argv[2], &basis, &threads, &want_deltas)) return NULL;
+
+    size_t n = len / HOLDER_RECORD_SIZE;
+    if ((size_t)threads > n / MIN_PART + 1) threads = (int)(n / MIN_PART + 1);
+
+    napi_value shares_buffer, shares_array;
+    void* shares_data = NULL;
+    NAPI_CALL(env, napi_create_arraybuffer(env, n * sizeof(uint64_t), &shares_data, &shares_buffer));
+    NAPI_CALL(env, napi_create_typedarray(env, napi_biguint64_array, n, shares_buffer, 0, &shares_array));
+
+    prorata_part ctx = { 0 };
+    prorata_part parts[MAX_THREADS];
+    ctx.snapshot = snapshot;
+    ctx.shares = shares_data;
+    ctx.basis = basis;
+    ctx.pool = pool;
+    ctx.weights = malloc((n ? n : 1) * sizeof(uint64_t));
+    ctx.keys = malloc((n ? n : 1) * sizeof(uint16_t));
+    uint32_t* histograms = calloc((size_t)threads * KEY_BUCKETS, sizeof(uint32_t));
+    if (!ctx.weights || !ctx.keys || !histograms) {
+        free(ctx.weights);
+        free(ctx.keys);
+        free(histograms);
+        napi_throw_error(env, NULL, "out of memory");
+        return NULL;
+    }
+
+    for (int t = 0; t < threads; t++) {
+        parts[t] = ctx;
+        parts[t].begin = n * t / threads;
+        parts[t].end = n * (t + 1) / threads;
+        parts[t].histogram = histograms + (size_t)t * KEY_BUCKETS;
+    }
+
+    run_parts(parts, threads, weigh_part);
+    u128 total = 0;
+    int overflow = 0;
+    for (int t = 0; t < threads; t++) {
+        total += parts[t].weight_sum;
+        overflow |= parts[t].overflow;
+    }
+
+    uint64_t distributed = 0;
+    size_t paid = 0;
+    if (!overflow && total != 0 && pool != 0) {
+        ctx.total = total;
+        ctx.shift = clz128(total);
+        for (int t = 0; t < threads; t++) {
+            parts[t].total = ctx.total;
+            parts[t].shift = ctx.shift;
+        }
+        run_parts(parts, threads, split_part);
+
+        // Leftover drops go to the largest remainders: find the bucket where they run out
+        uint64_t floors = 0;
+        for (int t = 0; t < threads; t++)
+            floors += parts[t].share_sum;
+        uint64_t left = pool - floors;
+        uint64_t above = 0;
+        uint32_t cut = KEY_BUCKETS - 1;
+        for (;; cut--) {
+            uint64_t in_bucket = 0;
+            for (int t = 0; t < threads; t++)
+                in_bucket += parts[t].histogram[cut];
+            if (above + in_bucket >= left || cut == 0) break;
+            above += in_bucket;
+        }
+
+        ctx.cut = (uint16_t)cut;
+        for (int t = 0; t < threads; t++)
+            parts[t].cut = ctx.cut;
+        if (left) {
+            run_parts(parts, threads, round_part);
+            if (!rank_cut_bucket(&ctx, n, left - above)) {
+                free(ctx.weights);
+                free(ctx.keys);
+                free(histograms);
+                napi_throw_error(env, NULL, "out of memory");
+                return NULL;
+            }
+        }
+        distributed = pool;
+    }
+
+    // Holders paid, counted after the last +1
+    for (int t = 0; t < threads; t++) {
+        size_t c = 0;
+        for (size_t i = parts[t].begin; i < parts[t].end; i++)
+            c += ctx.shares[i] != 0;
+        parts[t].delta_offset = paid;
+        paid += c;
+    }
+
+    napi_value deltas;
+    if (want_deltas) {
+        void* delta_data = NULL;
+        NAPI_CALL(env, napi_create_buffer(env, paid * DELTA_RECORD_SIZE, &delta_data, &deltas));
+        for (int t = 0; t < threads; t++)
+            parts[t].deltas = delta_data;
+        run_parts(parts, threads, delta_part);
+    } else {
+        NAPI_CALL(env, napi_get_null(env, &deltas));
+    }
+
+    free(ctx.weights);
+    free(ctx.keys);
+    free(histograms);
+
+    if (overflow) {
+        napi_throw_range_error(env, NULL, "holder weight (basis x boost) exceeds 64 bits");
+        return NULL;
+    }
+
+    uint64_t words[2] = { (uint64_t)total, (uint64_t)(total >> 64) };
+    napi_value result, v;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    NAPI_CALL(env, napi_set_named_property(env, result, "shares", shares_array));
+    NAPI_CALL(env, napi_set_named_property(env, result, "deltas", deltas));
+    NAPI_CALL(env, napi_create_bigint_uint64(env, distributed, &v));
+    NAPI_CALL(env, napi_set_named_property(env, result, "distributed", v));
+    NAPI_CALL(env, napi_create_bigint_words(env, 0, 2, words, &v));
+    NAPI_CALL(env, napi_set_named_property(env, result, "totalWeight", v));
+    NAPI_CALL(env, napi_create_double(env, (double)paid, &v));
+    NAPI_CALL(env, napi_set_named_property(env, result, "paid", v));
+    return result;
+}
+
+napi_value prorata_init(napi_env env, napi_value exports)
+{
+    NAPI_CALL(env, addon_export(env, exports, "distribute", distribute));
+    return exports;
+}
@@ -0,0 +1,101 @@
+// Decoder for the hook state record rings (hooks/include/drippy_ring.h)
+//
+// The event ring and the change log share one 48-byte record format. Readers fetch the
+// slots written since their cursor and pass them here concatenated, so a page of
+// records is decoded in one call instead of one Buffer slice per field.
+//
+//   decodeRecords(buf) -> [{ seq, ledger, op, result, account, value, aux }]
+//     seq is a Number (exact below 2^53), value a BigInt, account upper-case hex
+//   decodeHead(buf)    -> { next, slots } or null when buf is not a head entry
+
+#include "addon.h"
+
+#define RING_RECORD_SIZE 48
+#define RING_HEAD_SIZE 12
+
+static uint32_t load_u32(const uint8_t* b)
+{
+    return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+}
+
+static uint64_t load_u64(const uint8_t* b)
+{
+    return ((uint64_t)load_u32(b) << 32) | load_u32(b + 4);
+}
+
+static napi_value decode_records(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "decodeRecords(buffer)");
+        return NULL;
+    }
+
+    const uint8_t* data;
+    size_t len;
+    if (!addon_get_bytes(env, argv[0], &data, &len)) return NULL;
+    if (len % RING_RECORD_SIZE != 0) {
+        napi_throw_range_error(env, NULL, "record data must be a multiple of 48 bytes");
+        return NULL;
+    }
+
+    size_t count = len / RING_RECORD_SIZE;
+    napi_value out;
+    NAPI_CALL(env, napi_create_array_with_length(env, count, &out));
+
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* r = data + i * RING_RECORD_SIZE;
+        napi_value obj, seq, value;
+
+        NAPI_CALL(env, napi_create_object(env, &obj));
+        NAPI_CALL(env, napi_create_double(env, (double)load_u64(r), &seq));
+        NAPI_CALL(env, napi_set_named_property(env, obj, "seq", seq));
+        NAPI_CALL(env, addon_set_u32(env, obj, "ledger", load_u32(r + 8)));
+        NAPI_CALL(env, addon_set_u32(env, obj, "op", r[12]));
+        NAPI_CALL(env, addon_set_u32(env, obj, "result", r[13]));
+        NAPI_CALL(env, addon_set_hex(env, obj, "account", r + 16, 20));
+        NAPI_CALL(env, napi_create_bigint_uint64(env, load_u64(r + 36), &value));
+        NAPI_CALL(env, napi_set_named_property(env, obj, "value", value));
+        NAPI_CALL(env, addon_set_u32(env, obj, "aux", load_u32(r + 44)));
+
+        NAPI_CALL(env, napi_set_element(env, out, (uint32_t)i, obj));
+    }
+
+    return out;
+}
+
+static napi_value decode_head(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1];
+    napi_value result;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+
+    const uint8_t* data;
+    size_t len;
+    if (argc < 1 || !addon_get_bytes(env, argv[0], &data, &len)) {
+        if (argc < 1) napi_throw_type_error(env, NULL, "decodeHead(buffer)");
+        return NULL;
+    }
+
+    if (len != RING_HEAD_SIZE) {
+        NAPI_CALL(env, napi_get_null(env, &result));
+        return result;
+    }
+
+    napi_value next;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    NAPI_CALL(env, napi_create_double(env, (double)load_u64(data), &next));
+    NAPI_CALL(env, napi_set_named_property(env, result, "next", next));
+    NAPI_CALL(env, addon_set_u32(env, result, "slots", load_u32(data + 8)));
+    return result;
+}
+
+napi_value records_init(napi_env env, napi_value exports)
+{
+    NAPI_CALL(env, addon_export(env, exports, "decodeRecords", decode_records));
+    NAPI_CALL(env, addon_export(env, exports, "decodeHead", decode_head));
+    return exports;
+}
@@ -0,0 +1,339 @@
+// Local transaction signing for admin submissions
+//
+// A TxSigner holds the key pair of one family seed, derived the way rippled does it:
+//   secp256k1  root = first SHA512Half(entropy | u32 seq) in [1, n), account key =
+//              root + first SHA512Half(root public | u32 0 | u32 seq) in [1, n), mod n
+//   ed25519    private key = SHA512Half(entropy), public key 0xED | the 32-byte key
+// sign(message) signs what encodeTx(tx, { signing: true }) returns. secp256k1 signs
+// SHA512Half of it, with a random nonce and the low S rippled requires, DER-encoded;
+// ed25519 signs the message itself.
+//
+// The curve arithmetic and SHA-512 come from the OpenSSL that Node links and exports;
+// only its non-deprecated BIGNUM, EC_POINT and EVP calls are used.
+//
+//   new TxSigner(seed)   seed "s..." (secp256k1) or "sEd..." (ed25519)
+//     .publicKey         33 bytes as hex, the SigningPubKey
+//     .address           classic address of the key
+//     .algorithm         "secp256k1" or "ed25519"
+//   sign(message)      -> Buffer, the TxnSignature
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/bn.h>
+#include <openssl/crypto.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/obj_mac.h>
+
+#include "addon.h"
+#include "base58.h"
+
+#define SEED_ENTROPY 16
+#define SEED_STRING_MAX 64
+#define DER_SIGNATURE_MAX 72
+#define ED25519_SIGNATURE 64
+
+static const uint8_t ED25519_SEED_PREFIX[3] = { 0x01, 0xE1, 0x4B };
+#define SECP256K1_SEED_VERSION 0x21
+
+typedef struct {
+    int ed25519;
+    uint8_t public_key[33];
+    EVP_PKEY* ed_key;       // ed25519
+    EC_GROUP* group;        // secp256k1
+    BIGNUM* secret;
+} signer;
+
+static int sha512_half(uint8_t out[32], const uint8_t* data, size_t len)
+{
+    uint8_t h[64];
+    unsigned int h_len = 0;
+    if (!EVP_Digest(data, len, h, &h_len, EVP_sha512(), NULL)) return 0;
+    memcpy(out, h, 32);
+    OPENSSL_cleanse(h, sizeof(h));
+    return 1;
+}
+
+static void store_u32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+// First SHA512Half(prefix | u32 seq) that is a valid scalar, into `out`
+static int derive_scalar(BIGNUM* out, const uint8_t* prefix, size_t prefix_len, const BIGNUM* order)
+{
+    uint8_t buf[33 + 8], h[32];
+    memcpy(buf, prefix, prefix_len);
+    for (uint32_t seq = 0; seq < 0xFFFFFFFF; seq++) {
+        store_u32(buf + prefix_len, seq);
+        if (!sha512_half(h, buf, prefix_len + 4) || !BN_bin2bn(h, 32, out)) break;
+        if (!BN_is_zero(out) && BN_cmp(out, order) < 0) {
+            OPENSSL_cleanse(buf, sizeof(buf));
+            OPENSSL_cleanse(h, sizeof(h));
+            return 1;
+        }
+    }
+    OPENSSL_cleanse(buf, sizeof(buf));
+    OPENSSL_cleanse(h, sizeof(h));
+    return 0;
+}
+
+static int public_point(signer* s, const BIGNUM* scalar, uint8_t out[33], BN_CTX* ctx)
+{
+    EC_POINT* p = EC_POINT_new(s->group);
+    int ok = p && EC_POINT_mul(s->group, p, scalar, NULL, NULL, ctx) &&
+             EC_POINT_point2oct(s->group, p, POINT_CONVERSION_COMPRESSED, out, 33, ctx) == 33;
+    EC_POINT_free(p);
+    return ok;
+}
+
+static int secp256k1_derive(signer* s, const uint8_t entropy[SEED_ENTROPY])
+{
+    BN_CTX* ctx = BN_CTX_secure_new();
+    BIGNUM* root = BN_secure_new();
+    BIGNUM* tweak = BN_secure_new();
+    s->group = EC_GROUP_new_by_curve_name(NID_secp256k1);
+    s->secret = BN_secure_new();
+    int ok = ctx && root && tweak && s->group && s->secret;
+
+    if (ok) {
+        BN_set_flags(root, BN_FLG_CONSTTIME);
+        BN_set_flags(s->secret, BN_FLG_CONSTTIME);
+        const BIGNUM* order = EC_GROUP_get0_order(s->group);
+        uint8_t root_public[33 + 4];
+        ok = derive_scalar(root, entropy, SEED_ENTROPY, order) && public_point(s, root, root_public, ctx);
+        store_u32(root_public + 33, 0);     // account index
+        ok = ok && derive_scalar(tweak, root_public, sizeof(root_public), order) &&
+             BN_mod_add(s->secret, root, tweak, order, ctx) &&
+             public_point(s, s->secret, s->public_key, ctx);
+    }
+    BN_clear_free(root);
+    BN_clear_free(tweak);
+    BN_CTX_free(ctx);
+    return ok;
+}
+
+static int ed25519_derive(signer* s, const uint8_t entropy[SEED_ENTROPY])
+{
+    uint8_t secret[32];
+    size_t len = 32;
+    if (!sha512_half(secret, entropy, SEED_ENTROPY)) return 0;
+    s->ed_key = EVP_PKEY_new_raw_private_key(EVP_PKEY_ED25519, NULL, secret, 32);
+    OPENSSL_cleanse(secret, sizeof(secret));
+    s->public_key[0] = 0xED;
+    return s->ed_key && EVP_PKEY_get_raw_public_key(s->ed_key, s->public_key + 1, &len) && len == 32;
+}
+
+// Minimal DER INTEGER of a non-negative 32-byte value
+static size_t der_integer(uint8_t* out, const uint8_t v[32])
+{
+    size_t skip = 0;
+    while (skip < 31 && v[skip] == 0)
+        skip++;
+    size_t len = 32 - skip;
+    int pad = v[skip] & 0x80 ? 1 : 0;
+    out[0] = 0x02;
+    out[1] = (uint8_t)(len + pad);
+    out[2] = 0;
+    memcpy(out + 2 + pad, v + skip, len);
+    return 2 + pad + len;
+}
+
+// ECDSA over SHA512Half(message): s = k^-1 (z + r d) mod n, with S folded to the low half
+static size_t secp256k1_sign(signer* s, const uint8_t* message, size_t len, uint8_t out[DER_SIGNATURE_MAX])
+{
+    uint8_t digest[32], r_bytes[32], s_bytes[32];
+    size_t out_len = 0;
+    BN_CTX* ctx = BN_CTX_secure_new();
+    BIGNUM *z = BN_new(), *k = BN_secure_new(), *k_inv = BN_secure_new(), *n_2 = BN_new();
+    BIGNUM *x = BN_new(), *r = BN_new(), *sig = BN_new(), *half = BN_new();
+    EC_POINT* point = EC_POINT_new(s->group);
+    if (!ctx || !z || !k || !k_inv || !n_2 || !x || !r || !sig || !half || !point) goto done;
+    BN_set_flags(k, BN_FLG_CONSTTIME);
+
+    const BIGNUM* order = EC_GROUP_get0_order(s->group);
+    if (!sha512_half(digest, message, len) || !BN_bin2bn(digest, 32, z) ||
+        !BN_sub(n_2, order, BN_value_one()) || !BN_sub_word(n_2, 1) || !BN_rshift1(half, order))
+        goto done;
+
+    for (int attempt = 0; attempt < 8; attempt++) {
+        do {
+            if (!BN_priv_rand_range(k, order)) goto done;
+        } while (BN_is_zero(k));
+        if (!EC_POINT_mul(s->group, point, k, NULL, NULL, ctx) ||
+            !EC_POINT_get_affine_coordinates(s->group, point, x, NULL, ctx) ||
+            !BN_nnmod(r, x, order, ctx))
+            goto done;
+        if (BN_is_zero(r)) continue;
+
+        // k^-1 by Fermat, n being prime, so the nonce is inverted in constant time
+        if (!BN_mod_exp_mont_consttime(k_inv, k, n_2, order, ctx, NULL) ||
+            !BN_mod_mul(sig, r, s->secret, order, ctx) ||
+            !BN_mod_add(sig, sig, z, order, ctx) ||
+            !BN_mod_mul(sig, sig, k_inv, order, ctx))
+            goto done;
+        if (BN_is_zero(sig)) continue;
+        if (BN_cmp(sig, half) > 0 && !BN_sub(sig, order, sig)) goto done;
+
+        if (BN_bn2binpad(r, r_bytes, 32) != 32 || BN_bn2binpad(sig, s_bytes, 32) != 32) goto done;
+        size_t body = der_integer(out + 2, r_bytes);
+        body += der_integer(out + 2 + body, s_bytes);
+        out[0] = 0x30;
+        out[1] = (uint8_t)body;
+        out_len = 2 + body;
+        break;
+    }
+
+done:
+    EC_POINT_free(point);
+    BN_free(z);
+    BN_clear_free(k);
+    BN_clear_free(k_inv);
+    BN_free(n_2);
+    BN_free(x);
+    BN_free(r);
+    BN_free(sig);
+    BN_free(half);
+    BN_CTX_free(ctx);
+    return out_len;
+}
+
+static size_t ed25519_sign(signer* s, const uint8_t* message, size_t len, uint8_t out[ED25519_SIGNATURE])
+{
+    size_t out_len = ED25519_SIGNATURE;
+    EVP_MD_CTX* md = EVP_MD_CTX_new();
+    int ok = md && EVP_DigestSignInit(md, NULL, NULL, NULL, s->ed_key) &&
+             EVP_DigestSign(md, out, &out_len, message, len);
+    EVP_MD_CTX_free(md);
+    return ok ? out_len : 0;
+}
+
+static void signer_free(signer* s)
+{
+    EVP_PKEY_free(s->ed_key);
+    BN_clear_free(s->secret);
+    EC_GROUP_free(s->group);
+    free(s);
+}
+
+static void signer_finalize(napi_env env, void* data, void* hint)
+{
+    (void)env;
+    (void)hint;
+    signer_free(data);
+}
+
+static int set_string(napi_env env, napi_value obj, const char* name, const char* s, size_t len)
+{
+    napi_value v;
+    return napi_create_string_latin1(env, s, len, &v) == napi_ok &&
+           napi_set_named_property(env, obj, name, v) == napi_ok;
+}
+
+static napi_value signer_new(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1], self;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, &self, NULL));
+
+    char seed[SEED_STRING_MAX];
+    size_t len;
+    if (argc < 1 || napi_get_value_string_utf8(env, argv[0], seed, sizeof(seed), &len) != napi_ok) {
+        napi_throw_type_error(env, NULL, "new TxSigner(seed)");
+        return NULL;
+    }
+
+    uint8_t payload[SEED_ENTROPY + 3];
+    size_t payload_len = base58check_decode(payload, sizeof(payload), seed, len);
+    OPENSSL_cleanse(seed, sizeof(seed));
+    int ed25519 = payload_len == SEED_ENTROPY + 3 && memcmp(payload, ED25519_SEED_PREFIX, 3) == 0;
+    if (!ed25519 && !(payload_len == SEED_ENTROPY + 1 && payload[0] == SECP256K1_SEED_VERSION)) {
+        OPENSSL_cleanse(payload, sizeof(payload));
+        napi_throw_type_error(env, NULL, "not a family seed");
+        return NULL;
+    }
+
+    signer* s = calloc(1, sizeof(signer));
+    if (!s) {
+        OPENSSL_cleanse(payload, sizeof(payload));
+        napi_throw_error(env, NULL, "out of memory");
+        return NULL;
+    }
+    s->ed25519 = ed25519;
+    const uint8_t* entropy = payload + payload_len - SEED_ENTROPY;
+    int ok = ed25519 ? ed25519_derive(s, entropy) : secp256k1_derive(s, entropy);
+    OPENSSL_cleanse(payload, sizeof(payload));
+    if (!ok) {
+        signer_free(s);
+        napi_throw_error(env, NULL, "key derivation failed");
+        return NULL;
+    }
+
+    // Account id = RIPEMD-160(SHA-256(public key))
+    uint8_t h[32], id[32];
+    unsigned int id_len = 0;
+    sha256(h, s->public_key, sizeof(s->public_key));
+    char address[ACCOUNT_ADDRESS_MAX];
+    size_t address_len = 0;
+    if (EVP_Digest(h, sizeof(h), id, &id_len, EVP_ripemd160(), NULL) && id_len == 20)
+        address_len = account_encode(address, id);
+
+    const char* algorithm = ed25519 ? "ed25519" : "secp256k1";
+    if (!address_len || addon_set_hex(env, self, "publicKey", s->public_key, 33) != napi_ok ||
+        !set_string(env, self, "address", address, address_len) ||
+        !set_string(env, self, "algorithm", algorithm, strlen(algorithm)) ||
+        napi_wrap(env, self, s, signer_finalize, NULL, NULL) != napi_ok) {
+        signer_free(s);
+        napi_throw_error(env, NULL, "cannot set up the signer");
+        return NULL;
+    }
+    return self;
+}
+
+static napi_value signer_sign(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1], self;
+    signer* s = NULL;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, &self, NULL));
+    if (napi_unwrap(env, self, (void**)&s) != napi_ok) {
+        napi_throw_type_error(env, NULL, "not a TxSigner");
+        return NULL;
+    }
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "sign(message)");
+        return NULL;
+    }
+    const uint8_t* message;
+    size_t len;
+    if (!addon_get_bytes(env, argv[0], &message, &len)) return NULL;
+
+    uint8_t signature[DER_SIGNATURE_MAX];
+    size_t signature_len = s->ed25519 ? ed25519_sign(s, message, len, signature)
+                                      : secp256k1_sign(s, message, len, signature);
+    if (!signature_len) {
+        napi_throw_error(env, NULL, "signing failed");
+        return NULL;
+    }
+
+    napi_value result;
+    void* out = NULL;
+    NAPI_CALL(env, napi_create_buffer_copy(env, signature_len, signature, &out, &result));
+    return result;
+}
+
+napi_value signer_init(napi_env env, napi_value exports)
+{
+    napi_property_descriptor methods[] = {
+        { "sign", NULL, signer_sign, NULL, NULL, NULL, napi_default, NULL }
+    };
+    napi_value cls;
+    NAPI_CALL(env, napi_define_class(env, "TxSigner", NAPI_AUTO_LENGTH, signer_new, NULL,
+                                     sizeof(methods) / sizeof(methods[0]), methods, &cls));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "TxSigner", cls));
+    return exports;
+}
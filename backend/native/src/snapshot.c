@@ -0,0 +1,539 @@
+// Memory-mapped snapshot of the claim hook's per-account state
+//
+// The backend keeps the state of every "DRIPPY:CLAIM" + account entry of the claim hook
+// (src/drippy_enhanced_claim.c) in one file, so balance reads are served from mapped
+// memory instead of a ledger request. File layout, integers big-endian like hook state:
+//   [0..8)    "DRIPSNAP"
+//   [8..12)   record size, 52
+//   [12..16)  record count
+//   [16..20)  ledger the snapshot is current to
+//   [20..28)  change log cursor (hooks/include/drippy_changes.h) to refresh from
+//   [28..64)  zero
+//   [64..)    records sorted by account: 20-byte account id, then the 32-byte state
+//             (accrued, last claim, claim count, boost, daily claimed)
+//
+// On open an index of the first record for each leading two bytes of the account is
+// built, so a lookup is a binary search over the few records of one bucket. apply()
+// writes the states that changed in a ledger: accounts already present are overwritten
+// in place, new ones are merged into a fresh file that replaces the old one by rename.
+// The header goes last, and every entry is a whole state, so applying a batch again
+// after a crash gives the same file. One process owns the file; another process
+// opening it sees a consistent copy as of the last rename.
+//
+//   new ClaimSnapshot(path)            opens the snapshot, creating an empty one
+//   get(account)     -> { accrued, lastClaim, claimCount, boost, dailyClaimed } or null
+//   record(account)  -> the 32-byte state as a Buffer, or null
+//   apply(records, { ledger, cursor, replace }) -> { updated, inserted }
+//   info()           -> { count, ledger, cursor }
+//   close()
+//
+// account is a classic address, 40 hex digits or a 20-byte Buffer. records is a Buffer
+// of 52-byte account + state entries; with `replace` they become the whole snapshot.
+// A later entry for the same account wins.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "addon.h"
+#include "base58.h"
+
+#define SNAPSHOT_MAGIC "DRIPSNAP"
+#define SNAPSHOT_HEADER_SIZE 64
+#define SNAPSHOT_RECORD_SIZE 52
+#define SNAPSHOT_STATE_SIZE 32
+#define SNAPSHOT_BUCKETS 65536
+
+typedef struct {
+    char* path;
+    int fd;
+    uint8_t* map;
+    size_t map_len;
+    uint32_t count;
+    uint32_t index[SNAPSHOT_BUCKETS + 1];   // first record of each two-byte prefix
+} snapshot;
+
+static uint32_t load_u32(const uint8_t* b)
+{
+    return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+}
+
+static uint64_t load_u64(const uint8_t* b)
+{
+    return ((uint64_t)load_u32(b) << 32) | load_u32(b + 4);
+}
+
+static void store_u32(uint8_t* b, uint32_t v)
+{
+    b[0] = (uint8_t)(v >> 24);
+    b[1] = (uint8_t)(v >> 16);
+    b[2] = (uint8_t)(v >> 8);
+    b[3] = (uint8_t)v;
+}
+
+static void store_u64(uint8_t* b, uint64_t v)
+{
+    store_u32(b, (uint32_t)(v >> 32));
+    store_u32(b + 4, (uint32_t)v);
+}
+
+static uint8_t* records_of(const snapshot* s)
+{
+    return s->map + SNAPSHOT_HEADER_SIZE;
+}
+
+static void snapshot_unmap(snapshot* s)
+{
+    if (s->map) munmap(s->map, s->map_len);
+    if (s->fd >= 0) close(s->fd);
+    s->map = NULL;
+    s->fd = -1;
+    s->count = 0;
+}
+
+// Maps the file at s->path and indexes it; NULL on success, else the reason
+static const char* snapshot_map(snapshot* s)
+{
+    struct stat st;
+    s->fd = open(s->path, O_RDWR);
+    if (s->fd < 0) return "cannot open the snapshot file";
+    if (fstat(s->fd, &st) != 0 || (size_t)st.st_size < SNAPSHOT_HEADER_SIZE) {
+        snapshot_unmap(s);
+        return "not a claim snapshot";
+    }
+
+    s->map_len = (size_t)st.st_size;
+    s->map = mmap(NULL, s->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, s->fd, 0);
+    if (s->map == MAP_FAILED) {
+        s->map = NULL;
+        snapshot_unmap(s);
+        return "cannot map the snapshot file";
+    }
+
+    uint32_t count = load_u32(s->map + 12);
+    if (memcmp(s->map, SNAPSHOT_MAGIC, 8) != 0 || load_u32(s->map + 8) != SNAPSHOT_RECORD_SIZE ||
+        s->map_len != SNAPSHOT_HEADER_SIZE + (size_t)count * SNAPSHOT_RECORD_SIZE) {
+        snapshot_unmap(s);
+        return "not a claim snapshot";
+    }
+    s->count = count;
+
+    const uint8_t* r = records_of(s);
+    uint32_t i = 0;
+    for (uint32_t b = 0; b < SNAPSHOT_BUCKETS; b++) {
+        while (i < count && (uint32_t)((r[(size_t)i * SNAPSHOT_RECORD_SIZE] << 8) |
+                                       r[(size_t)i * SNAPSHOT_RECORD_SIZE + 1]) < b)
+            i++;
+        s->index[b] = i;
+    }
+    s->index[SNAPSHOT_BUCKETS] = count;
+    return NULL;
+}
+
+static uint8_t* snapshot_find(const snapshot* s, const uint8_t id[20])
+{
+    uint32_t b = ((uint32_t)id[0] << 8) | id[1];
+    uint32_t lo = s->index[b], hi = s->index[b + 1];
+    uint8_t* r = records_of(s);
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int c = memcmp(r + (size_t)mid * SNAPSHOT_RECORD_SIZE, id, 20);
+        if (c == 0) return r + (size_t)mid * SNAPSHOT_RECORD_SIZE;
+        if (c < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return NULL;
+}
+
+static int compare_entries(const void* a, const void* b)
+{
+    const uint8_t* x = *(const uint8_t* const*)a;
+    const uint8_t* y = *(const uint8_t* const*)b;
+    int c = memcmp(x, y, 20);
+    if (c) return c;
+    return x < y ? -1 : x > y;
+}
+
+// Sorts entries by account, input order breaking ties, and keeps the last of each account
+static size_t sort_entries(const uint8_t** entries, size_t n)
+{
+    size_t kept = 0;
+    qsort(entries, n, sizeof(*entries), compare_entries);
+    for (size_t i = 0; i < n; i++) {
+        if (i + 1 < n && memcmp(entries[i], entries[i + 1], 20) == 0) continue;
+        entries[kept++] = entries[i];
+    }
+    return kept;
+}
+
+// Writes `old` (count records, sorted) merged with the sorted `added` entries to
+// path.tmp and renames it over the snapshot; the new states win on equal accounts
+static int snapshot_write(const char* path, const uint8_t* old, uint32_t count,
+                          const uint8_t** added, size_t n, uint32_t ledger, uint64_t cursor)
+{
+    size_t path_len = strlen(path);
+    char* tmp = malloc(path_len + 5);
+    if (!tmp) return 0;
+    memcpy(tmp, path, path_len);
+    memcpy(tmp + path_len, ".tmp", 5);
+
+    FILE* f = fopen(tmp, "wb");
+    if (!f) {
+        free(tmp);
+        return 0;
+    }
+
+    uint8_t header[SNAPSHOT_HEADER_SIZE] = { 0 };
+    int ok = fwrite(header, 1, sizeof(header), f) == sizeof(header);
+
+    size_t i = 0, j = 0, total = 0;
+    while (ok && (i < count || j < n)) {
+        const uint8_t* r;
+        if (j == n) r = old + i++ * SNAPSHOT_RECORD_SIZE;
+        else if (i == count) r = added[j++];
+        else {
+            int c = memcmp(old + i * SNAPSHOT_RECORD_SIZE, added[j], 20);
+            if (c < 0) r = old + i++ * SNAPSHOT_RECORD_SIZE;
+            else {
+                if (c == 0) i++;
+                r = added[j++];
+            }
+        }
+        ok = fwrite(r, 1, SNAPSHOT_RECORD_SIZE, f) == SNAPSHOT_RECORD_SIZE;
+        total++;
+    }
+    ok = ok && total <= UINT32_MAX;
+
+    memcpy(header, SNAPSHOT_MAGIC, 8);
+    store_u32(header + 8, SNAPSHOT_RECORD_SIZE);
+    store_u32(header + 12, (uint32_t)total);
+    store_u32(header + 16, ledger);
+    store_u64(header + 20, cursor);
+    ok = ok && fseek(f, 0, SEEK_SET) == 0 && fwrite(header, 1, sizeof(header), f) == sizeof(header);
+    ok = ok && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    ok = (fclose(f) == 0) && ok;
+    ok = ok && rename(tmp, path) == 0;
+    if (!ok) unlink(tmp);
+    free(tmp);
+    return ok;
+}
+
+static void snapshot_finalize(napi_env env, void* data, void* hint)
+{
+    snapshot* s = data;
+    (void)env;
+    (void)hint;
+    snapshot_unmap(s);
+    free(s->path);
+    free(s);
+}
+
+// The snapshot behind `this`; throws when it has been closed
+static snapshot* get_this(napi_env env, napi_callback_info info, size_t* argc, napi_value* argv)
+{
+    napi_value self;
+    snapshot* s = NULL;
+    if (napi_get_cb_info(env, info, argc, argv, &self, NULL) != napi_ok ||
+        napi_unwrap(env, self, (void**)&s) != napi_ok) {
+        napi_throw_type_error(env, NULL, "not a ClaimSnapshot");
+        return NULL;
+    }
+    if (!s->map) {
+        napi_throw_error(env, NULL, "snapshot is closed");
+        return NULL;
+    }
+    return s;
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int get_account_id(napi_env env, napi_value value, uint8_t id[20])
+{
+    napi_valuetype type;
+    if (napi_typeof(env, value, &type) == napi_ok && type == napi_string) {
+        char s[64];
+        size_t len;
+        if (napi_get_value_string_utf8(env, value, s, sizeof(s), &len) == napi_ok) {
+            if (len == 40) {
+                int ok = 1;
+                for (size_t i = 0; i < 20 && ok; i++) {
+                    int hi = hex_value(s[2 * i]), lo = hex_value(s[2 * i + 1]);
+                    ok = hi >= 0 && lo >= 0;
+                    id[i] = (uint8_t)(hi << 4 | lo);
+                }
+                if (ok) return 1;
+            } else if (accounts_decode(env, id, s, len)) {
+                return 1;
+            }
+        }
+    } else {
+        const uint8_t* data;
+        size_t len;
+        if (!addon_get_bytes(env, value, &data, &len)) return 0;
+        if (len == 20) {
+            memcpy(id, data, 20);
+            return 1;
+        }
+    }
+    napi_throw_type_error(env, NULL, "account must be a classic address, 40 hex digits or 20 bytes");
+    return 0;
+}
+
+static napi_value snapshot_new(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1], self;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, &self, NULL));
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "new ClaimSnapshot(path)");
+        return NULL;
+    }
+
+    size_t len;
+    if (napi_get_value_string_utf8(env, argv[0], NULL, 0, &len) != napi_ok) {
+        napi_throw_type_error(env, NULL, "path must be a string");
+        return NULL;
+    }
+    snapshot* s = calloc(1, sizeof(snapshot));
+    if (s) s->path = malloc(len + 1);
+    if (!s || !s->path) {
+        free(s);
+        napi_throw_error(env, NULL, "out of memory");
+        return NULL;
+    }
+    s->fd = -1;
+    napi_get_value_string_utf8(env, argv[0], s->path, len + 1, &len);
+
+    const char* error = NULL;
+    if (access(s->path, F_OK) != 0 && errno == ENOENT &&
+        !snapshot_write(s->path, NULL, 0, NULL, 0, 0, 0))
+        error = "cannot create the snapshot file";
+    if (!error) error = snapshot_map(s);
+    if (error || napi_wrap(env, self, s, snapshot_finalize, NULL, NULL) != napi_ok) {
+        snapshot_unmap(s);
+        free(s->path);
+        free(s);
+        napi_throw_error(env, NULL, error ? error : "N-API call failed: napi_wrap");
+        return NULL;
+    }
+    return self;
+}
+
+static napi_value snapshot_get(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1] = { NULL }, result;
+    snapshot* s = get_this(env, info, &argc, argv);
+    uint8_t id[20];
+    if (!s) return NULL;
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "get(account)");
+        return NULL;
+    }
+    if (!get_account_id(env, argv[0], id)) return NULL;
+
+    const uint8_t* r = snapshot_find(s, id);
+    if (!r) {
+        NAPI_CALL(env, napi_get_null(env, &result));
+        return result;
+    }
+    r += 20;
+
+    napi_value v;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    NAPI_CALL(env, napi_create_bigint_uint64(env, load_u64(r), &v));
+    NAPI_CALL(env, napi_set_named_property(env, result, "accrued", v));
+    NAPI_CALL(env, napi_create_double(env, (double)load_u64(r + 8), &v));
+    NAPI_CALL(env, napi_set_named_property(env, result, "lastClaim", v));
+    NAPI_CALL(env, addon_set_u32(env, result, "claimCount", load_u32(r + 16)));
+    NAPI_CALL(env, addon_set_u32(env, result, "boost", load_u32(r + 20)));
+    NAPI_CALL(env, napi_create_bigint_uint64(env, load_u64(r + 24), &v));
+    NAPI_CALL(env, napi_set_named_property(env, result, "dailyClaimed", v));
+    return result;
+}
+
+static napi_value snapshot_record(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1] = { NULL }, result;
+    snapshot* s = get_this(env, info, &argc, argv);
+    uint8_t id[20];
+    if (!s) return NULL;
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "record(account)");
+        return NULL;
+    }
+    if (!get_account_id(env, argv[0], id)) return NULL;
+
+    const uint8_t* r = snapshot_find(s, id);
+    if (!r) {
+        NAPI_CALL(env, napi_get_null(env, &result));
+        return result;
+    }
+    NAPI_CALL(env, napi_create_buffer_copy(env, SNAPSHOT_STATE_SIZE, r + 20, NULL, &result));
+    return result;
+}
+
+// Reads { ledger, cursor, replace }; missing fields keep their defaults
+static int read_apply_options(napi_env env, napi_value options, uint32_t* ledger,
+                              uint64_t* cursor, int* replace)
+{
+    napi_valuetype type;
+    if (napi_typeof(env, options, &type) != napi_ok) return 0;
+    if (type == napi_undefined || type == napi_null) return 1;
+    if (type != napi_object) {
+        napi_throw_type_error(env, NULL, "options must be an object");
+        return 0;
+    }
+
+    napi_value v;
+    bool has = false;
+    if (napi_has_named_property(env, options, "ledger", &has) == napi_ok && has) {
+        napi_get_named_property(env, options, "ledger", &v);
+        if (napi_get_value_uint32(env, v, ledger) != napi_ok) {
+            napi_throw_type_error(env, NULL, "ledger must be a ledger index");
+            return 0;
+        }
+    }
+    if (napi_has_named_property(env, options, "cursor", &has) == napi_ok && has) {
+        double d = -1;
+        napi_get_named_property(env, options, "cursor", &v);
+        if (napi_get_value_double(env, v, &d) != napi_ok || d < 0 || d > 9007199254740991.0 ||
+            d != (double)(uint64_t)d) {
+            napi_throw_range_error(env, NULL, "cursor must be a non-negative integer");
+            return 0;
+        }
+        *cursor = (uint64_t)d;
+    }
+    if (napi_has_named_property(env, options, "replace", &has) == napi_ok && has) {
+        bool b = false;
+        napi_get_named_property(env, options, "replace", &v);
+        if (napi_get_value_bool(env, v, &b) != napi_ok) {
+            napi_throw_type_error(env, NULL, "replace must be a boolean");
+            return 0;
+        }
+        *replace = b;
+    }
+    return 1;
+}
+
+static napi_value snapshot_apply(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value argv[2] = { NULL, NULL };
+    snapshot* s = get_this(env, info, &argc, argv);
+    if (!s) return NULL;
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "apply(records, options?)");
+        return NULL;
+    }
+
+    const uint8_t* data;
+    size_t len;
+    if (!addon_get_bytes(env, argv[0], &data, &len)) return NULL;
+    if (len % SNAPSHOT_RECORD_SIZE != 0) {
+        napi_throw_range_error(env, NULL, "records must be a multiple of 52 bytes");
+        return NULL;
+    }
+
+    uint32_t ledger = load_u32(s->map + 16);
+    uint64_t cursor = load_u64(s->map + 20);
+    int replace = 0;
+    if (argc > 1 && !read_apply_options(env, argv[1], &ledger, &cursor, &replace)) return NULL;
+
+    size_t n = len / SNAPSHOT_RECORD_SIZE;
+    const uint8_t** added = malloc((n ? n : 1) * sizeof(*added));
+    if (!added) {
+        napi_throw_error(env, NULL, "out of memory");
+        return NULL;
+    }
+
+    uint32_t updated = 0;
+    size_t inserts = 0;
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t* entry = data + i * SNAPSHOT_RECORD_SIZE;
+        uint8_t* r = replace ? NULL : snapshot_find(s, entry);
+        if (r) {
+            memcpy(r + 20, entry + 20, SNAPSHOT_STATE_SIZE);
+            updated++;
+        } else {
+            added[inserts++] = entry;
+        }
+    }
+    inserts = sort_entries(added, inserts);
+
+    if (replace || inserts) {
+        int ok = snapshot_write(s->path, records_of(s), replace ? 0 : s->count, added, inserts,
+                                ledger, cursor);
+        free(added);
+        snapshot_unmap(s);
+        const char* error = snapshot_map(s);
+        if (!ok || error) {
+            napi_throw_error(env, NULL, ok ? error : "cannot write the snapshot file");
+            return NULL;
+        }
+    } else {
+        free(added);
+        store_u32(s->map + 16, ledger);
+        store_u64(s->map + 20, cursor);
+    }
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    NAPI_CALL(env, addon_set_u32(env, result, "updated", updated));
+    NAPI_CALL(env, addon_set_u32(env, result, "inserted", (uint32_t)inserts));
+    return result;
+}
+
+static napi_value snapshot_info(napi_env env, napi_callback_info info)
+{
+    size_t argc = 0;
+    snapshot* s = get_this(env, info, &argc, NULL);
+    if (!s) return NULL;
+
+    napi_value result, cursor;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    NAPI_CALL(env, addon_set_u32(env, result, "count", s->count));
+    NAPI_CALL(env, addon_set_u32(env, result, "ledger", load_u32(s->map + 16)));
+    NAPI_CALL(env, napi_create_double(env, (double)load_u64(s->map + 20), &cursor));
+    NAPI_CALL(env, napi_set_named_property(env, result, "cursor", cursor));
+    return result;
+}
+
+static napi_value snapshot_close(napi_env env, napi_callback_info info)
+{
+    size_t argc = 0;
+    napi_value self, result;
+    snapshot* s = NULL;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, NULL, &self, NULL));
+    if (napi_unwrap(env, self, (void**)&s) == napi_ok) snapshot_unmap(s);
+    NAPI_CALL(env, napi_get_undefined(env, &result));
+    return result;
+}
+
+napi_value snapshot_init(napi_env env, napi_value exports)
+{
+    napi_property_descriptor methods[] = {
+        { "get", NULL, snapshot_get, NULL, NULL, NULL, napi_default, NULL },
+        { "record", NULL, snapshot_record, NULL, NULL, NULL, napi_default, NULL },
+        { "apply", NULL, snapshot_apply, NULL, NULL, NULL, napi_default, NULL },
+        { "info", NULL, snapshot_info, NULL, NULL, NULL, napi_default, NULL },
+        { "close", NULL, snapshot_close, NULL, NULL, NULL, napi_default, NULL }
+    };
+    napi_value cls;
+    NAPI_CALL(env, napi_define_class(env, "ClaimSnapshot", NAPI_AUTO_LENGTH, snapshot_new, NULL,
+                                     sizeof(methods) / sizeof(methods[0]), methods, &cls));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "ClaimSnapshot", cls));
+    return exports;
+}
@@ -0,0 +1,669 @@
+// XRPL binary serialization over the sfcodes.h field table
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sfcodes.h"
+#include "stcodec.h"
+#include "stfields.h"
+
+#define MAX_DEPTH 32
+
+#define FIELD_DEF(sf) { #sf + 2, sf },
+static st_field_def by_code[] = { ST_FIELDS(FIELD_DEF) };
+static const st_field_def* by_name[sizeof(by_code) / sizeof(by_code[0])];
+static const size_t field_count = sizeof(by_code) / sizeof(by_code[0]);
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+// Codes of the tt* constants in hooks/carbon/macro.h
+static const struct {
+    uint16_t code;
+    const char* name;
+} tx_types[] = {
+    { 0, "Payment" },
+    { 1, "EscrowCreate" },
+    { 2, "EscrowFinish" },
+    { 3, "AccountSet" },
+    { 4, "EscrowCancel" },
+    { 5, "SetRegularKey" },
+    { 7, "OfferCreate" },
+    { 8, "OfferCancel" },
+    { 10, "TicketCreate" },
+    { 12, "SignerListSet" },
+    { 13, "PaymentChannelCreate" },
+    { 14, "PaymentChannelFund" },
+    { 15, "PaymentChannelClaim" },
+    { 16, "CheckCreate" },
+    { 17, "CheckCash" },
+    { 18, "CheckCancel" },
+    { 19, "DepositPreauth" },
+    { 20, "TrustSet" },
+    { 21, "AccountDelete" },
+    { 22, "SetHook" },
+    { 25, "NFTokenMint" },
+    { 26, "NFTokenBurn" },
+    { 27, "NFTokenCreateOffer" },
+    { 28, "NFTokenCancelOffer" },
+    { 29, "NFTokenAcceptOffer" },
+    { 45, "URITokenMint" },
+    { 46, "URITokenBurn" },
+    { 47, "URITokenBuy" },
+    { 48, "URITokenCreateSellOffer" },
+    { 49, "URITokenCancelSellOffer" },
+    { 98, "ClaimReward" },
+    { 99, "Invoke" },
+    { 100, "EnableAmendment" },
+    { 101, "SetFee" },
+    { 102, "UNLModify" },
+    { 103, "EmitFailure" }
+};
+
+static int compare_code(const void* a, const void* b)
+{
+    uint32_t x = ((const st_field_def*)a)->code;
+    uint32_t y = ((const st_field_def*)b)->code;
+    return x < y ? -1 : x > y;
+}
+
+static int compare_name(const void* a, const void* b)
+{
+    return strcmp((*(const st_field_def* const*)a)->name, (*(const st_field_def* const*)b)->name);
+}
+
+static void build_tables(void)
+{
+    qsort(by_code, field_count, sizeof(by_code[0]), compare_code);
+    for (size_t i = 0; i < field_count; i++)
+        by_name[i] = &by_code[i];
+    qsort(by_name, field_count, sizeof(by_name[0]), compare_name);
+}
+
+const st_field_def* st_fields(size_t* count)
+{
+    pthread_once(&tables_once, build_tables);
+    *count = field_count;
+    return by_code;
+}
+
+const st_field_def* st_field_by_code(uint32_t code)
+{
+    pthread_once(&tables_once, build_tables);
+    size_t lo = 0, hi = field_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (by_code[mid].code == code) return &by_code[mid];
+        if (by_code[mid].code < code) lo = mid + 1;
+        else hi = mid;
+    }
+    return NULL;
+}
+
+const st_field_def* st_field_by_name(const char* name, size_t len)
+{
+    pthread_once(&tables_once, build_tables);
+    size_t lo = 0, hi = field_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const char* s = by_name[mid]->name;
+        int cmp = strncmp(s, name, len);
+        if (cmp == 0 && s[len] != 0) cmp = 1;
+        if (cmp == 0) return by_name[mid];
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return NULL;
+}
+
+const char* st_tx_type_name(uint16_t type)
+{
+    for (size_t i = 0; i < sizeof(tx_types) / sizeof(tx_types[0]); i++)
+        if (tx_types[i].code == type) return tx_types[i].name;
+    return NULL;
+}
+
+int st_tx_type_code(const char* name, size_t len)
+{
+    for (size_t i = 0; i < sizeof(tx_types) / sizeof(tx_types[0]); i++)
+        if (strlen(tx_types[i].name) == len && memcmp(tx_types[i].name, name, len) == 0)
+            return tx_types[i].code;
+    return -1;
+}
+
+size_t st_read_vl(const uint8_t* p, const uint8_t* end, size_t* len)
+{
+    if (p >= end) return 0;
+    uint8_t b0 = p[0];
+    if (b0 <= 192) {
+        *len = b0;
+        return 1;
+    }
+    if (b0 <= 240) {
+        if (end - p < 2) return 0;
+        *len = 193 + ((size_t)(b0 - 193) << 8) + p[1];
+        return 2;
+    }
+    if (b0 <= 254) {
+        if (end - p < 3) return 0;
+        *len = 12481 + ((size_t)(b0 - 241) << 16) + ((size_t)p[1] << 8) + p[2];
+        return 3;
+    }
+    return 0;
+}
+
+// Length of a path set, through its 0x00 terminator
+static const uint8_t* skip_pathset(const uint8_t* p, const uint8_t* end)
+{
+    while (p < end) {
+        uint8_t t = *p++;
+        if (t == 0x00) return p;
+        if (t == 0xFF) continue;
+        size_t n = ((t & 0x01) ? 20 : 0) + ((t & 0x10) ? 20 : 0) + ((t & 0x20) ? 20 : 0);
+        if ((size_t)(end - p) < n) return NULL;
+        p += n;
+    }
+    return NULL;
+}
+
+static const uint8_t* parse_field(const uint8_t* p, const uint8_t* end, st_field* f, int depth);
+
+// Walks the fields of an object or array up to its end marker; returns the marker
+static const uint8_t* find_end(const uint8_t* p, const uint8_t* end, uint8_t marker, int depth)
+{
+    if (depth > MAX_DEPTH) return NULL;
+    st_field inner;
+    while (p < end) {
+        if (*p == marker) return p;
+        if (*p == ST_OBJECT_END || *p == ST_ARRAY_END) return NULL;
+        p = parse_field(p, end, &inner, depth + 1);
+        if (!p) return NULL;
+    }
+    return NULL;
+}
+
+// One field at p; returns the position after it, NULL when malformed
+static const uint8_t* parse_field(const uint8_t* p, const uint8_t* end, st_field* f, int depth)
+{
+    if (p >= end) return NULL;
+    uint32_t type = p[0] >> 4, nth = p[0] & 0x0F;
+    p++;
+    if (type == 0) {
+        if (p >= end) return NULL;
+        type = *p++;
+    }
+    if (nth == 0) {
+        if (p >= end) return NULL;
+        nth = *p++;
+    }
+    f->code = ST_CODE(type, nth);
+
+    size_t n, avail = (size_t)(end - p);
+    const uint8_t* marker;
+    switch (type) {
+    case ST_UINT8: n = 1; break;
+    case ST_UINT16: n = 2; break;
+    case ST_UINT32: n = 4; break;
+    case ST_UINT64: n = 8; break;
+    case ST_HASH128: n = 16; break;
+    case ST_HASH160_SF:
+    case ST_HASH160: n = 20; break;
+    case ST_HASH256: n = 32; break;
+    case ST_AMOUNT:
+        if (avail < 1) return NULL;
+        n = (p[0] & 0x80) ? 48 : 8;
+        break;
+    case ST_VL:
+    case ST_ACCOUNT:
+    case ST_VECTOR256: {
+        size_t prefix = st_read_vl(p, end, &n);
+        if (!prefix) return NULL;
+        p += prefix;
+        avail -= prefix;
+        break;
+    }
+    case ST_OBJECT:
+    case ST_ARRAY:
+        marker = find_end(p, end, type == ST_OBJECT ? ST_OBJECT_END : ST_ARRAY_END, depth);
+        if (!marker) return NULL;
+        f->data = p;
+        f->len = (size_t)(marker - p);
+        return marker + 1;
+    case ST_PATHSET: {
+        const uint8_t* after = skip_pathset(p, end);
+        if (!after) return NULL;
+        f->data = p;
+        f->len = (size_t)(after - p);
+        return after;
+    }
+    default:
+        return NULL;
+    }
+    if (avail < n) return NULL;
+    f->data = p;
+    f->len = n;
+    return p + n;
+}
+
+int st_next(st_reader* r, st_field* f)
+{
+    if (r->p >= r->end || *r->p == ST_OBJECT_END || *r->p == ST_ARRAY_END) return ST_END;
+    const uint8_t* next = parse_field(r->p, r->end, f, 0);
+    if (!next) return ST_ERROR;
+    r->p = next;
+    return ST_OK;
+}
+
+int st_find(const uint8_t* data, size_t len, uint32_t code, st_field* f)
+{
+    st_reader r;
+    int status;
+    st_reader_init(&r, data, len);
+    while ((status = st_next(&r, f)) == ST_OK)
+        if (f->code == code) return ST_OK;
+    return status;
+}
+
+size_t st_header_size(uint32_t code)
+{
+    return 1 + (ST_TYPE(code) >= 16) + (ST_NTH(code) >= 16);
+}
+
+size_t st_write_header(uint8_t* out, uint32_t code)
+{
+    uint32_t type = ST_TYPE(code), nth = ST_NTH(code);
+    if (type < 16 && nth < 16) {
+        out[0] = (uint8_t)(type << 4 | nth);
+        return 1;
+    }
+    if (type < 16) {
+        out[0] = (uint8_t)(type << 4);
+        out[1] = (uint8_t)nth;
+        return 2;
+    }
+    if (nth < 16) {
+        out[0] = (uint8_t)nth;
+        out[1] = (uint8_t)type;
+        return 2;
+    }
+    out[0] = 0;
+    out[1] = (uint8_t)type;
+    out[2] = (uint8_t)nth;
+    return 3;
+}
+
+void st_writer_init(st_writer* w)
+{
+    w->data = NULL;
+    w->len = 0;
+    w->cap = 0;
+    w->failed = 0;
+}
+
+void st_writer_free(st_writer* w)
+{
+    free(w->data);
+    st_writer_init(w);
+}
+
+static uint8_t* reserve(st_writer* w, size_t n)
+{
+    if (w->failed) return NULL;
+    if (w->len + n > w->cap) {
+        size_t cap = w->cap ? w->cap * 2 : 256;
+        while (cap < w->len + n)
+            cap *= 2;
+        uint8_t* data = realloc(w->data, cap);
+        if (!data) {
+            w->failed = 1;
+            return NULL;
+        }
+        w->data = data;
+        w->cap = cap;
+    }
+    uint8_t* p = w->data + w->len;
+    w->len += n;
+    return p;
+}
+
+void st_put_raw(st_writer* w, const void* data, size_t len)
+{
+    uint8_t* p = reserve(w, len);
+    if (p && len) memcpy(p, data, len);
+}
+
+void st_put_header(st_writer* w, uint32_t code)
+{
+    uint8_t header[3];
+    st_put_raw(w, header, st_write_header(header, code));
+}
+
+void st_put_uint(st_writer* w, uint32_t code, uint64_t v)
+{
+    size_t n;
+    switch (ST_TYPE(code)) {
+    case ST_UINT8: n = 1; break;
+    case ST_UINT16: n = 2; break;
+    case ST_UINT32: n = 4; break;
+    case ST_UINT64: n = 8; break;
+    default: w->failed = 1; return;
+    }
+    if (n < 8 && v >> (8 * n)) {
+        w->failed = 1;
+        return;
+    }
+    st_put_header(w, code);
+    uint8_t* p = reserve(w, n);
+    if (!p) return;
+    for (size_t i = 0; i < n; i++)
+        p[i] = (uint8_t)(v >> (8 * (n - 1 - i)));
+}
+
+void st_put_bytes(st_writer* w, uint32_t code, const void* data, size_t len)
+{
+    st_put_header(w, code);
+    st_put_raw(w, data, len);
+}
+
+void st_put_vl(st_writer* w, uint32_t code, const void* data, size_t len)
+{
+    uint8_t prefix[3];
+    size_t n;
+    if (len <= 192) {
+        prefix[0] = (uint8_t)len;
+        n = 1;
+    } else if (len <= 12480) {
+        size_t v = len - 193;
+        prefix[0] = (uint8_t)(193 + (v >> 8));
+        prefix[1] = (uint8_t)v;
+        n = 2;
+    } else if (len <= 918744) {
+        size_t v = len - 12481;
+        prefix[0] = (uint8_t)(241 + (v >> 16));
+        prefix[1] = (uint8_t)(v >> 8);
+        prefix[2] = (uint8_t)v;
+        n = 3;
+    } else {
+        w->failed = 1;
+        return;
+    }
+    st_put_header(w, code);
+    st_put_raw(w, prefix, n);
+    st_put_raw(w, data, len);
+}
+
+void st_put_drops(st_writer* w, uint32_t code, uint64_t drops)
+{
+    if (drops > 100000000000000000ULL) {
+        w->failed = 1;
+        return;
+    }
+    uint8_t b[8];
+    uint64_t raw = drops | (1ULL << 62);
+    for (int i = 0; i < 8; i++)
+        b[i] = (uint8_t)(raw >> (56 - 8 * i));
+    st_put_bytes(w, code, b, 8);
+}
+
+void st_put_iou(st_writer* w, uint32_t code, int64_t xfl, const uint8_t currency[20],
+                const uint8_t issuer[20])
+{
+    if (xfl < 0) {
+        w->failed = 1;
+        return;
+    }
+    uint8_t b[48];
+    uint64_t raw = (uint64_t)xfl | (1ULL << 63);
+    for (int i = 0; i < 8; i++)
+        b[i] = (uint8_t)(raw >> (56 - 8 * i));
+    memcpy(b + 8, currency, 20);
+    memcpy(b + 28, issuer, 20);
+    st_put_bytes(w, code, b, 48);
+}
+
+void st_put_end(st_writer* w, uint32_t container_type)
+{
+    uint8_t marker = container_type == ST_ARRAY ? ST_ARRAY_END : ST_OBJECT_END;
+    st_put_raw(w, &marker, 1);
+}
+
+static uint64_t load_u64(const uint8_t* b)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+        v = v << 8 | b[i];
+    return v;
+}
+
+int st_amount_is_native(const uint8_t* amount)
+{
+    return !(amount[0] & 0x80);
+}
+
+uint64_t st_amount_drops(const uint8_t* amount)
+{
+    return load_u64(amount) & 0x3FFFFFFFFFFFFFFFULL;
+}
+
+int st_amount_negative(const uint8_t* amount)
+{
+    return !(amount[0] & 0x40);
+}
+
+int64_t st_amount_xfl(const uint8_t* amount)
+{
+    uint64_t raw = load_u64(amount);
+    if ((raw & ((1ULL << 54) - 1)) == 0) return 0;
+    return (int64_t)(raw & ~(1ULL << 63));
+}
+
+#define XFL_MANT_MIN 1000000000000000ULL
+#define XFL_MANT_MAX 9999999999999999ULL
+
+typedef unsigned __int128 u128;
+
+static int64_t xfl_make(int negative, int exponent, u128 mantissa)
+{
+    if (mantissa == 0) return 0;
+    while (mantissa > XFL_MANT_MAX) {
+        mantissa /= 10;
+        exponent++;
+    }
+    while (mantissa < XFL_MANT_MIN) {
+        mantissa *= 10;
+        exponent--;
+    }
+    if (exponent < -96) return 0;
+    if (exponent > 80) exponent = 80;     // saturate; ledger amounts never get there
+    return (int64_t)((negative ? 0 : (1ULL << 62)) | ((uint64_t)(exponent + 97) << 54) |
+                     (uint64_t)mantissa);
+}
+
+int64_t st_xfl_negate(int64_t a)
+{
+    if (a <= 0) return 0;
+    return (int64_t)((uint64_t)a ^ (1ULL << 62));
+}
+
+int64_t st_xfl_sum(int64_t a, int64_t b)
+{
+    uint64_t ma = (uint64_t)a & ((1ULL << 54) - 1), mb = (uint64_t)b & ((1ULL << 54) - 1);
+    if (a <= 0 || ma == 0) return b > 0 && mb ? b : 0;
+    if (b <= 0 || mb == 0) return a;
+
+    int ea = (int)(((uint64_t)a >> 54) & 0xFF) - 97, eb = (int)(((uint64_t)b >> 54) & 0xFF) - 97;
+    int na = !((uint64_t)a & (1ULL << 62)), nb = !((uint64_t)b & (1ULL << 62));
+    if (ea < eb) {
+        uint64_t tm = ma; ma = mb; mb = tm;
+        int te = ea; ea = eb; eb = te;
+        int tn = na; na = nb; nb = tn;
+    }
+    if (ea - eb > 19) return xfl_make(na, ea, ma);
+
+    u128 x = ma, y = mb;
+    for (int i = 0; i < ea - eb; i++)
+        x *= 10;
+    if (na == nb) return xfl_make(na, eb, x + y);
+    if (x >= y) return xfl_make(na, eb, x - y);
+    return xfl_make(nb, eb, y - x);
+}
+
+size_t st_xfl_to_string(char out[ST_XFL_STRING_MAX], int64_t xfl)
+{
+    uint64_t mantissa = (uint64_t)xfl & ((1ULL << 54) - 1);
+    if (xfl <= 0 || mantissa == 0) {
+        out[0] = '0';
+        out[1] = 0;
+        return 1;
+    }
+    int exponent = (int)(((uint64_t)xfl >> 54) & 0xFF) - 97;
+    while (mantissa % 10 == 0) {
+        mantissa /= 10;
+        exponent++;
+    }
+
+    char digits[20];
+    int n = 0;
+    for (uint64_t m = mantissa; m; m /= 10)
+        digits[n++] = (char)('0' + m % 10);
+
+    size_t len = 0;
+    if (!((uint64_t)xfl & (1ULL << 62))) out[len++] = '-';
+    int point = n + exponent;     // digits before the decimal point
+    if (exponent >= 0 && point <= 28) {
+        while (n) out[len++] = digits[--n];
+        for (int i = 0; i < exponent; i++) out[len++] = '0';
+    } else if (exponent < 0 && point > 0) {
+        for (int i = 0; i < point; i++) out[len++] = digits[--n];
+        out[len++] = '.';
+        while (n) out[len++] = digits[--n];
+    } else if (exponent < 0 && point > -20) {
+        out[len++] = '0';
+        out[len++] = '.';
+        for (int i = 0; i < -point; i++) out[len++] = '0';
+        while (n) out[len++] = digits[--n];
+    } else {
+        while (n) out[len++] = digits[--n];
+        out[len++] = 'e';
+        if (exponent < 0) {
+            out[len++] = '-';
+            exponent = -exponent;
+        }
+        char e[4];
+        int k = 0;
+        do {
+            e[k++] = (char)('0' + exponent % 10);
+            exponent /= 10;
+        } while (exponent);
+        while (k) out[len++] = e[--k];
+    }
+    out[len] = 0;
+    return len;
+}
+
+int st_xfl_from_string(const char* s, size_t len, int64_t* xfl)
+{
+    size_t i = 0;
+    int negative = 0;
+    if (i < len && (s[i] == '-' || s[i] == '+')) negative = s[i++] == '-';
+
+    uint64_t mantissa = 0;
+    int significant = 0, exponent = 0, any = 0, seen_point = 0;
+    for (; i < len; i++) {
+        char c = s[i];
+        if (c == '.' && !seen_point) {
+            seen_point = 1;
+            continue;
+        }
+        if (c < '0' || c > '9') break;
+        any = 1;
+        if (seen_point) exponent--;
+        if (mantissa == 0 && c == '0') continue;
+        if (significant == 16) {
+            // Digits past the 16th must be zeros
+            if (c != '0') return 0;
+            exponent++;
+            continue;
+        }
+        mantissa = mantissa * 10 + (uint64_t)(c - '0');
+        significant++;
+    }
+    if (!any) return 0;
+
+    if (i < len && (s[i] == 'e' || s[i] == 'E')) {
+        int sign = 1, e = 0, digits = 0;
+        i++;
+        if (i < len && (s[i] == '-' || s[i] == '+')) sign = s[i++] == '-' ? -1 : 1;
+        for (; i < len && s[i] >= '0' && s[i] <= '9'; i++, digits++)
+            if (e < 10000) e = e * 10 + (s[i] - '0');
+        if (!digits) return 0;
+        exponent += sign * e;
+    }
+    if (i != len) return 0;
+
+    if (mantissa == 0) {
+        *xfl = 0;
+        return 1;
+    }
+    while (mantissa < XFL_MANT_MIN) {
+        mantissa *= 10;
+        exponent--;
+    }
+    if (exponent < -96 || exponent > 80) return 0;
+    *xfl = (int64_t)((negative ? 0 : (1ULL << 62)) | ((uint64_t)(exponent + 97) << 54) | mantissa);
+    return 1;
+}
+
+size_t st_currency_to_string(char out[41], const uint8_t currency[20])
+{
+    static const char hex[] = "0123456789ABCDEF";
+    int zero = 1, standard = 1;
+    for (int i = 0; i < 20; i++) {
+        if (currency[i]) zero = 0;
+        if ((i < 12 || i >= 15) && currency[i]) standard = 0;
+    }
+    if (zero) {
+        memcpy(out, "XRP", 4);
+        return 3;
+    }
+    for (int i = 12; i < 15 && standard; i++)
+        if (currency[i] < 0x20 || currency[i] > 0x7E) standard = 0;
+    if (standard && memcmp(currency + 12, "XRP", 3) != 0) {
+        memcpy(out, currency + 12, 3);
+        out[3] = 0;
+        return 3;
+    }
+    for (int i = 0; i < 20; i++) {
+        out[2 * i] = hex[currency[i] >> 4];
+        out[2 * i + 1] = hex[currency[i] & 0x0F];
+    }
+    out[40] = 0;
+    return 40;
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+int st_currency_from_string(uint8_t currency[20], const char* s, size_t len)
+{
+    memset(currency, 0, 20);
+    if (len == 3) {
+        if (memcmp(s, "XRP", 3) == 0) return 1;
+        for (int i = 0; i < 3; i++) {
+            if (s[i] < 0x20 || s[i] > 0x7E) return 0;
+            currency[12 + i] = (uint8_t)s[i];
+        }
+        return 1;
+    }
+    if (len != 40) return 0;
+    for (int i = 0; i < 20; i++) {
+        int hi = hex_value(s[2 * i]), lo = hex_value(s[2 * i + 1]);
+        if (hi < 0 || lo < 0) return 0;
+        currency[i] = (uint8_t)(hi << 4 | lo);
+    }
+    return 1;
+}
@@ -0,0 +1,139 @@
+// XRPL binary serialization (STObject) from the field codes in hooks/carbon/sfcodes.h
+//
+// A field code is (type << 16) + nth, the same value the hooks pass to otxn_field and the
+// ENCODE_* macros in macro.h write. The reader walks a buffer in place: st_next() hands
+// out each field with a pointer into the buffer (past the header and any length prefix)
+// and never copies; objects and arrays are entered with st_enter(). The writer appends
+// fields to a growing buffer; the caller writes them in canonical order (ascending code).
+//
+// Plain C with no N-API dependency; codec.c binds it for JavaScript.
+
+#ifndef DRIPPY_NATIVE_STCODEC_H
+#define DRIPPY_NATIVE_STCODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum {
+    ST_UINT16 = 1,
+    ST_UINT32 = 2,
+    ST_UINT64 = 3,
+    ST_HASH128 = 4,
+    ST_HASH256 = 5,
+    ST_AMOUNT = 6,
+    ST_VL = 7,
+    ST_ACCOUNT = 8,
+    ST_HASH160_SF = 10,        // sfcodes.h numbers the Taker*Currency/Issuer hashes 10
+    ST_OBJECT = 14,
+    ST_ARRAY = 15,
+    ST_UINT8 = 16,
+    ST_HASH160 = 17,
+    ST_PATHSET = 18,
+    ST_VECTOR256 = 19
+};
+
+#define ST_TYPE(code) ((code) >> 16)
+#define ST_NTH(code) ((code) & 0xFFFF)
+#define ST_CODE(type, nth) (((uint32_t)(type) << 16) + (nth))
+
+#define ST_OBJECT_END 0xE1
+#define ST_ARRAY_END 0xF1
+
+typedef struct {
+    const char* name;          // without the sf prefix, as JSON spells it
+    uint32_t code;
+} st_field_def;
+
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+} st_reader;
+
+typedef struct {
+    uint32_t code;
+    const uint8_t* data;       // value bytes, past header and length prefix
+    size_t len;                // for objects and arrays: up to, not including, the end marker
+} st_field;
+
+enum { ST_END = 0, ST_OK = 1, ST_ERROR = -1 };
+
+// Field table, sorted by code
+const st_field_def* st_fields(size_t* count);
+const st_field_def* st_field_by_code(uint32_t code);
+const st_field_def* st_field_by_name(const char* name, size_t len);
+
+// Transaction type names (macro.h tt* codes, xrpl.js spelling); NULL or -1 when unknown
+const char* st_tx_type_name(uint16_t type);
+int st_tx_type_code(const char* name, size_t len);
+
+static inline void st_reader_init(st_reader* r, const uint8_t* data, size_t len)
+{
+    r->p = data;
+    r->end = data + len;
+}
+
+// Next field; ST_END at the end of the buffer or at the end marker of an enclosing
+// object or array, ST_ERROR on a truncated or unknown-type field
+int st_next(st_reader* r, st_field* f);
+
+// Reader over the inside of an object or array field
+static inline void st_enter(st_reader* r, const st_field* f)
+{
+    st_reader_init(r, f->data, f->len);
+}
+
+// First top-level field with this code; ST_END when absent
+int st_find(const uint8_t* data, size_t len, uint32_t code, st_field* f);
+
+// Serialized header length of a field code, and the header itself
+size_t st_header_size(uint32_t code);
+size_t st_write_header(uint8_t* out, uint32_t code);
+
+// Variable-length prefix: returns its size and the length it encodes, 0 when truncated
+size_t st_read_vl(const uint8_t* p, const uint8_t* end, size_t* len);
+
+typedef struct {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+    int failed;                // allocation failed or a value was out of range
+} st_writer;
+
+void st_writer_init(st_writer* w);
+void st_writer_free(st_writer* w);
+
+void st_put_raw(st_writer* w, const void* data, size_t len);
+void st_put_header(st_writer* w, uint32_t code);
+void st_put_uint(st_writer* w, uint32_t code, uint64_t v);       // UINT8/16/32/64 by type
+void st_put_bytes(st_writer* w, uint32_t code, const void* data, size_t len);  // hashes
+void st_put_vl(st_writer* w, uint32_t code, const void* data, size_t len);     // blobs, accounts
+void st_put_drops(st_writer* w, uint32_t code, uint64_t drops);
+void st_put_iou(st_writer* w, uint32_t code, int64_t xfl, const uint8_t currency[20],
+                const uint8_t issuer[20]);
+void st_put_end(st_writer* w, uint32_t container_type);          // ST_OBJECT or ST_ARRAY
+
+// Amounts. The issued-currency value is an XFL with bit 63 set (hookapi.h float_*):
+//   bit 62 positive, bits 54..61 exponent + 97, bits 0..53 mantissa 10^15 .. 10^16-1
+#define ST_XFL_STRING_MAX 48
+
+int st_amount_is_native(const uint8_t* amount);
+uint64_t st_amount_drops(const uint8_t* amount);                  // magnitude
+int st_amount_negative(const uint8_t* amount);
+int64_t st_amount_xfl(const uint8_t* amount);
+
+// a + b and -a, truncated to 16 digits like the float_* host functions; a term more than
+// 19 digits below the other does not register
+int64_t st_xfl_sum(int64_t a, int64_t b);
+int64_t st_xfl_negate(int64_t a);
+
+// Decimal string of an XFL; returns its length
+size_t st_xfl_to_string(char out[ST_XFL_STRING_MAX], int64_t xfl);
+// XFL of a decimal string ("-12.5", "1e-7"); 0 when it is not a number or needs more
+// than 16 significant digits or is out of range
+int st_xfl_from_string(const char* s, size_t len, int64_t* xfl);
+
+// Currency code: "XRP", three ASCII characters or 40 hex digits
+size_t st_currency_to_string(char out[41], const uint8_t currency[20]);
+int st_currency_from_string(uint8_t currency[20], const char* s, size_t len);
+
+#endif
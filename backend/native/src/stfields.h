@@ -0,0 +1,224 @@
+// Field list for stcodec.c, one X() per field in hooks/carbon/sfcodes.h
+//
+// The codes come from sfcodes.h itself; this list only names them. Regenerate it when
+// sfcodes.h changes:
+//   sed -n 's/^#define \(sf[A-Za-z0-9]*\) .*/    X(\1) \\/p' ../../hooks/carbon/sfcodes.h
+
+#ifndef DRIPPY_NATIVE_STFIELDS_H
+#define DRIPPY_NATIVE_STFIELDS_H
+
+#define ST_FIELDS(X) \
+    X(sfCloseResolution) \
+    X(sfMethod) \
+    X(sfTransactionResult) \
+    X(sfTickSize) \
+    X(sfUNLModifyDisabling) \
+    X(sfHookResult) \
+    X(sfLedgerEntryType) \
+    X(sfTransactionType) \
+    X(sfSignerWeight) \
+    X(sfTransferFee) \
+    X(sfVersion) \
+    X(sfHookStateChangeCount) \
+    X(sfHookEmitCount) \
+    X(sfHookExecutionIndex) \
+    X(sfHookApiVersion) \
+    X(sfNetworkID) \
+    X(sfFlags) \
+    X(sfSourceTag) \
+    X(sfSequence) \
+    X(sfPreviousTxnLgrSeq) \
+    X(sfLedgerSequence) \
+    X(sfCloseTime) \
+    X(sfParentCloseTime) \
+    X(sfSigningTime) \
+    X(sfExpiration) \
+    X(sfTransferRate) \
+    X(sfWalletSize) \
+    X(sfOwnerCount) \
+    X(sfDestinationTag) \
+    X(sfHighQualityIn) \
+    X(sfHighQualityOut) \
+    X(sfLowQualityIn) \
+    X(sfLowQualityOut) \
+    X(sfQualityIn) \
+    X(sfQualityOut) \
+    X(sfStampEscrow) \
+    X(sfBondAmount) \
+    X(sfLoadFee) \
+    X(sfOfferSequence) \
+    X(sfFirstLedgerSequence) \
+    X(sfLastLedgerSequence) \
+    X(sfTransactionIndex) \
+    X(sfOperationLimit) \
+    X(sfReferenceFeeUnits) \
+    X(sfReserveBase) \
+    X(sfReserveIncrement) \
+    X(sfSetFlag) \
+    X(sfClearFlag) \
+    X(sfSignerQuorum) \
+    X(sfCancelAfter) \
+    X(sfFinishAfter) \
+    X(sfSignerListID) \
+    X(sfSettleDelay) \
+    X(sfTicketCount) \
+    X(sfTicketSequence) \
+    X(sfNFTokenTaxon) \
+    X(sfMintedNFTokens) \
+    X(sfBurnedNFTokens) \
+    X(sfHookStateCount) \
+    X(sfEmitGeneration) \
+    X(sfLockCount) \
+    X(sfRewardTime) \
+    X(sfRewardLgrFirst) \
+    X(sfRewardLgrLast) \
+    X(sfIndexNext) \
+    X(sfIndexPrevious) \
+    X(sfBookNode) \
+    X(sfOwnerNode) \
+    X(sfBaseFee) \
+    X(sfExchangeRate) \
+    X(sfLowNode) \
+    X(sfHighNode) \
+    X(sfDestinationNode) \
+    X(sfCookie) \
+    X(sfServerVersion) \
+    X(sfNFTokenOfferNode) \
+    X(sfEmitBurden) \
+    X(sfHookInstructionCount) \
+    X(sfHookReturnCode) \
+    X(sfReferenceCount) \
+    X(sfRewardAccumulator) \
+    X(sfEmailHash) \
+    X(sfTakerPaysCurrency) \
+    X(sfTakerPaysIssuer) \
+    X(sfTakerGetsCurrency) \
+    X(sfTakerGetsIssuer) \
+    X(sfLedgerHash) \
+    X(sfParentHash) \
+    X(sfTransactionHash) \
+    X(sfAccountHash) \
+    X(sfPreviousTxnID) \
+    X(sfLedgerIndex) \
+    X(sfWalletLocator) \
+    X(sfRootIndex) \
+    X(sfAccountTxnID) \
+    X(sfNFTokenID) \
+    X(sfEmitParentTxnID) \
+    X(sfEmitNonce) \
+    X(sfEmitHookHash) \
+    X(sfBookDirectory) \
+    X(sfInvoiceID) \
+    X(sfNickname) \
+    X(sfAmendment) \
+    X(sfHookOn) \
+    X(sfDigest) \
+    X(sfChannel) \
+    X(sfConsensusHash) \
+    X(sfCheckID) \
+    X(sfValidatedHash) \
+    X(sfPreviousPageMin) \
+    X(sfNextPageMin) \
+    X(sfNFTokenBuyOffer) \
+    X(sfNFTokenSellOffer) \
+    X(sfHookStateKey) \
+    X(sfHookHash) \
+    X(sfHookNamespace) \
+    X(sfHookSetTxnID) \
+    X(sfOfferID) \
+    X(sfEscrowID) \
+    X(sfURITokenID) \
+    X(sfAmount) \
+    X(sfBalance) \
+    X(sfLimitAmount) \
+    X(sfTakerPays) \
+    X(sfTakerGets) \
+    X(sfLowLimit) \
+    X(sfHighLimit) \
+    X(sfFee) \
+    X(sfSendMax) \
+    X(sfDeliverMin) \
+    X(sfMinimumOffer) \
+    X(sfRippleEscrow) \
+    X(sfDeliveredAmount) \
+    X(sfNFTokenBrokerFee) \
+    X(sfHookCallbackFee) \
+    X(sfLockedBalance) \
+    X(sfPublicKey) \
+    X(sfMessageKey) \
+    X(sfSigningPubKey) \
+    X(sfTxnSignature) \
+    X(sfURI) \
+    X(sfSignature) \
+    X(sfDomain) \
+    X(sfFundCode) \
+    X(sfRemoveCode) \
+    X(sfExpireCode) \
+    X(sfCreateCode) \
+    X(sfMemoType) \
+    X(sfMemoData) \
+    X(sfMemoFormat) \
+    X(sfFulfillment) \
+    X(sfCondition) \
+    X(sfMasterSignature) \
+    X(sfUNLModifyValidator) \
+    X(sfValidatorToDisable) \
+    X(sfValidatorToReEnable) \
+    X(sfHookStateData) \
+    X(sfHookReturnString) \
+    X(sfHookParameterName) \
+    X(sfHookParameterValue) \
+    X(sfBlob) \
+    X(sfAccount) \
+    X(sfOwner) \
+    X(sfDestination) \
+    X(sfIssuer) \
+    X(sfAuthorize) \
+    X(sfUnauthorize) \
+    X(sfRegularKey) \
+    X(sfNFTokenMinter) \
+    X(sfEmitCallback) \
+    X(sfHookAccount) \
+    X(sfIndexes) \
+    X(sfHashes) \
+    X(sfAmendments) \
+    X(sfNFTokenOffers) \
+    X(sfHookNamespaces) \
+    X(sfPaths) \
+    X(sfTransactionMetaData) \
+    X(sfCreatedNode) \
+    X(sfDeletedNode) \
+    X(sfModifiedNode) \
+    X(sfPreviousFields) \
+    X(sfFinalFields) \
+    X(sfNewFields) \
+    X(sfTemplateEntry) \
+    X(sfMemo) \
+    X(sfSignerEntry) \
+    X(sfNFToken) \
+    X(sfEmitDetails) \
+    X(sfHook) \
+    X(sfSigner) \
+    X(sfMajority) \
+    X(sfDisabledValidator) \
+    X(sfEmittedTxn) \
+    X(sfHookExecution) \
+    X(sfHookDefinition) \
+    X(sfHookParameter) \
+    X(sfHookGrant) \
+    X(sfSigners) \
+    X(sfSignerEntries) \
+    X(sfTemplate) \
+    X(sfNecessary) \
+    X(sfSufficient) \
+    X(sfAffectedNodes) \
+    X(sfMemos) \
+    X(sfNFTokens) \
+    X(sfHooks) \
+    X(sfMajorities) \
+    X(sfDisabledValidators) \
+    X(sfHookExecutions) \
+    X(sfHookParameters) \
+    X(sfHookGrants)
+
+#endif
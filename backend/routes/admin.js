@@ -3,6 +3,7 @@ const router = express.Router()
 const { Client } = require('xahau')
 const fs = require('fs').promises
 const path = require('path')
+const { pushAccrual } = require('../src/accruals')
 
 // Hook State Reader for real data
 class AdminHookReader {
@@ -376,18 +377,8 @@ router.post('/accrual/adjust', requireAdmin, async (req, res) => {
       return res.status(400).json({ error: 'Amount must be positive' })
     }
 
-    // TODO: Use the existing push-accrual endpoint
-    const accrualResult = await fetch(`${req.protocol}://${req.get('host')}/admin/push-accrual`, {
-      method: 'POST',
-      headers: { 'Content-Type': 'application/json' },
-      body: JSON.stringify({ account, drops })
-    })
-
-    if (!accrualResult.ok) {
-      throw new Error('Failed to push accrual to hook')
-    }
-
-    const accrualData = await accrualResult.json()
+    // Signed locally on a Ticket by the shared admin sender, no HTTP hop to push-accrual
+    const accrualData = await pushAccrual(account, drops)
 
     // Log the adjustment
     const logEntry = {
@@ -397,7 +388,8 @@ router.post('/accrual/adjust', requireAdmin, async (req, res) => {
       amount,
       type,
       reason: reason || 'Manual adjustment',
-      transactionHash: accrualData.meta?.TransactionResult || 'N/A'
+      transactionHash: accrualData.hash,
+      result: accrualData.result
     }
 
     res.json({
@@ -1,6 +1,14 @@
 const express = require('express')
 const router = express.Router()
 const { Client } = require('xahau')
+const { decodeAccounts } = require('../native')
+const { DEFAULT_NAMESPACE, FEE_ROUTER_NAMESPACE, readState, readChangesSince } = require('../src/hook-events')
+const { PERIODS, readMetrics } = require('../src/hook-metrics')
+const { CLAIM_PREFIX, CLAIM_STATE_SIZE, claimStateKey, decodeClaimState, followClaimSnapshot } = require('../src/claim-snapshot')
+const { previewClaim } = require('../src/claim-preview')
+
+// Hooks store ledger times in seconds since the Ripple epoch (2000-01-01)
+const RIPPLE_EPOCH = 946684800
 
 // Hook State Reader - reads actual hook state from Xahau
 class HookStateReader {
@@ -58,6 +66,24 @@ class HookStateReader {
     }
   }
 
+  // XFL (Xahau float): bit 62 = positive, bits 54..61 = exponent + 97, bits 0..53 = mantissa
+  decodeXfl(hexData) {
+    const xfl = BigInt('0x' + hexData)
+    if (xfl === 0n) return '0'
+    const negative = ((xfl >> 62n) & 1n) === 0n
+    const exponent = Number((xfl >> 54n) & 0xFFn) - 97
+    const mantissa = (xfl & ((1n << 54n) - 1n)).toString()
+    let digits = mantissa
+    if (exponent >= 0) {
+      digits = mantissa + '0'.repeat(exponent)
+    } else {
+      const padded = mantissa.padStart(-exponent + 1, '0')
+      const split = padded.length + exponent
+      digits = `${padded.slice(0, split)}.${padded.slice(split)}`.replace(/\.?0+$/, '')
+    }
+    return negative ? `-${digits}` : digits
+  }
+
   decodeStateData(hexData) {
     try {
       // Try to decode as uint64 (8 bytes)
@@ -98,6 +124,39 @@ class HookStateReader {
 
 const stateReader = new HookStateReader()
 
+// Claim balances are served from a local snapshot (src/claim-snapshot.js) when
+// CLAIM_SNAPSHOT_PATH is set; until it is ready, and without it, they are read live
+let claimSnapshot = null
+const claimNamespace = () => process.env.CLAIM_HOOK_NAMESPACE || DEFAULT_NAMESPACE
+
+if (process.env.CLAIM_SNAPSHOT_PATH && process.env.CLAIM_HOOK_ACCOUNT) {
+  stateReader.connect()
+    .then(() => followClaimSnapshot(stateReader.client, process.env.CLAIM_SNAPSHOT_PATH,
+      process.env.CLAIM_HOOK_ACCOUNT, claimNamespace()))
+    .then(store => { claimSnapshot = store })
+    .catch(error => console.error('Claim snapshot unavailable:', error.message))
+}
+
+// Changes since ?cursor=N from a hook's change log (hooks/include/drippy_changes.h).
+// Without a cursor the oldest change still in the log is returned first; pass the
+// returned cursor on the next call.
+async function sendChanges(req, res, account, namespace) {
+  const cursor = req.query.cursor === undefined ? null : Number(req.query.cursor)
+  if (cursor !== null && (!Number.isSafeInteger(cursor) || cursor < 0)) {
+    return res.status(400).json({ error: 'cursor must be a non-negative integer' })
+  }
+
+  await stateReader.connect()
+  const { changes, cursor: next, missed } = await readChangesSince(stateReader.client, account, namespace, cursor)
+
+  res.json({
+    account,
+    cursor: next,
+    missed,
+    changes: changes.map(c => ({ ...c, value: c.value.toString() }))
+  })
+}
+
 // Get enhanced router hook statistics
 router.get('/router/stats', async (req, res) => {
   try {
@@ -140,7 +199,7 @@ router.get('/router/stats', async (req, res) => {
       if (keyStr.includes('STATS:TOTAL')) {
         stats.totalDistributed = decoded.value || 0
       } else if (keyStr.includes('LAST_TIME')) {
-        stats.lastDistribution = decoded.value ? new Date(decoded.value * 1000).toISOString() : null
+        stats.lastDistribution = decoded.value ? new Date((decoded.value + RIPPLE_EPOCH) * 1000).toISOString() : null
       } else if (keyStr.includes('NFT_TOTAL')) {
         stats.nftRewards = decoded.value || 0
       } else if (keyStr.includes('HOLD_TOTAL')) {
@@ -159,6 +218,59 @@ router.get('/router/stats', async (req, res) => {
   }
 })
 
+// Get NFT royalty router statistics (real-time pool accrual from hook state)
+router.get('/nft-router/stats', async (req, res) => {
+  try {
+    const nftRouterAccount = process.env.NFT_ROUTER_ACCOUNT
+
+    if (!nftRouterAccount) {
+      return res.status(500).json({ error: 'NFT router account not configured' })
+    }
+
+    const states = await stateReader.getAllHookStates(nftRouterAccount)
+
+    const stats = {
+      account: nftRouterAccount,
+      pendingPoolBalance: 0,
+      totalRoyalties: 0,
+      totalFlushed: 0,
+      saleVolume: 0,
+      saleCount: 0,
+      flushCount: 0,
+      lastFlush: null
+    }
+
+    // Keys are "DRIPPY:NFTROY:v1:<NAME>" padded with zeros
+    const fields = {
+      NFT_ACC: 'pendingPoolBalance',
+      ROY_TOTAL: 'totalRoyalties',
+      FLUSHED: 'totalFlushed',
+      SALE_VOL: 'saleVolume',
+      SALE_COUNT: 'saleCount',
+      FLUSH_COUNT: 'flushCount'
+    }
+
+    states.forEach(state => {
+      const keyStr = Buffer.from(state.HookStateKey, 'hex').toString('utf8').replace(/\0+$/, '')
+      if (!keyStr.startsWith('DRIPPY:NFTROY:v1:')) return
+
+      const name = keyStr.substring('DRIPPY:NFTROY:v1:'.length)
+      const decoded = stateReader.decodeStateData(state.HookStateData)
+
+      if (fields[name]) {
+        stats[fields[name]] = decoded.value || 0
+      } else if (name === 'LAST_FLUSH') {
+        stats.lastFlush = decoded.value ? new Date((decoded.value + RIPPLE_EPOCH) * 1000).toISOString() : null
+      }
+    })
+
+    res.json(stats)
+  } catch (error) {
+    console.error('Error getting NFT router stats:', error)
+    res.status(500).json({ error: 'Failed to get NFT router statistics' })
+  }
+})
+
 // Get claim hook statistics
 router.get('/claim/stats', async (req, res) => {
   try {
@@ -212,6 +324,81 @@ router.get('/claim/stats', async (req, res) => {
   }
 })
 
+router.get('/claim/changes', async (req, res) => {
+  try {
+    const claimAccount = process.env.CLAIM_HOOK_ACCOUNT
+
+    if (!claimAccount) {
+      return res.status(500).json({ error: 'Claim hook account not configured' })
+    }
+
+    await sendChanges(req, res, claimAccount, process.env.CLAIM_HOOK_NAMESPACE || DEFAULT_NAMESPACE)
+  } catch (error) {
+    console.error('Error getting claim changes:', error)
+    res.status(500).json({ error: 'Failed to get claim changes' })
+  }
+})
+
+router.get('/router/changes', async (req, res) => {
+  try {
+    const routerAccount = process.env.HOOK_FEE_ROUTER_ACCOUNT
+
+    if (!routerAccount) {
+      return res.status(500).json({ error: 'Fee router account not configured' })
+    }
+
+    await sendChanges(req, res, routerAccount, process.env.FEE_ROUTER_NAMESPACE || FEE_ROUTER_NAMESPACE)
+  } catch (error) {
+    console.error('Error getting router changes:', error)
+    res.status(500).json({ error: 'Failed to get router changes' })
+  }
+})
+
+// Hooks that keep hourly/daily metric buckets (hooks/include/drippy_metrics.h)
+const METRIC_HOOKS = {
+  router: () => [process.env.ENHANCED_ROUTER_ACCOUNT, process.env.ENHANCED_ROUTER_NAMESPACE || DEFAULT_NAMESPACE],
+  'fee-router': () => [process.env.HOOK_FEE_ROUTER_ACCOUNT, process.env.FEE_ROUTER_NAMESPACE || FEE_ROUTER_NAMESPACE],
+  claim: () => [process.env.CLAIM_HOOK_ACCOUNT, process.env.CLAIM_HOOK_NAMESPACE || DEFAULT_NAMESPACE]
+}
+
+// Last ?count= hourly or daily buckets (?period=hour|day) from one state query
+router.get('/:hook/metrics', async (req, res) => {
+  try {
+    const hook = METRIC_HOOKS[req.params.hook]
+    if (!hook) {
+      return res.status(404).json({ error: `No metrics for ${req.params.hook}` })
+    }
+
+    const [account, namespace] = hook()
+    if (!account) {
+      return res.status(500).json({ error: `${req.params.hook} account not configured` })
+    }
+
+    const period = req.query.period || 'hour'
+    const count = Number(req.query.count || (period === 'day' ? 7 : 24))
+    if (!PERIODS[period] || !Number.isInteger(count) || count < 1 || count > 366) {
+      return res.status(400).json({ error: 'period must be hour or day and count 1..366' })
+    }
+
+    await stateReader.connect()
+    const buckets = await readMetrics(stateReader.client, account, namespace, period, count)
+
+    res.json({
+      account,
+      period,
+      buckets: buckets.map(b => ({
+        ...b,
+        volume: b.volume.toString(),
+        pools: b.pools.map(p => p.toString()),
+        claimed: b.claimed.toString()
+      }))
+    })
+  } catch (error) {
+    console.error('Error getting hook metrics:', error)
+    res.status(500).json({ error: 'Failed to get hook metrics' })
+  }
+})
+
 // Get utility hook statistics
 router.get('/utility/stats', async (req, res) => {
   try {
@@ -229,6 +416,7 @@ router.get('/utility/stats', async (req, res) => {
       antiSnipeEnd: null,
       totalTransactions: 0,
       blockedTransactions: 0,
+      fees: null,
       stateEntries: []
     }
 
@@ -247,10 +435,23 @@ router.get('/utility/stats', async (req, res) => {
       })
 
       // Parse utility hook specific keys
-      if (keyStr.includes('ANTI_SNIPE')) {
+      if (keyStr.startsWith('DRIPPY:UTIL:FEES') && dataHex.length === 64) {
+        // Coalesced fee record: pending XFL, lifetime XFL, buy/sell/snipe/flush counts
+        const record = Buffer.from(dataHex, 'hex')
+        stats.fees = {
+          pending: stateReader.decodeXfl(dataHex.substring(0, 16)),
+          lifetime: stateReader.decodeXfl(dataHex.substring(16, 32)),
+          buyCount: record.readUInt32BE(16),
+          sellCount: record.readUInt32BE(20),
+          antiSnipeCount: record.readUInt32BE(24),
+          flushCount: record.readUInt32BE(28)
+        }
+        stats.totalTransactions = stats.fees.buyCount + stats.fees.sellCount
+      } else if (keyStr.includes('ANTI_SNIPE')) {
+        // Ripple-epoch seconds, the clock the hook compares it with
         const endTime = decoded.value || 0
-        stats.antiSnipeEnd = endTime > 0 ? new Date(endTime * 1000).toISOString() : null
-        stats.antiSnipeActive = endTime > Math.floor(Date.now() / 1000)
+        stats.antiSnipeEnd = endTime > 0 ? new Date((endTime + RIPPLE_EPOCH) * 1000).toISOString() : null
+        stats.antiSnipeActive = endTime > Math.floor(Date.now() / 1000) - RIPPLE_EPOCH
       }
     })
 
@@ -272,27 +473,39 @@ router.get('/claim/balance/:account', async (req, res) => {
     }
 
     // Validate account format
-    if (!userAccount.startsWith('r') || userAccount.length < 25) {
+    let accountId
+    try {
+      accountId = decodeAccounts([userAccount])
+    } catch (error) {
       return res.status(400).json({ error: 'Invalid account format' })
     }
 
-    // Create state key: "DRIPPY:" + user account (simplified)
-    const stateKey = Buffer.from('DRIPPY:' + userAccount, 'utf8').toString('hex').padEnd(64, '0').toUpperCase()
-
-    const states = await stateReader.getHookState(claimAccount, stateKey)
-
-    let balance = 0
-    if (states.length > 0) {
-      const stateData = states[0].HookStateData
-      const decoded = stateReader.decodeStateData(stateData)
-      balance = decoded.value || 0
+    // State key: "DRIPPY:CLAIM" + account id (src/drippy_enhanced_claim.c)
+    const stateKey = claimStateKey(accountId)
+
+    let data
+    let ledger = null
+    if (claimSnapshot) {
+      data = claimSnapshot.record(accountId)
+      ledger = claimSnapshot.info().ledger
+    } else {
+      await stateReader.connect()
+      data = await readState(stateReader.client, claimAccount, claimNamespace(), stateKey)
     }
 
+    const state = data && data.length === CLAIM_STATE_SIZE ? decodeClaimState(data) : null
+    const balance = state ? Number(state.accrued) : 0
+
     res.json({
       account: userAccount,
       claimableBalance: balance,
       claimableBalanceXRP: (balance / 1000000).toString(),
-      stateKey
+      boost: state ? state.boost || 100 : 100,
+      claimCount: state ? state.claimCount : 0,
+      lastClaim: state ? state.lastClaim : 0,
+      stateKey,
+      source: claimSnapshot ? 'snapshot' : 'ledger',
+      ledger
     })
   } catch (error) {
     console.error('Error getting user balance:', error)
@@ -300,6 +513,50 @@ router.get('/claim/balance/:account', async (req, res) => {
   }
 })
 
+// Dry run of a CLAIM: ?nfts=<URIToken id>,... lists the tokens the NFTS memo would carry.
+// Runs the claim hook's own payout rules (src/claim-preview.js) on the account's state.
+router.get('/claim/preview/:account', async (req, res) => {
+  try {
+    const userAccount = req.params.account
+    const claimAccount = process.env.CLAIM_HOOK_ACCOUNT
+
+    if (!claimAccount) {
+      return res.status(500).json({ error: 'Claim hook account not configured' })
+    }
+
+    let accountId
+    try {
+      accountId = decodeAccounts([userAccount])
+    } catch (error) {
+      return res.status(400).json({ error: 'Invalid account format' })
+    }
+
+    const nftIds = req.query.nfts ? String(req.query.nfts).split(',').filter(Boolean) : []
+    if (nftIds.length > 8 || nftIds.some(id => !/^[0-9A-Fa-f]{64}$/.test(id))) {
+      return res.status(400).json({ error: 'nfts must be at most 8 comma-separated URIToken IDs' })
+    }
+
+    await stateReader.connect()
+    const data = claimSnapshot
+      ? claimSnapshot.record(accountId)
+      : await readState(stateReader.client, claimAccount, claimNamespace(), claimStateKey(accountId))
+
+    const preview = await previewClaim(stateReader.client, {
+      hookAccount: claimAccount,
+      account: userAccount,
+      state: data && data.length === CLAIM_STATE_SIZE ? data : null,
+      nftIds,
+      profile: process.env.CLAIM_PROFILE || 'full',
+      hookHash: process.env.CLAIM_HOOK_HASH
+    })
+
+    res.json({ account: userAccount, ...preview })
+  } catch (error) {
+    console.error('Error previewing claim:', error)
+    res.status(500).json({ error: 'Failed to preview claim' })
+  }
+})
+
 // Get all hook deployment info
 router.get('/deployment/info', async (req, res) => {
   try {
@@ -357,6 +614,18 @@ router.post('/state/query', async (req, res) => {
       return res.status(400).json({ error: 'Hook account and state key required' })
     }
 
+    // Claim states are answered from the snapshot when it is running
+    const claimPrefix = CLAIM_PREFIX.toString('hex').toUpperCase()
+    const key = String(stateKey).toUpperCase()
+    if (claimSnapshot && hookAccount === process.env.CLAIM_HOOK_ACCOUNT &&
+        key.length === 64 && key.startsWith(claimPrefix)) {
+      const data = claimSnapshot.record(key.substring(claimPrefix.length))
+      const results = data
+        ? [{ key, data: data.toString('hex').toUpperCase(), decoded: stateReader.decodeStateData(data.toString('hex')) }]
+        : []
+      return res.json({ hookAccount, stateKey, results, source: 'snapshot', ledger: claimSnapshot.info().ledger })
+    }
+
     const states = await stateReader.getHookState(hookAccount, stateKey)
 
     const results = states.map(state => ({
@@ -2,7 +2,7 @@ require('dotenv').config()
 const express = require('express')
 const cors = require('cors')
 const { XummSdk } = require('xumm-sdk')
-const xrpl = require('xrpl')
+const { pushAccrual, pushAccruals } = require('./src/accruals')
 
 // Import admin routes
 const adminRoutes = require('./routes/admin')
@@ -235,15 +235,26 @@ app.post('/api/xumm/create-claim', async (req, res) => {
     if (!claimDest) return res.status(500).json({ error: 'HOOK_POOL_ACCOUNT missing' })
     const network = (req.body?.network || process.env.XAMAN_NETWORK || 'XAHAU').toUpperCase()
 
+    // Optional URIToken IDs for on-chain NFT boost derivation (max 8, 32-byte hex each)
+    const nftIds = Array.isArray(req.body?.nftIds) ? req.body.nftIds : []
+    if (nftIds.length > 8 || nftIds.some(id => !/^[0-9A-Fa-f]{64}$/.test(id))) {
+      return res.status(400).json({ error: 'nftIds must be at most 8 URIToken IDs (64 hex chars)' })
+    }
+
+    const memos = [
+      { Memo: { MemoType: Buffer.from('CLAIM').toString('hex').toUpperCase() } }
+    ]
+    if (nftIds.length > 0) {
+      memos.push({ Memo: { MemoType: Buffer.from('NFTS').toString('hex').toUpperCase(), MemoData: nftIds.join('').toUpperCase() } })
+    }
+
     const xumm = new XummSdk(key, secret)
     const payload = {
       txjson: {
         TransactionType: 'Payment',
         Destination: claimDest,
         Amount: '1', // 1 drop just to trigger hook
-        Memos: [
-          { Memo: { MemoType: Buffer.from('CLAIM').toString('hex').toUpperCase() } }
-        ]
+        Memos: memos
       },
       options: {
         submit: false,
@@ -271,34 +282,12 @@ app.post('/api/xumm/create-claim', async (req, res) => {
 // Admin: push an accrual to Hook state (Payment to hooked account with ACC memos)
 app.post('/admin/push-accrual', async (req, res) => {
   try {
-    const seed = process.env.HOOK_ADMIN_SEED
-    const wss = process.env.XAHAU_WSS || 'wss://xahau.network'
-    const dest = process.env.HOOK_POOL_ACCOUNT
-    if (!seed || !dest) return res.status(500).json({ error: 'HOOK_ADMIN_SEED or HOOK_POOL_ACCOUNT missing' })
+    if (!process.env.HOOK_ADMIN_SEED || !process.env.HOOK_POOL_ACCOUNT) {
+      return res.status(500).json({ error: 'HOOK_ADMIN_SEED or HOOK_POOL_ACCOUNT missing' })
+    }
     const { account, drops } = req.body || {}
     if (!account || typeof drops !== 'number') return res.status(400).json({ error: 'account and drops required' })
-    const client = new xrpl.Client(wss)
-    await client.connect()
-    const wallet = xrpl.Wallet.fromSeed(seed)
-    const acctHex = Buffer.from(xrpl.decodeAccountID(account)).toString('hex').toUpperCase()
-    // format drops as big-endian hex without 0x, max 16 hex chars
-    let valHex = BigInt(drops).toString(16).toUpperCase()
-    if (valHex.length % 2) valHex = '0' + valHex
-
-    const tx = {
-      TransactionType: 'Payment',
-      Account: wallet.classicAddress,
-      Destination: dest,
-      Amount: '1',
-      Memos: [
-        { Memo: { MemoType: Buffer.from('ACC_A').toString('hex').toUpperCase(), MemoData: acctHex } },
-        { Memo: { MemoType: Buffer.from('ACC_V').toString('hex').toUpperCase(), MemoData: valHex } }
-      ]
-    }
-    const prepared = await client.autofill(tx)
-    const signed = wallet.sign(prepared)
-    const result = await client.submitAndWait(signed.tx_blob)
-    await client.disconnect()
+    const result = await pushAccrual(account, drops)
     return res.json(result)
   } catch (e) {
     console.error('push-accrual error', e)
@@ -306,6 +295,32 @@ app.post('/admin/push-accrual', async (req, res) => {
   }
 })
 
+// Admin: push a batch of accruals (one ledger's worth from the AMM indexer). The claim
+// hook takes one ACC_A/ACC_V pair per Payment; each is signed locally on its own Ticket
+// (src/tx-sender.js) and all of them are submitted at once.
+const MAX_ACCRUAL_BATCH = 200
+app.post('/admin/push-accruals', async (req, res) => {
+  try {
+    if (!process.env.HOOK_ADMIN_SEED || !process.env.HOOK_POOL_ACCOUNT) {
+      return res.status(500).json({ error: 'HOOK_ADMIN_SEED or HOOK_POOL_ACCOUNT missing' })
+    }
+    const { accruals } = req.body || {}
+    if (!Array.isArray(accruals) || accruals.length === 0 || accruals.length > MAX_ACCRUAL_BATCH) {
+      return res.status(400).json({ error: `accruals must be 1 to ${MAX_ACCRUAL_BATCH} entries` })
+    }
+    // drops as an integer string (exact) or a safe integer
+    const valid = accruals.every(a => a && typeof a.account === 'string' &&
+      (/^[1-9][0-9]{0,18}$/.test(String(a.drops))) && BigInt(a.drops) < 2n ** 64n)
+    if (!valid) return res.status(400).json({ error: 'each accrual needs account and positive integer drops' })
+
+    const submitted = (await pushAccruals(accruals)).map(({ validated, ...entry }) => entry)
+    return res.json({ submitted })
+  } catch (e) {
+    console.error('push-accruals error', e)
+    return res.status(400).json({ error: 'Failed to push accruals' })
+  }
+})
+
 const port = process.env.PORT || 8787
 app.listen(port, () => {
   console.log(`Backend listening on http://localhost:${port}`)
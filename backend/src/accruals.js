@@ -0,0 +1,116 @@
+/**
+ * Admin writes to the claim hook: Payments from the hook admin (HOOK_ADMIN_SEED) to
+ * the hooked pool account (HOOK_POOL_ACCOUNT) carrying one ACC_A/ACC_V (accrual) or
+ * ACC_A/BOOST (boost multiplier) memo pair each.
+ * They go out through one TxSender (src/tx-sender.js) kept per process, so concurrent
+ * requests each take their own Ticket instead of queueing on the admin Sequence.
+ */
+
+const { Client } = require('xahau')
+const { decodeAccounts } = require('../native')
+const { TxSender } = require('./tx-sender')
+
+let shared = null
+
+function memoHex(s) {
+  return Buffer.from(s).toString('hex').toUpperCase()
+}
+
+// The hook reads ACC_A, ACC_V and BOOST data as hex text and unhexlifies it, so the
+// MemoData is the hex of that text
+function adminTx(dest, account, type, value) {
+  const acctHex = decodeAccounts([account]).toString('hex').toUpperCase()
+  // value as big-endian hex without 0x; at most 16 digits for ACC_V, 8 for BOOST
+  let valHex = BigInt(value).toString(16).toUpperCase()
+  if (valHex.length % 2) valHex = '0' + valHex
+  return {
+    TransactionType: 'Payment',
+    Destination: dest,
+    Amount: '1',
+    Memos: [
+      { Memo: { MemoType: memoHex('ACC_A'), MemoData: memoHex(acctHex) } },
+      { Memo: { MemoType: memoHex(type), MemoData: memoHex(valHex) } }
+    ]
+  }
+}
+
+// Payment to the hooked pool account carrying one ACC_A/ACC_V accrual
+function accrualTx(dest, account, drops) {
+  return adminTx(dest, account, 'ACC_V', drops)
+}
+
+// Payment setting `account`'s stored boost (100 = 1x); the hook caps it at BOOST_MAX
+function boostTx(dest, account, boost) {
+  return adminTx(dest, account, 'BOOST', boost)
+}
+
+/**
+ * The admin TxSender, connected and holding its Ticket pool; a dropped connection
+ * makes the next call start a new one. TX_TICKETS sets the pool size.
+ */
+async function accrualSender() {
+  const seed = process.env.HOOK_ADMIN_SEED
+  if (!seed || !process.env.HOOK_POOL_ACCOUNT) throw new Error('HOOK_ADMIN_SEED or HOOK_POOL_ACCOUNT missing')
+
+  if (!shared) {
+    shared = (async () => {
+      const client = new Client(process.env.XAHAU_WSS || 'wss://xahau.network', { connectionTimeout: 10000 })
+      await client.connect()
+      client.on('disconnected', () => { shared = null })
+      const sender = new TxSender(client, seed, { tickets: Number(process.env.TX_TICKETS) || undefined })
+      await sender.start()
+      return sender
+    })().catch((error) => {
+      shared = null
+      throw error
+    })
+  }
+  return shared
+}
+
+/**
+ * Sends one accrual per entry of `accruals` ({ account, drops }), all in flight at
+ * once. Resolves when the server has them, with one { account, drops, hash, result,
+ * validated } or { account, drops, error } per entry, in order.
+ */
+async function pushAccruals(accruals) {
+  return pushAll(accruals, ({ account, drops }) => ({ account, drops: String(drops) }),
+    (dest, { account, drops }) => accrualTx(dest, account, drops))
+}
+
+/**
+ * Sends one BOOST per entry of `boosts` ({ account, boost }), as pushAccruals() does;
+ * one { account, boost, hash, result, validated } or { account, boost, error } each.
+ */
+async function pushBoosts(boosts) {
+  return pushAll(boosts, ({ account, boost }) => ({ account, boost }),
+    (dest, { account, boost }) => boostTx(dest, account, boost))
+}
+
+// Submits makeTx(dest, entry) for every entry at once; outcomes keyed by describe(entry)
+async function pushAll(entries, describe, makeTx) {
+  const sender = await accrualSender()
+  const dest = process.env.HOOK_POOL_ACCOUNT
+  const outcomes = await Promise.allSettled(entries.map((e) => sender.submit(makeTx(dest, e))))
+  return outcomes.map((o, i) => {
+    const entry = describe(entries[i])
+    if (o.status === 'rejected') return { ...entry, error: o.reason.message }
+    return { ...entry, hash: o.value.hash, result: o.value.engineResult, validated: o.value.validated }
+  })
+}
+
+// One accrual, resolved once validated: { hash, result, ledger }
+async function pushAccrual(account, drops) {
+  const [sent] = await pushAccruals([{ account, drops }])
+  if (sent.error) throw new Error(sent.error)
+  return sent.validated
+}
+
+module.exports = {
+  accrualTx,
+  boostTx,
+  accrualSender,
+  pushAccruals,
+  pushAccrual,
+  pushBoosts
+}
@@ -1,67 +1,68 @@
-// Minimal AMM watcher skeleton for Xahau: subscribes to transactions, estimates volume contribution,
-// and pushes small accruals to the Claim Hook via the admin endpoint.
+// Minimal AMM watcher skeleton for Xahau: on every closed ledger, fetches its transactions in
+// binary, measures the XRP each sender moved (native balance-change walker, backend/native)
+// and pushes that ledger's accruals to the Claim Hook in one admin call.
 require('dotenv').config()
 const xrpl = require('xrpl')
-const { getBalanceChanges } = xrpl
+const { readField, ledgerVolume } = require('../native')
 const fetch = (...args) => import('node-fetch').then(({default: fetch}) => fetch(...args))
 
-async function pushAccrual(account, drops){
-  const base = process.env.API_BASE || 'http://localhost:8787'
-  const res = await fetch(`${base}/admin/push-accrual`,{
-    method:'POST', headers:{'Content-Type':'application/json'},
-    body: JSON.stringify({ account, drops })
-  })
-  if(!res.ok){ console.error('push-accrual failed', res.status); return }
-  console.log('accrual ->', account, drops)
-}
+// Focus on AMM-related or high-volume payments; refine as needed
+const TRACKED_TYPES = new Set(['AMMDeposit', 'AMMWithdraw', 'Payment'])
+const ACCRUAL_DIVISOR = 10000n // 0.01% accrual as a placeholder
+const ACCRUAL_BATCH = 200 // MAX_ACCRUAL_BATCH in server.js
 
-function pickBeneficiaryFromTx(tx){
-  // Simple heuristic: reward the initiating Account
-  return tx?.Account
+async function pushAccruals(ledger, accruals){
+  const base = process.env.API_BASE || 'http://localhost:8787'
+  for (let i = 0; i < accruals.length; i += ACCRUAL_BATCH) {
+    const batch = accruals.slice(i, i + ACCRUAL_BATCH)
+    const res = await fetch(`${base}/admin/push-accruals`,{
+      method:'POST', headers:{'Content-Type':'application/json'},
+      body: JSON.stringify({ accruals: batch })
+    })
+    if(!res.ok){ console.error('push-accruals failed', ledger, res.status); return }
+    console.log('accruals ->', ledger, batch.length)
+  }
 }
 
-function estimateDropsFromMeta(meta){
-  if (!meta) return 0
-  let total = 0
-  try {
-    const balances = getBalanceChanges(meta)
-    for (const acct of balances) {
-      for (const ch of acct.balances) {
-        if (ch.currency === 'XRP') {
-          total += Math.abs(parseFloat(ch.value)) * 1_000_000 // to drops
-        }
-      }
-    }
-  } catch {}
-  return Math.floor(total)
+// Beneficiary heuristic: ledgerVolume() credits the initiating Account of each transaction
+function accrualsFromLedger(transactions){
+  const entries = []
+  for (const { tx_blob, meta } of transactions) {
+    if (!tx_blob || !meta) continue
+    const tx = Buffer.from(tx_blob, 'hex')
+    if (!TRACKED_TYPES.has(readField(tx, 'TransactionType'))) continue
+    entries.push({ tx, meta: Buffer.from(meta, 'hex') })
+  }
+  return ledgerVolume(entries)
+    .filter(v => v.drops > 0n)
+    .map(v => {
+      const drops = v.drops / ACCRUAL_DIVISOR
+      return { account: v.account, drops: (drops > 0n ? drops : 1n).toString() }
+    })
 }
 
 async function main(){
   const wss = process.env.XAHAU_WSS || 'wss://xahau.network'
   const client = new xrpl.Client(wss)
   await client.connect()
-  await client.request({ command: 'subscribe', streams: ['transactions'] })
-  console.log('Subscribed to transactions on', wss)
-
-  client.on('transaction', async (ev) => {
-    try {
-      const tx = ev.transaction
-      const meta = ev.meta
-      if (!tx || !meta) return
-      // Focus on AMM-related or high-volume payments; refine as needed
-      const t = tx.TransactionType
-      if (t !== 'AMMDeposit' && t !== 'AMMWithdraw' && t !== 'Payment') return
+  await client.request({ command: 'subscribe', streams: ['ledger'] })
+  console.log('Subscribed to ledgers on', wss)
 
-      const drops = estimateDropsFromMeta(meta)
-      if (!drops || drops <= 0) return
-      const beneficiary = pickBeneficiaryFromTx(tx)
-      if (!beneficiary) return
-
-      const scaled = Math.max(1, Math.floor(drops * 0.0001)) // 0.01% accrual as a placeholder
-      await pushAccrual(beneficiary, scaled)
-    } catch (e) {
-      console.error('tx handler error', e)
-    }
+  // Ledgers are handled one at a time, in close order
+  let queue = Promise.resolve()
+  client.on('ledgerClosed', (ev) => {
+    queue = queue.then(async () => {
+      try {
+        const { result } = await client.request({
+          command: 'ledger', ledger_index: ev.ledger_index,
+          transactions: true, expand: true, binary: true
+        })
+        const accruals = accrualsFromLedger(result.ledger.transactions || [])
+        if (accruals.length) await pushAccruals(ev.ledger_index, accruals)
+      } catch (e) {
+        console.error('ledger handler error', ev.ledger_index, e)
+      }
+    })
   })
 }
 
@@ -0,0 +1,128 @@
+/**
+ * Claim dry run for /claim/preview: what a CLAIM from an account would do if it were
+ * submitted now, without paying a fee to find out
+ *
+ * The decision is made by the claim hook's own rules compiled into backend/native
+ * (hooks/include/drippy_claim_rules.h), fed with what the hook would read on ledger:
+ * the account's claim state, the installed HookParameters, the last ledger close time
+ * and, when NFT_TBL is set, the URITokens the claimant lists.
+ */
+
+const { claimPreview } = require('../native')
+
+const RIPPLE_EPOCH = 946684800
+const PARAMS_TTL_MS = 60000
+const NFT_IDS_MAX = 8
+
+// HookParameters of an account's hooks, cached briefly: they change only with SetHook
+const paramCache = new Map()
+
+function parameterMap(list, into) {
+  for (const { HookParameter: p } of list || []) {
+    if (!p || !p.HookParameterName) continue
+    const name = Buffer.from(p.HookParameterName, 'hex').toString('utf8')
+    into[name] = p.HookParameterValue || ''
+  }
+  return into
+}
+
+/**
+ * Parameters the hook at `account` runs with: its definition's defaults overridden by
+ * the ones on the install. `hookHash` picks the hook when the account has several;
+ * otherwise the first installed hook is used.
+ */
+async function readHookParameters(client, account, hookHash) {
+  const cached = paramCache.get(account)
+  if (cached && Date.now() - cached.at < PARAMS_TTL_MS) return cached.params
+
+  const res = await client.request({
+    command: 'account_objects',
+    account,
+    type: 'hook',
+    ledger_index: 'validated'
+  })
+  const hooks = (res.result?.account_objects?.[0]?.Hooks || []).map(h => h.Hook).filter(h => h && h.HookHash)
+  const hook = hookHash ? hooks.find(h => h.HookHash.toUpperCase() === hookHash.toUpperCase()) : hooks[0]
+  if (!hook) throw new Error(`no hook installed on ${account}`)
+
+  const definition = await client.request({
+    command: 'ledger_entry',
+    hook_definition: hook.HookHash,
+    ledger_index: 'validated'
+  })
+  const params = parameterMap(hook.HookParameters, parameterMap(definition.result?.node?.HookParameters, {}))
+  paramCache.set(account, { at: Date.now(), params })
+  return params
+}
+
+/**
+ * Issuer and taxon of each listed URIToken, checked the way derive_nft_boost() in the
+ * hook checks them; null when one is missing, listed twice or not owned by `owner`
+ */
+async function readClaimNfts(client, owner, ids) {
+  if (new Set(ids.map(id => id.toUpperCase())).size !== ids.length) return null
+  const nodes = await Promise.all(ids.map(async (id) => {
+    try {
+      const res = await client.request({ command: 'ledger_entry', index: id, ledger_index: 'validated' })
+      return res.result.node
+    } catch (error) {
+      return null
+    }
+  }))
+
+  const nfts = []
+  for (const node of nodes) {
+    if (!node || node.LedgerEntryType !== 'URIToken' || node.Owner !== owner || !node.Issuer) return null
+    // URITokens carry no taxon; the hook reads the first 4 bytes of the Digest instead
+    const digest = node.Digest && node.Digest.length === 64 ? Buffer.from(node.Digest, 'hex') : null
+    nfts.push({ issuer: node.Issuer, taxon: digest ? digest.readUInt32BE(0) : 0 })
+  }
+  return nfts
+}
+
+/**
+ * Preview of a CLAIM by `account` (classic address) whose 32-byte claim state is
+ * `state` (null when it has none). `nftIds` are the URIToken IDs its NFTS memo would
+ * carry. Amounts are strings of drops, times are ISO strings.
+ */
+async function previewClaim(client, { hookAccount, account, state, nftIds = [], profile, hookHash }) {
+  if (!claimPreview) throw new Error('claim preview needs the native addon (npm run build:native)')
+  if (nftIds.length > NFT_IDS_MAX) throw new RangeError(`a claim lists at most ${NFT_IDS_MAX} NFTs`)
+
+  const [params, ledgerRes] = await Promise.all([
+    readHookParameters(client, hookAccount, hookHash),
+    client.request({ command: 'ledger', ledger_index: 'validated' })
+  ])
+  const ledger = ledgerRes.result.ledger
+  const now = Number(ledger.close_time)
+
+  // Tokens are only loaded by the hook when NFT_TBL is configured
+  let nfts = []
+  if (params.NFT_TBL && nftIds.length) {
+    nfts = await readClaimNfts(client, account, nftIds)
+    if (!nfts) {
+      return { ok: false, error: 'nft not owned', ledger: Number(ledger.ledger_index) }
+    }
+  }
+
+  const r = claimPreview(state, { params, now, profile: profile || 'full', nfts })
+  const toTime = (t) => new Date((t + RIPPLE_EPOCH) * 1000).toISOString()
+  return {
+    ok: r.ok,
+    error: r.error,
+    payout: r.payout.toString(),
+    paid: r.paid.toString(),
+    boost: r.boost,
+    remaining: r.remaining.toString(),
+    claimCount: r.claimCount,
+    nextEligible: toTime(r.nextEligible),
+    evaluatedAt: toTime(now),
+    ledger: Number(ledger.ledger_index)
+  }
+}
+
+module.exports = {
+  readHookParameters,
+  readClaimNfts,
+  previewClaim
+}
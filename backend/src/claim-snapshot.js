@@ -0,0 +1,133 @@
+/**
+ * Local snapshot of the claim hook's per-account state (backend/native ClaimSnapshot)
+ *
+ * Balance reads are served from a memory-mapped file instead of a ledger request per
+ * HTTP call. The file is built once from the whole claim namespace, then kept current
+ * from the hook's change log (hooks/include/drippy_changes.h): on every validated
+ * ledger the changes since the stored cursor name the accounts whose state moved, and
+ * only those entries are fetched and written. When the log has lapped the cursor the
+ * snapshot is rebuilt from the namespace.
+ */
+
+const { ClaimSnapshot, decodeHead } = require('../native')
+const { CHANGE_LOG, readState, readChangesSince } = require('./hook-events')
+
+const CLAIM_PREFIX = Buffer.from('DRIPPY:CLAIM', 'utf8')
+const CLAIM_STATE_SIZE = 32
+
+// HookStateKey of an account's claim state: "DRIPPY:CLAIM" + 20-byte account id
+function claimStateKey(accountId) {
+  return Buffer.concat([CLAIM_PREFIX, Buffer.from(accountId)]).toString('hex').toUpperCase()
+}
+
+// Fields of a 32-byte claim state (src/drippy_enhanced_claim.c)
+function decodeClaimState(data) {
+  return {
+    accrued: data.readBigUInt64BE(0),
+    lastClaim: Number(data.readBigUInt64BE(8)),
+    claimCount: data.readUInt32BE(16),
+    boost: data.readUInt32BE(20),
+    dailyClaimed: data.readBigUInt64BE(24)
+  }
+}
+
+function snapshotEntry(accountId, data) {
+  const entry = Buffer.alloc(20 + CLAIM_STATE_SIZE)
+  Buffer.from(accountId).copy(entry, 0)
+  if (data && data.length === CLAIM_STATE_SIZE) data.copy(entry, 20)
+  return entry
+}
+
+// Every claim state in the namespace, as snapshot entries
+async function readAllClaims(client, account, namespace) {
+  const entries = []
+  let marker
+  do {
+    const res = await client.request({
+      command: 'account_namespace',
+      account,
+      namespace_id: namespace,
+      ledger_index: 'validated',
+      ...(marker ? { marker } : {})
+    })
+    for (const state of res.result?.namespace_entries || []) {
+      const key = Buffer.from(state.HookStateKey, 'hex')
+      const data = Buffer.from(state.HookStateData, 'hex')
+      if (!key.subarray(0, CLAIM_PREFIX.length).equals(CLAIM_PREFIX)) continue
+      if (data.length !== CLAIM_STATE_SIZE) continue
+      entries.push(snapshotEntry(key.subarray(CLAIM_PREFIX.length), data))
+    }
+    marker = res.result?.marker
+  } while (marker)
+  return entries
+}
+
+// The change log's next sequence number; changes from it on are not in a rebuild yet
+async function changeLogHead(client, account, namespace) {
+  const data = await readState(client, account, namespace, CHANGE_LOG.head)
+  const head = data && decodeHead(data)
+  return head ? head.next : 0
+}
+
+async function rebuild(client, store, account, namespace, ledger) {
+  const cursor = await changeLogHead(client, account, namespace)
+  const entries = await readAllClaims(client, account, namespace)
+  store.apply(Buffer.concat(entries), { ledger, cursor, replace: true })
+  return { rebuilt: true, accounts: entries.length }
+}
+
+/**
+ * Brings the snapshot up to `ledger`. A fresh snapshot, or one whose cursor the change
+ * log has overwritten, is rebuilt; otherwise only the accounts in the new changes are
+ * re-read.
+ */
+async function refreshClaimSnapshot(client, store, account, namespace, ledger) {
+  const { ledger: current, cursor } = store.info()
+  if (current === 0) return rebuild(client, store, account, namespace, ledger)
+
+  const { changes, cursor: next, missed } = await readChangesSince(client, account, namespace, cursor)
+  if (missed > 0) return rebuild(client, store, account, namespace, ledger)
+
+  const accounts = [...new Set(changes.map(c => c.account))]
+  const states = await Promise.all(
+    accounts.map(id => readState(client, account, namespace, claimStateKey(Buffer.from(id, 'hex'))))
+  )
+  const entries = accounts.map((id, i) => snapshotEntry(Buffer.from(id, 'hex'), states[i]))
+  store.apply(Buffer.concat(entries), { ledger, cursor: next })
+  return { rebuilt: false, accounts: accounts.length }
+}
+
+/**
+ * Opens the snapshot at `path` and refreshes it on every validated ledger the client
+ * reports. Ledgers are handled one at a time; a failed refresh is retried with the
+ * next ledger, the snapshot keeps serving the state it has.
+ */
+async function followClaimSnapshot(client, path, account, namespace) {
+  const store = new ClaimSnapshot(path)
+  let queue = Promise.resolve()
+  const refresh = (ledger) => {
+    queue = queue.then(async () => {
+      try {
+        await refreshClaimSnapshot(client, store, account, namespace, ledger)
+      } catch (error) {
+        console.error('claim snapshot refresh failed', ledger, error.message)
+      }
+    })
+    return queue
+  }
+
+  client.on('ledgerClosed', (ev) => refresh(ev.ledger_index))
+  await client.request({ command: 'subscribe', streams: ['ledger'] })
+  const { result } = await client.request({ command: 'ledger', ledger_index: 'validated' })
+  await refresh(Number(result.ledger_index || result.ledger?.ledger_index || 0))
+  return store
+}
+
+module.exports = {
+  CLAIM_PREFIX,
+  CLAIM_STATE_SIZE,
+  claimStateKey,
+  decodeClaimState,
+  refreshClaimSnapshot,
+  followClaimSnapshot
+}
@@ -0,0 +1,120 @@
+/**
+ * Readers for the record rings the hooks keep in state (hooks/include/drippy_ring.h)
+ *
+ * - Event ring ("DRIPPY:EVT:", drippy_trace.h): one record per operation of the Builder hooks
+ * - Change log ("DRIPPY:CHG:", drippy_changes.h): one record per state change of the
+ *   claim and fee router hooks
+ *
+ * Each ring keeps the next sequence number in a head entry. A reader holds a cursor (the
+ * next sequence it has not seen) and fetches only the slots written since, so the cost
+ * of a poll is the number of new records rather than the size of the ledger. Records
+ * are decoded a page at a time by backend/native.
+ */
+
+const { decodeRecords, decodeHead } = require('../native')
+
+const RING_RECORD_SIZE = 48
+
+const EVENT_OPS = { 1: 'route', 2: 'claim', 3: 'accrue', 4: 'fee' }
+const EVENT_RESULTS = { 0: 'ok', 1: 'skipped' }
+const CHANGE_OPS = { 1: 'accrued', 2: 'boost', 3: 'routed', 4: 'routed_iou', 5: 'whitelist' }
+
+// Namespaces used by deploy-enhanced.js (Builder hooks) and deploy-fee-router.js
+const DEFAULT_NAMESPACE = Buffer.from('DRIPPY', 'utf8').toString('hex').padEnd(64, '0').toUpperCase()
+const FEE_ROUTER_NAMESPACE = Buffer.from('DRIPPY:FEE:ROUTER:v1', 'utf8').toString('hex').padEnd(64, '0').toUpperCase()
+
+function stateKey(prefix, slot) {
+  const key = Buffer.alloc(32)
+  key.write(prefix, 0, 'utf8')
+  if (slot !== undefined) key.writeUInt32BE(slot, 28)
+  return key.toString('hex').toUpperCase()
+}
+
+const EVENT_RING = { head: stateKey('DRIPPY:EVT:HEAD'), prefix: 'DRIPPY:EVT:' }
+const CHANGE_LOG = { head: stateKey('DRIPPY:CHG:HEAD'), prefix: 'DRIPPY:CHG:' }
+
+function toEvent(record) {
+  return {
+    ...record,
+    op: EVENT_OPS[record.op] || `op${record.op}`,
+    result: EVENT_RESULTS[record.result] ?? record.result,
+    // Drops for route/claim/accrue; XFL bits for fee
+    amount: record.value
+  }
+}
+
+function toChange(record) {
+  return { ...record, op: CHANGE_OPS[record.op] || `op${record.op}` }
+}
+
+// Raw HookStateData of one key, or null when the entry does not exist
+async function readState(client, account, namespace, key) {
+  try {
+    const res = await client.request({
+      command: 'ledger_entry',
+      hook_state: { account, key, namespace_id: namespace },
+      ledger_index: 'validated'
+    })
+    return Buffer.from(res.result.node.HookStateData, 'hex')
+  } catch (error) {
+    if (error.data?.error === 'entryNotFound' || /entryNotFound/.test(error.message)) return null
+    throw error
+  }
+}
+
+/**
+ * Records with seq >= cursor, oldest first. A null cursor starts at the oldest record
+ * still in the ring. `missed` counts records overwritten before they were read.
+ */
+async function readRingSince(client, account, namespace, ring, cursor = null) {
+  const headData = await readState(client, account, namespace, ring.head)
+  const head = headData && decodeHead(headData)
+  if (!head) return { records: [], cursor: cursor ?? 0, missed: 0 }
+
+  const oldest = Math.max(0, head.next - head.slots)
+  let from = cursor === null ? oldest : cursor
+  let missed = 0
+  if (from < oldest) {
+    missed = oldest - from
+    from = oldest
+  }
+
+  const seqs = []
+  for (let seq = from; seq < head.next; seq++) seqs.push(seq)
+  const slots = await Promise.all(
+    seqs.map(seq => readState(client, account, namespace, stateKey(ring.prefix, seq % head.slots)))
+  )
+
+  const page = slots.filter(data => data && data.length === RING_RECORD_SIZE)
+  const records = []
+  for (const record of decodeRecords(Buffer.concat(page))) {
+    // A newer record in the slot means the hook lapped us while paging
+    if (record.seq < from || record.seq >= head.next) continue
+    records.push(record)
+  }
+  missed += seqs.length - records.length
+
+  return { records, cursor: head.next, missed }
+}
+
+async function readEventsSince(client, account, namespace = DEFAULT_NAMESPACE, cursor = null) {
+  const { records, ...rest } = await readRingSince(client, account, namespace, EVENT_RING, cursor)
+  return { events: records.map(toEvent), ...rest }
+}
+
+async function readChangesSince(client, account, namespace = DEFAULT_NAMESPACE, cursor = null) {
+  const { records, ...rest } = await readRingSince(client, account, namespace, CHANGE_LOG, cursor)
+  return { changes: records.map(toChange), ...rest }
+}
+
+module.exports = {
+  DEFAULT_NAMESPACE,
+  FEE_ROUTER_NAMESPACE,
+  EVENT_RING,
+  CHANGE_LOG,
+  stateKey,
+  readState,
+  readRingSince,
+  readEventsSince,
+  readChangesSince
+}
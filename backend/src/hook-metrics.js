@@ -0,0 +1,75 @@
+/**
+ * Reader for the hourly/daily metric buckets the hooks keep in state
+ * (hooks/include/drippy_metrics.h)
+ *
+ * All buckets of a hook come back from one account_namespace query; this module picks
+ * the ones still current for the requested window and fills the periods without
+ * activity with zeros, so a chart gets exactly `count` points.
+ */
+
+const METRIC_BUCKET_SIZE = 80
+const METRIC_POOLS = 6
+const RIPPLE_EPOCH = 946684800
+
+const PERIODS = {
+  hour: { seconds: 3600, prefix: 'DRIPPY:MET:H' },
+  day: { seconds: 86400, prefix: 'DRIPPY:MET:D' }
+}
+
+function decodeBucket(buf) {
+  if (buf.length !== METRIC_BUCKET_SIZE) return null
+  const pools = []
+  for (let i = 0; i < METRIC_POOLS; i++) pools.push(buf.readBigUInt64BE(16 + i * 8))
+  return {
+    period: buf.readUInt32BE(0),
+    operations: buf.readUInt32BE(4),
+    volume: buf.readBigUInt64BE(8),
+    pools,
+    claimed: buf.readBigUInt64BE(64),
+    claims: buf.readUInt32BE(72)
+  }
+}
+
+function emptyBucket(period) {
+  return {
+    period,
+    operations: 0,
+    volume: 0n,
+    pools: new Array(METRIC_POOLS).fill(0n),
+    claimed: 0n,
+    claims: 0
+  }
+}
+
+// Last `count` buckets of `period` ('hour' or 'day'), oldest first
+async function readMetrics(client, account, namespace, period = 'hour', count = 24) {
+  const spec = PERIODS[period]
+  if (!spec) throw new Error(`unknown period ${period}`)
+
+  const res = await client.request({
+    command: 'account_namespace',
+    account,
+    namespace_id: namespace,
+    ledger_index: 'validated'
+  })
+
+  const prefix = Buffer.from(spec.prefix, 'utf8')
+  const byPeriod = new Map()
+  for (const entry of res.result?.namespace_entries || []) {
+    const key = Buffer.from(entry.HookStateKey, 'hex')
+    if (!key.subarray(0, prefix.length).equals(prefix) || key[prefix.length] !== 0) continue
+    const bucket = decodeBucket(Buffer.from(entry.HookStateData, 'hex'))
+    if (bucket) byPeriod.set(bucket.period, bucket)
+  }
+
+  const now = Math.floor(Date.now() / 1000) - RIPPLE_EPOCH
+  const current = Math.floor(now / spec.seconds)
+  const buckets = []
+  for (let p = current - count + 1; p <= current; p++) {
+    const bucket = byPeriod.get(p) || emptyBucket(p)
+    buckets.push({ ...bucket, start: new Date((p * spec.seconds + RIPPLE_EPOCH) * 1000).toISOString() })
+  }
+  return buckets
+}
+
+module.exports = { PERIODS, decodeBucket, readMetrics }
@@ -14,6 +14,7 @@ require('dotenv').config()
 const { Client } = require('xahau')
 const fs = require('fs')
 const path = require('path')
+const { DEFAULT_NAMESPACE, readEventsSince, readChangesSince } = require('./hook-events')
 
 class HookMonitor {
   constructor() {
@@ -31,16 +32,25 @@ class HookMonitor {
       utility: {
         account: process.env.UTILITY_HOOK_ACCOUNT,
         name: 'DRIPPY Utility Hook',
+        namespace: process.env.UTILITY_HOOK_NAMESPACE || DEFAULT_NAMESPACE,
+        cursor: null,
+        changeCursor: null,
         active: true
       },
       router: {
         account: process.env.ENHANCED_ROUTER_ACCOUNT,
         name: 'Enhanced Fee Router',
+        namespace: process.env.ENHANCED_ROUTER_NAMESPACE || DEFAULT_NAMESPACE,
+        cursor: null,
+        changeCursor: null,
         active: true
       },
       claim: {
         account: process.env.CLAIM_HOOK_ACCOUNT,
         name: 'Claim Hook',
+        namespace: process.env.CLAIM_HOOK_NAMESPACE || DEFAULT_NAMESPACE,
+        cursor: null,
+        changeCursor: null,
         active: true
       }
     }
@@ -119,26 +129,51 @@ class HookMonitor {
     await this.pollHookAccounts()
   }
 
+  // Page each hook's event ring and change log from their cursors; only records since
+  // the last poll are read
   async pollHookAccounts() {
     try {
       for (const [type, hook] of Object.entries(this.hooks)) {
         if (!hook.active || !hook.account) continue
 
-        // Get account info
-        const accountInfo = await this.client.request({
-          command: 'account_info',
-          account: hook.account
-        })
+        const { events, cursor, missed } = await readEventsSince(this.client, hook.account, hook.namespace, hook.cursor)
+        hook.cursor = cursor
 
-        // Simple activity check
-        const balance = parseInt(accountInfo.result.account_data.Balance) / 1000000
-        console.log(`📋 ${hook.name}: Balance ${balance} XAH`)
+        if (missed > 0) {
+          console.log(`⚠️  ${hook.name}: ${missed} events overwritten before they were read`)
+        }
+        for (const event of events) {
+          this.recordEvent(hook, event)
+        }
+
+        const changes = await readChangesSince(this.client, hook.account, hook.namespace, hook.changeCursor)
+        hook.changeCursor = changes.cursor
+        if (changes.missed > 0) {
+          console.log(`⚠️  ${hook.name}: ${changes.missed} changes overwritten before they were read`)
+        }
+        for (const change of changes.changes) {
+          console.log(`🔁 ${hook.name} change #${change.seq} @${change.ledger}: ${change.op} ${change.account} = ${change.value}`)
+        }
       }
     } catch (error) {
       console.log('❌ Polling error:', error.message)
     }
   }
 
+  recordEvent(hook, event) {
+    console.log(`📋 ${hook.name} #${event.seq} @${event.ledger}: ${event.op} ${event.result} ${event.account} ${event.amount}`)
+
+    if (event.result !== 'ok') return
+
+    if (event.op === 'claim') {
+      this.stats.totalClaims++
+    } else if (event.op === 'route') {
+      this.stats.totalDistributions++
+      this.stats.totalAmount += Number(event.amount)
+    }
+    this.stats.lastActivity = new Date().toISOString()
+  }
+
   async handleTransaction(tx) {
     try {
       const { transaction, meta } = tx
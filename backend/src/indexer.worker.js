@@ -1,19 +1,15 @@
 // Minimal indexer skeleton: periodically pushes mock accruals to Hook state on Xahau
 require('dotenv').config()
-const fetch = (...args) => import('node-fetch').then(({default: fetch}) => fetch(...args))
+const { pushAccruals } = require('./accruals')
 
 async function sleep(ms){ return new Promise(r=>setTimeout(r,ms)) }
 
+// Signed here and sent on a Ticket (src/tx-sender.js); validation is not waited for
 async function pushAccrual(account, drops){
-  const base = process.env.API_BASE || 'http://localhost:8787'
-  const res = await fetch(`${base}/admin/push-accrual`,{
-    method:'POST', headers:{'Content-Type':'application/json'},
-    body: JSON.stringify({ account, drops })
-  })
-  if(!res.ok){
-    const txt = await res.text(); throw new Error(`push-accrual failed: ${res.status} ${txt}`)
-  }
-  return res.json()
+  const [sent] = await pushAccruals([{ account, drops }])
+  if(sent.error) throw new Error(`push-accrual failed: ${sent.error}`)
+  sent.validated.catch(e=>console.error('accrual', sent.hash, e.message))
+  return sent
 }
 
 async function main(){
@@ -0,0 +1,96 @@
+// NFT boost follower: keeps the claim hook's stored BOOST in step with holdings of the
+// DRIPPY collection (Taxon 2 of the NFT issuer on XRPL mainnet).
+//
+// The holdings are listed once (NFTService.getCollectionOwners), then every validated
+// ledger's metadata is applied to a BoostIndex (backend/native), which reports only the
+// holders whose count crossed into another boost tier. Those get one BOOST admin Payment
+// each (src/accruals.js); a ledger without NFT movement sends nothing.
+//
+// NFT_BOOST_TIERS  count:boost pairs, boost in hook units (100 = 1x), e.g. "1:150,3:200"
+// CLAIM_SNAPSHOT_PATH  when set, the boosts the hook stores now (src/claim-snapshot.js)
+//                      are read from it so the first round only sends real differences
+require('dotenv').config()
+const NFTService = require('./nft-service')
+const { BoostIndex, ClaimSnapshot, readField } = require('../native')
+const { pushBoosts } = require('./accruals')
+
+const DEFAULT_TIERS = '1:150,3:200,5:300,10:400,25:500'
+
+function parseTiers(spec) {
+  return spec.split(',').map(pair => pair.split(':').map(Number))
+}
+
+// Boosts the hook stores for `accounts`, from the claim snapshot file when there is one
+function storedBoosts(accounts) {
+  if (!process.env.CLAIM_SNAPSHOT_PATH) return []
+  const snapshot = new ClaimSnapshot(process.env.CLAIM_SNAPSHOT_PATH)
+  try {
+    return accounts.map(account => ({ account, boost: snapshot.get(account)?.boost || 100 }))
+  } finally {
+    snapshot.close()
+  }
+}
+
+// Sends `changes`; failed ones are kept and retried with the next round unless a newer
+// boost for the same account replaces them
+const retry = new Map()
+
+async function sendBoosts(ledger, changes) {
+  for (const c of changes) retry.set(c.account, c.boost)
+  if (!retry.size) return
+  const boosts = [...retry].map(([account, boost]) => ({ account, boost }))
+  const sent = await pushBoosts(boosts)
+  for (const s of sent) {
+    if (!s.error && retry.get(s.account) === s.boost) retry.delete(s.account)
+  }
+  console.log('boosts ->', ledger, sent.length - retry.size, 'sent,', retry.size, 'to retry')
+}
+
+async function main(){
+  const nftService = new NFTService()
+  const index = new BoostIndex({
+    issuer: nftService.issuerAccount,
+    taxon: nftService.targetTaxon,
+    tiers: parseTiers(process.env.NFT_BOOST_TIERS || DEFAULT_TIERS)
+  })
+
+  await nftService.connect()
+  const client = nftService.client
+  const { ledger: seeded, tokens } = await nftService.getCollectionOwners()
+  index.load(tokens)
+  index.baseline(storedBoosts([...new Set(tokens.map(t => t.owner))]))
+  console.log('Loaded', index.info(), 'at ledger', seeded)
+  await sendBoosts(seeded, index.flush())
+
+  // Ledgers are applied one at a time, in order, including any the stream skipped
+  let applied = seeded
+  let queue = Promise.resolve()
+  client.on('ledgerClosed', (ev) => {
+    queue = queue.then(async () => {
+      while (applied < ev.ledger_index) {
+        const ledger = applied + 1
+        try {
+          const { result } = await client.request({
+            command: 'ledger', ledger_index: ledger,
+            transactions: true, expand: true, binary: true
+          })
+          // Binary ledgers list transactions by hash; metadata carries their order
+          const metas = (result.ledger.transactions || [])
+            .filter(t => t.meta)
+            .map(t => Buffer.from(t.meta, 'hex'))
+            .sort((a, b) => readField(a, 'TransactionIndex') - readField(b, 'TransactionIndex'))
+          const changes = index.apply(metas)
+          applied = ledger
+          await sendBoosts(ledger, changes)
+        } catch (e) {
+          console.error('ledger handler error', ledger, e.message)
+          return
+        }
+      }
+    })
+  })
+  await client.request({ command: 'subscribe', streams: ['ledger'] })
+  console.log('Following NFT boosts on', nftService.mainnetWSS)
+}
+
+main().catch(e=>{console.error(e); process.exit(1)})
@@ -138,6 +138,57 @@ class NFTService {
     }
   }
 
+  /**
+   * Token ids and owners of the whole collection, without metadata: { ledger, tokens:
+   * [{ id, owner }] }. Read from Clio's nfts_by_issuer at one validated ledger; servers
+   * without it fall back to the Bithomp listing, with ledger the one validated before it.
+   */
+  async getCollectionOwners(issuer = this.issuerAccount, taxon = this.targetTaxon) {
+    await this.connect()
+
+    const tokens = []
+    let marker
+    let ledger
+    try {
+      do {
+        const { result } = await this.client.request({
+          command: 'nfts_by_issuer',
+          issuer,
+          nft_taxon: taxon,
+          limit: 400,
+          ledger_index: ledger || 'validated',
+          ...(marker ? { marker } : {})
+        })
+        ledger = result.ledger_index
+        for (const nft of result.nfts || []) {
+          if (!nft.is_burned) tokens.push({ id: nft.nft_id, owner: nft.owner })
+        }
+        marker = result.marker
+      } while (marker)
+      return { ledger, tokens }
+    } catch (error) {
+      if (!this.bithompApiKey) throw error
+      console.log(`⚠️ nfts_by_issuer unavailable (${error.message}), listing owners via Bithomp`)
+    }
+
+    const { result } = await this.client.request({ command: 'ledger', ledger_index: 'validated' })
+    ledger = Number(result.ledger_index)
+    tokens.length = 0
+    marker = null
+    do {
+      const url = `${this.bithompBaseUrl}/nfts?issuer=${issuer}&limit=100${marker ? `&marker=${marker}` : ''}`
+      const response = await axios.get(url, {
+        headers: { 'x-bithomp-token': this.bithompApiKey, 'User-Agent': 'DRIPPY-NFT-Service/1.0' },
+        timeout: 30000
+      })
+      for (const nft of response.data.nfts || []) {
+        if (nft.nftokenTaxon === taxon && nft.owner) tokens.push({ id: nft.nftokenID, owner: nft.owner })
+      }
+      marker = response.data.marker
+    } while (marker)
+    return { ledger, tokens }
+  }
+
   /**
    * Get NFTs owned by a specific account
    */
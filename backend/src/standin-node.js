@@ -0,0 +1,847 @@
+/**
+ * Local Xahau stand-in node for integration and load testing
+ *
+ * A WebSocket server speaking the part of the rippled API the backend uses (subscribe,
+ * server_info, fee, account_info, account_objects, account_namespace, ledger_entry,
+ * ledger, tx, submit, and the ledger and transaction streams), so hook-monitor.js, the
+ * routes, the indexers and TxSender run unchanged against XAHAU_WSS=ws://localhost:6006.
+ *
+ * Payments are executed by our hooks: hooks/build/sim/drippy_standin (make -C hooks
+ * standin) runs the utility, router and claim hooks compiled natively against the hook
+ * API emulator, holds balances and hook state and applies emitted transactions as the
+ * next ledger opens. This process keeps the rest: Sequences and Tickets, fees, the open
+ * ledger and a window of closed ones, and the streams. A ledger closes every ledgerMs.
+ *
+ * Not a node: signatures are not checked, every ledger_index reads the current state,
+ * transaction types other than Payment and TicketCreate only pay their fee, and
+ * HookInstructionCount carries the emulator's guard iterations.
+ *
+ * Configuration: the JSON file given as the first argument (standin.example.json):
+ *   port, ledgerMs, networkId, baseFee, hookFee, history (closed ledgers kept)
+ *   accounts  { address: drops } funded at the start
+ *   hooks     [{ account, hook: utility|router|claim, namespace (ASCII), params }] with
+ *             parameter values as addresses (their account id) or hex
+ */
+
+require('dotenv').config()
+const { spawn } = require('child_process')
+const crypto = require('crypto')
+const fs = require('fs')
+const path = require('path')
+const { WebSocketServer } = require('ws')
+const { decodeTx, encodeTx, encodeAccounts, decodeAccounts } = require('../native')
+
+const RIPPLE_EPOCH = 946684800
+const TXN_PREFIX = Buffer.from('54584E00', 'hex')
+const LEDGER_PREFIX = Buffer.from('4C575200', 'hex')
+const SPACE = {
+  account: Buffer.from([0x00, 0x61]),
+  hook: Buffer.from([0x00, 0x48]),
+  hookState: Buffer.from([0x00, 0x76]),
+  ticket: Buffer.from([0x00, 0x54])
+}
+const STANDIN_BIN = process.env.STANDIN_BIN || path.join(__dirname, '../hooks/build/sim/drippy_standin')
+const DEFAULT_CONFIG = path.join(__dirname, '../standin.example.json')
+
+// Requests to the ledger process (hooks/sim/drippy_standin.c) and its results (EMU_*)
+const OP = { HOOK: 1, ACCOUNT: 2, STATE: 3, SUBMIT: 8, LEDGER: 9, ENTRIES: 10 }
+const EMU = { SUCCESS: 0, REJECTED: 1, UNFUNDED: 2, MALFORMED: 3 }
+
+const NAMESPACES = { utility: 'DRIPPY', router: 'DRIPPY:FEE:ROUTER:v1', claim: 'DRIPPY' }
+const HOOK_ON_PAYMENT = 'FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFBFFFFE'
+const HOOK_ACCEPT = 3
+const HOOK_ROLLBACK = 2
+const TICKETS_MAX = 250
+
+const RESULTS = {
+  tesSUCCESS: [0, 'The transaction was applied.'],
+  tecUNFUNDED_PAYMENT: [104, 'Insufficient XRP balance to send.'],
+  tecHOOK_REJECTED: [153, 'Rejected by hook on sending or receiving account.'],
+  tefALREADY: [-198, 'The exact transaction was already in this ledger.'],
+  tefMAX_LEDGER: [-186, 'Ledger sequence too high.'],
+  tefNO_TICKET: [-180, 'Ticket is not in ledger.'],
+  tefPAST_SEQ: [-190, 'This sequence number has already passed.'],
+  telINSUF_FEE_P: [-394, 'Fee insufficient.'],
+  temMALFORMED: [-299, 'Malformed transaction.'],
+  terINSUF_FEE_B: [-99, 'Account balance can\'t pay fee.'],
+  terNO_ACCOUNT: [-96, 'The source account does not exist.'],
+  terPRE_SEQ: [-92, 'Missing/inapplicable prior transaction.']
+}
+
+const ENTRY_TYPES = { AccountRoot: 0x61, HookState: 0x76, Ticket: 0x54 }
+
+function sha512Half(...parts) {
+  return crypto.createHash('sha512').update(Buffer.concat(parts)).digest().subarray(0, 32)
+}
+
+function hex(buf) {
+  return Buffer.from(buf).toString('hex').toUpperCase()
+}
+
+function u32(v) {
+  const b = Buffer.alloc(4)
+  b.writeUInt32BE(v)
+  return b
+}
+
+function i64(v) {
+  const b = Buffer.alloc(8)
+  b.writeBigInt64BE(BigInt(v))
+  return b
+}
+
+function rippleTime() {
+  return Math.floor(Date.now() / 1000) - RIPPLE_EPOCH
+}
+
+function isApplied(result) {
+  return /^te[sc]/.test(result)
+}
+
+function accountId(address) {
+  return decodeAccounts([address])
+}
+
+function address(id) {
+  return encodeAccounts(id)[0]
+}
+
+class RpcError extends Error {
+  // `fields` go into the error response next to `error`, as rippled's do
+  constructor(error, message, fields) {
+    super(message || error)
+    this.error = error
+    this.fields = fields
+  }
+}
+
+// Parameter values: an address stands for its account id, anything else is hex
+function paramValue(value) {
+  return /^r[1-9A-HJ-NP-Za-km-z]{24,34}$/.test(value) ? accountId(value) : Buffer.from(value, 'hex')
+}
+
+function namespaceOf(ascii) {
+  const b = Buffer.alloc(32)
+  Buffer.from(ascii, 'utf8').copy(b)
+  return b
+}
+
+// ---- Ledger process ---------------------------------------------------------------
+
+class LedgerProcess {
+  constructor(args) {
+    if (!fs.existsSync(STANDIN_BIN)) throw new Error(`${STANDIN_BIN} missing: run make -C hooks standin`)
+    this.child = spawn(STANDIN_BIN, args, { stdio: ['pipe', 'pipe', 'inherit'] })
+    this.waiting = []
+    this.input = Buffer.alloc(0)
+    this.failed = null
+    this.child.stdout.on('data', (chunk) => this.#read(chunk))
+    this.child.on('exit', (code) => this.#fail(new Error(`ledger process exited (${code})`)))
+    this.child.on('error', (error) => this.#fail(error))
+  }
+
+  // Replies come back in request order
+  call(op, ...parts) {
+    if (this.failed) return Promise.reject(this.failed)
+    const payload = Buffer.concat(parts)
+    const head = Buffer.alloc(5)
+    head[0] = op
+    head.writeUInt32BE(payload.length, 1)
+    this.child.stdin.write(Buffer.concat([head, payload]))
+    return new Promise((resolve, reject) => this.waiting.push({ resolve, reject }))
+  }
+
+  #read(chunk) {
+    this.input = this.input.length ? Buffer.concat([this.input, chunk]) : chunk
+    while (this.input.length >= 4) {
+      const len = this.input.readUInt32BE(0)
+      if (this.input.length < 4 + len) break
+      const reply = this.input.subarray(4, 4 + len)
+      this.input = this.input.subarray(4 + len)
+      this.waiting.shift().resolve(reply)
+    }
+  }
+
+  #fail(error) {
+    this.failed = error
+    for (const w of this.waiting.splice(0)) w.reject(error)
+  }
+
+  close() {
+    this.child.stdin.end()
+  }
+}
+
+class Reader {
+  constructor(buf) {
+    this.buf = buf
+    this.at = 0
+  }
+
+  bytes(n) {
+    this.at += n
+    return this.buf.subarray(this.at - n, this.at)
+  }
+
+  u8() { return this.buf[this.at++] }
+  u16() { return this.bytes(2).readUInt16BE(0) }
+  u32() { return this.bytes(4).readUInt32BE(0) }
+  u64() { return this.bytes(8).readBigUInt64BE(0) }
+  i64() { return this.bytes(8).readBigInt64BE(0) }
+  get done() { return this.at >= this.buf.length }
+}
+
+// Events of a SUBMIT or LEDGER reply (see drippy_standin.c)
+function parseEvents(buf) {
+  const r = new Reader(buf)
+  const events = []
+  while (!r.done) {
+    const e = { result: r.u8(), emitted: r.u8() === 1, fee: r.u64() }
+    e.blob = Buffer.from(r.bytes(r.u16()))
+    e.balances = []
+    for (let n = r.u8(); n > 0; n--) e.balances.push({ id: Buffer.from(r.bytes(20)), drops: r.i64() })
+    e.runs = []
+    for (let n = r.u8(); n > 0; n--) {
+      e.runs.push({ id: Buffer.from(r.bytes(20)), accepted: r.u8() === 1, emitted: r.u16(), guard: r.u64(), message: Buffer.from(r.bytes(r.u8())) })
+    }
+    e.state = []
+    for (let n = r.u16(); n > 0; n--) {
+      const id = Buffer.from(r.bytes(20))
+      const key = Buffer.from(r.bytes(32))
+      const deleted = r.u8() === 1
+      e.state.push({ id, key, deleted, data: Buffer.from(r.bytes(r.u16())) })
+    }
+    events.push(e)
+  }
+  return events
+}
+
+function paymentResult(e) {
+  if (e.result === EMU.SUCCESS) return 'tesSUCCESS'
+  if (e.result === EMU.REJECTED) return 'tecHOOK_REJECTED'
+  if (e.result === EMU.UNFUNDED) return e.fee > 0n ? 'tecUNFUNDED_PAYMENT' : 'terINSUF_FEE_B'
+  return e.balances.length ? 'temMALFORMED' : 'terNO_ACCOUNT'
+}
+
+// ---- Node --------------------------------------------------------------------------
+
+class StandinNode {
+  constructor(config) {
+    this.config = {
+      port: 6006,
+      ledgerMs: 4000,
+      networkId: 21337,
+      baseFee: 10,
+      hookFee: 10,
+      history: 256,
+      accounts: {},
+      hooks: [],
+      ...config
+    }
+    this.accounts = new Map()    // address -> { id, balance, sequence, tickets, ownerCount }
+    this.hooks = new Map()       // address -> { name, hookHash, namespace, params, keys }
+    this.txns = new Map()        // hash -> { tx, blob, meta, result, ledger, accounts, validated }
+    this.closed = []
+    this.open = null
+    this.queue = Promise.resolve()
+    this.clients = new Set()
+  }
+
+  // Runs mutations one at a time, in arrival order
+  #serial(fn) {
+    const run = this.queue.then(fn)
+    this.queue = run.catch(() => {})
+    return run
+  }
+
+  async start() {
+    const c = this.config
+    this.ledger = new LedgerProcess(['--base-fee', String(c.baseFee), '--hook-fee', String(c.hookFee)])
+
+    for (const h of c.hooks) {
+      if (!NAMESPACES[h.hook]) throw new Error(`unknown hook ${h.hook} (utility, router or claim)`)
+      const params = Object.entries(h.params || {}).map(([name, value]) => [Buffer.from(name), paramValue(value)])
+      const id = accountId(h.account)
+      const name = Buffer.from(h.hook)
+      const encoded = params.flatMap(([n, v]) => [Buffer.from([n.length]), n, Buffer.from([v.length >> 8, v.length & 0xFF]), v])
+      await this.ledger.call(OP.HOOK, id, Buffer.from([name.length]), name, Buffer.from([params.length >> 8, params.length & 0xFF]), ...encoded)
+      this.hooks.set(h.account, {
+        name: h.hook,
+        // The emulator writes the same hash into EmitDetails
+        hookHash: hex(sha512Half(name)),
+        namespace: namespaceOf(h.namespace || NAMESPACES[h.hook]),
+        params,
+        keys: new Set()
+      })
+      this.#account(h.account)
+    }
+    for (const [account, drops] of Object.entries(c.accounts)) {
+      const reply = await this.ledger.call(OP.ACCOUNT, accountId(account), i64(drops))
+      this.#account(account).balance = reply.readBigInt64BE(0)
+    }
+
+    // An empty closed ledger first, so 'validated' has something to point at
+    const genesis = { seq: 2, hash: hex(sha512Half(LEDGER_PREFIX, u32(2))), closeTime: rippleTime(), parentCloseTime: 0, parentHash: '0'.repeat(64), txns: [] }
+    this.closed.push(genesis)
+    this.open = { seq: 3, txns: [] }
+    await this.ledger.call(OP.LEDGER, u32(this.open.seq), u32(genesis.closeTime))
+    for (const account of this.accounts.values()) account.sequence = genesis.seq
+
+    this.server = new WebSocketServer({ port: c.port })
+    this.server.on('connection', (ws) => this.#connect(ws))
+    this.timer = setInterval(() => this.#serial(() => this.#close()).catch((e) => console.error('ledger close failed', e.message)), c.ledgerMs)
+    console.log(`Xahau stand-in on ws://localhost:${c.port}: ${this.hooks.size} hooks, ${this.accounts.size} accounts, ledger every ${c.ledgerMs} ms`)
+  }
+
+  async stop() {
+    clearInterval(this.timer)
+    if (this.server) await new Promise((resolve) => this.server.close(resolve))
+    this.ledger.close()
+  }
+
+  #account(address, id) {
+    let a = this.accounts.get(address)
+    if (!a) {
+      a = { id: id || accountId(address), balance: 0n, sequence: this.open ? this.open.seq : 0, tickets: new Set(), ownerCount: 0 }
+      this.accounts.set(address, a)
+    }
+    return a
+  }
+
+  get validated() {
+    return this.closed[this.closed.length - 1]
+  }
+
+  // Fee a node asks of `tx`: the base fee plus one hook fee per hook it runs
+  #requiredFee(tx) {
+    if (tx.TransactionType !== 'Payment') return BigInt(this.config.baseFee)
+    let hooks = this.hooks.has(tx.Account) ? 1 : 0
+    if (tx.Destination !== tx.Account && this.hooks.has(tx.Destination)) hooks++
+    return BigInt(this.config.baseFee + this.config.hookFee * hooks)
+  }
+
+  // ---- Transactions ----
+
+  #accountNode(address, before) {
+    const a = this.accounts.get(address)
+    const node = {
+      LedgerEntryType: 'AccountRoot',
+      LedgerIndex: hex(sha512Half(SPACE.account, a.id)),
+      FinalFields: { Account: address, Balance: String(a.balance), Flags: 0, OwnerCount: a.ownerCount, Sequence: a.sequence }
+    }
+    if (before !== undefined && before !== a.balance) node.PreviousFields = { Balance: String(before) }
+    return { ModifiedNode: node }
+  }
+
+  #ticketNode(kind, address, ticket) {
+    const a = this.accounts.get(address)
+    const fields = { Account: address, Flags: 0, OwnerNode: '0000000000000000', TicketSequence: ticket }
+    const node = { LedgerEntryType: 'Ticket', LedgerIndex: hex(sha512Half(SPACE.ticket, a.id, u32(ticket))) }
+    return { [kind]: { ...node, [kind === 'CreatedNode' ? 'NewFields' : 'FinalFields']: fields } }
+  }
+
+  // Balances, hook state and hook executions of an event, as metadata
+  #effects(e) {
+    const nodes = []
+    for (const b of e.balances) {
+      const account = this.#account(address(b.id), b.id)
+      const before = account.balance
+      account.balance = b.drops
+      nodes.push({ address: address(b.id), before })
+    }
+
+    const stateNodes = []
+    const changed = new Map()
+    for (const s of e.state) {
+      const owner = address(s.id)
+      const hook = this.hooks.get(owner)
+      const key = hex(s.key)
+      changed.set(owner, (changed.get(owner) || 0) + 1)
+      const node = { LedgerEntryType: 'HookState', LedgerIndex: hex(sha512Half(SPACE.hookState, s.id, s.key, hook.namespace)) }
+      const fields = { Flags: 0, HookStateKey: key, HookStateData: hex(s.data), OwnerNode: '0000000000000000' }
+      if (s.deleted) {
+        hook.keys.delete(key)
+        this.accounts.get(owner).ownerCount--
+        stateNodes.push({ DeletedNode: { ...node, FinalFields: { ...fields, HookStateData: '' } } })
+      } else if (hook.keys.has(key)) {
+        stateNodes.push({ ModifiedNode: { ...node, FinalFields: fields } })
+      } else {
+        hook.keys.add(key)
+        this.accounts.get(owner).ownerCount++
+        stateNodes.push({ CreatedNode: { ...node, NewFields: fields } })
+      }
+    }
+
+    const executions = e.runs.map((r, i) => {
+      const account = address(r.id)
+      return {
+        HookExecution: {
+          HookAccount: account,
+          HookEmitCount: r.emitted,
+          HookExecutionIndex: i,
+          HookHash: this.hooks.get(account).hookHash,
+          HookInstructionCount: r.guard.toString(16).toUpperCase().padStart(16, '0'),
+          HookResult: r.accepted ? HOOK_ACCEPT : HOOK_ROLLBACK,
+          HookReturnCode: '0000000000000000',
+          HookReturnString: hex(r.message),
+          HookStateChangeCount: changed.get(account) || 0
+        }
+      }
+    })
+    return { balances: nodes, stateNodes, executions }
+  }
+
+  // Adds an applied transaction to the open ledger
+  #record(blob, tx, result, affected, executions) {
+    const hash = hex(sha512Half(TXN_PREFIX, blob))
+    const meta = { TransactionIndex: this.open.txns.length, TransactionResult: result, AffectedNodes: affected }
+    if (executions.length) meta.HookExecutions = executions
+    if (tx.TransactionType === 'Payment' && result === 'tesSUCCESS') meta.delivered_amount = tx.Amount
+
+    const accounts = new Set([tx.Account])
+    if (tx.Destination) accounts.add(tx.Destination)
+    for (const { HookExecution: e } of executions) accounts.add(e.HookAccount)
+    this.txns.set(hash, { tx, blob, meta, result, ledger: this.open.seq, accounts, validated: false })
+    this.open.txns.push(hash)
+    return hash
+  }
+
+  async submit(txBlob) {
+    return this.#serial(() => this.#submit(txBlob))
+  }
+
+  async #submit(txBlob) {
+    const blob = Buffer.from(txBlob, 'hex')
+    let tx
+    try {
+      tx = decodeTx(blob)
+    } catch (error) {
+      throw new RpcError('invalidTransaction', error.message)
+    }
+    const hash = hex(sha512Half(TXN_PREFIX, blob))
+    const response = (result) => ({
+      engine_result: result,
+      engine_result_code: RESULTS[result][0],
+      engine_result_message: RESULTS[result][1],
+      accepted: isApplied(result),
+      applied: isApplied(result),
+      broadcast: isApplied(result),
+      kept: isApplied(result),
+      queued: false,
+      current_ledger_index: this.open.seq,
+      validated_ledger_index: this.validated.seq,
+      tx_blob: txBlob,
+      tx_json: { ...tx, hash }
+    })
+
+    if (this.txns.has(hash)) return response('tefALREADY')
+    const account = this.accounts.get(tx.Account)
+    if (!account) return response('terNO_ACCOUNT')
+    if (tx.LastLedgerSequence && tx.LastLedgerSequence < this.open.seq) return response('tefMAX_LEDGER')
+    const ticket = tx.TicketSequence
+    if (ticket !== undefined) {
+      if (!account.tickets.has(ticket)) return response('tefNO_TICKET')
+    } else if (tx.Sequence < account.sequence) {
+      return response('tefPAST_SEQ')
+    } else if (tx.Sequence > account.sequence) {
+      return response('terPRE_SEQ')
+    }
+    const fee = BigInt(tx.Fee)
+    if (fee < this.#requiredFee(tx)) return response('telINSUF_FEE_P')
+
+    let result
+    let effects = { balances: [], stateNodes: [], executions: [] }
+    if (tx.TransactionType === 'Payment') {
+      const [event] = parseEvents(await this.ledger.call(OP.SUBMIT, blob))
+      result = paymentResult(event)
+      if (!isApplied(result)) return response(result)
+      effects = this.#effects(event)
+    } else {
+      if (account.balance < fee) return response('terINSUF_FEE_B')
+      const before = account.balance
+      account.balance = (await this.ledger.call(OP.ACCOUNT, account.id, i64(-fee))).readBigInt64BE(0)
+      effects.balances.push({ address: tx.Account, before })
+      result = 'tesSUCCESS'
+    }
+
+    // Sequence or Ticket used up, then any Tickets created
+    const ticketNodes = []
+    if (ticket !== undefined) {
+      account.tickets.delete(ticket)
+      account.ownerCount--
+      ticketNodes.push(this.#ticketNode('DeletedNode', tx.Account, ticket))
+    } else {
+      account.sequence++
+    }
+    if (tx.TransactionType === 'TicketCreate') {
+      const count = Math.min(tx.TicketCount || 0, TICKETS_MAX - account.tickets.size)
+      for (let i = 0; i < count; i++) {
+        account.tickets.add(account.sequence + i)
+        ticketNodes.push(this.#ticketNode('CreatedNode', tx.Account, account.sequence + i))
+      }
+      account.sequence += count
+      account.ownerCount += count
+    }
+
+    const affected = [...effects.balances.map((b) => this.#accountNode(b.address, b.before)), ...effects.stateNodes, ...ticketNodes]
+    this.#record(blob, tx, result, affected, effects.executions)
+    return response(result)
+  }
+
+  // Transactions emitted in the last ledger, applied as the next one opens
+  #applyEmitted(e) {
+    const result = paymentResult(e)
+    if (!isApplied(result)) return
+    let tx
+    try {
+      tx = decodeTx(e.blob)
+    } catch (error) {
+      console.error(`emitted transaction not decodable (${error.message}): ${hex(e.blob)}`)
+      return
+    }
+    const effects = this.#effects(e)
+    const affected = [...effects.balances.map((b) => this.#accountNode(b.address, b.before)), ...effects.stateNodes]
+    this.#record(e.blob, tx, result, affected, effects.executions)
+  }
+
+  async #close() {
+    const parent = this.validated
+    const closeTime = Math.max(rippleTime(), parent.closeTime + 1)
+    const ledger = {
+      seq: this.open.seq,
+      parentHash: parent.hash,
+      closeTime,
+      parentCloseTime: parent.closeTime,
+      txns: this.open.txns
+    }
+    ledger.hash = hex(sha512Half(LEDGER_PREFIX, u32(ledger.seq), Buffer.from(parent.hash, 'hex'), u32(closeTime),
+      ...ledger.txns.map((h) => Buffer.from(h, 'hex'))))
+    for (const hash of ledger.txns) this.txns.get(hash).validated = true
+    this.closed.push(ledger)
+    while (this.closed.length > this.config.history) {
+      for (const hash of this.closed.shift().txns) this.txns.delete(hash)
+    }
+
+    this.open = { seq: ledger.seq + 1, txns: [] }
+    const events = parseEvents(await this.ledger.call(OP.LEDGER, u32(this.open.seq), u32(closeTime)))
+    for (const e of events) this.#applyEmitted(e)
+    this.#publish(ledger)
+  }
+
+  // ---- Streams ----
+
+  #connect(ws) {
+    const client = { ws, streams: new Set(), accounts: new Set() }
+    this.clients.add(client)
+    ws.on('close', () => this.clients.delete(client))
+    ws.on('message', async (data) => {
+      let req
+      try {
+        req = JSON.parse(data)
+      } catch (error) {
+        return ws.send(JSON.stringify({ type: 'response', status: 'error', error: 'invalidParams', error_message: 'not JSON' }))
+      }
+      const reply = { id: req.id, type: 'response' }
+      if (req.api_version !== undefined) reply.api_version = req.api_version
+      try {
+        reply.result = await this.handle(client, req)
+        reply.status = 'success'
+      } catch (error) {
+        reply.status = 'error'
+        reply.error = error.error || 'internal'
+        reply.error_message = error.message
+        if (error.fields) Object.assign(reply, error.fields)
+        reply.request = req
+      }
+      if (ws.readyState === ws.OPEN) ws.send(JSON.stringify(reply))
+    })
+  }
+
+  #ledgerStream(ledger) {
+    return {
+      fee_base: this.config.baseFee,
+      fee_ref: this.config.baseFee,
+      ledger_hash: ledger.hash,
+      ledger_index: ledger.seq,
+      ledger_time: ledger.closeTime,
+      reserve_base: 1000000,
+      reserve_inc: 200000,
+      txn_count: ledger.txns.length,
+      validated_ledgers: `${this.closed[0].seq}-${ledger.seq}`
+    }
+  }
+
+  #publish(ledger) {
+    for (const hash of ledger.txns) {
+      const t = this.txns.get(hash)
+      const message = JSON.stringify({
+        type: 'transaction',
+        engine_result: t.result,
+        engine_result_code: RESULTS[t.result][0],
+        engine_result_message: RESULTS[t.result][1],
+        hash,
+        ledger_hash: ledger.hash,
+        ledger_index: ledger.seq,
+        meta: t.meta,
+        transaction: { ...t.tx, hash },
+        tx_json: t.tx,
+        close_time_iso: new Date((ledger.closeTime + RIPPLE_EPOCH) * 1000).toISOString().replace('.000', ''),
+        validated: true
+      })
+      for (const c of this.clients) {
+        if (c.streams.has('transactions') || [...t.accounts].some((a) => c.accounts.has(a))) c.ws.send(message)
+      }
+    }
+    const closed = JSON.stringify({ type: 'ledgerClosed', ...this.#ledgerStream(ledger) })
+    for (const c of this.clients) {
+      if (c.streams.has('ledger')) c.ws.send(closed)
+    }
+  }
+
+  // ---- Requests ----
+
+  #requireAccount(address) {
+    const a = this.accounts.get(address)
+    if (!a) throw new RpcError('actNotFound', 'Account not found.')
+    return a
+  }
+
+  async #stateEntries(address) {
+    const hook = this.hooks.get(address)
+    if (!hook) return []
+    const r = new Reader(await this.ledger.call(OP.ENTRIES, this.accounts.get(address).id))
+    const entries = []
+    for (let n = r.u32(); n > 0; n--) {
+      const key = Buffer.from(r.bytes(32))
+      const data = Buffer.from(r.bytes(r.u16()))
+      entries.push({
+        Flags: 0,
+        HookStateData: hex(data),
+        HookStateKey: hex(key),
+        LedgerEntryType: 'HookState',
+        OwnerNode: '0000000000000000',
+        index: hex(sha512Half(SPACE.hookState, this.accounts.get(address).id, key, hook.namespace))
+      })
+    }
+    return entries
+  }
+
+  #hookObject(address) {
+    const hook = this.hooks.get(address)
+    const HookParameters = hook.params.map(([name, value]) => ({ HookParameter: { HookParameterName: hex(name), HookParameterValue: hex(value) } }))
+    return {
+      Account: address,
+      Flags: 0,
+      Hooks: [{ Hook: { HookHash: hook.hookHash, HookNamespace: hex(hook.namespace), HookOn: HOOK_ON_PAYMENT, HookParameters } }],
+      LedgerEntryType: 'Hook',
+      OwnerNode: '0000000000000000',
+      index: hex(sha512Half(SPACE.hook, this.accounts.get(address).id))
+    }
+  }
+
+  #accountRoot(address) {
+    const a = this.#requireAccount(address)
+    return {
+      Account: address,
+      Balance: String(a.balance),
+      Flags: 0,
+      LedgerEntryType: 'AccountRoot',
+      OwnerCount: a.ownerCount,
+      Sequence: a.sequence,
+      index: hex(sha512Half(SPACE.account, a.id))
+    }
+  }
+
+  #findLedger(index) {
+    if (index === undefined || index === 'validated' || index === 'closed') return this.validated
+    if (index === 'current') return null
+    const seq = Number(index)
+    const ledger = this.closed.find((l) => l.seq === seq)
+    if (!ledger && seq !== this.open.seq) throw new RpcError('lgrNotFound', 'ledgerNotFound')
+    return ledger || null
+  }
+
+  #txEntry(hash, t, v1, binary) {
+    if (binary) return { hash, tx_blob: hex(t.blob), meta: hex(encodeTx(binaryMeta(t.meta))) }
+    if (v1) return { ...t.tx, hash, metaData: t.meta }
+    return { hash, tx_json: t.tx, meta: t.meta }
+  }
+
+  async handle(client, req) {
+    const v1 = req.api_version === 1
+    const current = { ledger_current_index: this.open.seq }
+    switch (req.command) {
+      case 'ping':
+        return {}
+
+      case 'server_info':
+      case 'server_state': {
+        const v = this.validated
+        return {
+          info: {
+            build_version: 'drippy-standin',
+            complete_ledgers: `${this.closed[0].seq}-${v.seq}`,
+            network_id: this.config.networkId,
+            server_state: 'full',
+            load_factor: 1,
+            validated_ledger: {
+              seq: v.seq,
+              hash: v.hash,
+              age: Math.max(0, rippleTime() - v.closeTime),
+              base_fee_xrp: this.config.baseFee / 1e6,
+              reserve_base_xrp: 1,
+              reserve_inc_xrp: 0.2
+            }
+          }
+        }
+      }
+
+      case 'fee': {
+        let fee = BigInt(this.config.baseFee)
+        if (req.tx_blob) fee = this.#requiredFee(decodeTx(Buffer.from(req.tx_blob, 'hex')))
+        return {
+          ...current,
+          current_ledger_size: String(this.open.txns.length),
+          current_queue_size: '0',
+          drops: { base_fee: String(fee), median_fee: String(fee), minimum_fee: String(fee), open_ledger_fee: String(fee) },
+          expected_ledger_size: '1000',
+          max_queue_size: '2000'
+        }
+      }
+
+      case 'subscribe':
+      case 'unsubscribe': {
+        const add = req.command === 'subscribe'
+        for (const s of req.streams || []) add ? client.streams.add(s) : client.streams.delete(s)
+        for (const a of req.accounts || []) add ? client.accounts.add(a) : client.accounts.delete(a)
+        return add && (req.streams || []).includes('ledger') ? this.#ledgerStream(this.validated) : {}
+      }
+
+      case 'account_info':
+        return { account_data: this.#accountRoot(req.account), ...current, validated: false }
+
+      case 'account_objects': {
+        const a = this.#requireAccount(req.account)
+        const objects = []
+        if ((!req.type || req.type === 'hook') && this.hooks.has(req.account)) objects.push(this.#hookObject(req.account))
+        if (!req.type || req.type === 'ticket') {
+          for (const t of [...a.tickets].sort((x, y) => x - y)) {
+            objects.push({ Account: req.account, Flags: 0, LedgerEntryType: 'Ticket', OwnerNode: '0000000000000000', TicketSequence: t, index: hex(sha512Half(SPACE.ticket, a.id, u32(t))) })
+          }
+        }
+        if (!req.type || req.type === 'hook_state') objects.push(...await this.#stateEntries(req.account))
+        return { account: req.account, account_objects: objects, ...current, validated: false }
+      }
+
+      case 'account_namespace': {
+        this.#requireAccount(req.account)
+        const hook = this.hooks.get(req.account)
+        const match = hook && String(req.namespace_id || '').toUpperCase() === hex(hook.namespace)
+        return {
+          account: req.account,
+          namespace_id: req.namespace_id,
+          namespace_entries: match ? await this.#stateEntries(req.account) : [],
+          ...current,
+          validated: false
+        }
+      }
+
+      case 'ledger_entry': {
+        let node
+        if (req.hook_definition) {
+          const hook = [...this.hooks.values()].find((h) => h.hookHash === String(req.hook_definition).toUpperCase())
+          if (hook) {
+            node = { Flags: 0, HookHash: hook.hookHash, HookNamespace: hex(hook.namespace), HookOn: HOOK_ON_PAYMENT, HookParameters: [], LedgerEntryType: 'HookDefinition', ReferenceCount: '1' }
+          }
+        } else if (req.hook_state) {
+          const { account, key, namespace_id: namespace } = req.hook_state
+          const hook = this.hooks.get(account)
+          if (hook && String(namespace).toUpperCase() === hex(hook.namespace)) {
+            node = (await this.#stateEntries(account)).find((e) => e.HookStateKey === String(key).toUpperCase())
+          }
+        } else if (req.account_root) {
+          node = this.accounts.has(req.account_root) ? this.#accountRoot(req.account_root) : null
+        } else if (req.index) {
+          const index = String(req.index).toUpperCase()
+          for (const account of this.hooks.keys()) {
+            node = node || (await this.#stateEntries(account)).find((e) => e.index === index)
+          }
+        }
+        if (!node) throw new RpcError('entryNotFound', 'Entry not found.')
+        return { index: node.index, node, ...current, validated: false }
+      }
+
+      case 'ledger': {
+        const ledger = this.#findLedger(req.ledger_index)
+        if (!ledger) return { ledger: { closed: false, ledger_index: this.open.seq, parent_hash: this.validated.hash }, ...current, validated: false }
+        const header = {
+          closed: true,
+          close_time: ledger.closeTime,
+          close_time_iso: new Date((ledger.closeTime + RIPPLE_EPOCH) * 1000).toISOString().replace('.000', ''),
+          ledger_hash: ledger.hash,
+          ledger_index: v1 ? String(ledger.seq) : ledger.seq,
+          parent_close_time: ledger.parentCloseTime,
+          parent_hash: ledger.parentHash
+        }
+        if (req.transactions) {
+          header.transactions = req.expand
+            ? ledger.txns.map((h) => this.#txEntry(h, this.txns.get(h), v1, req.binary))
+            : ledger.txns
+        }
+        return { ledger: header, ledger_hash: ledger.hash, ledger_index: ledger.seq, validated: true }
+      }
+
+      case 'tx': {
+        const hash = String(req.transaction || '').toUpperCase()
+        const t = this.txns.get(hash)
+        if (!t) {
+          // Every ledger since the stand-in started is kept, so a validated range is searched whole
+          const ranged = req.min_ledger !== undefined && req.max_ledger !== undefined
+          throw new RpcError('txnNotFound', 'Transaction not found.',
+            ranged ? { searched_all: req.max_ledger <= this.validated.seq } : undefined)
+        }
+        const base = { hash, ledger_index: t.ledger, validated: t.validated }
+        return v1 ? { ...t.tx, ...base, meta: t.meta } : { ...base, tx_json: t.tx, meta: t.meta }
+      }
+
+      case 'submit':
+        if (!req.tx_blob) throw new RpcError('invalidParams', 'tx_blob is required; the stand-in does not sign')
+        return this.submit(req.tx_blob)
+
+      default:
+        throw new RpcError('unknownCmd', `${req.command} is not served by the stand-in`)
+    }
+  }
+}
+
+// Metadata in the form encodeTx() takes: results and entry types as their codes
+function binaryMeta(meta) {
+  const { delivered_amount, ...rest } = meta
+  return {
+    ...rest,
+    TransactionResult: RESULTS[meta.TransactionResult][0],
+    AffectedNodes: meta.AffectedNodes.map((wrapper) => {
+      const [kind, node] = Object.entries(wrapper)[0]
+      return { [kind]: { ...node, LedgerEntryType: ENTRY_TYPES[node.LedgerEntryType] } }
+    })
+  }
+}
+
+async function main() {
+  const file = process.argv[2] || DEFAULT_CONFIG
+  const config = JSON.parse(fs.readFileSync(file, 'utf8'))
+  if (process.env.STANDIN_PORT) config.port = Number(process.env.STANDIN_PORT)
+  if (process.env.STANDIN_LEDGER_MS) config.ledgerMs = Number(process.env.STANDIN_LEDGER_MS)
+  const node = new StandinNode(config)
+  await node.start()
+  process.on('SIGINT', () => node.stop().then(() => process.exit(0)))
+}
+
+if (require.main === module) {
+  main().catch((e) => {
+    console.error(e)
+    process.exit(1)
+  })
+}
+
+module.exports = { StandinNode }
@@ -0,0 +1,320 @@
+/**
+ * Admin transaction submission without autofill round trips
+ *
+ * `client.submit(tx, { autofill: true })` asks the server for the fee, the account
+ * sequence and the ledger before every transaction, and the account sequence lets only
+ * one of them be in flight. TxSender completes transactions locally instead: Fee,
+ * LastLedgerSequence and NetworkID come from values it refreshes as ledgers validate,
+ * and in place of the account Sequence each transaction takes a Ticket from a pool kept
+ * topped up with TicketCreate. They are signed with backend/native TxSigner and
+ * submitted without waiting on each other, so throughput is bounded by what the ledger
+ * accepts rather than by round trips.
+ *
+ * A Ticket is used up once its transaction is in a validated ledger, whatever the result.
+ * Transactions the server rejects outright give their Ticket back to the pool, and so do
+ * ones the server confirms are in none of the ledgers up to their LastLedgerSequence.
+ */
+
+const crypto = require('crypto')
+const { TxSigner, encodeTx } = require('../native')
+
+const TXN_PREFIX = Buffer.from('54584E00', 'hex')
+const TICKETS_MAX = 250           // per account, rippled's limit
+const FEE_TTL_LEDGERS = 256
+
+function sha512Half(data) {
+  return crypto.createHash('sha512').update(data).digest().subarray(0, 32)
+}
+
+/**
+ * Signs a complete transaction with `signer` (a TxSigner); returns the blob to submit
+ * and the transaction hash
+ */
+function signTransaction(signer, tx) {
+  const unsigned = { ...tx, SigningPubKey: signer.publicKey }
+  const signature = signer.sign(encodeTx(unsigned, { signing: true }))
+  const blob = encodeTx({ ...unsigned, TxnSignature: signature.toString('hex').toUpperCase() })
+  return {
+    tx_blob: blob.toString('hex').toUpperCase(),
+    hash: sha512Half(Buffer.concat([TXN_PREFIX, blob])).toString('hex').toUpperCase()
+  }
+}
+
+// Results after which the transaction can no longer make it into a ledger
+function isFinalRejection(engineResult) {
+  return /^(tem|tef|tel)/.test(engineResult)
+}
+
+class TxSender {
+  /**
+   * `seed` is the family seed of the sending account. Options: `tickets`, the pool
+   * size TicketCreate tops up to (each Ticket holds an owner reserve); `lowWater`,
+   * the size that triggers it; `ledgerWindow`, ledgers until LastLedgerSequence.
+   */
+  constructor(client, seed, { tickets = 40, lowWater = 10, ledgerWindow = 20 } = {}) {
+    this.client = client
+    this.signer = new TxSigner(seed)
+    this.account = this.signer.address
+    this.target = Math.min(tickets, TICKETS_MAX)
+    this.lowWater = Math.min(lowWater, this.target)
+    this.ledgerWindow = ledgerWindow
+    this.tickets = []
+    this.inUse = new Set()
+    this.waiting = []
+    this.pending = new Map()
+    this.fees = new Map()
+    this.refilling = null
+    this.ledgerIndex = 0
+    this.networkId = undefined
+    this.started = null
+  }
+
+  start() {
+    if (!this.started) {
+      this.started = this.#start().catch((error) => {
+        this.started = null
+        throw error
+      })
+    }
+    return this.started
+  }
+
+  async #start() {
+    this.client.on('ledgerClosed', (ev) => this.#onLedger(ev))
+    this.client.on('transaction', (ev) => this.#onTransaction(ev))
+    await this.client.request({ command: 'subscribe', streams: ['ledger'], accounts: [this.account] })
+
+    const { result } = await this.client.request({ command: 'server_info' })
+    const info = result.info || {}
+    this.ledgerIndex = info.validated_ledger?.seq || 0
+    // NetworkID is required on networks above 1024 (Xahau is 21337) and refused below
+    if (info.network_id > 1024) this.networkId = info.network_id
+
+    await this.#loadTickets()
+    if (this.tickets.length < this.lowWater) await this.#refill()
+  }
+
+  async #loadTickets() {
+    const tickets = []
+    let marker
+    do {
+      const res = await this.client.request({
+        command: 'account_objects',
+        account: this.account,
+        type: 'ticket',
+        ledger_index: 'validated',
+        ...(marker ? { marker } : {})
+      })
+      for (const o of res.result.account_objects || []) tickets.push(o.TicketSequence)
+      marker = res.result.marker
+    } while (marker)
+    this.tickets = tickets.filter(t => !this.inUse.has(t)).sort((a, b) => a - b)
+  }
+
+  // One TicketCreate at a time, on the account Sequence, waited for until validated
+  #refill() {
+    if (!this.refilling) {
+      this.refilling = this.#createTickets().then(() => {
+        this.refilling = null
+        this.#wake()
+      }, (error) => {
+        this.refilling = null
+        for (const w of this.waiting.splice(0)) w.reject(error)
+        throw error
+      })
+    }
+    return this.refilling
+  }
+
+  async #createTickets() {
+    const owned = this.tickets.length + this.inUse.size
+    const count = Math.min(this.target - this.tickets.length, TICKETS_MAX - owned)
+    if (count <= 0) return
+
+    const { result } = await this.client.request({
+      command: 'account_info',
+      account: this.account,
+      ledger_index: 'current'
+    })
+    const tx = await this.#complete({
+      TransactionType: 'TicketCreate',
+      Account: this.account,
+      Sequence: result.account_data.Sequence,
+      TicketCount: count
+    })
+    const outcome = await this.#send(tx, null)
+    const { result: final } = await outcome.validated
+    if (final !== 'tesSUCCESS') throw new Error(`TicketCreate failed: ${final}`)
+    await this.#loadTickets()
+  }
+
+  #wake() {
+    while (this.waiting.length && this.tickets.length) this.waiting.shift().resolve(this.#use(this.tickets.shift()))
+  }
+
+  #topUp() {
+    this.#refill().catch((error) => console.error('TicketCreate failed', error.message))
+  }
+
+  #takeTicket() {
+    if (this.tickets.length <= this.lowWater) this.#topUp()
+    if (this.tickets.length) return Promise.resolve(this.#use(this.tickets.shift()))
+    return new Promise((resolve, reject) => this.waiting.push({ resolve, reject }))
+  }
+
+  // Tickets handed out are kept out of the pool until released or used up
+  #use(ticket) {
+    this.inUse.add(ticket)
+    return ticket
+  }
+
+  #releaseTicket(ticket) {
+    if (ticket === null || !this.inUse.delete(ticket)) return
+    const i = this.tickets.findIndex(t => t > ticket)
+    this.tickets.splice(i < 0 ? this.tickets.length : i, 0, ticket)
+    this.#wake()
+  }
+
+  // With every Ticket handed out, one used up makes room for the next TicketCreate
+  #usedUp(ticket) {
+    this.inUse.delete(ticket)
+    if (this.waiting.length) this.#topUp()
+  }
+
+  /**
+   * Fee for a transaction like `tx`. Asked once per type and destination with the
+   * transaction itself, since on Xahau the fee includes the hooks it triggers, and
+   * kept for FEE_TTL_LEDGERS.
+   */
+  #fee(tx) {
+    const key = `${tx.TransactionType}:${tx.Destination || ''}`
+    const cached = this.fees.get(key)
+    if (cached && this.ledgerIndex - cached.ledger < FEE_TTL_LEDGERS) return cached.fee
+
+    // The promise is kept, so a burst of submissions asks once
+    const probe = encodeTx({ ...tx, Fee: '0', SigningPubKey: '' }).toString('hex').toUpperCase()
+    const fee = this.client.request({ command: 'fee', tx_blob: probe }).then(({ result }) =>
+      String(Math.max(Number(result.drops.base_fee), Number(result.drops.open_ledger_fee || 0))))
+    this.fees.set(key, { fee, ledger: this.ledgerIndex })
+    fee.catch(() => this.fees.delete(key))
+    return fee
+  }
+
+  async #complete(tx) {
+    const filled = {
+      ...tx,
+      Account: this.account,
+      LastLedgerSequence: this.ledgerIndex + this.ledgerWindow,
+      ...(this.networkId !== undefined ? { NetworkID: this.networkId } : {})
+    }
+    filled.Fee = tx.Fee || await this.#fee(filled)
+    return filled
+  }
+
+  async #send(tx, ticket) {
+    const { tx_blob, hash } = signTransaction(this.signer, tx)
+    let entry
+    const validated = new Promise((resolve, reject) => {
+      entry = { ticket, firstLedger: this.ledgerIndex, lastLedger: tx.LastLedgerSequence, resolve, reject }
+    })
+    validated.catch(() => {})
+    // Registered before submitting: the validation can arrive before the response
+    this.pending.set(hash, entry)
+
+    // A failed request may still have reached the server: the entry stays and expires
+    const res = await this.client.request({ command: 'submit', tx_blob })
+    const engineResult = res.result.engine_result
+    if (isFinalRejection(engineResult) && this.pending.has(hash)) {
+      this.pending.delete(hash)
+      // tefNO_TICKET: the Ticket is gone already
+      if (engineResult === 'tefNO_TICKET') this.#usedUp(ticket)
+      else this.#releaseTicket(ticket)
+      if (engineResult === 'telINSUF_FEE_P') this.fees.clear()
+      entry.reject(new Error(`rejected: ${engineResult}`))
+    }
+    return { hash, ticket, engineResult, validated }
+  }
+
+  /**
+   * Completes, signs and submits `tx` on a Ticket. Resolves once the server has the
+   * transaction, with { hash, ticket, engineResult, validated }; `validated` resolves
+   * to { hash, result, ledger } when it is in a validated ledger and rejects when it is
+   * rejected or expires.
+   */
+  async submit(tx) {
+    await this.start()
+    const ticket = await this.#takeTicket()
+    let filled
+    try {
+      filled = await this.#complete({ ...tx, Sequence: 0, TicketSequence: ticket })
+    } catch (error) {
+      this.#releaseTicket(ticket)
+      throw error
+    }
+    return this.#send(filled, ticket)
+  }
+
+  async submitAndWait(tx) {
+    const { validated } = await this.submit(tx)
+    return validated
+  }
+
+  #onTransaction(ev) {
+    if (!ev.validated) return
+    const hash = ev.hash || ev.transaction?.hash || ev.tx_json?.hash
+    const entry = hash && this.pending.get(hash)
+    if (!entry) return
+    this.pending.delete(hash)
+    this.#usedUp(entry.ticket)
+    entry.resolve({ hash, result: ev.meta?.TransactionResult || ev.engine_result, ledger: ev.ledger_index })
+  }
+
+  /**
+   * Pending transactions past their LastLedgerSequence are looked up in the ledgers they
+   * could be in. Only a lookup that searched all of them expires one and returns its
+   * Ticket; a failed or partial lookup (a reconnect, a server missing ledgers) is tried
+   * again next ledger, as the transaction may have validated in the meantime.
+   */
+  async #onLedger(ev) {
+    this.ledgerIndex = ev.ledger_index
+    for (const [hash, entry] of this.pending) {
+      if (entry.lastLedger >= ev.ledger_index || entry.checking) continue
+      entry.checking = true
+      const found = await this.#lookUp(hash, entry)
+      entry.checking = false
+      if (found === null || !this.pending.has(hash)) continue
+      this.pending.delete(hash)
+      if (found.validated) {
+        this.#usedUp(entry.ticket)
+        entry.resolve({ hash, result: found.result, ledger: found.ledger })
+      } else {
+        this.#releaseTicket(entry.ticket)
+        entry.reject(new Error(`expired after ledger ${entry.lastLedger}`))
+      }
+    }
+  }
+
+  // { validated: true, result, ledger } when in a validated ledger, { validated: false }
+  // when the server searched every ledger up to LastLedgerSequence, null when unknown
+  async #lookUp(hash, entry) {
+    try {
+      const { result } = await this.client.request({
+        command: 'tx',
+        transaction: hash,
+        min_ledger: entry.firstLedger,
+        max_ledger: entry.lastLedger
+      })
+      if (!result.validated) return null
+      return { validated: true, result: result.meta?.TransactionResult, ledger: result.ledger_index }
+    } catch (error) {
+      const response = error.data || {}
+      if (response.error === 'txnNotFound' && response.searched_all === true) return { validated: false }
+      return null
+    }
+  }
+}
+
+module.exports = {
+  signTransaction,
+  TxSender
+}
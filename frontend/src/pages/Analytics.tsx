@@ -1,4 +1,4 @@
-import React from 'react'
+import React, { useEffect, useState } from 'react'
 import { motion } from 'framer-motion'
 import { 
   TrendingUp, 
@@ -22,7 +22,7 @@ const Analytics: React.FC = () => {
     { time: '24:00', price: 1.15 }
   ]
 
-  const volumeData = [
+  const [volumeData, setVolumeData] = useState([
     { time: 'Mon', volume: 45.2 },
     { time: 'Tue', volume: 52.1 },
     { time: 'Wed', volume: 38.7 },
@@ -30,7 +30,23 @@ const Analytics: React.FC = () => {
     { time: 'Fri', volume: 48.9 },
     { time: 'Sat', volume: 35.6 },
     { time: 'Sun', volume: 42.8 }
-  ]
+  ])
+
+  // Daily buckets kept by the router hook in state; the sample data stays when the
+  // backend is unreachable
+  useEffect(() => {
+    const baseUrl = import.meta.env.VITE_API_URL || 'http://localhost:8787'
+    fetch(`${baseUrl}/api/hooks/router/metrics?period=day&count=7`)
+      .then(res => (res.ok ? res.json() : null))
+      .then(data => {
+        if (!data?.buckets) return
+        setVolumeData(data.buckets.map((b: { start: string; volume: string }) => ({
+          time: new Date(b.start).toLocaleDateString('en-US', { weekday: 'short' }),
+          volume: Number(b.volume) / 1000000
+        })))
+      })
+      .catch(() => {})
+  }, [])
 
   const distributionData = [
     { name: 'Staked XRP', value: 45, color: '#0ea5e9' },